@@ -59,6 +59,7 @@ protected:
 	void changeLabelMarkerColor();
 	void changeMaxMeshSize(double);
 	void changeMaxCloudSize(double);
+	void changePointBudget(double);
 	void changeVBOUsage();
 	void changeColorScaleRampWidth(int);
 	void changePickingCursor(int);
@@ -61,6 +61,7 @@ ccDisplayOptionsDlg::ccDisplayOptionsDlg(QWidget* parent)
 	connect(m_ui->useColorScaleShaderCheckBox,     &QCheckBox::toggled, this, [&](bool state) { m_parameters.colorScaleUseShader = state; });
 	connect(m_ui->decimateMeshBox,                 &QCheckBox::toggled, this, [&](bool state) { m_parameters.decimateMeshOnMove = state; });
 	connect(m_ui->decimateCloudBox,                &QCheckBox::toggled, this, [&](bool state) { m_parameters.decimateCloudOnMove = state; });
+	connect(m_ui->pointBudgetCheckBox,             &QCheckBox::toggled, this, [&](bool state) { m_parameters.usePointBudget = state; });
 	connect(m_ui->drawRoundedPointsCheckBox,       &QCheckBox::toggled, this, [&](bool state) { m_parameters.drawRoundedPoints = state; });
 	connect(m_ui->singleClickPickingCheckBox,	   &QCheckBox::toggled, this, [&](bool state) { m_parameters.singleClickPicking = state; });
 	connect(m_ui->autoDisplayNormalsCheckBox,      &QCheckBox::toggled, this, [&](bool state) { m_options.normalsDisplayedByDefault = state; });
@@ -78,6 +79,7 @@ ccDisplayOptionsDlg::ccDisplayOptionsDlg(QWidget* parent)
 
 	connect(m_ui->zoomSpeedDoubleSpinBox,		qOverload<double>(&QDoubleSpinBox::valueChanged), this, &ccDisplayOptionsDlg::changeZoomSpeed);
 	connect(m_ui->maxCloudSizeDoubleSpinBox,	qOverload<double>(&QDoubleSpinBox::valueChanged), this, &ccDisplayOptionsDlg::changeMaxCloudSize);
+	connect(m_ui->pointBudgetDoubleSpinBox,		qOverload<double>(&QDoubleSpinBox::valueChanged), this, &ccDisplayOptionsDlg::changePointBudget);
 	connect(m_ui->maxMeshSizeDoubleSpinBox,		qOverload<double>(&QDoubleSpinBox::valueChanged), this, &ccDisplayOptionsDlg::changeMaxMeshSize);
 
 	connect(m_ui->autoComputeOctreeComboBox,	qOverload<int>(&QComboBox::currentIndexChanged), this, &ccDisplayOptionsDlg::changeAutoComputeOctreeOption);
@@ -184,6 +186,8 @@ void ccDisplayOptionsDlg::refresh()
 	m_ui->decimateCloudBox->setChecked(m_parameters.decimateCloudOnMove);
 	m_ui->drawRoundedPointsCheckBox->setChecked(m_parameters.drawRoundedPoints);
 	m_ui->maxCloudSizeDoubleSpinBox->setValue(m_parameters.minLoDCloudSize / 1000000.0);
+	m_ui->pointBudgetCheckBox->setChecked(m_parameters.usePointBudget);
+	m_ui->pointBudgetDoubleSpinBox->setValue(m_parameters.pointBudget / 1000000.0);
 	m_ui->useVBOCheckBox->setChecked(m_parameters.useVBOs);
 	m_ui->showCrossCheckBox->setChecked(m_parameters.displayCross);
 	m_ui->singleClickPickingCheckBox->setChecked(m_parameters.singleClickPicking);
@@ -386,6 +390,11 @@ void ccDisplayOptionsDlg::changeMaxCloudSize(double val)
 	m_parameters.minLoDCloudSize = static_cast<unsigned>(val * 1000000);
 }
 
+void ccDisplayOptionsDlg::changePointBudget(double val)
+{
+	m_parameters.pointBudget = static_cast<unsigned>(val * 1000000);
+}
+
 void ccDisplayOptionsDlg::changeVBOUsage()
 {
 	m_parameters.useVBOs = m_ui->useVBOCheckBox->isChecked();
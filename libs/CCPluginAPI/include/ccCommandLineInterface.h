@@ -175,6 +175,12 @@ public: //commands
 		//! Main process
 		virtual bool process(ccCommandLineInterface& cmd) = 0;
 
+		//! Whether the command can process clouds with a pending (deferred) transformation
+		/** Otherwise, the pending transformations are applied before the command is processed
+			(see ccGenericPointCloud::setDeferredTransformations).
+		**/
+		virtual bool supportsDeferredTransformations() const { return false; }
+
 		//! Command name
 		QString m_name;
 		//! Command keyword
@@ -270,6 +276,17 @@ public: //file I/O
 	**/
 	virtual bool importFile(QString filename, const GlobalShiftOptions& globalShiftOptions, FileIOFilter::Shared filter = FileIOFilter::Shared(nullptr)) = 0;
 
+	//! Opens a cloud file to process it block by block
+	/** Only one block (of at most 'blockSize' points) is loaded at a time. The
+		subsequent point-local commands are applied to each block, and the blocks
+		are written one after the other when the cloud is saved.
+		\return success
+	**/
+	virtual bool importFileAsStream(QString filename, const GlobalShiftOptions& globalShiftOptions, unsigned blockSize) = 0;
+
+	//! Returns whether a cloud is currently streamed (i.e. the loaded cloud is only one block of it)
+	virtual bool isCloudStreamed() const = 0;
+
 	//! Returns the current cloud(s) export format
 	virtual QString cloudExportFormat() const = 0;
 	//! Returns the current cloud(s) export extension (warning: can be anything)
@@ -139,8 +139,9 @@ protected:
 	virtual ~ccArray() {}
 
 	//inherited from ccHObject
-	inline bool toFile_MeOnly(QFile& out, short dataVersion) const override { return ccSerializationHelper::GenericArrayToFile<Type, N, ComponentType>(*this, out); }
+	inline bool toFile_MeOnly(QFile& out, short dataVersion) const override { return ccSerializationHelper::GenericArrayToFile<Type, N, ComponentType>(*this, out, dataVersion); }
 	inline bool fromFile_MeOnly(QFile& in, short dataVersion, int flags, LoadedIDMap& oldToNewIDMap) override { return ccSerializationHelper::GenericArrayFromFile<Type, N, ComponentType>(*this, in, dataVersion); }
+	inline short minimumFileVersion_MeOnly() const override { return std::max(ccHObject::minimumFileVersion_MeOnly(), ccSerializationHelper::GenericArrayToFileMinVersion(this->size())); }
 
 };
 
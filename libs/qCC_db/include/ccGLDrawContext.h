@@ -24,6 +24,8 @@
 #include "ccMaterial.h"
 
 class ccGenericGLDisplay;
+class ccLODPointBudget;
+class ccRenderScheduler;
 class ccScalarField;
 class ccColorRampShader;
 class ccShader;
@@ -50,7 +52,7 @@ enum CC_DRAWING_FLAGS
 	CC_SKIP_SELECTED						= 0x0020,
 	CC_SKIP_ALL								= 0x0030,		// = CC_SKIP_UNSELECTED | CC_SKIP_SELECTED
 	CC_ENTITY_PICKING						= 0x0040,		// formerly named CC_DRAW_ENTITY_NAMES
-	//CC_FREE_FLAG							= 0x0080,		// UNUSED (formerly CC_DRAW_POINT_NAMES)
+	CC_SCHEDULING_PASS						= 0x0080,		// scheduling pass (the clouds and meshes are only registered, see ccRenderScheduler)
 	//CC_FREE_FLAG							= 0x0100,		// UNUSED (formerly CC_DRAW_TRI_NAMES)
 	CC_FAST_ENTITY_PICKING					= 0x0200,		// formerly named CC_DRAW_FAST_NAMES_ONLY
 	//CC_FREE_FLAG							= 0x03C0,		// UNUSED (formerly CC_DRAW_ANY_NAMES = CC_DRAW_ENTITY_NAMES | CC_DRAW_POINT_NAMES | CC_DRAW_TRI_NAMES)
@@ -68,6 +70,7 @@ enum CC_DRAWING_FLAGS
 #define MACRO_LightIsEnabled(context)      (context.drawingFlags & CC_LIGHT_ENABLED)
 #define MACRO_Foreground(context)          (context.drawingFlags & CC_DRAW_FOREGROUND)
 #define MACRO_LODActivated(context)        (context.drawingFlags & CC_LOD_ACTIVATED)
+#define MACRO_SchedulingPass(context)      (context.drawingFlags & CC_SCHEDULING_PASS)
 #define MACRO_VirtualTransEnabled(context) (context.drawingFlags & CC_VIRTUAL_TRANS_ENABLED)
 
 //! Display context
@@ -118,6 +121,10 @@ struct ccGLDrawContext
 	bool moreLODPointsAvailable;
 	//! Whether higher levels are available or not
 	bool higherLODLevelsAvailable;
+	//! Point budget shared by all the clouds (point budget mode only)
+	ccLODPointBudget* lodPointBudget;
+	//! Scene-level scheduler (point budget mode only)
+	ccRenderScheduler* renderScheduler;
 
 	//! Whether to decimate big meshes when rotating the camera
 	bool decimateMeshOnMove;
@@ -133,6 +140,8 @@ struct ccGLDrawContext
 	ccShader* customRenderingShader;
 	//! Use VBOs for faster display
 	bool useVBOs;
+	//! Whether some VBOs are still being updated (asynchronously)
+	bool pendingVBOUpdates;
 
 	//! Label marker size (radius)
 	float labelMarkerSize;
@@ -181,12 +190,15 @@ struct ccGLDrawContext
 		, currentLODLevel(0)
 		, moreLODPointsAvailable(false)
 		, higherLODLevelsAvailable(false)
+		, lodPointBudget(nullptr)
+		, renderScheduler(nullptr)
 		, decimateMeshOnMove(true)
 		, minLODTriangleCount(2500000)
 		, sfColorScaleToDisplay(nullptr)
 		, colorRampShader(nullptr)
 		, customRenderingShader(nullptr)
 		, useVBOs(true)
+		, pendingVBOUpdates(false)
 		, labelMarkerSize(5)
 		, labelMarkerTextShift_pix(5)
 		, dispNumberPrecision(6)
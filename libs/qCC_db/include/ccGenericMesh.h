@@ -24,6 +24,7 @@
 //Local
 #include "ccAdvancedTypes.h"
 #include "ccGenericGLDisplay.h"
+#include "ccMeshBVH.h"
 #include "ccShiftedObject.h"
 
 namespace CCCoreLib
@@ -212,7 +213,9 @@ public:
 	**/
 	void importParametersFrom(const ccGenericMesh* mesh);
 
-	//! Brute force triangle picking
+	//! Triangle picking
+	/** Ray-cast through the mesh BVH (brute force if the BVH can't be built).
+	**/
 	virtual bool trianglePicking(	const CCVector2d& clickPos,
 									const ccGLCameraParameters& camera,
 									int& nearestTriIndex,
@@ -230,6 +233,18 @@ public:
 	//! Computes the point that corresponds to the given uv (barycentric) coordinates
 	bool computePointPosition(unsigned triIndex, const CCVector2d& uv, CCVector3& P, bool warningIfOutside = true) const;
 
+	//! Returns the BVH of the mesh (local coordinates)
+	/** The BVH is built on the first call, and rebuilt if the triangles or the vertices have changed.
+		\return a null pointer if the BVH can't be built (empty mesh or not enough memory)
+	**/
+	ccMeshBVH::Shared getBVH() const;
+
+	//! Releases the BVH (if any)
+	void releaseBVH();
+
+	//inherited from ccHObject
+	void notifyGeometryUpdate() override;
+
 	//! Helper to determine if the input cloud acts as vertices of a mesh
 	static bool IsCloudVerticesOfMesh(ccGenericPointCloud* cloud, ccGenericMesh** mesh = nullptr);
 
@@ -279,6 +294,11 @@ protected:
 	//! Handles the color ramp display
 	void handleColorRamp(CC_DRAW_CONTEXT& context);
 
+	//! Returns the decimation step for LOD display (1 = no decimation)
+	/** The triangle budget may be shared by all the displayed meshes (see ccRenderScheduler).
+	**/
+	unsigned getLODDecimationStep(const CC_DRAW_CONTEXT& context, size_t triNum) const;
+
 	//! Per-triangle normals display flag
 	bool m_triNormsShown;
 
@@ -290,6 +310,9 @@ protected:
 
 	//! Polygon stippling state
 	bool m_stippling;
+
+	//! Bounding Volume Hierarchy (built on demand)
+	mutable ccMeshBVH::Shared m_bvh;
 };
 
 #endif //CC_GENERIC_MESH_HEADER
@@ -234,6 +234,41 @@ public:
 	//! Applies a rigid transformation (rotation + translation)
 	virtual void applyRigidTransformation(const ccGLMatrix& trans) = 0;
 
+	//! Sets whether the rigid transformations should be deferred
+	/** In this mode, the successive transformations are only composed and stored
+		(see getPendingTransformation) so that chaining them is cheap. The coordinates
+		are physically updated on demand (see applyPendingTransformation), when the mode
+		is disabled, or when the cloud is saved, picked, etc. Meanwhile, the pending
+		transformation is applied on the fly by the display (as a GL transformation),
+		by the bounding-box and by getTransformedPoint.
+		\warning Algorithms reading the coordinates directly should not be run while
+		the cloud has a pending transformation.
+	**/
+	void setDeferredTransformations(bool state);
+
+	//! Returns whether the rigid transformations are deferred (see setDeferredTransformations)
+	inline bool deferredTransformations() const { return m_deferTransformations; }
+
+	//! Returns whether the cloud has a pending (deferred) transformation
+	inline bool hasPendingTransformation() const { return m_hasPendingTransformation; }
+
+	//! Returns the pending (deferred) transformation
+	inline const ccGLMatrix& getPendingTransformation() const { return m_pendingTransformation; }
+
+	//! Returns a point with the pending transformation applied (if any)
+	inline CCVector3 getTransformedPoint(unsigned index) const
+	{
+		CCVector3 P = *getPoint(index);
+		if (m_hasPendingTransformation)
+		{
+			m_pendingTransformation.apply(P);
+		}
+		return P;
+	}
+
+	//! Physically applies the pending transformation to the cloud data (if any)
+	virtual void applyPendingTransformation() {}
+
 	//! Crops the cloud inside (or outside) a bounding box
 	/** \warning Always returns a selection (potentially empty) if successful.
 		\param box cropping box
@@ -297,6 +332,15 @@ protected:
 	//! Point size (won't be applied if 0)
 	unsigned char m_pointSize;
 
+	//! Whether the rigid transformations are deferred
+	bool m_deferTransformations;
+
+	//! Whether the cloud has a pending (deferred) transformation
+	bool m_hasPendingTransformation;
+
+	//! Pending (deferred) transformation
+	ccGLMatrix m_pendingTransformation;
+
 };
 
 #endif //CC_GENERIC_POINT_CLOUD_HEADER
@@ -290,6 +290,12 @@ public: //display
 	//Inherited from ccDrawableObject
 	void draw(CC_DRAW_CONTEXT& context) override;
 
+	//! Draws the entity only (i.e. not its children)
+	/** The GL transformation of the entity must have already been applied
+		(used to draw the entities in a different order, see ccRenderScheduler).
+	**/
+	void drawEntityOnly(CC_DRAW_CONTEXT& context);
+
 	//! Returns the absolute transformation (i.e. the actual displayed GL transformation) of an entity
 	/** \param[out] trans absolute transformation
 		\return whether a GL transformation is actually enabled or not
@@ -0,0 +1,106 @@
+#pragma once
+
+//##########################################################################
+//#                                                                        #
+//#                              CLOUDCOMPARE                              #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU General Public License as published by  #
+//#  the Free Software Foundation; version 2 or later of the License.      #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#                    COPYRIGHT: CloudCompare project                     #
+//#                                                                        #
+//##########################################################################
+
+//Local
+#include "ccGenericGLDisplay.h"
+#include "ccPointCloudLOD.h"
+#include "qCC_db.h"
+
+//system
+#include <vector>
+
+//! Point budget shared by the LOD structures of all the displayed clouds
+/** Instead of displaying the LOD levels one after the other, a fixed number
+	of points is displayed at each frame. The visible cells of all the clouds
+	are prioritized by their projected size on screen: the biggest (i.e. the
+	closest) cells are refined first, until the budget is exhausted.
+
+	Usage (for each frame):
+	- reset
+	- addCloud for each displayed cloud (once its cells visibility has been flagged)
+	  or addFixedPoints for the clouds displayed without LOD structure
+	- dispatch
+	- indexMap to retrieve the points to display for each cloud
+**/
+class QCC_DB_LIB_API ccLODPointBudget
+{
+public:
+
+	//! Default constructor
+	ccLODPointBudget();
+
+	//! Clears the registered clouds and sets the number of points to display
+	void reset(unsigned pointBudget);
+
+	//! Returns the number of points to display
+	inline unsigned pointBudget() const { return m_pointBudget; }
+
+	//! Registers the LOD structure of a cloud
+	/** The cells visibility must have been flagged (see ccPointCloudLOD::flagVisibility).
+		\param lod initialized LOD structure
+		\param camera camera parameters (in the cloud local coordinate system)
+	**/
+	void addCloud(ccPointCloudLOD* lod, const ccGLCameraParameters& camera);
+
+	//! Registers points that will be displayed without LOD structure
+	/** These points are deducted from the budget (half of it is always kept for the LOD structures).
+	**/
+	inline void addFixedPoints(unsigned count) { m_fixedPointCount += count; }
+
+	//! Selects the cells to display and builds the index map of each registered cloud
+	void dispatch();
+
+	//! Returns the index map of a given LOD structure (after dispatch)
+	/** \return nullptr if the structure has not been registered
+	**/
+	LODIndexSet* indexMap(const ccPointCloudLOD* lod);
+
+	//! Returns the number of points that will actually be displayed (after dispatch)
+	inline unsigned displayedPoints() const { return m_displayedPoints; }
+
+protected:
+
+	//! Registered cloud
+	struct Cloud
+	{
+		//! LOD structure
+		ccPointCloudLOD* lod = nullptr;
+		//! Camera parameters (in the cloud local coordinate system)
+		ccGLCameraParameters camera;
+		//! Selected cells
+		std::vector<ccPointCloudLOD::SelectedCell> cells;
+		//! Index map (after dispatch)
+		LODIndexSet* indexMap = nullptr;
+	};
+
+	//! Returns the projected radius of a cell (in pixels)
+	static float ProjectedRadius(const ccPointCloudLOD::Node& node, const ccGLCameraParameters& camera);
+
+	//! Registered clouds
+	std::vector<Cloud> m_clouds;
+
+	//! Number of points to display
+	unsigned m_pointBudget;
+
+	//! Number of points displayed without LOD structure
+	unsigned m_fixedPointCount;
+
+	//! Number of points that will actually be displayed
+	unsigned m_displayedPoints;
+};
@@ -24,6 +24,7 @@
 
 //Local
 #include "ccGenericMesh.h"
+#include "ccPointCloud.h"
 
 class ccProgressDialog;
 class ccPolyline;
@@ -409,6 +410,17 @@ public:
 	//! Merges duplicated vertices
 	bool mergeDuplicatedVertices(unsigned char octreeLevel = DefaultMergeDuplicateVerticesLevel, QWidget* parentWidget = nullptr);
 
+	//! Release VBOs
+	void releaseVBOs();
+
+	//! Returns the VBOs size (if any)
+	size_t vboSize() const;
+
+	//inherited from ccHObject
+	void notifyGeometryUpdate() override;
+	void setDisplay(ccGenericGLDisplay* win) override;
+	void removeFromDisplay(const ccGenericGLDisplay* win) override; //for proper VBO release
+
 protected: //methods
 
 	//inherited from ccHObject
@@ -432,6 +444,108 @@ protected: //methods
 	//! Used internally by 'subdivide'
 	bool pushSubdivide(/*PointCoordinateType maxArea, */unsigned indexA, unsigned indexB, unsigned indexC);
 
+protected: // VBO
+
+	//! Display options of the VBOs
+	struct VBOLayout
+	{
+		//! Whether the data is stored per triangle corner (per-triangle normals or textures) or per vertex (indexed)
+		bool perCorner = false;
+		//! Whether the triangles are sorted by material
+		bool sortedByMaterial = false;
+		bool hasNormals = false;
+		bool triNormals = false;
+		bool hasColors = false;
+		bool colorIsSF = false;
+		bool hasTexCoords = false;
+
+		inline bool operator != (const VBOLayout& other) const
+		{
+			return	perCorner != other.perCorner
+				||	sortedByMaterial != other.sortedByMaterial
+				||	hasNormals != other.hasNormals
+				||	triNormals != other.triNormals
+				||	hasColors != other.hasColors
+				||	colorIsSF != other.colorIsSF
+				||	hasTexCoords != other.hasTexCoords;
+		}
+	};
+
+	//! Init/updates VBOs
+	/** \return whether the VBOs can be used for display
+	**/
+	bool updateVBOs(const CC_DRAW_CONTEXT& context, const VBOLayout& layout, ccScalarField* sf);
+
+	//! Draws the mesh with the VBOs
+	void drawWithVBOs(CC_DRAW_CONTEXT& context, const glDrawParams& glParams, bool showWired);
+
+	//! Part of the mesh stored in a single buffer
+	struct VBOPart
+	{
+		//! Triangle or vertex data (per-corner layout) or triangle indexes (indexed layout)
+		QGLBuffer* buffer = nullptr;
+		//! First triangle (in display order)
+		unsigned firstTriangle = 0;
+		unsigned triangleCount = 0;
+		//! Offsets of the different data (per-corner layout)
+		int normalShift = 0;
+		int colorShift = 0;
+		int texCoordShift = 0;
+	};
+
+	//! Range of consecutive triangles (in display order) sharing the same material
+	struct VBOMaterialGroup
+	{
+		int mtlIndex;
+		unsigned firstTriangle;
+		unsigned triangleCount;
+	};
+
+	//! VBO set
+	struct vboSet
+	{
+		//! States of the VBO(s)
+		enum STATES { NEW, INITIALIZED, FAILED };
+
+		//! Update flags
+		enum UPDATE_FLAGS {
+			UPDATE_POINTS = 1,
+			UPDATE_COLORS = 2,
+			UPDATE_NORMALS = 4,
+			UPDATE_TEXCOORDS = 8,
+			UPDATE_TRIANGLES = 16,
+			UPDATE_ALL = UPDATE_POINTS | UPDATE_COLORS | UPDATE_NORMALS | UPDATE_TEXCOORDS | UPDATE_TRIANGLES
+		};
+
+		//! Current layout
+		VBOLayout layout;
+		//! Shared vertex data (indexed layout)
+		QGLBuffer* vertexBuffer = nullptr;
+		//! Offsets of the vertex data (indexed layout)
+		int normalShift = 0;
+		int colorShift = 0;
+		//! Triangle buffers
+		std::vector<VBOPart> parts;
+		//! Material groups (if the triangles are sorted by material)
+		std::vector<VBOMaterialGroup> materialGroups;
+		//! Display order of the triangles (if they are sorted by material)
+		std::vector<unsigned> triangleOrder;
+
+		//! Source data
+		unsigned triangleCount = 0;
+		unsigned vertexCount = 0;
+		const ccScalarField* sourceSF = nullptr;
+		unsigned sourceSFModificationCount = 0;
+		ccPointCloud::DisplayDataVersions cloudVersions;
+
+		size_t totalMemSizeBytes = 0;
+		//! Current state
+		STATES state = NEW;
+	};
+
+	//! Set of VBOs attached to this mesh
+	vboSet m_vboManager;
+
 	/*** EXTENDED CALL SCRIPTS (FOR CC_SUB_MESHES) ***/
 	
 	//0 parameter
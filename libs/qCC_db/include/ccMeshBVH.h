@@ -0,0 +1,131 @@
+#pragma once
+
+//##########################################################################
+//#                                                                        #
+//#                              CLOUDCOMPARE                              #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU General Public License as published by  #
+//#  the Free Software Foundation; version 2 or later of the License.      #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#                    COPYRIGHT: CloudCompare project                     #
+//#                                                                        #
+//##########################################################################
+
+//Local
+#include "qCC_db.h"
+
+//CCCoreLib
+#include <CCGeom.h>
+
+//Qt
+#include <QSharedPointer>
+
+//system
+#include <vector>
+
+class ccGenericMesh;
+class ccGenericPointCloud;
+
+//! Bounding Volume Hierarchy of the triangles of a mesh
+/** The hierarchy is expressed in the local coordinate system of the mesh
+	(i.e. without the GL transformation). It is used to accelerate ray queries
+	(e.g. triangle picking).
+	Queries are deterministic: in case of a tie, the triangle with the smallest
+	index wins.
+**/
+class QCC_DB_LIB_API ccMeshBVH
+{
+public:
+
+	//! Shared pointer
+	typedef QSharedPointer<ccMeshBVH> Shared;
+
+	//! Builds the BVH of a mesh
+	/** \return nullptr if the mesh is empty or if there's not enough memory
+	**/
+	static Shared Build(const ccGenericMesh& mesh);
+
+	//! Returns whether the BVH is still valid for the given mesh
+	/** I.e. whether the triangles and the vertices have not changed since it was built.
+	**/
+	bool isValidFor(const ccGenericMesh& mesh) const;
+
+	//! Ray intersection
+	struct RayHit
+	{
+		//! Index of the intersected triangle
+		unsigned triIndex = 0;
+		//! Ray parameter of the intersection (origin + t * direction)
+		double t = 0.0;
+		//! Intersection point
+		CCVector3d point;
+		//! Barycentric coordinates of the intersection point (relatively to the triangle vertices A, B and C)
+		CCVector3d barycentricCoords;
+	};
+
+	//! Computes the first intersection between a ray and the mesh
+	/** \param mesh the mesh used to build the BVH
+		\param origin ray origin (local coordinates)
+		\param direction ray direction (not necessarily normalized)
+		\param tMax maximum ray parameter (the intersection must verify 0 <= t <= tMax)
+		\param hit nearest intersection (if any)
+		\return whether an intersection has been found
+	**/
+	bool intersectRay(	const ccGenericMesh& mesh,
+						const CCVector3d& origin,
+						const CCVector3d& direction,
+						double tMax,
+						RayHit& hit) const;
+
+	//! Returns the memory used by the structure (in bytes)
+	size_t memoryUsage() const;
+
+protected:
+
+	//! Default constructor (see Build)
+	ccMeshBVH();
+
+	//! BVH node
+	struct Node
+	{
+		//! Bounding-box min corner
+		CCVector3 bbMin;
+		//! Bounding-box max corner
+		CCVector3 bbMax;
+		//! First triangle (leaf) or index of the first child (inner node - the second child follows)
+		unsigned start = 0;
+		//! Number of triangles (leaf) or 0 (inner node)
+		unsigned count = 0;
+	};
+
+	//! Builds a sub-tree (the nodes are appended to the input vector)
+	void buildSubTree(	std::vector<Node>& nodes,
+						unsigned nodeIndex,
+						unsigned firstTri,
+						unsigned triCount,
+						const std::vector<CCVector3>& centroids,
+						const ccGenericMesh& mesh);
+
+	//! Splits the input triangles range in two (at the median of the longest axis)
+	unsigned split(unsigned firstTri, unsigned triCount, const std::vector<CCVector3>& centroids);
+
+	//! Nodes (the first one is the root)
+	std::vector<Node> m_nodes;
+	//! Triangle indexes (sorted by leaf)
+	std::vector<unsigned> m_triIndexes;
+
+	//! Vertices of the mesh when the BVH was built
+	const ccGenericPointCloud* m_vertices;
+	//! Number of vertices when the BVH was built
+	unsigned m_vertexCount;
+	//! Number of triangles when the BVH was built
+	unsigned m_triangleCount;
+	//! Version of the vertices coordinates when the BVH was built (ccPointCloud only)
+	unsigned m_pointsVersion;
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+//##########################################################################
+//#                                                                        #
+//#                              CLOUDCOMPARE                              #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU General Public License as published by  #
+//#  the Free Software Foundation; version 2 or later of the License.      #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#                    COPYRIGHT: CloudCompare project                     #
+//#                                                                        #
+//##########################################################################
+
+//Local
+#include "qCC_db.h"
+
+//system
+#include <limits>
+#include <vector>
+
+namespace CCCoreLib
+{
+	class ReferenceCloud;
+}
+
+//! Several subsets of the points of a cloud, stored in a single flat array of indexes
+/** The indexes are sorted by subset (and by increasing index inside each subset).
+	The structure is built in two passes (counting then filling) from the subset
+	index of each point, so that thousands of subsets can be built without any
+	per-subset (re)allocation, contrarily to many ReferenceCloud instances filled
+	point by point.
+**/
+class QCC_DB_LIB_API ccMultiReferenceCloud
+{
+public:
+
+	//! Subset index of the points that don't belong to any subset
+	static const unsigned InvalidIndex = std::numeric_limits<unsigned>::max();
+
+	//! Builds the subsets
+	/** \param pointSubsetIndexes subset index of each point of the cloud (or InvalidIndex)
+		\param subsetCount number of subsets
+		\return false if there's not enough memory
+	**/
+	bool build(const std::vector<unsigned>& pointSubsetIndexes, unsigned subsetCount);
+
+	//! Clears the structure
+	void clear();
+
+	//! Returns the number of subsets
+	inline unsigned subsetCount() const { return m_offsets.empty() ? 0 : static_cast<unsigned>(m_offsets.size() - 1); }
+
+	//! Returns the number of points of a given subset
+	inline unsigned subsetSize(unsigned subsetIndex) const { return m_offsets[subsetIndex + 1] - m_offsets[subsetIndex]; }
+
+	//! Returns the number of non empty subsets
+	unsigned nonEmptySubsetCount() const;
+
+	//! Returns the (global) indexes of the points of a given subset
+	/** \warning The array has subsetSize(subsetIndex) elements
+	**/
+	inline const unsigned* subsetIndexes(unsigned subsetIndex) const { return m_indexes.data() + m_offsets[subsetIndex]; }
+
+	//! Fills a reference cloud with the points of a given subset
+	/** The reference cloud should be associated to the right cloud. Its previous
+		content is cleared (but its memory is kept, so that it can be reused for
+		several subsets).
+		\return false if there's not enough memory
+	**/
+	bool getSubset(unsigned subsetIndex, CCCoreLib::ReferenceCloud& refCloud) const;
+
+protected:
+
+	//! Points indexes (sorted by subset)
+	std::vector<unsigned> m_indexes;
+	//! Position of the first index of each subset in m_indexes (+ total number of indexes)
+	std::vector<unsigned> m_offsets;
+};
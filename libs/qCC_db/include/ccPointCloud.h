@@ -125,7 +125,9 @@ public: //clone, copy, etc.
 
 	//! Clones this entity
 	/** All the main features of the entity are cloned, except from the octree and
-		the points visibility information.
+		the points visibility information. The colors and normals tables are shared
+		with the clone until one of the clouds modifies them (see detachColors), while
+		the points and the scalar fields are copied.
 		\param destCloud [optional] the destination cloud can be provided here
 		\param ignoreChildren [optional] whether to ignore the cloud's children or not (in which case they will be cloned as well)
 		\return a copy of this entity
@@ -161,11 +163,44 @@ public: //features deletion/clearing
 	void unallocateNorms();
 
 	//! Notify a modification of color / scalar field display parameters or contents
-	inline void colorsHaveChanged() { m_vboManager.updateFlags |= vboSet::UPDATE_COLORS; }
+	inline void colorsHaveChanged() { m_vboManager.updateFlags |= vboSet::UPDATE_COLORS; ++m_displayDataVersions.colors; }
 	//! Notify a modification of normals display parameters or contents
-	inline void normalsHaveChanged() { m_vboManager.updateFlags |= vboSet::UPDATE_NORMALS; decompressNormals();}
+	inline void normalsHaveChanged() { m_vboManager.updateFlags |= vboSet::UPDATE_NORMALS; ++m_displayDataVersions.normals; decompressNormals();}
 	//! Notify a modification of points display parameters or contents
-	inline void pointsHaveChanged() { m_vboManager.updateFlags |= vboSet::UPDATE_POINTS; }
+	inline void pointsHaveChanged() { m_vboManager.updateFlags |= vboSet::UPDATE_POINTS; ++m_displayDataVersions.points; }
+
+	//! Versions of the displayed data
+	/** Each version is incremented when the corresponding data is flagged as modified
+		(or when the cloud VBOs are released). Used by the entities that display the
+		cloud data through their own VBOs (e.g. meshes).
+	**/
+	struct DisplayDataVersions
+	{
+		unsigned points = 0;
+		unsigned colors = 0;
+		unsigned normals = 0;
+	};
+
+	//! Returns the versions of the displayed data
+	inline const DisplayDataVersions& displayDataVersions() const { return m_displayDataVersions; }
+
+	//! Returns a contiguous copy of one dimension of the points coordinates
+	/** The column is built (in parallel) on the first call and is then cached
+		until the points are modified (i.e. until pointsHaveChanged, releaseVBOs or
+		notifyGeometryUpdate is called). Column-oriented algorithms (statistics,
+		rasterization, etc.) can stream it instead of the interleaved points. The
+		caller should release the column (see releaseCoordinateColumns) once done,
+		as it holds a full copy of one coordinate.
+		\warning The column holds the stored coordinates (i.e. without the pending
+		transformation, if any). The returned pointer is invalidated as soon as the
+		points are modified. This method is not thread-safe.
+		\param dim coordinate dimension (0 = X, 1 = Y, 2 = Z)
+		\return the column (size() values) or nullptr if not enough memory
+	**/
+	const PointCoordinateType* getCoordinateColumn(unsigned char dim) const;
+
+	//! Releases the cached coordinate columns (see getCoordinateColumn)
+	void releaseCoordinateColumns() const;
 
 public: //features allocation/resize
 
@@ -487,6 +522,7 @@ public: //other methods
 																CCCoreLib::ReferenceCloud* selection = nullptr) override;
 	bool removeVisiblePoints(VisibilityTableType* visTable = nullptr, std::vector<int>* newIndexes = nullptr) override;
 	void applyRigidTransformation(const ccGLMatrix& trans) override;
+	void applyPendingTransformation() override;
 	inline void refreshBB() override { invalidateBoundingBox(); }
 
 	//! Sets whether visibility check is enabled or not (e.g. during distances computation)
@@ -510,6 +546,12 @@ public: //other methods
 								CCCoreLib::GenericProgressCallback* progressCb = nullptr,
 								unsigned char octreeLevel = 0);
 
+	//! Sets a particular point coordinates
+	/** \warning the point must already exist (see resize). The bounding-box
+		is not invalidated (see invalidateBoundingBox).
+	**/
+	inline void setPoint(unsigned pointIndex, const CCVector3& P) { assert(pointIndex < m_points.size()); m_points[pointIndex] = P; }
+
 	//! Sets a particular point color
 	/** \warning colors must be enabled.
 	**/
@@ -732,11 +774,34 @@ public: //other methods
 	int addScalarField(ccScalarField* sf);
 
 	//! Returns pointer on RGBA colors table
+	/** \warning The table may be shared with other clouds (see detachColors)
+	**/
 	RGBAColorsTableType* rgbaColors() const { return m_rgbaColors; }
 
 	//! Returns pointer on compressed normals indexes table
+	/** \warning The table may be shared with other clouds (see detachNormals)
+	**/
 	NormsIndexesTableType* normals() const { return m_normals; }
 
+	//! Makes sure the colors table is not shared with another cloud (copy-on-write)
+	/** Clones share the colors and normals tables of their source cloud until one of
+		them modifies them. The methods of this class take care of it, but this
+		method must be called before modifying the table through rgbaColors().
+		\return false if there's not enough memory to duplicate the table
+	**/
+	bool detachColors();
+
+	//! Makes sure the normals table is not shared with another cloud (copy-on-write)
+	/** See detachColors.
+	**/
+	bool detachNormals();
+
+	//! Makes sure none of the per-point tables (colors, normals) is shared with another cloud
+	/** See detachColors.
+		\return false if there's not enough memory to duplicate one of the tables
+	**/
+	bool detachSharedArrays();
+
 	//! Crops the cloud inside (or outside) a 2D polyline
 	/** \warning Always returns a selection (potentially empty) if successful.
 		\param poly cropping polyline
@@ -798,10 +863,17 @@ protected:
 	void notifyGeometryUpdate() override;
 
 	//inherited from PointCloud
-	/** \warning Doesn't handle scan grids!
+	/** \warning Doesn't handle scan grids! Does nothing if the shared tables
+		can't be detached (see detachSharedArrays): callers that can fail should
+		call detachSharedArrays first.
 	**/
 	void swapPoints(unsigned firstIndex, unsigned secondIndex) override;
 
+	//! Applies a rigid transformation to the cloud data (points, normals, grids, waveforms, etc.)
+	/** Doesn't update the transformation history.
+	**/
+	void transformData(const ccGLMatrix& trans);
+
 	//! Colors
 	RGBAColorsTableType* m_rgbaColors;
 
@@ -830,22 +902,42 @@ protected:
 protected: // VBO
 
 	//! Init/updates VBOs
-	bool updateVBOs(const CC_DRAW_CONTEXT& context, const glDrawParams& glParams);
+	bool updateVBOs(CC_DRAW_CONTEXT& context, const glDrawParams& glParams);
+
+	//! Updates the colors of the VBOs asynchronously
+	/** The colors are converted and uploaded chunk by chunk over several frames, in the
+		back color region of each VBO (see VBO::rgbBackShift). The front color regions are
+		displayed until all the chunks are ready, then the regions are swapped (the points
+		are not uploaded again). context.pendingVBOUpdates is set in the meantime.
+		\return false if the colors must be updated synchronously
+	**/
+	bool updateVBOColorsAsync(CC_DRAW_CONTEXT& context, const glDrawParams& glParams);
+
+	//! Cancels the asynchronous update of the VBO colors (if any)
+	void cancelVBOColorsUpdate();
 
 	class VBO : public QGLBuffer
 	{
 	public:
 		int rgbShift;
+		//! Back color region (see updateVBOColorsAsync)
+		int rgbBackShift;
 		int normalShift;
 
 		//! Inits the VBO
-		/** \return the number of allocated bytes (or -1 if an error occurred)
+		/** The colors (if any) have two regions: the displayed one (rgbShift) and
+			the one updated asynchronously (rgbBackShift).
+			\return the number of allocated bytes (or -1 if an error occurred)
 		**/
 		int init(int count, bool withColors, bool withNormals, bool* reallocated = nullptr);
 
+		//! Swaps the displayed and back color regions
+		inline void swapColorRegions() { std::swap(rgbShift, rgbBackShift); }
+
 		VBO()
 			: QGLBuffer(QGLBuffer::VertexBuffer)
 			, rgbShift(0)
+			, rgbBackShift(0)
 			, normalShift(0)
 		{}
 	};
@@ -884,11 +976,49 @@ protected: // VBO
 
 		//! Current state
 		STATES state;
+
+		//! Asynchronous colors update (see updateVBOColorsAsync)
+		/** The 'hasColors', 'colorIsSF' and 'sourceSF' members above describe
+			the displayed colors until the update is complete.
+		**/
+		struct ColorsUpdate
+		{
+			//! Whether an update is in progress
+			bool inProgress = false;
+			//! Whether the new colors come from a scalar field
+			bool colorIsSF = false;
+			//! Source scalar field (if any)
+			ccScalarField* sourceSF = nullptr;
+			//! Modification count of the source scalar field when the update started
+			unsigned sfModificationCount = 0;
+			//! Version of the colors when the update started (see DisplayDataVersions)
+			unsigned colorsVersion = 0;
+			//! Index of the next chunk to update
+			size_t nextChunk = 0;
+		};
+
+		//! Asynchronous colors update
+		ColorsUpdate colorsUpdate;
 	};
 
 	//! Set of VBOs attached to this cloud
 	vboSet m_vboManager;
 
+	//! Versions of the displayed data (see displayDataVersions)
+	DisplayDataVersions m_displayDataVersions;
+
+	//! Cached coordinate column (see getCoordinateColumn)
+	struct CoordinateColumn
+	{
+		std::vector<PointCoordinateType> values;
+		//! Version of the points when the column was built
+		unsigned pointsVersion = 0;
+		bool valid = false;
+	};
+
+	//! Cached coordinate columns (X, Y and Z)
+	mutable CoordinateColumn m_coordColumns[3];
+
 	//per-block data transfer to the GPU (VBO or standard mode)
 	void glChunkVertexPointer(const CC_DRAW_CONTEXT& context, size_t chunkIndex, unsigned decimStep, bool useVBOs);
 	void glChunkColorPointer (const CC_DRAW_CONTEXT& context, size_t chunkIndex, unsigned decimStep, bool useVBOs);
@@ -905,6 +1035,16 @@ public: //Level of Detail (LOD)
 	//! Clears the LOD structure
 	void clearLOD();
 
+	//! Returns the LOD structure (if any)
+	inline const ccPointCloudLOD* getLOD() const { return m_lod; }
+
+	//! Sets whether the (initialized) LOD structures are saved in BIN files or not
+	/** Disabled by default, as it requires version 5.8 (the files can't be read by older versions).
+	**/
+	static void SetLODFileStorage(bool state);
+	//! Returns whether the (initialized) LOD structures are saved in BIN files or not
+	static bool LODFileStorage();
+
 protected: //Level of Detail (LOD)
 
 	//! L.O.D. structure
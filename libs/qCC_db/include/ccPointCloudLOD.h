@@ -28,9 +28,12 @@
 #include <stdint.h>
 #include <array>
 #include <functional>
+#include <future>
 
+class ccGLMatrix;
 class ccPointCloud;
 class ccPointCloudLODThread;
+class QFile;
 
 //! Level descriptor
 struct LODLevelDesc
@@ -162,15 +165,53 @@ public:
 	inline const Node& root() const { return node(0, 0); }
 
 	//! Test all cells visibility with a given frustum
-	/** Automatically calls resetVisibility
+	/** Automatically calls resetVisibility. The levels are processed top-down,
+		and the cells of each level are tested in parallel.
 	**/
 	uint32_t flagVisibility(const Frustum& frustum, ccClipPlaneSet* clipPlanes = nullptr);
 
 	//! Builds an index map with the remaining visible points
+	/** If an index map has been prepared in the background for the same level and the same
+		maximum number of points (see prepareNextIndexMap), it is returned directly.
+	**/
 	LODIndexSet& getIndexMap(unsigned char level, unsigned& maxCount, unsigned& remainingPointsAtThisLevel);
 
+	//! Prepares the next index map in the background
+	/** Typically called once the current index map has been sent to the GPU: the next call
+		to getIndexMap will return the prepared index map (double buffering). The structure
+		state is only updated when the prepared index map is actually used by getIndexMap.
+		\param level LOD level of the next render pass
+		\param maxCount maximum number of points
+	**/
+	void prepareNextIndexMap(unsigned char level, unsigned maxCount);
+
 	//! Returns the last index map
-	inline const LODIndexSet& getLasIndexMap() const { return m_lastIndexMap; }
+	inline const LODIndexSet& getLasIndexMap() const { return m_indexMap; }
+
+	//! Returns the number of visible points of a given cell (see flagVisibility)
+	inline uint32_t visibleCount(int32_t index, unsigned char level) const
+	{
+		const Level& l = m_levels[level];
+		return (static_cast<size_t>(index) < l.visibleCounts.size() ? l.visibleCounts[index] : l.data[index].pointCount);
+	}
+
+	//! Cell selected for display (point budget mode)
+	struct SelectedCell
+	{
+		//! Cell level
+		uint8_t level;
+		//! Cell index (in its level)
+		int32_t index;
+		//! Number of points to display
+		uint32_t count;
+	};
+
+	//! Builds the index map from a set of selected cells (point budget mode, see ccLODPointBudget)
+	/** Must be called after flagVisibility. As for getIndexMap, the points of each cell
+		are dispatched among its visible children. The cells are processed level by level
+		(so that the points of a parent cell are always taken before those of its children).
+	**/
+	LODIndexSet& buildIndexMap(std::vector<SelectedCell>& cells);
 
 	//! Returns whether all points have been displayed or not
 	inline bool allDisplayed() const { return m_currentState.displayedPoints >= m_currentState.visiblePoints; }
@@ -178,10 +219,33 @@ public:
 	//! Returns the memory used by the structure (in bytes)
 	size_t memory() const;
 
+	//! Applies a rigid transformation to the structure
+	/** The cells (centers) are transformed, so that the structure remains valid once
+		the same transformation has been applied to the cloud. As the octree is not
+		valid anymore, the structure keeps its own copy of the points indexes.
+		\return false if the structure is not initialized or if there's not enough memory
+	**/
+	bool transform(const ccGLMatrix& trans);
+
+	//! Saves the structure to a file (dataVersion>=58)
+	/** The structure must be initialized.
+	**/
+	bool toFile(QFile& out, short dataVersion) const;
+
+	//! Loads the structure from a file (dataVersion>=58)
+	/** \param in input file
+		\param dataVersion file version
+		\param pointCount number of points of the associated cloud
+	**/
+	bool fromFile(QFile& in, short dataVersion, unsigned pointCount);
+
 protected: //methods
 
 	friend ccPointCloudLODThread;
 
+	//! Render state (see m_currentState)
+	struct RenderParams;
+
 	//! Reserves memory
 	bool initInternal(ccOctree::Shared octree);
 
@@ -191,10 +255,11 @@ protected: //methods
 	//! Clears the internal (nodes) data
 	void clearData();
 
-	//! Reserves a new cell at a given level
-	/** \return the new cell index in the array corresponding to this level (see m_levels)
-	**/
-	int32_t newCell(unsigned char level);
+	//! Returns whether the points indexes are available (from the octree or from m_pointIndexes)
+	inline bool hasPointIndexes() const { return m_octree || !m_pointIndexes.empty(); }
+
+	//! Copies the points indexes (sorted by cell) and releases the octree
+	bool detachFromOctree();
 
 	//! Shrinks the internal data to its minimum size
 	void shrink_to_fit();
@@ -204,8 +269,32 @@ protected: //methods
 	**/
 	void resetVisibility();
 
-	//! Adds a given number of points to the active index map (should be dispatched among the children cells)
-	uint32_t addNPointsToIndexMap(Node& node, uint32_t count);
+	//! Adds a given number of points to an index map (should be dispatched among the children cells)
+	/** \param node cell
+		\param count number of points to add
+		\param indexes output indexes (the buffer must be large enough)
+		\return the number of added points
+	**/
+	uint32_t addNPointsToIndexMap(Node& node, uint32_t count, unsigned* indexes);
+
+	//! Fills an index map with the points of the cells listed in m_cellQuotas (in parallel)
+	/** \return the number of added points
+	**/
+	uint32_t fillIndexMap(unsigned char level, LODIndexSet& indexMap);
+
+	//! Builds an index map with the remaining visible points (see getIndexMap)
+	/** \param state render state (updated)
+	**/
+	void computeIndexMap(unsigned char level, unsigned& maxCount, unsigned& remainingPointsAtThisLevel, LODIndexSet& indexMap, RenderParams& state);
+
+	//! Copies the number of displayed points of all the cells (level by level)
+	void saveDisplayedPointCounts(std::vector<uint32_t>& counts) const;
+
+	//! Swaps the number of displayed points of all the cells with the given ones (see saveDisplayedPointCounts)
+	void swapDisplayedPointCounts(std::vector<uint32_t>& counts);
+
+	//! Waits for the index map being prepared in the background (if any)
+	void waitForNextIndexMap();
 
 protected: //members
 
@@ -213,6 +302,8 @@ protected: //members
 	struct Level
 	{
 		std::vector<Node> data;
+		//! Number of visible points per cell (see flagVisibility)
+		std::vector<uint32_t> visibleCounts;
 	};
 
 	//! Per-level cells data
@@ -244,12 +335,51 @@ protected: //members
 	//! Index map
 	LODIndexSet m_indexMap;
 
-	//! Last index map (pointer on)
-	LODIndexSet m_lastIndexMap;
+	//! Next index map (prepared in the background)
+	LODIndexSet m_nextIndexMap;
+
+	//! Background preparation of the next index map
+	std::future<void> m_nextIndexMapTask;
+
+	//! Parameters of the next index map
+	struct NextIndexMapParams
+	{
+		unsigned char level = 0;
+		unsigned maxCount = 0;
+		unsigned count = 0;
+		unsigned remainingPointsAtThisLevel = 0;
+		bool ready = false;
+		//! Render state once the index map is used
+		RenderParams state;
+		//! Number of displayed points of the cells once the index map is used
+		std::vector<uint32_t> displayedPointCounts;
+	};
+
+	//! Parameters of the next index map
+	NextIndexMapParams m_nextIndexMapParams;
+
+	//! Number of points to display per cell (see fillIndexMap)
+	struct CellQuota
+	{
+		CellQuota(uint32_t _cellIndex, uint32_t _maxCount) : cellIndex(_cellIndex), maxCount(_maxCount), offset(0), displayedCount(0) {}
+
+		uint32_t cellIndex;
+		uint32_t maxCount;
+		uint32_t offset;
+		uint32_t displayedCount;
+	};
+
+	//! Cells to display (see computeIndexMap)
+	std::vector<CellQuota> m_cellQuotas;
 
 	//! Associated octree
 	ccOctree::Shared m_octree;
 
+	//! Indexes of the points, sorted by cell (when the structure is not associated to an octree)
+	/** E.g. after a rigid transformation, or when the structure has been loaded from a file.
+	**/
+	std::vector<unsigned> m_pointIndexes;
+
 	//! Computing thread
 	ccPointCloudLODThread* m_thread;
 
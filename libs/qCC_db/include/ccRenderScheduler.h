@@ -0,0 +1,132 @@
+#pragma once
+
+//##########################################################################
+//#                                                                        #
+//#                              CLOUDCOMPARE                              #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU General Public License as published by  #
+//#  the Free Software Foundation; version 2 or later of the License.      #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#                    COPYRIGHT: CloudCompare project                     #
+//#                                                                        #
+//##########################################################################
+
+//Local
+#include "ccGenericGLDisplay.h"
+#include "ccLODPointBudget.h"
+#include "qCC_db.h"
+
+//system
+#include <unordered_map>
+#include <vector>
+
+class ccBBox;
+class ccHObject;
+
+//! Scene-level render scheduler
+/** The displayed clouds and meshes of a 3D view are gathered before being drawn
+	(see CC_SCHEDULING_PASS), so as to:
+	- share the point budget between all the clouds (see ccLODPointBudget)
+	- share the triangle budget between all the meshes, by projected size (when the meshes are decimated)
+	- draw them front to back (the closest entities hide the farthest ones earlier, which reduces overdraw)
+
+	Usage (for each frame):
+	- reset
+	- addEntity for each displayed cloud or mesh (the clouds also register their LOD structure)
+	- dispatch
+	- drawEntities (front to back), then the regular scene traversal (which skips the deferred entities)
+**/
+class QCC_DB_LIB_API ccRenderScheduler
+{
+public:
+
+	//! Default constructor
+	ccRenderScheduler();
+
+	//! Clears the registered entities and sets the budgets
+	/** \param pointBudget number of points to display (shared by all the clouds)
+		\param triangleBudget number of triangles to display when the meshes are decimated (shared by all the meshes)
+		\param frontToBack whether the entities should be drawn front to back (see drawEntities)
+	**/
+	void reset(unsigned pointBudget, unsigned triangleBudget, bool frontToBack);
+
+	//! Returns the point budget shared by the LOD structures of the clouds
+	inline ccLODPointBudget& lodPointBudget() { return m_lodPointBudget; }
+	//! Returns the point budget shared by the LOD structures of the clouds (const version)
+	inline const ccLODPointBudget& lodPointBudget() const { return m_lodPointBudget; }
+
+	//! Registers an entity (only the clouds and the meshes are considered)
+	/** \param entity entity
+		\param camera camera parameters (in the entity local coordinate system)
+	**/
+	void addEntity(ccHObject* entity, const ccGLCameraParameters& camera);
+
+	//! Dispatches the budgets and sorts the entities (front to back)
+	void dispatch();
+
+	//! Returns whether an entity is drawn by drawEntities instead of the regular scene traversal
+	bool isDeferred(const ccHObject* entity) const;
+
+	//! Returns the decimation step of a mesh (after dispatch)
+	/** \return 1 if the mesh should be displayed entirely, or 0 if it has not been registered
+	**/
+	unsigned meshDecimationStep(const ccHObject* mesh) const;
+
+	//! Draws the deferred entities (front to back)
+	void drawEntities(CC_DRAW_CONTEXT& context);
+
+	//! Returns the number of registered entities
+	inline size_t entityCount() const { return m_entities.size(); }
+
+	//! Returns the number of triangles that will actually be displayed when the meshes are decimated (after dispatch)
+	inline unsigned displayedTriangles() const { return m_displayedTriangles; }
+
+protected:
+
+	//! Registered entity
+	struct Entity
+	{
+		//! Entity
+		ccHObject* entity = nullptr;
+		//! Whether the entity is a mesh (or a cloud)
+		bool isMesh = false;
+		//! Number of triangles (mesh) or points (cloud)
+		unsigned primitiveCount = 0;
+		//! Modelview matrix (including the entity GL transformation)
+		ccGLMatrixd modelViewMat;
+		//! Projected area (in pixels)
+		double area_pix = 0.0;
+		//! Depth of the closest point of the entity bounding sphere
+		double depth = 0.0;
+		//! Decimation step (mesh only)
+		unsigned decimationStep = 1;
+	};
+
+	//! Computes the projected area (in pixels) and the depth of the bounding sphere of a box
+	static void ProjectBoundingBox(const ccBBox& box, const ccGLCameraParameters& camera, double& area_pix, double& depth);
+
+	//! Shares the triangle budget between the registered meshes
+	void dispatchTriangleBudget();
+
+	//! Registered entities
+	std::vector<Entity> m_entities;
+	//! Index of each registered entity (in m_entities)
+	std::unordered_map<const ccHObject*, size_t> m_entityIndexes;
+
+	//! Point budget shared by the LOD structures of the clouds
+	ccLODPointBudget m_lodPointBudget;
+
+	//! Number of triangles to display when the meshes are decimated
+	unsigned m_triangleBudget;
+	//! Number of triangles that will actually be displayed when the meshes are decimated
+	unsigned m_displayedTriangles;
+
+	//! Whether the entities are drawn front to back
+	bool m_frontToBack;
+};
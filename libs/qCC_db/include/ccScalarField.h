@@ -139,6 +139,54 @@ public:
 	//! Shortcut to getColor
 	inline const ccColor::Rgb* getValueColor(unsigned index) const { return getColor(getValue(index)); }
 
+	//! Converts a set of scalar values to colors (batch version of getColor)
+	/** The colors of the color ramp steps are gathered in a lookup table first,
+		then the values are converted in parallel (by blocks).
+		Warning: must not be called if the SF is not associated to a color scale!
+		\param values input scalar values
+		\param count number of values
+		\param output output colors (count elements)
+		\param hiddenColor color of the hidden values (i.e. for which getColor returns nullptr)
+	**/
+	void getColors(const ScalarType* values, unsigned count, ccColor::Rgba* output, const ccColor::Rgba& hiddenColor = ccColor::lightGrey) const;
+
+	//! Copy of the display parameters needed to convert scalar values to colors (see getColorConverter)
+	/** Contrary to getColors, it can be used by another thread while the scalar field is modified.
+	**/
+	class QCC_DB_LIB_API ColorConverter
+	{
+	public:
+
+		//! Converts a set of scalar values to colors (same as ccScalarField::getColors)
+		void convert(const ScalarType* values, unsigned count, ccColor::Rgba* output) const;
+
+	protected:
+
+		friend ccScalarField;
+
+		//! Lookup table (one color per color ramp step)
+		std::vector<ccColor::Rgba> m_lut;
+		//! Displayed values range
+		Range m_displayRange;
+		//! Saturation values range
+		Range m_saturationRange;
+		//! Saturation values range (log scale mode)
+		Range m_logSaturationRange;
+		//! Whether color scale is symmetrical or not
+		bool m_symmetricalScale = false;
+		//! Whether scale is logarithmic or not
+		bool m_logScale = false;
+		//! Color of the NaN/out of displayed range values
+		ccColor::Rgba m_outOfRangeColor;
+	};
+
+	//! Returns a copy of the current display parameters (to convert scalar values to colors)
+	/** Warning: must not be called if the SF is not associated to a color scale!
+		\param hiddenColor color of the hidden values (i.e. for which getColor returns nullptr)
+		\warning May throw a std::bad_alloc exception
+	**/
+	ColorConverter getColorConverter(const ccColor::Rgba& hiddenColor = ccColor::lightGrey) const;
+
 	//! Sets whether NaN/out of displayed range values should be displayed in grey or hidden
 	void showNaNValuesInGrey(bool state);
 
@@ -168,6 +216,8 @@ public:
 	inline bool logScale() const { return m_logScale; }
 
 	//inherited
+	/** All the values are scanned (in parallel, by chunks). The statistics and the histogram are updated at the same time.
+	**/
 	void computeMinAndMax() override;
 
 	//! Returns associated color scale
@@ -192,6 +242,46 @@ public:
 	//! Returns associated histogram values (for display)
 	inline const Histogram& getHistogram() const { return m_histogram; }
 
+	//! Statistics of the scalar values
+	struct Statistics
+	{
+		//! Minimum (valid) value
+		ScalarType minVal = 0;
+		//! Maximum (valid) value
+		ScalarType maxVal = 0;
+		//! Number of valid values
+		unsigned validCount = 0;
+		//! Number of invalid (NaN) values
+		unsigned nanCount = 0;
+		//! Sum of the valid values
+		double sum = 0.0;
+		//! Sum of the squared deviations of the valid values from their mean
+		double squaredDeviationsSum = 0.0;
+
+		//! Returns the mean of the valid values
+		inline double mean() const { return validCount != 0 ? sum / validCount : 0.0; }
+		//! Returns the variance of the valid values
+		inline double variance() const { return validCount != 0 ? squaredDeviationsSum / validCount : 0.0; }
+		//! Returns the sum of the squared valid values
+		inline double sumOfSquares() const { return squaredDeviationsSum + (validCount != 0 ? sum * sum / validCount : 0.0); }
+	};
+
+	//! Returns the statistics of the values
+	/** As of the last call to computeMinAndMax (which must be called
+		again if the values have been modified since then).
+	**/
+	inline const Statistics& getStatistics() const { return m_statistics; }
+
+	//! Computes the histogram of the values inside a given interval
+	/** The values are scanned in parallel. Values outside of [minVal, maxVal] (and NaN values) are ignored.
+		\param minVal histogram lower bound
+		\param maxVal histogram upper bound (must be greater than minVal)
+		\param binCount number of classes
+		\param histo output histogram
+		\return false if not enough memory
+	**/
+	bool computeHistogram(double minVal, double maxVal, size_t binCount, std::vector<unsigned>& histo) const;
+
 	//! Returns whether the scalar field in its current configuration MAY have 'hidden' values or not
 	/** 'Hidden' values are typically NaN values or values outside of the 'displayed' interval
 		while those values are not displayed in grey (see ccScalarField::showNaNValuesInGrey).
@@ -199,13 +289,40 @@ public:
 	bool mayHaveHiddenValues() const;
 
 	//! Sets modification flag state
-	inline void setModificationFlag(bool state) { m_modified = state; }
+	inline void setModificationFlag(bool state) { m_modified = state; if (state) ++m_modificationCount; }
 	//! Returns modification flag state
 	inline bool getModificationFlag() const { return m_modified; }
+	//! Returns the number of times the modification flag has been turned on
+	/** Contrarily to the modification flag (reset by the cloud when its VBOs are updated),
+		this counter can be checked by any entity displaying this scalar field (e.g. meshes).
+	**/
+	inline unsigned getModificationCount() const { return m_modificationCount; }
 
 	//! Imports the parameters from another scalar field
 	void importParametersFrom(const ccScalarField* sf);
 
+	//! Storage type of the values in BIN files (dataVersion>=57)
+	enum class FileStorageType : uint8_t
+	{
+		NATIVE	= 0, /**< ScalarType (float or double) **/
+		UINT8	= 1, /**< 8 bits unsigned integers **/
+		UINT16	= 2, /**< 16 bits unsigned integers **/
+		INT32	= 3, /**< 32 bits signed integers **/
+	};
+
+	//! Returns the narrowest type that can store all the values without loss
+	/** Only scalar fields with integer values (and no NaN value) can be stored as integers
+		(typically classification, return number or flags fields).
+	**/
+	FileStorageType narrowestFileStorageType() const;
+
+	//! Sets whether scalar fields with integer values should be saved with a narrower type in BIN files (disabled by default)
+	/** Narrower types require version 5.7 (the files can't be read by older versions).
+	**/
+	static void SetIntegerFileStorage(bool state);
+	//! Returns whether scalar fields with integer values are saved with a narrower type in BIN files
+	static bool IntegerFileStorage();
+
 	//inherited from ccSerializableObject
 	inline bool isSerializable() const override { return true; }
 	bool toFile(QFile& out, short dataVersion) const override;
@@ -271,11 +388,16 @@ protected: //members
 	//! Associated histogram values (for display)
 	Histogram m_histogram;
 
+	//! Statistics of all the values
+	Statistics m_statistics;
+
 	//! Modification flag
 	/** Any modification to the scalar field values or parameters
 		will turn this flag on.
 	**/
 	bool m_modified;
+	//! Modification counter (see getModificationCount)
+	unsigned m_modificationCount;
 
 	//! Global shift
 	double m_globalShift;
@@ -20,14 +20,18 @@
 
 //Local
 #include "ccLog.h"
+#include "qCC_db.h"
 
 //CCCoreLib
 #include <CCPlatform.h>
 #include <CCTypes.h>
 
 //System
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <limits>
+#include <vector>
 
 //Qt
 #include <QDataStream>
@@ -105,7 +109,7 @@ public:
 };
 
 //! Serialization helpers
-class ccSerializationHelper
+class QCC_DB_LIB_API ccSerializationHelper
 {
 public:
 
@@ -155,17 +159,50 @@ public:
 		}
 	}
 
+	//! Compression of the 'generic arrays' (dataVersion>=56)
+	/** All modes are lossless. The arrays are compressed by chunks, in parallel.
+	**/
+	enum class ArrayCompression : ::uint8_t
+	{
+		NONE	= 0, /**< Raw data **/
+		DEFLATE	= 1, /**< Deflate (zlib) **/
+		SHUFFLE	= 2, /**< Byte-shuffle + deflate (best for floating point values) **/
+		DELTA	= 3, /**< Delta coding + byte-shuffle + deflate (best for sorted or quantized values) **/
+	};
+
+	//! Sets the compression of the 'generic arrays' saved from now on (none by default)
+	/** Compressed arrays require version 5.6.
+	**/
+	static void SetArrayCompression(ArrayCompression compression);
+	//! Returns the compression of the 'generic arrays'
+	static ArrayCompression GetArrayCompression();
+
+	//! Sets the maximum size of the (raw) chunks of the 'generic arrays' saved from now on
+	/** Arrays bigger than this size are followed by a chunk table (version 5.5 only).
+		\param byteSize chunk size in bytes (MaxChunkByteSize if zero or negative, by default)
+	**/
+	static void SetArrayChunkByteSize(qint64 byteSize);
+	//! Returns the maximum size of the (raw) chunks of the 'generic arrays'
+	static qint64 GetArrayChunkByteSize();
+
 	//! Returns the minimum file version to save/load a 'generic array'
-	static short GenericArrayToFileMinVersion() { return 20;  }
+	/** \param elementCount number of elements of the array (arrays with more than 2^32-1 elements require version 5.5)
+	**/
+	static short GenericArrayToFileMinVersion(size_t elementCount = 0);
 
 	//! Helper: saves a vector to file
-	/** \param data vector to save (must be allocated)
+	/** Since version 5.5, the element count is coded on 64 bits and large arrays
+		are followed by a chunk table (the stored byte size of each chunk).
+		Since version 5.6, the chunks can be compressed (see SetArrayCompression).
+		\param data vector to save (must be allocated)
 		\param out output file (must be already opened)
+		\param dataVersion target file version
 		\return success
 	**/
-	template <class Type, int N, class ComponentType> static bool GenericArrayToFile(const std::vector<Type>& data, QFile& out)
+	template <class Type, int N, class ComponentType> static bool GenericArrayToFile(const std::vector<Type>& data, QFile& out, short dataVersion)
 	{
 		assert(out.isOpen() && (out.openMode() & QIODevice::WriteOnly));
+		assert(sizeof(ComponentType) * N == sizeof(Type));
 		
 		//removed to allow saving empty clouds
 		//if (data.empty())
@@ -178,28 +215,8 @@ public:
 		if (out.write((const char*)&componentCount, 1) < 0)
 			return ccSerializableObject::WriteError();
 
-		//element count = array size (dataVersion>=20)
-		::uint32_t elementCount = static_cast<::uint32_t>(data.size());
-		if (out.write((const char*)&elementCount, 4) < 0)
-			return ccSerializableObject::WriteError();
-
-		//array data (dataVersion>=20)
-		{
-			//DGM: do it by chunks, in case it's too big to be processed by the system
-			const char* _data = (const char*)data.data();
-			qint64 byteCount = static_cast<qint64>(elementCount);
-			byteCount *= sizeof(Type);
-			while (byteCount != 0)
-			{
-				static const qint64 s_maxByteSaveCount = (1 << 26); //64 Mb each time
-				qint64 saveCount = std::min(byteCount, s_maxByteSaveCount);
-				if (out.write(_data, saveCount) < 0)
-					return ccSerializableObject::WriteError();
-				_data += saveCount;
-				byteCount -= saveCount;
-			}
-		}
-		return true;
+		//element count, chunk table and array data (dataVersion>=20)
+		return WriteArrayData(out, dataVersion, (const char*)data.data(), data.size(), sizeof(Type), sizeof(ComponentType));
 	}
 
 	//! Helper: loads a vector structure from file
@@ -210,23 +227,24 @@ public:
 	**/
 	template <class Type, int N, class ComponentType> static bool GenericArrayFromFile(std::vector<Type>& data, QFile& in, short dataVersion)
 	{
-		::uint8_t componentCount = 0;
-		::uint32_t elementCount = 0;
-		if (!ReadArrayHeader(in, dataVersion, componentCount, elementCount))
+		assert(sizeof(ComponentType) * N == sizeof(Type));
+
+		ArrayHeader header;
+		if (!ReadArrayHeader(in, dataVersion, sizeof(Type), header))
 		{
 			return false;
 		}
-		if (componentCount != N)
+		if (header.componentCount != N)
 		{
 			return ccSerializableObject::CorruptError();
 		}
 
-		if (elementCount)
+		if (header.elementCount)
 		{
 			//try to allocate memory
 			try
 			{
-				data.resize(elementCount);
+				data.resize(static_cast<size_t>(header.elementCount));
 			}
 			catch (const std::bad_alloc&)
 			{
@@ -234,22 +252,9 @@ public:
 			}
 
 			//array data (dataVersion>=20)
+			if (!ReadArrayData(in, header, sizeof(Type), sizeof(ComponentType), 0, header.chunkCount(), (char*)data.data()))
 			{
-				//Apparently Qt and/or Windows don't like to read too many bytes in a row...
-				static const qint64 MaxElementPerChunk = (static_cast<qint64>(1) << 24);
-				assert(sizeof(ComponentType) * N == sizeof(Type));
-				qint64 byteCount = static_cast<qint64>(data.size()) * (sizeof(ComponentType) * N);
-				char* dest = (char*)data.data();
-				while (byteCount > 0)
-				{
-					qint64 chunkSize = std::min(MaxElementPerChunk, byteCount);
-					if (in.read(dest, chunkSize) < 0)
-					{
-						return ccSerializableObject::ReadError();
-					}
-					byteCount -= chunkSize;
-					dest += chunkSize;
-				}
+				return false;
 			}
 		}
 
@@ -264,23 +269,28 @@ public:
 	**/
 	template <class Type, int N, class ComponentType, class FileComponentType> static bool GenericArrayFromTypedFile(std::vector<Type>& data, QFile& in, short dataVersion)
 	{
-		::uint8_t componentCount = 0;
-		::uint32_t elementCount = 0;
-		if (!ReadArrayHeader(in, dataVersion, componentCount, elementCount))
+		ArrayHeader header;
+		if (!ReadArrayHeader(in, dataVersion, sizeof(FileComponentType) * N, header))
 		{
 			return false;
 		}
-		if (componentCount != N)
+		if (header.componentCount != N)
 		{
 			return ccSerializableObject::CorruptError();
 		}
 
-		if (elementCount)
+		if (header.elementCount)
 		{
+			//we read a few chunks at a time
+			::uint64_t chunkCountPerStep = std::max<::uint64_t>(1, static_cast<::uint64_t>(MaxChunkByteSize) / (header.chunkSize * sizeof(FileComponentType) * N));
+			::uint64_t elementCountPerStep = std::min(header.elementCount, chunkCountPerStep * header.chunkSize);
+
 			//try to allocate memory
+			std::vector<FileComponentType> buffer;
 			try
 			{
-				data.resize(elementCount);
+				data.resize(static_cast<size_t>(header.elementCount));
+				buffer.resize(static_cast<size_t>(elementCountPerStep) * N);
 			}
 			catch (const std::bad_alloc&)
 			{
@@ -288,23 +298,21 @@ public:
 			}
 
 			//array data (dataVersion>=20)
-			//--> sadly we can't read it as a block...
-			//we must convert each element, value by value!
-			FileComponentType dummyArray[N] = { 0 };
-
+			//--> sadly we can't read it directly in the array...
+			//we must read it step by step and convert each value!
 			ComponentType* _data = (ComponentType*)data.data();
-			for (unsigned i = 0; i < elementCount; ++i)
+			for (::uint64_t firstChunk = 0; firstChunk < header.chunkCount(); firstChunk += chunkCountPerStep)
 			{
-				if (in.read((char*)dummyArray, sizeof(FileComponentType) * N) >= 0)
+				::uint64_t chunkCount = std::min(chunkCountPerStep, header.chunkCount() - firstChunk);
+				if (!ReadArrayData(in, header, sizeof(FileComponentType) * N, sizeof(FileComponentType), firstChunk, chunkCount, (char*)buffer.data()))
 				{
-					for (unsigned k = 0; k < N; ++k)
-					{
-						*_data++ = static_cast<ComponentType>(dummyArray[k]);
-					}
+					return false;
 				}
-				else
+
+				size_t valueCount = static_cast<size_t>(std::min(chunkCount * header.chunkSize, header.elementCount - firstChunk * header.chunkSize)) * N;
+				for (size_t k = 0; k < valueCount; ++k)
 				{
-					return ccSerializableObject::ReadError();
+					*_data++ = static_cast<ComponentType>(buffer[k]);
 				}
 			}
 		}
@@ -312,28 +320,76 @@ public:
 		return true;
 	}
 
-protected:
+	//! Reads a block of raw data from a file
+	/** Large blocks are read by chunks, in parallel, each thread having its own
+		file handle (positional reads). The file position is moved after the block.
+		\return success
+	**/
+	static bool ReadRawData(QFile& in, char* data, qint64 byteCount);
 
-	static bool ReadArrayHeader(QFile& in,
-								short dataVersion,
-								::uint8_t &componentCount,
-								::uint32_t &elementCount)
-	{
-		assert(in.isOpen() && (in.openMode() & QIODevice::ReadOnly));
+	//! Writes a block of raw data in a file
+	/** Large blocks are written by chunks, in parallel, each thread having its own
+		file handle (positional writes). The file position is moved after the block.
+		\return success
+	**/
+	static bool WriteRawData(QFile& out, const char* data, qint64 byteCount);
 
-		if (dataVersion < 20)
-			return ccSerializableObject::CorruptError();
+protected:
 
-		//component count (dataVersion>=20)
-		if (in.read((char*)&componentCount, 1) < 0)
-			return ccSerializableObject::ReadError();
+	//! Maximum size of a chunk of a 'generic array' (in bytes)
+	static constexpr qint64 MaxChunkByteSize = (static_cast<qint64>(1) << 26); //64 Mb
 
-		//element count = array size (dataVersion>=20)
-		if (in.read((char*)&elementCount, 4) < 0)
-			return ccSerializableObject::ReadError();
+	//! Header of a 'generic array'
+	struct ArrayHeader
+	{
+		//! Number of components per element
+		::uint8_t componentCount = 0;
+		//! Number of elements
+		::uint64_t elementCount = 0;
+		//! Compression of the chunks (dataVersion>=56)
+		ArrayCompression compression = ArrayCompression::NONE;
+		//! Number of elements per chunk
+		/** Raw arrays without chunk table are divided in 'virtual' chunks.
+		**/
+		::uint64_t chunkSize = 0;
+		//! Stored byte size of each chunk (dataVersion>=55, may be empty for raw arrays)
+		std::vector<::uint64_t> chunkByteCounts;
+
+		//! Returns the number of chunks
+		inline ::uint64_t chunkCount() const { return chunkSize != 0 ? (elementCount + chunkSize - 1) / chunkSize : 0; }
+	};
 
-		return true;
-	}
+	//! Writes the element count, the chunk table and the data of a 'generic array'
+	static bool WriteArrayData(	QFile& out,
+								short dataVersion,
+								const char* data,
+								size_t elementCount,
+								size_t elementSize,
+								size_t componentSize);
+
+	//! Reads the header of a 'generic array' (up to the chunk table)
+	static bool ReadArrayHeader(QFile& in,
+								short dataVersion,
+								size_t fileElementSize,
+								ArrayHeader& header);
+
+	//! Reads (and decompresses) the next chunks of a 'generic array'
+	/** \param in input file (positioned on the first chunk to read)
+		\param header array header
+		\param fileElementSize size of an element in the file
+		\param fileComponentSize size of a component in the file
+		\param firstChunk index of the first chunk to read
+		\param chunkCount number of chunks to read
+		\param data output buffer (large enough for the elements of all the chunks)
+		\return success
+	**/
+	static bool ReadArrayData(	QFile& in,
+								const ArrayHeader& header,
+								size_t fileElementSize,
+								size_t fileComponentSize,
+								::uint64_t firstChunk,
+								::uint64_t chunkCount,
+								char* data);
 };
 
 #endif //CC_SERIALIZABLE_OBJECT_HEADER
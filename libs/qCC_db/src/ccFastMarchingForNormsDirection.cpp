@@ -377,6 +377,11 @@ int ccFastMarchingForNormsDirection::OrientNormals(	ccPointCloud* cloud,
 		assert(false);
 		return 0;
 	}
+	//the normals will be modified (they may be shared with another cloud)
+	if (!cloud->detachNormals())
+	{
+		return 0;
+	}
 	NormsIndexesTableType* theNorms = cloud->normals();
 
 	unsigned numberOfPoints = cloud->size();
@@ -29,6 +29,7 @@
 #include "ccMaterialSet.h"
 #include "ccNormalVectors.h"
 #include "ccPointCloud.h"
+#include "ccRenderScheduler.h"
 #include "ccScalarField.h"
 
 //CCCoreLib
@@ -38,6 +39,9 @@
 #include <PointCloud.h>
 #include <ReferenceCloud.h>
 
+//Qt
+#include <QMutex>
+
 //system
 #include <cassert>
 
@@ -193,6 +197,31 @@ void ccGenericMesh::handleColorRamp(CC_DRAW_CONTEXT& context)
 	}
 }
 
+unsigned ccGenericMesh::getLODDecimationStep(const CC_DRAW_CONTEXT& context, size_t triNum) const
+{
+	if (!context.decimateMeshOnMove || !MACRO_LODActivated(context))
+	{
+		return 1;
+	}
+
+	if (context.renderScheduler)
+	{
+		unsigned decimStep = context.renderScheduler->meshDecimationStep(this);
+		if (decimStep != 0)
+		{
+			return decimStep;
+		}
+		//otherwise the mesh has not been registered
+	}
+
+	if (triNum > context.minLODTriangleCount)
+	{
+		return static_cast<unsigned>(ceil(static_cast<double>(triNum * 3) / context.minLODTriangleCount));
+	}
+
+	return 1;
+}
+
 void ccGenericMesh::drawMeOnly(CC_DRAW_CONTEXT& context)
 {
 	ccGenericPointCloud* vertices = getAssociatedCloud();
@@ -217,8 +246,8 @@ void ccGenericMesh::drawMeOnly(CC_DRAW_CONTEXT& context)
 			return;
 
 		//L.O.D.
-		bool lodEnabled = (triNum > context.minLODTriangleCount && context.decimateMeshOnMove && MACRO_LODActivated(context));
-		unsigned decimStep = (lodEnabled ? static_cast<unsigned>(ceil(static_cast<double>(triNum*3) / context.minLODTriangleCount)) : 1);
+		unsigned decimStep = getLODDecimationStep(context, triNum);
+		bool lodEnabled = (decimStep > 1);
 		unsigned displayedTriNum = triNum / decimStep;
 
 		//display parameters
@@ -1066,6 +1095,35 @@ bool ccGenericMesh::trianglePicking(const CCVector2d& clickPos,
 		return false;
 	}
 
+	//ray-cast through the BVH (if possible)
+	ccMeshBVH::Shared bvh = getBVH();
+	CCVector3d Y(0, 0, 0);
+	if (bvh && camera.unproject(CCVector3d(clickPos.x, clickPos.y, 1.0), Y))
+	{
+		//the picking ray goes from the near plane to the far plane (i.e. it stays inside the frustum)
+		CCVector3d origin = X;
+		CCVector3d end = Y;
+		if (!noGLTrans)
+		{
+			//the BVH is expressed in the local coordinate system of the mesh
+			ccGLMatrix invTrans = trans.inverse();
+			invTrans.apply(origin);
+			invTrans.apply(end);
+		}
+
+		ccMeshBVH::RayHit hit;
+		if (bvh->intersectRay(*this, origin, end - origin, 1.0, hit))
+		{
+			nearestTriIndex = static_cast<int>(hit.triIndex);
+			nearestSquareDist = (X - hit.point).norm2d();
+			nearestPoint = hit.point;
+			if (barycentricCoords)
+				*barycentricCoords = hit.barycentricCoords;
+		}
+
+		return (nearestTriIndex >= 0);
+	}
+
 //#define TEST_PICKING
 #ifdef TEST_PICKING
 	QImage testImage(camera.viewport[2], camera.viewport[3], QImage::Format::Format_ARGB32);
@@ -1103,13 +1161,19 @@ bool ccGenericMesh::trianglePicking(const CCVector2d& clickPos,
 			continue;
 
 		double squareDist = (X - P).norm2d();
-		if (nearestTriIndex < 0 || squareDist < nearestSquareDist)
+#if defined(_OPENMP) && !defined(_DEBUG) && !defined(TEST_PICKING)
+		#pragma omp critical(ccGenericMesh_trianglePicking)
+#endif
 		{
-			nearestSquareDist = squareDist;
-			nearestTriIndex = static_cast<int>(i);
-			nearestPoint = P;
-			if (barycentricCoords)
-				*barycentricCoords = BC;
+			//deterministic result in case of a tie
+			if (nearestTriIndex < 0 || squareDist < nearestSquareDist || (squareDist == nearestSquareDist && i < nearestTriIndex))
+			{
+				nearestSquareDist = squareDist;
+				nearestTriIndex = static_cast<int>(i);
+				nearestPoint = P;
+				if (barycentricCoords)
+					*barycentricCoords = BC;
+			}
 		}
 	}
 
@@ -1145,6 +1209,35 @@ bool ccGenericMesh::trianglePicking(unsigned triIndex,
 	return trianglePicking(triIndex, clickPos, trans, noGLTrans, *vertices, camera, point, barycentricCoords);
 }
 
+//! Protects the (lazy) construction of the meshes BVH
+static QMutex s_bvhMutex;
+
+ccMeshBVH::Shared ccGenericMesh::getBVH() const
+{
+	QMutexLocker locker(&s_bvhMutex);
+
+	if (!m_bvh || !m_bvh->isValidFor(*this))
+	{
+		m_bvh = ccMeshBVH::Build(*this);
+	}
+
+	return m_bvh;
+}
+
+void ccGenericMesh::releaseBVH()
+{
+	QMutexLocker locker(&s_bvhMutex);
+
+	m_bvh.clear();
+}
+
+void ccGenericMesh::notifyGeometryUpdate()
+{
+	ccHObject::notifyGeometryUpdate();
+
+	releaseBVH();
+}
+
 bool ccGenericMesh::computePointPosition(unsigned triIndex, const CCVector2d& uv, CCVector3& P, bool warningIfOutside/*=true*/) const
 {
 	if (triIndex >= size())
@@ -43,6 +43,8 @@
 ccGenericPointCloud::ccGenericPointCloud(QString name, unsigned uniqueID)
 	: ccShiftedObject(name, uniqueID)
 	, m_pointSize(0)
+	, m_deferTransformations(false)
+	, m_hasPendingTransformation(false)
 {
 	setVisible(true);
 	lockVisibility(false);
@@ -52,6 +54,8 @@ ccGenericPointCloud::ccGenericPointCloud(const ccGenericPointCloud& cloud)
 	: ccShiftedObject(cloud)
 	, m_pointsVisibility(cloud.m_pointsVisibility)
 	, m_pointSize(cloud.m_pointSize)
+	, m_deferTransformations(false)
+	, m_hasPendingTransformation(false)
 {
 }
 
@@ -188,11 +192,27 @@ ccBBox ccGenericPointCloud::getOwnBB(bool withGLFeatures/*=false*/)
 	{
 		getBoundingBox(box.minCorner(), box.maxCorner());
 		box.setValidity(true);
+
+		if (m_hasPendingTransformation)
+		{
+			//the (deferred) transformation is not applied to the points yet
+			box = box * m_pendingTransformation;
+		}
 	}
 	
 	return box;
 }
 
+void ccGenericPointCloud::setDeferredTransformations(bool state)
+{
+	if (!state)
+	{
+		applyPendingTransformation();
+	}
+
+	m_deferTransformations = state;
+}
+
 bool ccGenericPointCloud::toFile_MeOnly(QFile& out, short dataVersion) const
 {
 	assert(out.isOpen() && (out.openMode() & QIODevice::WriteOnly));
@@ -216,7 +236,7 @@ bool ccGenericPointCloud::toFile_MeOnly(QFile& out, short dataVersion) const
 		return WriteError();
 	if (hasVisibilityArray)
 	{
-		if (!ccSerializationHelper::GenericArrayToFile<unsigned char, 1, unsigned char>(m_pointsVisibility, out))
+		if (!ccSerializationHelper::GenericArrayToFile<unsigned char, 1, unsigned char>(m_pointsVisibility, out, dataVersion))
 			return false;
 	}
 
@@ -318,6 +338,9 @@ bool ccGenericPointCloud::pointPicking(	const CCVector2d& clickPos,
 										double pickHeight/*=2.0*/,
 										bool autoComputeOctree/*=false*/)
 {
+	//the octree and the points must be up-to-date
+	applyPendingTransformation();
+
 	//can we use the octree to accelerate the point picking process?
 	if (pickWidth == pickHeight)
 	{
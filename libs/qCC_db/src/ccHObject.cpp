@@ -40,6 +40,7 @@
 #include "ccPointCloud.h"
 #include "ccPolyline.h"
 #include "ccQuadric.h"
+#include "ccRenderScheduler.h"
 #include "ccSphere.h"
 #include "ccSubMesh.h"
 #include "ccTorus.h"
@@ -693,6 +694,34 @@ void ccHObject::drawNameIn3D(CC_DRAW_CONTEXT& context)
 	}
 }
 
+void ccHObject::drawEntityOnly(CC_DRAW_CONTEXT& context)
+{
+	//get the set of OpenGL functions (version 2.1)
+	QOpenGLFunctions_2_1 *glFunc = context.glFunctions<QOpenGLFunctions_2_1>();
+	assert( glFunc != nullptr );
+
+	if ( glFunc == nullptr )
+		return;
+
+	//apply default color (in case of)
+	ccGL::Color(glFunc, context.pointsDefaultCol);
+
+	//enable clipping planes (if any)
+	bool useClipPlanes = (MACRO_Draw3D(context) && !m_clipPlanes.empty());
+	if (useClipPlanes)
+	{
+		toggleClipPlanes(context, true);
+	}
+
+	drawMeOnly(context);
+
+	//disable clipping planes (if any)
+	if (useClipPlanes)
+	{
+		toggleClipPlanes(context, false);
+	}
+}
+
 void ccHObject::draw(CC_DRAW_CONTEXT& context)
 {
 	if (!isEnabled())
@@ -728,6 +757,13 @@ void ccHObject::draw(CC_DRAW_CONTEXT& context)
 			//only for real clouds
 			drawInThisContext &= isA(CC_TYPES::POINT_CLOUD);
 		}
+
+		//scheduling pass
+		if (MACRO_SchedulingPass(context))
+		{
+			//only for real clouds and meshes
+			drawInThisContext &= (isA(CC_TYPES::POINT_CLOUD) || isKindOf(CC_TYPES::MESH));
+		}
 	}
 
 	//draw entity
@@ -736,28 +772,39 @@ void ccHObject::draw(CC_DRAW_CONTEXT& context)
 		if (( !m_selected || !MACRO_SkipSelected(context) ) &&
 			(  m_selected || !MACRO_SkipUnselected(context) ))
 		{
-			//apply default color (in case of)
-			ccGL::Color(glFunc, context.pointsDefaultCol);
-
-			//enable clipping planes (if any)
-			bool useClipPlanes = (draw3D && !m_clipPlanes.empty());
-			if (useClipPlanes)
+			if (MACRO_SchedulingPass(context))
 			{
-				toggleClipPlanes(context, true);
-			}
-
-			drawMeOnly(context);
+				//the entity is only registered (see ccRenderScheduler)
+				if (context.renderScheduler)
+				{
+					ccGLCameraParameters camera;
+					if (context.display)
+					{
+						context.display->getGLCameraParameters(camera);
+					}
+					glFunc->glGetIntegerv(GL_VIEWPORT, camera.viewport);
+					glFunc->glGetDoublev(GL_PROJECTION_MATRIX, camera.projectionMat.data());
+					glFunc->glGetDoublev(GL_MODELVIEW_MATRIX, camera.modelViewMat.data());
+
+					context.renderScheduler->addEntity(this, camera);
+				}
 
-			//disable clipping planes (if any)
-			if (useClipPlanes)
+				//the clouds also register their LOD structure
+				if (isA(CC_TYPES::POINT_CLOUD))
+				{
+					drawMeOnly(context);
+				}
+			}
+			else if (!context.renderScheduler || !context.renderScheduler->isDeferred(this))
 			{
-				toggleClipPlanes(context, false);
+				drawEntityOnly(context);
 			}
+			//otherwise the entity has already been drawn (see ccRenderScheduler::drawEntities)
 		}
 	}
 
 	//draw name - container objects are not visible but can still show a name
-	if (m_currentDisplay == context.display && m_showNameIn3D && !MACRO_EntityPicking(context))
+	if (m_currentDisplay == context.display && m_showNameIn3D && !MACRO_EntityPicking(context) && !MACRO_SchedulingPass(context))
 	{
 		if (MACRO_Draw3D(context))
 		{
@@ -792,7 +839,7 @@ void ccHObject::draw(CC_DRAW_CONTEXT& context)
 	}
 	
 	//if the entity is currently selected, we draw its bounding-box
-	if (m_selected && draw3D && drawInThisContext && !MACRO_EntityPicking(context) && context.currentLODLevel == 0)
+	if (m_selected && draw3D && drawInThisContext && !MACRO_EntityPicking(context) && !MACRO_SchedulingPass(context) && context.currentLODLevel == 0)
 	{
 		drawBB(context, context.bbDefaultCol);
 	}
@@ -0,0 +1,196 @@
+//##########################################################################
+//#                                                                        #
+//#                              CLOUDCOMPARE                              #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU General Public License as published by  #
+//#  the Free Software Foundation; version 2 or later of the License.      #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#                    COPYRIGHT: CloudCompare project                     #
+//#                                                                        #
+//##########################################################################
+
+#include "ccLODPointBudget.h"
+
+//Local
+#include "ccLog.h"
+
+//system
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+//! Maximum number of points displayed for a cell before its children are considered
+static const uint32_t s_pointsPerCell = 1024;
+//! The cells smaller than this (projected radius, in pixels) are not refined
+static const float s_minCellRadius_pix = 1.0f;
+
+//! Candidate cell (see ccLODPointBudget::dispatch)
+struct BudgetCandidate
+{
+	//! Projected radius (in pixels)
+	float priority;
+	//! Cloud index
+	uint32_t cloudIndex;
+	//! Cell index
+	int32_t cellIndex;
+	//! Cell level
+	uint8_t level;
+	//! Estimated ratio of visible points that have not been taken by the parent cells yet
+	double remainingRatio;
+
+	bool operator < (const BudgetCandidate& other) const { return priority < other.priority; }
+};
+
+ccLODPointBudget::ccLODPointBudget()
+	: m_pointBudget(0)
+	, m_fixedPointCount(0)
+	, m_displayedPoints(0)
+{
+}
+
+void ccLODPointBudget::reset(unsigned pointBudget)
+{
+	m_clouds.clear();
+	m_pointBudget = pointBudget;
+	m_fixedPointCount = 0;
+	m_displayedPoints = 0;
+}
+
+void ccLODPointBudget::addCloud(ccPointCloudLOD* lod, const ccGLCameraParameters& camera)
+{
+	if (!lod || !lod->isInitialized())
+	{
+		assert(false);
+		return;
+	}
+
+	Cloud cloud;
+	cloud.lod = lod;
+	cloud.camera = camera;
+	m_clouds.push_back(cloud);
+}
+
+float ccLODPointBudget::ProjectedRadius(const ccPointCloudLOD::Node& node, const ccGLCameraParameters& camera)
+{
+	//the second diagonal term of the projection matrix is 1/tan(fov/2) in perspective mode,
+	//and 2/(top-bottom) in orthographic mode
+	double radius_pix = node.radius * camera.projectionMat.data()[5] * (camera.viewport[3] / 2.0);
+
+	if (camera.perspective)
+	{
+		double depth = -(camera.modelViewMat * node.center.toDouble()).z;
+		if (depth <= node.radius)
+		{
+			//the camera is inside (or very close to) the cell
+			return std::numeric_limits<float>::max();
+		}
+		radius_pix /= depth;
+	}
+
+	return static_cast<float>(radius_pix);
+}
+
+void ccLODPointBudget::dispatch()
+{
+	m_displayedPoints = 0;
+
+	try
+	{
+		std::priority_queue<BudgetCandidate> candidates;
+		for (size_t i = 0; i < m_clouds.size(); ++i)
+		{
+			const ccPointCloudLOD::Node& root = m_clouds[i].lod->root();
+			if (root.intersection != Frustum::OUTSIDE)
+			{
+				candidates.push({ ProjectedRadius(root, m_clouds[i].camera), static_cast<uint32_t>(i), 0, 0, 1.0 });
+			}
+		}
+
+		//the biggest cells (on screen) are processed first, whatever the cloud they belong to
+		//(the points displayed without LOD structure are deducted first)
+		unsigned remainingBudget = std::max(m_pointBudget - std::min(m_fixedPointCount, m_pointBudget), m_pointBudget / 2);
+		while (!candidates.empty() && remainingBudget != 0)
+		{
+			BudgetCandidate candidate = candidates.top();
+			candidates.pop();
+
+			Cloud& cloud = m_clouds[candidate.cloudIndex];
+			const ccPointCloudLOD::Node& node = cloud.lod->node(candidate.cellIndex, candidate.level);
+
+			//estimated number of visible points that have not been taken by the parent cells yet
+			double remainingCount = candidate.remainingRatio * cloud.lod->visibleCount(candidate.cellIndex, candidate.level);
+			if (remainingCount < 1.0)
+			{
+				continue;
+			}
+
+			bool refine = (node.childCount != 0 && candidate.priority >= s_minCellRadius_pix);
+
+			double count = remainingCount;
+			if (candidate.priority < s_minCellRadius_pix)
+			{
+				//the cell covers a few pixels at most
+				count = std::min(count, std::max(1.0, 4.0 * candidate.priority * candidate.priority));
+			}
+			else if (refine)
+			{
+				count = std::min(count, static_cast<double>(s_pointsPerCell));
+			}
+
+			uint32_t cellCount = std::min(static_cast<uint32_t>(std::ceil(count)), remainingBudget);
+			cloud.cells.push_back({ candidate.level, candidate.cellIndex, cellCount });
+			remainingBudget -= cellCount;
+
+			if (refine && cellCount < remainingCount)
+			{
+				//the remaining points are dispatched among the children
+				double childRatio = candidate.remainingRatio * (1.0 - cellCount / remainingCount);
+				uint8_t childLevel = static_cast<uint8_t>(candidate.level + 1);
+				for (int32_t childIndex : node.childIndexes)
+				{
+					if (childIndex >= 0)
+					{
+						const ccPointCloudLOD::Node& childNode = cloud.lod->node(childIndex, childLevel);
+						if (childNode.intersection != Frustum::OUTSIDE)
+						{
+							candidates.push({ ProjectedRadius(childNode, cloud.camera), candidate.cloudIndex, childIndex, childLevel, childRatio });
+						}
+					}
+				}
+			}
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		//not enough memory: we'll only display the cells selected so far
+		ccLog::Warning("[LoD] Not enough memory to dispatch the point budget");
+	}
+
+	//eventually, we build the index map of each cloud
+	for (Cloud& cloud : m_clouds)
+	{
+		cloud.indexMap = &cloud.lod->buildIndexMap(cloud.cells);
+		m_displayedPoints += static_cast<unsigned>(cloud.indexMap->size());
+	}
+}
+
+LODIndexSet* ccLODPointBudget::indexMap(const ccPointCloudLOD* lod)
+{
+	for (Cloud& cloud : m_clouds)
+	{
+		if (cloud.lod == lod)
+		{
+			return cloud.indexMap;
+		}
+	}
+
+	return nullptr;
+}
@@ -112,6 +112,8 @@ ccMesh::ccMesh(CCCoreLib::GenericIndexedMesh* giMesh, ccGenericPointCloud* giVer
 
 ccMesh::~ccMesh()
 {
+	releaseVBOs();
+
 	clearTriNormals();
 	setMaterialSet(nullptr);
 	setTexCoordinatesTable(nullptr);
@@ -424,6 +426,9 @@ void ccMesh::setTriNormsTable(NormsIndexesTableType* triNormsTable, bool autoRel
 	if (m_triNormals == triNormsTable)
 		return;
 
+	//We must update the VBOs
+	releaseVBOs();
+
 	if (m_triNormals && autoReleaseOldTable)
 	{
 		int childIndex = getChildIndex(m_triNormals);
@@ -452,6 +457,9 @@ void ccMesh::setMaterialSet(ccMaterialSet* materialSet, bool autoReleaseOldMater
 	if (m_materials == materialSet)
 		return;
 
+	//We must update the VBOs
+	releaseVBOs();
+
 	if (m_materials && autoReleaseOldMaterialSet)
 	{
 		int childIndex = getChildIndex(m_materials);
@@ -490,6 +498,9 @@ void ccMesh::applyGLTransformation(const ccGLMatrix& trans)
 
 void ccMesh::transformTriNormals(const ccGLMatrix& trans)
 {
+	//We must update the VBOs
+	releaseVBOs();
+
     //we must take care of the triangle normals!
 	if (m_triNormals && (!getParent() || !getParent()->isKindOf(CC_TYPES::MESH)))
     {
@@ -1631,6 +1642,10 @@ bool ccMesh::resize(size_t n)
 
 void ccMesh::swapTriangles(unsigned index1, unsigned index2)
 {
+	//We must update the VBOs and the BVH
+	releaseVBOs();
+	releaseBVH();
+
 	assert(std::max(index1, index2) < size());
 
 	m_triVertIndexes->swap(index1, index2);
@@ -1689,8 +1704,8 @@ void ccMesh::drawMeOnly(CC_DRAW_CONTEXT& context)
 		}
 
 		//L.O.D.
-		bool lodEnabled = (triNum > context.minLODTriangleCount && context.decimateMeshOnMove && MACRO_LODActivated(context));
-		unsigned decimStep = (lodEnabled ? static_cast<unsigned>(ceil(static_cast<double>(triNum * 3) / context.minLODTriangleCount)) : 1);
+		unsigned decimStep = getLODDecimationStep(context, triNum);
+		bool lodEnabled = (decimStep > 1);
 
 		//display parameters
 		glDrawParams glParams;
@@ -1837,7 +1852,30 @@ void ccMesh::drawMeOnly(CC_DRAW_CONTEXT& context)
 			EnableGLStippleMask(context.qGLContext, true);
 		}
 
-		if (!visFiltering && !(applyMaterials || showTextures) && (!glParams.showSF || !sfMayHaveHiddenValues))
+		//whether VBOs are available (for faster display) or not
+		bool useVBOs = false;
+		if (	context.useVBOs
+			&&	!entityPickingMode
+			&&	!visFiltering //VBOs are not compatible with hidden triangles
+			&&	(!glParams.showSF || !sfMayHaveHiddenValues) )
+		{
+			VBOLayout layout;
+			layout.hasTexCoords = showTextures;
+			layout.triNormals = glParams.showNorms && showTriNormals;
+			layout.perCorner = (layout.hasTexCoords || layout.triNormals);
+			layout.sortedByMaterial = (applyMaterials || showTextures);
+			layout.hasNormals = glParams.showNorms;
+			layout.hasColors = (glParams.showSF || glParams.showColors);
+			layout.colorIsSF = glParams.showSF;
+
+			useVBOs = updateVBOs(context, layout, currentDisplayedScalarField);
+		}
+
+		if (useVBOs)
+		{
+			drawWithVBOs(context, glParams, showWired);
+		}
+		else if (!visFiltering && !(applyMaterials || showTextures) && (!glParams.showSF || !sfMayHaveHiddenValues))
 		{
 			assert(!entityPickingMode || !glParams.showSF);
 			//the GL type depends on the PointCoordinateType 'size' (float or double)
@@ -2180,6 +2218,592 @@ void ccMesh::drawMeOnly(CC_DRAW_CONTEXT& context)
 	}
 }
 
+//! Maximum number of triangles per VBO
+static const unsigned s_maxTrianglesPerVBO = (1 << 20); //~ 1M
+
+//! Creates a buffer in the active context (or returns nullptr if not enough GPU memory)
+static QGLBuffer* CreateVBO(QGLBuffer::Type type, int sizeBytes)
+{
+	QGLBuffer* buffer = new QGLBuffer(type);
+	if (!buffer->create())
+	{
+		//no message as it will probably happen on a lot on (old) graphic cards
+		delete buffer;
+		return nullptr;
+	}
+	buffer->setUsagePattern(QGLBuffer::StaticDraw); //"StaticDraw: The data will be set once and used many times for drawing operations."
+
+	if (!buffer->bind())
+	{
+		ccLog::Warning("[ccMesh::updateVBOs] Failed to bind VBO to active context!");
+		buffer->destroy();
+		delete buffer;
+		return nullptr;
+	}
+
+	buffer->allocate(sizeBytes);
+	bool success = (buffer->size() == sizeBytes);
+	buffer->release();
+
+	if (!success)
+	{
+		ccLog::Warning("[ccMesh::updateVBOs] Not enough (GPU) memory!");
+		buffer->destroy();
+		delete buffer;
+		return nullptr;
+	}
+
+	return buffer;
+}
+
+//! Writes some data in a buffer
+template <typename T> static bool WriteVBO(QGLBuffer* buffer, int offset, const std::vector<T>& data)
+{
+	if (!buffer->bind())
+	{
+		return false;
+	}
+	buffer->write(offset, data.data(), static_cast<int>(data.size() * sizeof(T)));
+	buffer->release();
+	return true;
+}
+
+bool ccMesh::updateVBOs(const CC_DRAW_CONTEXT& context, const VBOLayout& layout, ccScalarField* sf)
+{
+	if (m_vboManager.state == vboSet::FAILED)
+	{
+		return false;
+	}
+
+	if (!m_currentDisplay)
+	{
+		ccLog::Warning(QString("[ccMesh::updateVBOs] Need an associated GL context! (mesh '%1')").arg(getName()));
+		assert(false);
+		return false;
+	}
+
+	if (!m_associatedCloud || !m_associatedCloud->isA(CC_TYPES::POINT_CLOUD))
+	{
+		return false;
+	}
+	ccPointCloud* cloud = static_cast<ccPointCloud*>(m_associatedCloud);
+	assert(!layout.colorIsSF || sf);
+
+	const unsigned triCount = size();
+	const unsigned vertCount = cloud->size();
+	const ccPointCloud::DisplayDataVersions& cloudVersions = cloud->displayDataVersions();
+
+	//let's check if something has changed
+	int updateFlags = 0;
+	if (	m_vboManager.state != vboSet::INITIALIZED
+		||	m_vboManager.layout != layout
+		||	m_vboManager.triangleCount != triCount
+		||	m_vboManager.vertexCount != vertCount )
+	{
+		updateFlags = vboSet::UPDATE_ALL;
+	}
+	else
+	{
+		if (cloudVersions.points != m_vboManager.cloudVersions.points)
+		{
+			updateFlags |= vboSet::UPDATE_POINTS;
+		}
+		if (layout.hasColors)
+		{
+			if (layout.colorIsSF ? (m_vboManager.sourceSF != sf || m_vboManager.sourceSFModificationCount != sf->getModificationCount())
+								 : (cloudVersions.colors != m_vboManager.cloudVersions.colors))
+			{
+				updateFlags |= vboSet::UPDATE_COLORS;
+			}
+		}
+		if (layout.hasNormals && !layout.triNormals && cloudVersions.normals != m_vboManager.cloudVersions.normals)
+		{
+			updateFlags |= vboSet::UPDATE_NORMALS;
+		}
+
+		//nothing to do?
+		if (updateFlags == 0)
+		{
+			return true;
+		}
+	}
+
+	QOpenGLFunctions_2_1* glFunc = context.glFunctions<QOpenGLFunctions_2_1>();
+	assert(glFunc != nullptr);
+
+	const int coordsSizeBytes = static_cast<int>(sizeof(PointCoordinateType) * 3);
+	const int colorSizeBytes = static_cast<int>(sizeof(ColorCompType) * 4);
+	const int texCoordSizeBytes = static_cast<int>(sizeof(float) * 2);
+
+	try
+	{
+		if (updateFlags & vboSet::UPDATE_TRIANGLES)
+		{
+			//(re)allocate everything
+			releaseVBOs();
+			m_vboManager.layout = layout;
+			m_vboManager.triangleCount = triCount;
+			m_vboManager.vertexCount = vertCount;
+
+			//sort the triangles by material (if necessary)
+			if (layout.sortedByMaterial && m_triMtlIndexes && m_triMtlIndexes->size() == triCount)
+			{
+				m_vboManager.triangleOrder.resize(triCount);
+				for (unsigned i = 0; i < triCount; ++i)
+				{
+					m_vboManager.triangleOrder[i] = i;
+				}
+				std::stable_sort(m_vboManager.triangleOrder.begin(), m_vboManager.triangleOrder.end(), [this](unsigned a, unsigned b)
+				{
+					return m_triMtlIndexes->getValue(a) < m_triMtlIndexes->getValue(b);
+				});
+
+				for (unsigned i = 0; i < triCount; ++i)
+				{
+					int mtlIndex = m_triMtlIndexes->getValue(m_vboManager.triangleOrder[i]);
+					if (m_vboManager.materialGroups.empty() || m_vboManager.materialGroups.back().mtlIndex != mtlIndex)
+					{
+						m_vboManager.materialGroups.push_back({ mtlIndex, i, 0 });
+					}
+					++m_vboManager.materialGroups.back().triangleCount;
+				}
+			}
+			else
+			{
+				m_vboManager.materialGroups.push_back({ -1, 0, triCount });
+			}
+
+			//shared vertex data (indexed layout)
+			if (!layout.perCorner)
+			{
+				qint64 vertexSizeBytes = coordsSizeBytes;
+				if (layout.hasNormals)
+				{
+					m_vboManager.normalShift = static_cast<int>(vertexSizeBytes * vertCount);
+					vertexSizeBytes += coordsSizeBytes;
+				}
+				if (layout.hasColors)
+				{
+					m_vboManager.colorShift = static_cast<int>(vertexSizeBytes * vertCount);
+					vertexSizeBytes += colorSizeBytes;
+				}
+				qint64 totalSizeBytes = vertexSizeBytes * vertCount;
+				if (totalSizeBytes > std::numeric_limits<int>::max())
+				{
+					ccLog::Warning(QString("[ccMesh::updateVBOs] Too many vertices to be stored in a VBO (mesh '%1')").arg(getName()));
+					m_vboManager.state = vboSet::FAILED;
+					return false;
+				}
+
+				m_vboManager.vertexBuffer = CreateVBO(QGLBuffer::VertexBuffer, static_cast<int>(totalSizeBytes));
+				if (!m_vboManager.vertexBuffer)
+				{
+					m_vboManager.state = vboSet::FAILED;
+					return false;
+				}
+				m_vboManager.totalMemSizeBytes += static_cast<size_t>(totalSizeBytes);
+			}
+
+			//triangle buffers
+			int cornerSizeBytes = coordsSizeBytes
+								+ (layout.hasNormals ? coordsSizeBytes : 0)
+								+ (layout.hasColors ? colorSizeBytes : 0)
+								+ (layout.hasTexCoords ? texCoordSizeBytes : 0);
+			for (unsigned firstTriangle = 0; firstTriangle < triCount; firstTriangle += s_maxTrianglesPerVBO)
+			{
+				VBOPart part;
+				part.firstTriangle = firstTriangle;
+				part.triangleCount = std::min(s_maxTrianglesPerVBO, triCount - firstTriangle);
+
+				int partSizeBytes = 0;
+				if (layout.perCorner)
+				{
+					int cornerCount = static_cast<int>(part.triangleCount * 3);
+					part.normalShift = coordsSizeBytes * cornerCount;
+					part.colorShift = part.normalShift + (layout.hasNormals ? coordsSizeBytes * cornerCount : 0);
+					part.texCoordShift = part.colorShift + (layout.hasColors ? colorSizeBytes * cornerCount : 0);
+					partSizeBytes = cornerSizeBytes * cornerCount;
+					part.buffer = CreateVBO(QGLBuffer::VertexBuffer, partSizeBytes);
+				}
+				else
+				{
+					partSizeBytes = static_cast<int>(sizeof(unsigned) * 3 * part.triangleCount);
+					part.buffer = CreateVBO(QGLBuffer::IndexBuffer, partSizeBytes);
+				}
+
+				if (!part.buffer)
+				{
+					ccLog::Warning(QString("[ccMesh::updateVBOs] Failed to initialize VBOs (not enough memory?) (mesh '%1')").arg(getName()));
+					releaseVBOs();
+					m_vboManager.state = vboSet::FAILED;
+					return false;
+				}
+				m_vboManager.parts.push_back(part);
+				m_vboManager.totalMemSizeBytes += static_cast<size_t>(partSizeBytes);
+			}
+		}
+
+		//returns the index of the nth triangle (in display order)
+		auto triangleIndex = [this](unsigned n) { return m_vboManager.triangleOrder.empty() ? n : m_vboManager.triangleOrder[n]; };
+
+		//returns the color of a vertex
+		auto vertexColor = [&](unsigned vertIndex)
+		{
+			if (layout.colorIsSF)
+			{
+				const ccColor::Rgb* col = sf->getValueColor(vertIndex);
+				return (col ? ccColor::FromRgbToRgba(*col) : ccColor::lightGrey);
+			}
+			return cloud->getPointColor(vertIndex);
+		};
+
+		bool success = true;
+
+		//shared vertex data (indexed layout)
+		if (m_vboManager.vertexBuffer)
+		{
+			if (updateFlags & vboSet::UPDATE_POINTS)
+			{
+				std::vector<CCVector3> points(vertCount);
+				for (unsigned i = 0; i < vertCount; ++i)
+				{
+					points[i] = *cloud->getPoint(i);
+				}
+				success &= WriteVBO(m_vboManager.vertexBuffer, 0, points);
+			}
+			if (layout.hasNormals && (updateFlags & vboSet::UPDATE_NORMALS))
+			{
+				std::vector<CCVector3> normals(vertCount);
+				for (unsigned i = 0; i < vertCount; ++i)
+				{
+					normals[i] = cloud->getPointNormal(i);
+				}
+				success &= WriteVBO(m_vboManager.vertexBuffer, m_vboManager.normalShift, normals);
+			}
+			if (layout.hasColors && (updateFlags & vboSet::UPDATE_COLORS))
+			{
+				std::vector<ccColor::Rgba> colors(vertCount);
+				for (unsigned i = 0; i < vertCount; ++i)
+				{
+					colors[i] = vertexColor(i);
+				}
+				success &= WriteVBO(m_vboManager.vertexBuffer, m_vboManager.colorShift, colors);
+			}
+		}
+
+		//triangle data
+		for (const VBOPart& part : m_vboManager.parts)
+		{
+			if (!layout.perCorner)
+			{
+				if (updateFlags & vboSet::UPDATE_TRIANGLES)
+				{
+					std::vector<unsigned> indexes(static_cast<size_t>(part.triangleCount) * 3);
+					for (unsigned n = 0; n < part.triangleCount; ++n)
+					{
+						const CCCoreLib::VerticesIndexes& tsi = m_triVertIndexes->getValue(triangleIndex(part.firstTriangle + n));
+						indexes[n * 3    ] = tsi.i1;
+						indexes[n * 3 + 1] = tsi.i2;
+						indexes[n * 3 + 2] = tsi.i3;
+					}
+					success &= WriteVBO(part.buffer, 0, indexes);
+				}
+				continue;
+			}
+
+			//per-corner data
+			const size_t cornerCount = static_cast<size_t>(part.triangleCount) * 3;
+			if (updateFlags & vboSet::UPDATE_POINTS)
+			{
+				std::vector<CCVector3> points(cornerCount);
+				for (unsigned n = 0; n < part.triangleCount; ++n)
+				{
+					const CCCoreLib::VerticesIndexes& tsi = m_triVertIndexes->getValue(triangleIndex(part.firstTriangle + n));
+					points[n * 3    ] = *cloud->getPoint(tsi.i1);
+					points[n * 3 + 1] = *cloud->getPoint(tsi.i2);
+					points[n * 3 + 2] = *cloud->getPoint(tsi.i3);
+				}
+				success &= WriteVBO(part.buffer, 0, points);
+			}
+			if (layout.hasNormals && (updateFlags & vboSet::UPDATE_NORMALS))
+			{
+				std::vector<CCVector3> normals(cornerCount);
+				for (unsigned n = 0; n < part.triangleCount; ++n)
+				{
+					unsigned triIndex = triangleIndex(part.firstTriangle + n);
+					if (layout.triNormals)
+					{
+						const Tuple3i& idx = m_triNormalIndexes->getValue(triIndex);
+						for (unsigned c = 0; c < 3; ++c)
+						{
+							normals[n * 3 + c] = (idx.u[c] >= 0 ? ccNormalVectors::GetNormal(m_triNormals->getValue(idx.u[c])) : s_blankNorm);
+						}
+					}
+					else
+					{
+						const CCCoreLib::VerticesIndexes& tsi = m_triVertIndexes->getValue(triIndex);
+						normals[n * 3    ] = cloud->getPointNormal(tsi.i1);
+						normals[n * 3 + 1] = cloud->getPointNormal(tsi.i2);
+						normals[n * 3 + 2] = cloud->getPointNormal(tsi.i3);
+					}
+				}
+				success &= WriteVBO(part.buffer, part.normalShift, normals);
+			}
+			if (layout.hasColors && (updateFlags & vboSet::UPDATE_COLORS))
+			{
+				std::vector<ccColor::Rgba> colors(cornerCount);
+				for (unsigned n = 0; n < part.triangleCount; ++n)
+				{
+					const CCCoreLib::VerticesIndexes& tsi = m_triVertIndexes->getValue(triangleIndex(part.firstTriangle + n));
+					colors[n * 3    ] = vertexColor(tsi.i1);
+					colors[n * 3 + 1] = vertexColor(tsi.i2);
+					colors[n * 3 + 2] = vertexColor(tsi.i3);
+				}
+				success &= WriteVBO(part.buffer, part.colorShift, colors);
+			}
+			if (layout.hasTexCoords && (updateFlags & vboSet::UPDATE_TEXCOORDS))
+			{
+				std::vector<TexCoords2D> texCoords(cornerCount, TexCoords2D(0.0f, 0.0f));
+				for (unsigned n = 0; n < part.triangleCount; ++n)
+				{
+					const Tuple3i& txInd = m_texCoordIndexes->getValue(triangleIndex(part.firstTriangle + n));
+					for (unsigned c = 0; c < 3; ++c)
+					{
+						if (txInd.u[c] >= 0)
+						{
+							texCoords[n * 3 + c] = m_texCoords->getValue(txInd.u[c]);
+						}
+					}
+				}
+				success &= WriteVBO(part.buffer, part.texCoordShift, texCoords);
+			}
+		}
+
+		//if an error is detected
+		if (!success || glFunc->glGetError() != GL_NO_ERROR)
+		{
+			ccLog::Warning(QString("[ccMesh::updateVBOs] Failed to update VBOs (mesh '%1')").arg(getName()));
+			releaseVBOs();
+			m_vboManager.state = vboSet::FAILED;
+			return false;
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		ccLog::Warning(QString("[ccMesh::updateVBOs] Not enough memory! (mesh '%1')").arg(getName()));
+		releaseVBOs();
+		m_vboManager.state = vboSet::FAILED;
+		return false;
+	}
+
+	m_vboManager.cloudVersions = cloudVersions;
+	m_vboManager.sourceSF = (layout.colorIsSF ? sf : nullptr);
+	m_vboManager.sourceSFModificationCount = (layout.colorIsSF ? sf->getModificationCount() : 0);
+	m_vboManager.state = vboSet::INITIALIZED;
+
+	return true;
+}
+
+void ccMesh::drawWithVBOs(CC_DRAW_CONTEXT& context, const glDrawParams& glParams, bool showWired)
+{
+	QOpenGLFunctions_2_1* glFunc = context.glFunctions<QOpenGLFunctions_2_1>();
+	assert(glFunc != nullptr);
+
+	const VBOLayout& layout = m_vboManager.layout;
+
+	//the GL type depends on the PointCoordinateType 'size' (float or double)
+	GLenum GL_COORD_TYPE = sizeof(PointCoordinateType) == 4 ? GL_FLOAT : GL_DOUBLE;
+
+	glFunc->glEnableClientState(GL_VERTEX_ARRAY);
+	if (layout.hasNormals)
+		glFunc->glEnableClientState(GL_NORMAL_ARRAY);
+	if (layout.hasColors)
+		glFunc->glEnableClientState(GL_COLOR_ARRAY);
+	if (layout.hasTexCoords)
+	{
+		glFunc->glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glFunc->glEnable(GL_TEXTURE_2D);
+	}
+	if (showWired)
+	{
+		glFunc->glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+	}
+
+	//sets the data pointers (relatively to the currently bound VBO)
+	auto setPointers = [&](int normalShift, int colorShift, int texCoordShift)
+	{
+		glFunc->glVertexPointer(3, GL_COORD_TYPE, 0, nullptr);
+		if (layout.hasNormals)
+			glFunc->glNormalPointer(GL_COORD_TYPE, 0, reinterpret_cast<const GLvoid*>(static_cast<intptr_t>(normalShift)));
+		if (layout.hasColors)
+			glFunc->glColorPointer(4, GL_UNSIGNED_BYTE, 0, reinterpret_cast<const GLvoid*>(static_cast<intptr_t>(colorShift)));
+		if (layout.hasTexCoords)
+			glFunc->glTexCoordPointer(2, GL_FLOAT, 0, reinterpret_cast<const GLvoid*>(static_cast<intptr_t>(texCoordShift)));
+	};
+
+	if (!layout.perCorner)
+	{
+		if (m_vboManager.vertexBuffer->bind())
+		{
+			setPointers(m_vboManager.normalShift, m_vboManager.colorShift, 0);
+			m_vboManager.vertexBuffer->release();
+		}
+		else
+		{
+			ccLog::Warning("[VBO] Failed to bind VBO?! We'll deactivate them then...");
+			m_vboManager.state = vboSet::FAILED;
+		}
+	}
+
+	//draws a range of triangles (in display order)
+	auto drawTriangles = [&](unsigned firstTriangle, unsigned triangleCount)
+	{
+		const unsigned lastTriangle = firstTriangle + triangleCount;
+		for (const VBOPart& part : m_vboManager.parts)
+		{
+			unsigned start = std::max(firstTriangle, part.firstTriangle);
+			unsigned stop = std::min(lastTriangle, part.firstTriangle + part.triangleCount);
+			if (start >= stop || m_vboManager.state != vboSet::INITIALIZED)
+			{
+				continue;
+			}
+
+			if (!part.buffer->bind())
+			{
+				ccLog::Warning("[VBO] Failed to bind VBO?! We'll deactivate them then...");
+				m_vboManager.state = vboSet::FAILED;
+				return;
+			}
+
+			if (layout.perCorner)
+			{
+				setPointers(part.normalShift, part.colorShift, part.texCoordShift);
+				glFunc->glDrawArrays(GL_TRIANGLES, static_cast<GLint>((start - part.firstTriangle) * 3), static_cast<GLsizei>((stop - start) * 3));
+			}
+			else
+			{
+				size_t indexOffset = static_cast<size_t>(start - part.firstTriangle) * 3 * sizeof(unsigned);
+				glFunc->glDrawElements(GL_TRIANGLES, static_cast<GLsizei>((stop - start) * 3), GL_UNSIGNED_INT, reinterpret_cast<const GLvoid*>(indexOffset));
+			}
+
+			part.buffer->release();
+		}
+	};
+
+	if (layout.sortedByMaterial && m_materials)
+	{
+		GLuint currentTexID = 0;
+		for (const VBOMaterialGroup& group : m_vboManager.materialGroups)
+		{
+			assert(group.mtlIndex < static_cast<int>(m_materials->size()));
+			if (layout.hasTexCoords)
+			{
+				GLuint texID = (group.mtlIndex >= 0 ? m_materials->at(group.mtlIndex)->getTextureID() : 0);
+				if (texID != currentTexID)
+				{
+					glFunc->glBindTexture(GL_TEXTURE_2D, texID);
+					currentTexID = texID;
+				}
+			}
+
+			//if we don't have any current material, we apply default one
+			if (group.mtlIndex >= 0)
+				(*m_materials)[group.mtlIndex]->applyGL(context.qGLContext, glParams.showNorms, false);
+			else
+				context.defaultMat->applyGL(context.qGLContext, glParams.showNorms, false);
+
+			drawTriangles(group.firstTriangle, group.triangleCount);
+		}
+
+		if (currentTexID)
+		{
+			glFunc->glBindTexture(GL_TEXTURE_2D, 0);
+		}
+	}
+	else
+	{
+		drawTriangles(0, m_vboManager.triangleCount);
+	}
+
+	if (showWired)
+	{
+		glFunc->glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	}
+	glFunc->glDisableClientState(GL_VERTEX_ARRAY);
+	if (layout.hasNormals)
+		glFunc->glDisableClientState(GL_NORMAL_ARRAY);
+	if (layout.hasColors)
+		glFunc->glDisableClientState(GL_COLOR_ARRAY);
+	if (layout.hasTexCoords)
+		glFunc->glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+}
+
+void ccMesh::releaseVBOs()
+{
+	if (m_vboManager.state == vboSet::NEW)
+		return;
+
+	//'destroy' all vbos
+	if (m_vboManager.vertexBuffer)
+	{
+		m_vboManager.vertexBuffer->destroy();
+		delete m_vboManager.vertexBuffer;
+		m_vboManager.vertexBuffer = nullptr;
+	}
+	for (VBOPart& part : m_vboManager.parts)
+	{
+		if (part.buffer)
+		{
+			part.buffer->destroy();
+			delete part.buffer;
+			part.buffer = nullptr;
+		}
+	}
+
+	m_vboManager.parts.resize(0);
+	m_vboManager.materialGroups.resize(0);
+	m_vboManager.triangleOrder.resize(0);
+	m_vboManager.triangleCount = 0;
+	m_vboManager.vertexCount = 0;
+	m_vboManager.sourceSF = nullptr;
+	m_vboManager.totalMemSizeBytes = 0;
+	m_vboManager.state = vboSet::NEW;
+}
+
+size_t ccMesh::vboSize() const
+{
+	return m_vboManager.totalMemSizeBytes;
+}
+
+void ccMesh::notifyGeometryUpdate()
+{
+	ccGenericMesh::notifyGeometryUpdate();
+
+	releaseVBOs();
+}
+
+void ccMesh::setDisplay(ccGenericGLDisplay* win)
+{
+	if (m_currentDisplay && win != m_currentDisplay)
+	{
+		//be sure to release the VBOs before switching to another (or no) display!
+		releaseVBOs();
+	}
+
+	ccGenericMesh::setDisplay(win);
+}
+
+void ccMesh::removeFromDisplay(const ccGenericGLDisplay* win)
+{
+	if (win == m_currentDisplay)
+	{
+		releaseVBOs();
+	}
+
+	//call parent's method
+	ccGenericMesh::removeFromDisplay(win);
+}
+
 ccMesh* ccMesh::createNewMeshFromSelection(	bool removeSelectedTriangles,
 											std::vector<int>* newIndexesOfRemainingTriangles/*=nullptr*/,
 											bool withChildEntities/*=false*/)
@@ -2661,6 +3285,10 @@ ccMesh* ccMesh::createNewMeshFromSelection(	bool removeSelectedTriangles,
 
 void ccMesh::shiftTriangleIndexes(unsigned shift)
 {
+	//We must update the VBOs and the BVH
+	releaseVBOs();
+	releaseBVH();
+
 	for (CCCoreLib::VerticesIndexes& ti : *m_triVertIndexes)
 	{
 		ti.i1 += shift;
@@ -2671,6 +3299,9 @@ void ccMesh::shiftTriangleIndexes(unsigned shift)
 
 void ccMesh::flipTriangles()
 {
+	//We must update the VBOs
+	releaseVBOs();
+
 	for (CCCoreLib::VerticesIndexes& ti : *m_triVertIndexes)
 	{
 		std::swap(ti.i2, ti.i3);
@@ -2688,6 +3319,9 @@ bool ccMesh::arePerTriangleNormalsEnabled() const
 
 void ccMesh::removePerTriangleNormalIndexes()
 {
+	//We must update the VBOs
+	releaseVBOs();
+
 	if (m_triNormalIndexes)
 		m_triNormalIndexes->release();
 	m_triNormalIndexes = nullptr;
@@ -2725,6 +3359,9 @@ void ccMesh::invertNormals()
 
 void ccMesh::invertPerTriangleNormals()
 {
+	//We must update the VBOs
+	releaseVBOs();
+
 	if (m_triNormals)
 	{
 		for (CompressedNormType& n : *m_triNormals)
@@ -2743,6 +3380,10 @@ void ccMesh::addTriangleNormalIndexes(int i1, int i2, int i3)
 void ccMesh::setTriangleNormalIndexes(unsigned triangleIndex, int i1, int i2, int i3)
 {
 	assert(m_triNormalIndexes && m_triNormalIndexes->size() > triangleIndex);
+
+	//We must update the VBOs
+	releaseVBOs();
+
 	m_triNormalIndexes->setValue(triangleIndex, Tuple3i(i1, i2, i3));
 }
 
@@ -2799,6 +3440,9 @@ void ccMesh::setTexCoordinatesTable(TextureCoordsContainer* texCoordsTable, bool
 	if (m_texCoords == texCoordsTable)
 		return;
 
+	//We must update the VBOs
+	releaseVBOs();
+
 	if (m_texCoords && autoReleaseOldTable)
 	{
 		int childIndex = getChildIndex(m_texCoords);
@@ -2853,6 +3497,9 @@ bool ccMesh::reservePerTriangleTexCoordIndexes()
 
 void ccMesh::removePerTriangleTexCoordIndexes()
 {
+	//We must update the VBOs
+	releaseVBOs();
+
 	triangleTexCoordIndexesSet* texCoordIndexes = m_texCoordIndexes;
 	m_texCoordIndexes = nullptr;
 
@@ -2869,6 +3516,10 @@ void ccMesh::addTriangleTexCoordIndexes(int i1, int i2, int i3)
 void ccMesh::setTriangleTexCoordIndexes(unsigned triangleIndex, int i1, int i2, int i3)
 {
 	assert(m_texCoordIndexes && m_texCoordIndexes->size() > triangleIndex);
+
+	//We must update the VBOs
+	releaseVBOs();
+
 	m_texCoordIndexes->setValue(triangleIndex, Tuple3i(i1, i2, i3));
 }
 
@@ -2901,6 +3552,9 @@ void ccMesh::setTriangleMtlIndexesTable(triangleMaterialIndexesSet* matIndexesTa
 	if (m_triMtlIndexes == matIndexesTable)
 		return;
 
+	//We must update the VBOs
+	releaseVBOs();
+
 	if (m_triMtlIndexes && autoReleaseOldTable)
 	{
 		m_triMtlIndexes->release();
@@ -2930,6 +3584,9 @@ bool ccMesh::reservePerTriangleMtlIndexes()
 
 void ccMesh::removePerTriangleMtlIndexes()
 {
+	//We must update the VBOs
+	releaseVBOs();
+
 	if (m_triMtlIndexes)
 		m_triMtlIndexes->release();
 	m_triMtlIndexes = nullptr;
@@ -2944,6 +3601,10 @@ void ccMesh::addTriangleMtlIndex(int mtlIndex)
 void ccMesh::setTriangleMtlIndex(unsigned triangleIndex, int mtlIndex)
 {
 	assert(m_triMtlIndexes && m_triMtlIndexes->size() > triangleIndex);
+
+	//We must update the VBOs
+	releaseVBOs();
+
 	m_triMtlIndexes->setValue(triangleIndex, mtlIndex);
 }
 
@@ -3007,7 +3668,7 @@ bool ccMesh::toFile_MeOnly(QFile& out, short dataVersion) const
 	//triangles indexes (dataVersion>=20)
 	if (!m_triVertIndexes)
 		return ccLog::Warning("Internal error: mesh has no triangles array! (not enough memory?)");
-	if (!ccSerializationHelper::GenericArrayToFile<CCCoreLib::VerticesIndexes, 3, unsigned>(*m_triVertIndexes, out))
+	if (!ccSerializationHelper::GenericArrayToFile<CCCoreLib::VerticesIndexes, 3, unsigned>(*m_triVertIndexes, out, dataVersion))
 		return false;
 
 	//per-triangle materials (dataVersion>=20))
@@ -3017,7 +3678,7 @@ bool ccMesh::toFile_MeOnly(QFile& out, short dataVersion) const
 	if (hasTriMtlIndexes)
 	{
 		assert(m_triMtlIndexes);
-		if (!ccSerializationHelper::GenericArrayToFile<int, 1, int>(*m_triMtlIndexes, out))
+		if (!ccSerializationHelper::GenericArrayToFile<int, 1, int>(*m_triMtlIndexes, out, dataVersion))
 			return false;
 	}
 
@@ -3028,7 +3689,7 @@ bool ccMesh::toFile_MeOnly(QFile& out, short dataVersion) const
 	if (hasTexCoordIndexes)
 	{
 		assert(m_texCoordIndexes);
-		if (!ccSerializationHelper::GenericArrayToFile<Tuple3i, 3, int>(*m_texCoordIndexes, out))
+		if (!ccSerializationHelper::GenericArrayToFile<Tuple3i, 3, int>(*m_texCoordIndexes, out, dataVersion))
 			return false;
 	}
 
@@ -3039,7 +3700,7 @@ bool ccMesh::toFile_MeOnly(QFile& out, short dataVersion) const
 	if (hasTriNormalIndexes)
 	{
 		assert(m_triNormalIndexes);
-		if (!ccSerializationHelper::GenericArrayToFile<Tuple3i, 3, int>(*m_triNormalIndexes, out))
+		if (!ccSerializationHelper::GenericArrayToFile<Tuple3i, 3, int>(*m_triNormalIndexes, out, dataVersion))
 			return false;
 	}
 
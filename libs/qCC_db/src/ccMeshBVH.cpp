@@ -0,0 +1,505 @@
+//##########################################################################
+//#                                                                        #
+//#                              CLOUDCOMPARE                              #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU General Public License as published by  #
+//#  the Free Software Foundation; version 2 or later of the License.      #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#                    COPYRIGHT: CloudCompare project                     #
+//#                                                                        #
+//##########################################################################
+
+#ifdef CC_CORE_LIB_USES_TBB
+#include <tbb/parallel_for.h>
+#endif
+
+#include "ccMeshBVH.h"
+
+//Local
+#include "ccGenericMesh.h"
+#include "ccGenericPointCloud.h"
+#include "ccLog.h"
+#include "ccPointCloud.h"
+
+//system
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <limits>
+
+#if defined(_OPENMP)
+//OpenMP
+#include <omp.h>
+#endif
+
+//! Maximum number of triangles per leaf
+static const unsigned s_maxLeafSize = 4;
+//! Depth of the top of the hierarchy (built sequentially, the sub-trees below are built in parallel)
+static const unsigned s_topDepth = 6;
+
+//! Returns the ray parameter range inside a box (if the ray intersects it)
+static inline bool RayBoxIntersection(	const CCVector3& bbMin,
+										const CCVector3& bbMax,
+										const CCVector3d& origin,
+										const CCVector3d& invDir,
+										double tMax,
+										double& tEntry)
+{
+	double t0 = 0.0;
+	double t1 = tMax;
+	for (unsigned d = 0; d < 3; ++d)
+	{
+		double tNear = (bbMin.u[d] - origin.u[d]) * invDir.u[d];
+		double tFar  = (bbMax.u[d] - origin.u[d]) * invDir.u[d];
+		if (tNear > tFar)
+		{
+			std::swap(tNear, tFar);
+		}
+		t0 = std::max(t0, tNear);
+		t1 = std::min(t1, tFar);
+		if (t0 > t1)
+		{
+			return false;
+		}
+	}
+
+	tEntry = t0;
+	return true;
+}
+
+//! Ray/triangle intersection (Moller-Trumbore)
+static inline bool RayTriangleIntersection(	const CCVector3d& origin,
+											const CCVector3d& dir,
+											const CCVector3d& A,
+											const CCVector3d& B,
+											const CCVector3d& C,
+											double& t,
+											double& u,
+											double& v)
+{
+	CCVector3d AB = B - A;
+	CCVector3d AC = C - A;
+	CCVector3d P = dir.cross(AC);
+	double det = AB.dot(P);
+	//ray parallel to the triangle (or degenerate triangle)
+	if (std::abs(det) <= std::numeric_limits<double>::epsilon() * AB.norm() * AC.norm() * dir.norm())
+	{
+		return false;
+	}
+	double invDet = 1.0 / det;
+
+	CCVector3d AO = origin - A;
+	u = AO.dot(P) * invDet;
+	if (u < 0.0 || u > 1.0)
+	{
+		return false;
+	}
+
+	CCVector3d Q = AO.cross(AB);
+	v = dir.dot(Q) * invDet;
+	if (v < 0.0 || u + v > 1.0)
+	{
+		return false;
+	}
+
+	t = AC.dot(Q) * invDet;
+	return true;
+}
+
+ccMeshBVH::ccMeshBVH()
+	: m_vertices(nullptr)
+	, m_vertexCount(0)
+	, m_triangleCount(0)
+	, m_pointsVersion(0)
+{
+}
+
+ccMeshBVH::Shared ccMeshBVH::Build(const ccGenericMesh& mesh)
+{
+	ccGenericPointCloud* vertices = mesh.getAssociatedCloud();
+	unsigned triCount = mesh.size();
+	if (!vertices || triCount == 0)
+	{
+		return Shared(nullptr);
+	}
+
+	Shared bvh(new ccMeshBVH);
+	bvh->m_vertices = vertices;
+	bvh->m_vertexCount = vertices->size();
+	bvh->m_triangleCount = triCount;
+	if (vertices->isA(CC_TYPES::POINT_CLOUD))
+	{
+		bvh->m_pointsVersion = static_cast<const ccPointCloud*>(vertices)->displayDataVersions().points;
+	}
+
+	try
+	{
+		//triangle centroids (only required during the construction)
+		std::vector<CCVector3> centroids(triCount);
+		bvh->m_triIndexes.resize(triCount);
+
+		int count = static_cast<int>(triCount);
+#ifdef CC_CORE_LIB_USES_TBB
+		tbb::parallel_for(0, count, [&](int i)
+#else
+#if defined(_OPENMP)
+		#pragma omp parallel for num_threads(omp_get_max_threads())
+#endif
+		for (int i = 0; i < count; ++i)
+#endif
+		{
+			CCVector3 A;
+			CCVector3 B;
+			CCVector3 C;
+			mesh.getTriangleVertices(static_cast<unsigned>(i), A, B, C);
+			centroids[i] = (A + B + C) / static_cast<PointCoordinateType>(3);
+			bvh->m_triIndexes[i] = static_cast<unsigned>(i);
+		}
+#ifdef CC_CORE_LIB_USES_TBB
+		);
+#endif
+
+		//the top of the hierarchy is built sequentially
+		struct SubTree
+		{
+			unsigned nodeIndex;
+			unsigned firstTri;
+			unsigned triCount;
+			std::vector<Node> nodes;
+		};
+		std::vector<SubTree> subTrees;
+
+		bvh->m_nodes.reserve(2 * (triCount / s_maxLeafSize + 1));
+		bvh->m_nodes.resize(1);
+		std::function<void(unsigned, unsigned, unsigned, unsigned)> buildTop = [&](unsigned nodeIndex, unsigned firstTri, unsigned rangeCount, unsigned depth)
+		{
+			if (depth == s_topDepth || rangeCount <= s_maxLeafSize)
+			{
+				subTrees.push_back({ nodeIndex, firstTri, rangeCount, {} });
+				return;
+			}
+
+			unsigned leftCount = bvh->split(firstTri, rangeCount, centroids);
+			unsigned childIndex = static_cast<unsigned>(bvh->m_nodes.size());
+			bvh->m_nodes.resize(childIndex + 2);
+			bvh->m_nodes[nodeIndex].start = childIndex;
+			bvh->m_nodes[nodeIndex].count = 0;
+
+			buildTop(childIndex, firstTri, leftCount, depth + 1);
+			buildTop(childIndex + 1, firstTri + leftCount, rangeCount - leftCount, depth + 1);
+		};
+		buildTop(0, 0, triCount, 0);
+		const size_t topNodeCount = bvh->m_nodes.size();
+
+		//the sub-trees are built in parallel (they concern disjoint ranges of triangles)
+		int subTreeCount = static_cast<int>(subTrees.size());
+		std::atomic<bool> error(false);
+#ifdef CC_CORE_LIB_USES_TBB
+		tbb::parallel_for(0, subTreeCount, [&](int i)
+#else
+#if defined(_OPENMP)
+		#pragma omp parallel for num_threads(omp_get_max_threads())
+#endif
+		for (int i = 0; i < subTreeCount; ++i)
+#endif
+		{
+			SubTree& subTree = subTrees[i];
+			try
+			{
+				subTree.nodes.reserve(2 * (subTree.triCount / s_maxLeafSize + 1));
+				subTree.nodes.resize(1);
+				bvh->buildSubTree(subTree.nodes, 0, subTree.firstTri, subTree.triCount, centroids, mesh);
+			}
+			catch (const std::bad_alloc&)
+			{
+				error = true;
+			}
+		}
+#ifdef CC_CORE_LIB_USES_TBB
+		);
+#endif
+		if (error)
+		{
+			throw std::bad_alloc();
+		}
+
+		//merge the sub-trees (the sub-tree root replaces the corresponding top node)
+		std::vector<bool> isSubTreeRoot(topNodeCount, false);
+		for (SubTree& subTree : subTrees)
+		{
+			unsigned base = static_cast<unsigned>(bvh->m_nodes.size());
+			for (size_t j = 0; j < subTree.nodes.size(); ++j)
+			{
+				Node node = subTree.nodes[j];
+				if (node.count == 0)
+				{
+					//local child index (>= 1) to global index
+					node.start = base + node.start - 1;
+				}
+
+				if (j == 0)
+				{
+					bvh->m_nodes[subTree.nodeIndex] = node;
+					isSubTreeRoot[subTree.nodeIndex] = true;
+				}
+				else
+				{
+					bvh->m_nodes.push_back(node);
+				}
+			}
+			subTree.nodes.clear();
+			subTree.nodes.shrink_to_fit();
+		}
+
+		//bounding-boxes of the top nodes (children always come after their parent)
+		for (size_t i = topNodeCount; i > 0; --i)
+		{
+			if (isSubTreeRoot[i - 1])
+			{
+				continue;
+			}
+			Node& node = bvh->m_nodes[i - 1];
+			assert(node.count == 0);
+			const Node& left = bvh->m_nodes[node.start];
+			const Node& right = bvh->m_nodes[node.start + 1];
+			for (unsigned d = 0; d < 3; ++d)
+			{
+				node.bbMin.u[d] = std::min(left.bbMin.u[d], right.bbMin.u[d]);
+				node.bbMax.u[d] = std::max(left.bbMax.u[d], right.bbMax.u[d]);
+			}
+		}
+
+		bvh->m_nodes.shrink_to_fit();
+	}
+	catch (const std::bad_alloc&)
+	{
+		ccLog::Warning(QString("[ccMeshBVH] Not enough memory to build the BVH of mesh '%1'").arg(mesh.getName()));
+		return Shared(nullptr);
+	}
+
+	return bvh;
+}
+
+unsigned ccMeshBVH::split(unsigned firstTri, unsigned triCount, const std::vector<CCVector3>& centroids)
+{
+	assert(triCount > 1);
+
+	//bounding-box of the centroids
+	unsigned* indexes = m_triIndexes.data() + firstTri;
+	CCVector3 cMin = centroids[indexes[0]];
+	CCVector3 cMax = cMin;
+	for (unsigned i = 1; i < triCount; ++i)
+	{
+		const CCVector3& P = centroids[indexes[i]];
+		for (unsigned d = 0; d < 3; ++d)
+		{
+			cMin.u[d] = std::min(cMin.u[d], P.u[d]);
+			cMax.u[d] = std::max(cMax.u[d], P.u[d]);
+		}
+	}
+
+	//longest axis
+	CCVector3 diag = cMax - cMin;
+	unsigned char axis = 0;
+	if (diag.y > diag.u[axis])
+		axis = 1;
+	if (diag.z > diag.u[axis])
+		axis = 2;
+
+	//split at the median (ties are broken with the triangle index so that the result is deterministic)
+	unsigned leftCount = triCount / 2;
+	std::nth_element(indexes, indexes + leftCount, indexes + triCount, [&](unsigned a, unsigned b)
+	{
+		PointCoordinateType ca = centroids[a].u[axis];
+		PointCoordinateType cb = centroids[b].u[axis];
+		return (ca < cb || (ca == cb && a < b));
+	});
+
+	return leftCount;
+}
+
+void ccMeshBVH::buildSubTree(	std::vector<Node>& nodes,
+								unsigned nodeIndex,
+								unsigned firstTri,
+								unsigned triCount,
+								const std::vector<CCVector3>& centroids,
+								const ccGenericMesh& mesh)
+{
+	if (triCount <= s_maxLeafSize)
+	{
+		Node& leaf = nodes[nodeIndex];
+		leaf.start = firstTri;
+		leaf.count = triCount;
+
+		for (unsigned i = 0; i < triCount; ++i)
+		{
+			CCVector3 V[3];
+			mesh.getTriangleVertices(m_triIndexes[firstTri + i], V[0], V[1], V[2]);
+			if (i == 0)
+			{
+				leaf.bbMin = leaf.bbMax = V[0];
+			}
+			for (const CCVector3& P : V)
+			{
+				for (unsigned d = 0; d < 3; ++d)
+				{
+					leaf.bbMin.u[d] = std::min(leaf.bbMin.u[d], P.u[d]);
+					leaf.bbMax.u[d] = std::max(leaf.bbMax.u[d], P.u[d]);
+				}
+			}
+		}
+		return;
+	}
+
+	unsigned leftCount = split(firstTri, triCount, centroids);
+	unsigned childIndex = static_cast<unsigned>(nodes.size());
+	nodes.resize(childIndex + 2);
+	nodes[nodeIndex].start = childIndex;
+	nodes[nodeIndex].count = 0;
+
+	buildSubTree(nodes, childIndex, firstTri, leftCount, centroids, mesh);
+	buildSubTree(nodes, childIndex + 1, firstTri + leftCount, triCount - leftCount, centroids, mesh);
+
+	Node& node = nodes[nodeIndex];
+	const Node& left = nodes[childIndex];
+	const Node& right = nodes[childIndex + 1];
+	for (unsigned d = 0; d < 3; ++d)
+	{
+		node.bbMin.u[d] = std::min(left.bbMin.u[d], right.bbMin.u[d]);
+		node.bbMax.u[d] = std::max(left.bbMax.u[d], right.bbMax.u[d]);
+	}
+}
+
+bool ccMeshBVH::isValidFor(const ccGenericMesh& mesh) const
+{
+	if (	mesh.getAssociatedCloud() != m_vertices
+		||	mesh.size() != m_triangleCount
+		||	!m_vertices
+		||	m_vertices->size() != m_vertexCount)
+	{
+		return false;
+	}
+
+	if (m_vertices->isA(CC_TYPES::POINT_CLOUD) && static_cast<const ccPointCloud*>(m_vertices)->displayDataVersions().points != m_pointsVersion)
+	{
+		//the vertices have been modified
+		return false;
+	}
+
+	return true;
+}
+
+bool ccMeshBVH::intersectRay(	const ccGenericMesh& mesh,
+								const CCVector3d& origin,
+								const CCVector3d& direction,
+								double tMax,
+								RayHit& hit) const
+{
+	if (m_nodes.empty())
+	{
+		return false;
+	}
+
+	CCVector3d invDir(	1.0 / direction.x,
+						1.0 / direction.y,
+						1.0 / direction.z );
+
+	bool found = false;
+	double bestT = tMax;
+
+	std::vector<unsigned> stack;
+	stack.reserve(64);
+	stack.push_back(0);
+	while (!stack.empty())
+	{
+		const Node& node = m_nodes[stack.back()];
+		stack.pop_back();
+
+		double tEntry = 0.0;
+		if (!RayBoxIntersection(node.bbMin, node.bbMax, origin, invDir, bestT, tEntry))
+		{
+			continue;
+		}
+
+		if (node.count != 0)
+		{
+			//leaf
+			for (unsigned i = 0; i < node.count; ++i)
+			{
+				unsigned triIndex = m_triIndexes[node.start + i];
+				CCVector3 A;
+				CCVector3 B;
+				CCVector3 C;
+				mesh.getTriangleVertices(triIndex, A, B, C);
+
+				double t = 0.0;
+				double u = 0.0;
+				double v = 0.0;
+				if (	!RayTriangleIntersection(origin, direction, A.toDouble(), B.toDouble(), C.toDouble(), t, u, v)
+					||	t < 0.0
+					||	t > bestT )
+				{
+					continue;
+				}
+
+				//deterministic result in case of a tie
+				if (found && t == bestT && triIndex > hit.triIndex)
+				{
+					continue;
+				}
+
+				found = true;
+				bestT = t;
+				hit.triIndex = triIndex;
+				hit.t = t;
+				hit.barycentricCoords = CCVector3d(1.0 - u - v, u, v);
+				hit.point = A.toDouble() * hit.barycentricCoords.x + B.toDouble() * u + C.toDouble() * v;
+			}
+		}
+		else
+		{
+			//visit the nearest child first
+			double tLeft = 0.0;
+			double tRight = 0.0;
+			const Node& left = m_nodes[node.start];
+			const Node& right = m_nodes[node.start + 1];
+			bool hitLeft = RayBoxIntersection(left.bbMin, left.bbMax, origin, invDir, bestT, tLeft);
+			bool hitRight = RayBoxIntersection(right.bbMin, right.bbMax, origin, invDir, bestT, tRight);
+			if (hitLeft && hitRight)
+			{
+				if (tLeft <= tRight)
+				{
+					stack.push_back(node.start + 1);
+					stack.push_back(node.start);
+				}
+				else
+				{
+					stack.push_back(node.start);
+					stack.push_back(node.start + 1);
+				}
+			}
+			else if (hitLeft)
+			{
+				stack.push_back(node.start);
+			}
+			else if (hitRight)
+			{
+				stack.push_back(node.start + 1);
+			}
+		}
+	}
+
+	return found;
+}
+
+size_t ccMeshBVH::memoryUsage() const
+{
+	return m_nodes.capacity() * sizeof(Node) + m_triIndexes.capacity() * sizeof(unsigned);
+}
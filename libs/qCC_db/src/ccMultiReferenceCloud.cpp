@@ -0,0 +1,113 @@
+//##########################################################################
+//#                                                                        #
+//#                              CLOUDCOMPARE                              #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU General Public License as published by  #
+//#  the Free Software Foundation; version 2 or later of the License.      #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#                    COPYRIGHT: CloudCompare project                     #
+//#                                                                        #
+//##########################################################################
+
+#include "ccMultiReferenceCloud.h"
+
+//CCCoreLib
+#include <ReferenceCloud.h>
+
+//system
+#include <cassert>
+
+void ccMultiReferenceCloud::clear()
+{
+	m_indexes.clear();
+	m_offsets.clear();
+}
+
+bool ccMultiReferenceCloud::build(const std::vector<unsigned>& pointSubsetIndexes, unsigned subsetCount)
+{
+	clear();
+
+	std::vector<unsigned> fillPositions;
+	try
+	{
+		//count the points of each subset
+		m_offsets.resize(static_cast<size_t>(subsetCount) + 1, 0);
+		for (unsigned subsetIndex : pointSubsetIndexes)
+		{
+			if (subsetIndex < subsetCount)
+			{
+				++m_offsets[subsetIndex + 1];
+			}
+			else
+			{
+				assert(subsetIndex == InvalidIndex);
+			}
+		}
+		for (unsigned i = 0; i < subsetCount; ++i)
+		{
+			m_offsets[i + 1] += m_offsets[i];
+		}
+
+		m_indexes.resize(m_offsets.back());
+		fillPositions.assign(m_offsets.begin(), m_offsets.end() - 1);
+	}
+	catch (const std::bad_alloc&)
+	{
+		//not enough memory
+		clear();
+		return false;
+	}
+
+	//store the indexes
+	unsigned pointCount = static_cast<unsigned>(pointSubsetIndexes.size());
+	for (unsigned i = 0; i < pointCount; ++i)
+	{
+		unsigned subsetIndex = pointSubsetIndexes[i];
+		if (subsetIndex < subsetCount)
+		{
+			m_indexes[fillPositions[subsetIndex]++] = i;
+		}
+	}
+
+	return true;
+}
+
+unsigned ccMultiReferenceCloud::nonEmptySubsetCount() const
+{
+	unsigned count = 0;
+	for (unsigned i = 0; i < subsetCount(); ++i)
+	{
+		if (subsetSize(i) != 0)
+		{
+			++count;
+		}
+	}
+	return count;
+}
+
+bool ccMultiReferenceCloud::getSubset(unsigned subsetIndex, CCCoreLib::ReferenceCloud& refCloud) const
+{
+	assert(subsetIndex < subsetCount());
+
+	refCloud.clear(false);
+
+	unsigned count = subsetSize(subsetIndex);
+	if (!refCloud.reserve(count))
+	{
+		return false;
+	}
+
+	const unsigned* indexes = subsetIndexes(subsetIndex);
+	for (unsigned i = 0; i < count; ++i)
+	{
+		refCloud.addPointIndex(indexes[i]);
+	}
+
+	return true;
+}
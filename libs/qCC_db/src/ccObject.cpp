@@ -65,8 +65,12 @@
 	v5.2 - 11/30/2020 - New ccCoordinateSystem added
 	v5.3 - 10/02/2022 - ccViewportParameters new members (near and far clipping planes)
 	v5.4 - 01/29/2023 - ccColorScale custom labels can be overridden by a string
+	v5.5 - 10/16/2026 - Generic arrays: 64 bits element count + chunk table
+	v5.6 - 10/16/2026 - Generic arrays: optional compression of the chunks
+	v5.7 - 10/16/2026 - Scalar fields with integer values are stored on 8, 16 or 32 bits integers
+	v5.8 - 10/16/2026 - Point clouds LOD structure
 **/
-const unsigned c_currentDBVersion = 54; //5.4
+const unsigned c_currentDBVersion = 58; //5.8
 
 //! Default unique ID generator (using the system persistent settings as we did previously proved to be not reliable)
 static ccUniqueIDGenerator::Shared s_uniqueIDGenerator(new ccUniqueIDGenerator);
@@ -18,6 +18,10 @@
 //Always first
 #include "ccIncludeGL.h"
 
+#ifdef CC_CORE_LIB_USES_TBB
+#include <tbb/parallel_for.h>
+#endif
+
 #include "ccPointCloud.h"
 
 //CCCoreLib
@@ -36,6 +40,7 @@
 #include "ccGenericMesh.h"
 #include "ccImage.h"
 #include "ccKdTree.h"
+#include "ccLODPointBudget.h"
 #include "ccMaterial.h"
 #include "ccMesh.h"
 #include "ccMinimumSpanningTreeForNormsDirection.h"
@@ -53,11 +58,56 @@
 #include <QSettings>
 
 //system
+#include <atomic>
 #include <cassert>
 #include <queue>
 
+#if defined(_OPENMP)
+//OpenMP
+#include <omp.h>
+#endif
+
 static const char s_deviationSFName[] = "Deviation";
 
+//! Whether the (initialized) LOD structures are saved in BIN files
+static std::atomic<bool> s_lodFileStorage(false);
+
+//! Processes the [0 ; count[ range in parallel (by blocks of ccChunk::SIZE elements)
+template <typename Func> static void ParallelForBlocks(unsigned count, const Func& func)
+{
+	int blockCount = static_cast<int>(ccChunk::Count(count));
+#ifdef CC_CORE_LIB_USES_TBB
+	tbb::parallel_for(0, blockCount, [&](int b)
+#else
+#if defined(_OPENMP)
+	#pragma omp parallel for num_threads(omp_get_max_threads())
+#endif
+	for (int b = 0; b < blockCount; ++b)
+#endif
+	{
+		unsigned first = static_cast<unsigned>(ccChunk::StartPos(b));
+		unsigned last = first + static_cast<unsigned>(ccChunk::Size(b, count));
+		func(first, last);
+	}
+#ifdef CC_CORE_LIB_USES_TBB
+	);
+#endif
+}
+
+//! Copies the values corresponding to a selection of points (in parallel)
+/** output[i] = input[selection.getPointGlobalIndex(i)]
+**/
+template <typename T> static void GatherValues(const T* input, T* output, const CCCoreLib::ReferenceCloud& selection)
+{
+	ParallelForBlocks(selection.size(), [&](unsigned first, unsigned last)
+	{
+		for (unsigned i = first; i < last; ++i)
+		{
+			output[i] = input[selection.getPointGlobalIndex(i)];
+		}
+	});
+}
+
 // 'Draw normals' shader program
 static QSharedPointer<QOpenGLShaderProgram> s_programDrawNormals;
 // 'Draw normals' shader parameters
@@ -294,7 +344,8 @@ ccPointCloud* ccPointCloud::partialClone(const CCCoreLib::ReferenceCloud* select
 	unsigned selectionSize = selection->size();
 	if (selectionSize != 0)
 	{
-		if (!result->reserveThePointsTable(selectionSize))
+		//all the arrays are allocated once, then the values are gathered in parallel
+		if (!result->resize(selectionSize))
 		{
 			ccLog::Error("[ccPointCloud::partialClone] Not enough memory to duplicate cloud!");
 			delete result;
@@ -302,22 +353,15 @@ ccPointCloud* ccPointCloud::partialClone(const CCCoreLib::ReferenceCloud* select
 		}
 
 		//import points
-		{
-			for (unsigned i = 0; i < selectionSize; i++)
-			{
-				result->addPoint(*getPointPersistentPtr(selection->getPointGlobalIndex(i)));
-			}
-		}
+		GatherValues(m_points.data(), result->m_points.data(), *selection);
+		result->invalidateBoundingBox();
 
 		//RGB colors
 		if (hasColors())
 		{
-			if (result->reserveTheRGBTable())
+			if (result->resizeTheRGBTable(false))
 			{
-				for (unsigned i = 0; i < selectionSize; i++)
-				{
-					result->addColor(getPointColor(selection->getPointGlobalIndex(i)));
-				}
+				GatherValues(m_rgbaColors->data(), result->m_rgbaColors->data(), *selection);
 				result->showColors(colorsShown());
 			}
 			else
@@ -331,12 +375,9 @@ ccPointCloud* ccPointCloud::partialClone(const CCCoreLib::ReferenceCloud* select
 		//normals
 		if (hasNormals())
 		{
-			if (result->reserveTheNormsTable())
+			if (result->resizeTheNormsTable())
 			{
-				for (unsigned i = 0; i < selectionSize; i++)
-				{
-					result->addNormIndex(getPointNormalIndex(selection->getPointGlobalIndex(i)));
-				}
+				GatherValues(m_normals->data(), result->m_normals->data(), *selection);
 				result->showNormals(normalsShown());
 			}
 			else
@@ -354,16 +395,23 @@ ccPointCloud* ccPointCloud::partialClone(const CCCoreLib::ReferenceCloud* select
 			{
 				try
 				{
-					for (unsigned i = 0; i < selectionSize; i++)
+					result->waveforms().resize(selectionSize);
+					GatherValues(m_fwfWaveforms.data(), result->waveforms().data(), *selection);
+
+					//copy only the necessary descriptors
+					bool usedDescriptors[256] { false };
+					for (const ccWaveform& w : result->waveforms())
 					{
-						const ccWaveform& w = m_fwfWaveforms[selection->getPointGlobalIndex(i)];
-						if (!result->fwfDescriptors().contains(w.descriptorID()))
+						usedDescriptors[w.descriptorID()] = true;
+					}
+					for (FWFDescriptorSet::const_iterator it = m_fwfDescriptors.begin(); it != m_fwfDescriptors.end(); ++it)
+					{
+						if (usedDescriptors[it.key()])
 						{
-							//copy only the necessary descriptors
-							result->fwfDescriptors().insert(w.descriptorID(), m_fwfDescriptors[w.descriptorID()]);
+							result->fwfDescriptors().insert(it.key(), it.value());
 						}
-						result->waveforms().push_back(w);
 					}
+
 					//we will use the same FWF data container
 					result->fwfData() = fwfData();
 				}
@@ -404,8 +452,7 @@ ccPointCloud* ccPointCloud::partialClone(const CCCoreLib::ReferenceCloud* select
 							currentScalarField->setGlobalShift(sf->getGlobalShift());
 
 							//we copy data to new SF
-							for (unsigned i = 0; i < selectionSize; i++)
-								currentScalarField->setValue(i, sf->getValue(selection->getPointGlobalIndex(i)));
+							GatherValues(sf->data(), currentScalarField->data(), *selection);
 
 							currentScalarField->computeMinAndMax();
 							//copy display parameters
@@ -447,10 +494,13 @@ ccPointCloud* ccPointCloud::partialClone(const CCCoreLib::ReferenceCloud* select
 			try
 			{
 				newIndexMap.resize(size(), -1);
-				for (unsigned i = 0; i < selectionSize; i++)
+				ParallelForBlocks(selectionSize, [&](unsigned first, unsigned last)
 				{
-					newIndexMap[selection->getPointGlobalIndex(i)] = i;
-				}
+					for (unsigned i = first; i < last; ++i)
+					{
+						newIndexMap[selection->getPointGlobalIndex(i)] = static_cast<int>(i);
+					}
+				});
 			}
 			catch (const std::bad_alloc&)
 			{
@@ -504,6 +554,12 @@ ccPointCloud* ccPointCloud::partialClone(const CCCoreLib::ReferenceCloud* select
 		}
 	}
 
+	//the points of this cloud may not be up-to-date
+	if (m_hasPendingTransformation)
+	{
+		result->transformData(m_pendingTransformation);
+	}
+
 	return result;
 }
 
@@ -528,6 +584,7 @@ void ccPointCloud::clear()
 
 void ccPointCloud::unallocatePoints()
 {
+	cancelVBOColorsUpdate(); // the SFs are about to be destroyed
 	clearLOD();	// we have to clear the LOD structure before clearing the colors / SFs, so we can't leave it to notifyGeometryUpdate()
 	showSFColorsScale(false); //SFs will be destroyed
 	BaseClass::reset();
@@ -541,6 +598,7 @@ void ccPointCloud::notifyGeometryUpdate()
 	ccHObject::notifyGeometryUpdate();
 
 	releaseVBOs();
+	releaseCoordinateColumns();
 	clearLOD();
 }
 
@@ -569,6 +627,9 @@ ccGenericPointCloud* ccPointCloud::clone(ccGenericPointCloud* destCloud/*=nullpt
 
 ccPointCloud* ccPointCloud::cloneThis(ccPointCloud* destCloud/*=nullptr*/, bool ignoreChildren/*=false*/)
 {
+	//the points must be up-to-date
+	applyPendingTransformation();
+
 	ccPointCloud* result = destCloud ? destCloud : new ccPointCloud();
 
 	result->setVisible(isVisible());
@@ -609,6 +670,10 @@ const ccPointCloud& ccPointCloud::append(ccPointCloud* addedCloud, unsigned poin
 
 	assert(addedCloud);
 
+	//the points must be up-to-date
+	applyPendingTransformation();
+	addedCloud->applyPendingTransformation();
+
 	unsigned addedPoints = addedCloud->size();
 
 	if (!reserve(pointCountBefore + addedPoints))
@@ -642,7 +707,7 @@ const ccPointCloud& ccPointCloud::append(ccPointCloud* addedCloud, unsigned poin
 		//merge display parameters
 		showColors(colorsShown() || addedCloud->colorsShown());
 
-		if (hasColors())
+		if (hasColors() && detachColors())
 		{
 			m_rgbaColors->resize(pointCountBefore); // just in case
 		}
@@ -656,6 +721,13 @@ const ccPointCloud& ccPointCloud::append(ccPointCloud* addedCloud, unsigned poin
 				addColor(ccColor::white);
 			}
 		}
+		else if (pointCountBefore == 0 && !hasColors() && addedCloud->m_rgbaColors->currentSize() == addedPoints)
+		{
+			//we share the colors of the added cloud (copy-on-write)
+			m_rgbaColors = addedCloud->m_rgbaColors;
+			m_rgbaColors->link();
+			colorsHaveChanged();
+		}
 		else //otherwise
 		{
 			//if this cloud hadn't any color before
@@ -702,6 +774,13 @@ const ccPointCloud& ccPointCloud::append(ccPointCloud* addedCloud, unsigned poin
 				addNormIndex(0);
 			}
 		}
+		else if (pointCountBefore == 0 && !hasNormals() && addedCloud->m_normals->currentSize() == addedPoints)
+		{
+			//we share the normals of the added cloud (copy-on-write)
+			m_normals = addedCloud->m_normals;
+			m_normals->link();
+			normalsHaveChanged();
+		}
 		else //otherwise
 		{
 			//if this cloud hasn't any normal
@@ -1176,6 +1255,10 @@ bool ccPointCloud::reserveTheRGBTable()
 		m_rgbaColors = new RGBAColorsTableType();
 		m_rgbaColors->link();
 	}
+	else if (!detachColors())
+	{
+		return false;
+	}
 
 	if (!m_rgbaColors->reserveSafe(m_points.capacity()))
 	{
@@ -1203,6 +1286,10 @@ bool ccPointCloud::resizeTheRGBTable(bool fillWithWhite/*=false*/)
 		m_rgbaColors = new RGBAColorsTableType();
 		m_rgbaColors->link();
 	}
+	else if (!detachColors())
+	{
+		return false;
+	}
 
 	static const ccColor::Rgba s_white(ccColor::MAX, ccColor::MAX, ccColor::MAX, ccColor::MAX);
 	if (!m_rgbaColors->resizeSafe(m_points.size(), fillWithWhite, &s_white))
@@ -1231,6 +1318,10 @@ bool ccPointCloud::reserveTheNormsTable()
 		m_normals = new NormsIndexesTableType();
 		m_normals->link();
 	}
+	else if (!detachNormals())
+	{
+		return false;
+	}
 
 	if (!m_normals->reserveSafe(m_points.capacity()))
 	{
@@ -1259,6 +1350,10 @@ bool ccPointCloud::resizeTheNormsTable()
 		m_normals = new NormsIndexesTableType();
 		m_normals->link();
 	}
+	else if (!detachNormals())
+	{
+		return false;
+	}
 
 	static const CompressedNormType s_normZero = 0;
 	if (!m_normals->resizeSafe(m_points.size(), true, &s_normZero))
@@ -1445,6 +1540,8 @@ bool ccPointCloud::reserve(unsigned newNumberOfPoints)
 
 	//if we are changing the cloud contents, let's stop the LOD construction process
 	clearLOD();
+	//as well as the asynchronous update of the VBO colors (the SFs may be reallocated)
+	cancelVBOColorsUpdate();
 
 	//call parent method first (for points + scalar fields)
 	if (	!BaseClass::reserve(newNumberOfPoints)
@@ -1475,6 +1572,8 @@ bool ccPointCloud::resize(unsigned newNumberOfPoints)
 
 	//if we are changing the cloud contents, let's stop the LOD construction process
 	clearLOD();
+	//as well as the asynchronous update of the VBO colors (the SFs may be reallocated)
+	cancelVBOColorsUpdate();
 
 	if (newNumberOfPoints != size())
 	{
@@ -1570,6 +1669,8 @@ const CCVector3* ccPointCloud::getNormal(unsigned pointIndex) const
 void ccPointCloud::setPointColor(unsigned pointIndex, const ccColor::Rgba& col)
 {
 	assert(m_rgbaColors && pointIndex < m_rgbaColors->currentSize());
+	if (!detachColors())
+		return;
 
 	m_rgbaColors->setValue(pointIndex, col);
 
@@ -1580,6 +1681,8 @@ void ccPointCloud::setPointColor(unsigned pointIndex, const ccColor::Rgba& col)
 void ccPointCloud::setPointNormalIndex(unsigned pointIndex, CompressedNormType norm)
 {
 	assert(m_normals && pointIndex < m_normals->currentSize());
+	if (!detachNormals())
+		return;
 
 	m_normals->setValue(pointIndex, norm);
 
@@ -1622,6 +1725,8 @@ void ccPointCloud::invalidateBoundingBox()
 void ccPointCloud::addColor(const ccColor::Rgba& C)
 {
 	assert(m_rgbaColors && m_rgbaColors->isAllocated());
+	if (!detachColors())
+		return;
 	m_rgbaColors->emplace_back(C);
 
 	//We must update the VBOs
@@ -1636,12 +1741,16 @@ void ccPointCloud::addNorm(const CCVector3& N)
 void ccPointCloud::addNormIndex(CompressedNormType index)
 {
 	assert(m_normals && m_normals->isAllocated());
+	if (!detachNormals())
+		return;
 	m_normals->addElement(index);
 }
 
 void ccPointCloud::addNormAtIndex(const PointCoordinateType* N, unsigned index)
 {
 	assert(m_normals && m_normals->isAllocated());
+	if (!detachNormals())
+		return;
 	//we get the real normal vector corresponding to current index
 	CCVector3 P(ccNormalVectors::GetNormal(m_normals->getValue(index)));
 	//we add the provided vector (N)
@@ -1689,7 +1798,7 @@ bool ccPointCloud::convertNormalToRGB()
 
 bool ccPointCloud::convertRGBToGreyScale()
 {
-	if (!hasColors())
+	if (!hasColors() || !detachColors())
 	{
 		return false;
 	}
@@ -1762,6 +1871,51 @@ void ccPointCloud::setNormsTable(NormsIndexesTableType* norms)
 	normalsHaveChanged();
 }
 
+//! Makes sure an array is not shared anymore before modifying it (copy-on-write)
+template <class ArrayType> static bool DetachArray(ArrayType*& array)
+{
+	if (!array || array->getLinkCount() <= 1)
+	{
+		//nothing to do
+		return true;
+	}
+
+	ArrayType* duplicate = array->clone();
+	if (!duplicate || !duplicate->reserveSafe(array->capacity())) //reserved arrays may still be empty
+	{
+		if (duplicate)
+			duplicate->release();
+		ccLog::Error("[ccPointCloud] Not enough memory to duplicate a shared array!");
+		return false;
+	}
+	duplicate->link();
+
+	array->release();
+	array = duplicate;
+
+	return true;
+}
+
+bool ccPointCloud::detachColors()
+{
+	return DetachArray(m_rgbaColors);
+}
+
+bool ccPointCloud::detachNormals()
+{
+	return DetachArray(m_normals);
+}
+
+bool ccPointCloud::detachSharedArrays()
+{
+	if (hasColors() && !detachColors())
+		return false;
+	if (hasNormals() && !detachNormals())
+		return false;
+
+	return true;
+}
+
 bool ccPointCloud::colorize(float r, float g, float b, float a/*=1.0f*/)
 {
 	assert(r >= 0.0f && r <= 1.0f);
@@ -1771,6 +1925,8 @@ bool ccPointCloud::colorize(float r, float g, float b, float a/*=1.0f*/)
 
 	if (hasColors())
 	{
+		if (!detachColors())
+			return false;
 		assert(m_rgbaColors);
 		for (unsigned i = 0; i < m_rgbaColors->currentSize(); i++)
 		{
@@ -1812,8 +1968,14 @@ bool ccPointCloud::setRGBColorByBanding(unsigned char dim, double freq)
 
 	//allocate colors if necessary
 	if (!hasColors())
+	{
 		if (!resizeTheRGBTable(false))
 			return false;
+	}
+	else if (!detachColors())
+	{
+		return false;
+	}
 
 	enableTempColor(false);
 	assert(m_rgbaColors);
@@ -1850,8 +2012,14 @@ bool ccPointCloud::setRGBColorByHeight(unsigned char heightDim, ccColorScale::Sh
 
 	//allocate colors if necessary
 	if (!hasColors())
+	{
 		if (!resizeTheRGBTable(false))
 			return false;
+	}
+	else if (!detachColors())
+	{
+		return false;
+	}
 
 	enableTempColor(false);
 	assert(m_rgbaColors);
@@ -1889,8 +2057,14 @@ bool ccPointCloud::setColor(const ccColor::Rgba& col)
 
 	//allocate colors if necessary
 	if (!hasColors())
+	{
 		if (!reserveTheRGBTable())
 			return false;
+	}
+	else if (!detachColors())
+	{
+		return false;
+	}
 
 	assert(m_rgbaColors);
 	m_rgbaColors->resize(size()); // reserve might have set a capacity larger than the cloud size!
@@ -1922,44 +2096,115 @@ void ccPointCloud::applyGLTransformation(const ccGLMatrix& trans)
 	return applyRigidTransformation(trans);
 }
 
-void ccPointCloud::applyRigidTransformation(const ccGLMatrix& trans)
+//! Applies an affine transformation to a set of points
+/** The matrix coefficients are copied to local variables and the points are processed
+	in a plain loop, so that the compiler can vectorize it (the blocks are processed in parallel).
+**/
+static void TransformPoints(CCVector3* points, unsigned count, const ccGLMatrix& trans)
 {
-	//Clears the LOD structure (and potentially stop its construction)
-	clearLOD();
+	const float* M = trans.data();
+	const PointCoordinateType m11 = M[0], m12 = M[4], m13 = M[8], m14 = M[12];
+	const PointCoordinateType m21 = M[1], m22 = M[5], m23 = M[9], m24 = M[13];
+	const PointCoordinateType m31 = M[2], m32 = M[6], m33 = M[10], m34 = M[14];
+
+	ParallelForBlocks(count, [&](unsigned first, unsigned last)
+	{
+		CCVector3* P = points + first;
+		for (unsigned i = first; i < last; ++i, ++P)
+		{
+			const PointCoordinateType x = P->x;
+			const PointCoordinateType y = P->y;
+			const PointCoordinateType z = P->z;
+			P->x = m11 * x + m12 * y + m13 * z + m14;
+			P->y = m21 * x + m22 * y + m23 * z + m24;
+			P->z = m31 * x + m32 * y + m33 * z + m34;
+		}
+	});
+}
 
+void ccPointCloud::applyRigidTransformation(const ccGLMatrix& trans)
+{
 	//transparent call
 	ccGenericPointCloud::applyGLTransformation(trans);
 
+	if (m_deferTransformations)
+	{
+		//we only compose the transformation with the pending one (see applyPendingTransformation)
+		m_pendingTransformation = (m_hasPendingTransformation ? trans * m_pendingTransformation : trans);
+		m_hasPendingTransformation = true;
+
+		//the data (and the VBOs) are left untouched, but the display must be updated
+		ccHObject::notifyGeometryUpdate();
+		return;
+	}
+
+	transformData(trans);
+}
+
+void ccPointCloud::applyPendingTransformation()
+{
+	if (!m_hasPendingTransformation)
+	{
+		return;
+	}
+
+	ccGLMatrix trans = m_pendingTransformation;
+	m_pendingTransformation.toIdentity();
+	m_hasPendingTransformation = false;
+
+	transformData(trans);
+}
+
+void ccPointCloud::transformData(const ccGLMatrix& trans)
+{
+	//the LOD structure can be transformed as well if it's ready
+	bool lodTransformed = (m_lod && m_lod->transform(trans));
+	if (!lodTransformed)
+	{
+		//Clears the LOD structure (and potentially stop its construction)
+		clearLOD();
+	}
+
 	unsigned count = size();
-	for (unsigned i = 0; i < count; i++)
+	if (count != 0)
 	{
-		trans.apply(*point(i));
+		TransformPoints(point(0), count, trans);
 	}
 
 	//we must also take care of the normals!
-	if (hasNormals())
+	if (hasNormals() && detachNormals())
 	{
 		bool recoded = false;
 
 		//if there is more points than the size of the compressed normals array,
 		//we recompress the array instead of recompressing each normal
-		if (count > ccNormalVectors::GetNumberOfVectors())
+		unsigned normalCount = ccNormalVectors::GetNumberOfVectors();
+		if (count > normalCount)
 		{
 			NormsIndexesTableType newNorms;
-			if (newNorms.reserveSafe(ccNormalVectors::GetNumberOfVectors()))
+			if (newNorms.resizeSafe(normalCount))
 			{
-				for (unsigned i = 0; i < ccNormalVectors::GetNumberOfVectors(); i++)
+				ParallelForBlocks(normalCount, [&](unsigned first, unsigned last)
 				{
-					CCVector3 new_n(ccNormalVectors::GetNormal(i));
-					trans.applyRotation(new_n);
-					CompressedNormType newNormIndex = ccNormalVectors::GetNormIndex(new_n.u);
-					newNorms.emplace_back(newNormIndex);
-				}
+					for (unsigned i = first; i < last; ++i)
+					{
+						CCVector3 new_n(ccNormalVectors::GetNormal(i));
+						trans.applyRotation(new_n);
+						newNorms[i] = ccNormalVectors::GetNormIndex(new_n.u);
+					}
+				});
 
-				for (unsigned j = 0; j < count; j++)
+				ParallelForBlocks(count, [&](unsigned first, unsigned last)
 				{
-					m_normals->setValue(j, newNorms[m_normals->at(j)]);
-				}
+					for (unsigned j = first; j < last; ++j)
+					{
+						CompressedNormType& normIndex = (*m_normals)[j];
+						if (normIndex < normalCount) //the 'null' normal code is left untouched
+						{
+							normIndex = newNorms[normIndex];
+						}
+					}
+				});
 				recoded = true;
 			}
 		}
@@ -1969,13 +2214,16 @@ void ccPointCloud::applyRigidTransformation(const ccGLMatrix& trans)
 		//array), we recompress each normal ...
 		if (!recoded)
 		{
-			//on recode direct chaque normale
-			for (CompressedNormType& _theNormIndex : *m_normals)
+			ParallelForBlocks(count, [&](unsigned first, unsigned last)
 			{
-				CCVector3 new_n(ccNormalVectors::GetNormal(_theNormIndex));
-				trans.applyRotation(new_n);
-				_theNormIndex = ccNormalVectors::GetNormIndex(new_n.u);
-			}
+				for (unsigned j = first; j < last; ++j)
+				{
+					CompressedNormType& normIndex = (*m_normals)[j];
+					CCVector3 new_n(ccNormalVectors::GetNormal(normIndex));
+					trans.applyRotation(new_n);
+					normIndex = ccNormalVectors::GetNormIndex(new_n.u);
+				}
+			});
 		}
 	}
 
@@ -1995,19 +2243,66 @@ void ccPointCloud::applyRigidTransformation(const ccGLMatrix& trans)
 	}
 
 	//and the waveform!
-	for (ccWaveform& w : m_fwfWaveforms)
+	if (!m_fwfWaveforms.empty())
 	{
-		if (w.descriptorID() != 0)
+		ParallelForBlocks(static_cast<unsigned>(m_fwfWaveforms.size()), [&](unsigned first, unsigned last)
 		{
-			w.applyRigidTransformation(trans);
-		}
+			for (unsigned i = first; i < last; ++i)
+			{
+				ccWaveform& w = m_fwfWaveforms[i];
+				if (w.descriptorID() != 0)
+				{
+					w.applyRigidTransformation(trans);
+				}
+			}
+		});
 	}
 
 	//the octree is invalidated by rotation...
-	deleteOctree();
+	const float* M = trans.data();
+	bool pureTranslation = (	M[0] == 1.0f && M[1] == 0.0f && M[2] == 0.0f
+							&&	M[4] == 0.0f && M[5] == 1.0f && M[6] == 0.0f
+							&&	M[8] == 0.0f && M[9] == 0.0f && M[10] == 1.0f );
+	if (pureTranslation)
+	{
+		//... but it can be kept in case of a pure translation (as the Kd-trees)
+		CCVector3 T(M[12], M[13], M[14]);
+		ccOctree::Shared octree = getOctree();
+		if (octree)
+		{
+			octree->translateBoundingBox(T);
+		}
+
+		ccHObject::Container kdtrees;
+		filterChildren(kdtrees, false, CC_TYPES::POINT_KDTREE);
+		for (ccHObject* kdtree : kdtrees)
+		{
+			static_cast<ccKdTree*>(kdtree)->translateBoundingBox(T);
+		}
+	}
+	else
+	{
+		deleteOctree();
+	}
 
 	// ... as the bounding box
-	refreshBB(); //calls notifyGeometryUpdate + releaseVBOs
+	{
+		//the transformed LOD structure is still valid (we put it aside as notifyGeometryUpdate would clear it)
+		ccPointCloudLOD* lod = nullptr;
+		if (lodTransformed)
+		{
+			lod = m_lod;
+			m_lod = nullptr;
+		}
+
+		refreshBB(); //calls notifyGeometryUpdate + releaseVBOs
+
+		if (lod)
+		{
+			assert(!m_lod);
+			m_lod = lod;
+		}
+	}
 }
 
 void ccPointCloud::translate(const CCVector3& T)
@@ -2016,9 +2311,16 @@ void ccPointCloud::translate(const CCVector3& T)
 		return;
 
 	unsigned count = size();
+	if (count != 0)
 	{
-		for (unsigned i = 0; i < count; i++)
-			*point(i) += T;
+		CCVector3* points = point(0);
+		ParallelForBlocks(count, [&](unsigned first, unsigned last)
+		{
+			for (unsigned i = first; i < last; ++i)
+			{
+				points[i] += T;
+			}
+		});
 	}
 
 	notifyGeometryUpdate(); //calls releaseVBOs()
@@ -2052,15 +2354,20 @@ void ccPointCloud::translate(const CCVector3& T)
 void ccPointCloud::scale(PointCoordinateType fx, PointCoordinateType fy, PointCoordinateType fz, CCVector3 center)
 {
 	//transform the points
+	unsigned count = size();
+	if (count != 0)
 	{
-		unsigned count = size();
-		for (unsigned i = 0; i < count; i++)
+		CCVector3* points = point(0);
+		ParallelForBlocks(count, [&](unsigned first, unsigned last)
 		{
-			CCVector3* P = point(i);
-			P->x = (P->x - center.x) * fx + center.x;
-			P->y = (P->y - center.y) * fy + center.y;
-			P->z = (P->z - center.z) * fz + center.z;
-		}
+			for (unsigned i = first; i < last; ++i)
+			{
+				CCVector3& P = points[i];
+				P.x = (P.x - center.x) * fx + center.x;
+				P.y = (P.y - center.y) * fy + center.y;
+				P.z = (P.z - center.z) * fz + center.z;
+			}
+		});
 	}
 
 	invalidateBoundingBox();
@@ -2069,21 +2376,25 @@ void ccPointCloud::scale(PointCoordinateType fx, PointCoordinateType fy, PointCo
 	if (hasNormals())
 	{
 		//only if one of the scale coefficients is negative
-		if (fx < 0 || fy < 0 || fz < 0)
+		if ((fx < 0 || fy < 0 || fz < 0) && detachNormals())
 		{
 			PointCoordinateType signX = (fx < 0 ? -CCCoreLib::PC_ONE : CCCoreLib::PC_ONE);
 			PointCoordinateType signY = (fy < 0 ? -CCCoreLib::PC_ONE : CCCoreLib::PC_ONE);
 			PointCoordinateType signZ = (fz < 0 ? -CCCoreLib::PC_ONE : CCCoreLib::PC_ONE);
 
-			for (CompressedNormType& n : *m_normals)
+			ParallelForBlocks(static_cast<unsigned>(m_normals->size()), [&](unsigned first, unsigned last)
 			{
-				CCVector3 N;
-				ccNormalCompressor::Decompress(n, N.u);
-				N.x *= signX;
-				N.y *= signY;
-				N.z *= signZ;
-				n = ccNormalCompressor::Compress(N.u);
-			}
+				for (unsigned i = first; i < last; ++i)
+				{
+					CompressedNormType& n = (*m_normals)[i];
+					CCVector3 N;
+					ccNormalCompressor::Decompress(n, N.u);
+					N.x *= signX;
+					N.y *= signY;
+					N.z *= signZ;
+					n = ccNormalCompressor::Compress(N.u);
+				}
+			});
 
 			//we must update the VBOs
 			normalsHaveChanged();
@@ -2194,7 +2505,7 @@ void ccPointCloud::scale(PointCoordinateType fx, PointCoordinateType fy, PointCo
 
 void ccPointCloud::invertNormals()
 {
-	if (hasNormals())
+	if (hasNormals() && detachNormals())
 	{
 		for (CompressedNormType& n : *m_normals)
 		{
@@ -2213,6 +2524,14 @@ void ccPointCloud::swapPoints(unsigned firstIndex, unsigned secondIndex)
 	if (firstIndex == secondIndex)
 		return;
 
+	//the shared tables must be detached before swapping anything (otherwise
+	//the points and their colors or normals would be desynchronized)
+	if (!detachSharedArrays())
+	{
+		ccLog::Warning("[ccPointCloud::swapPoints] Not enough memory");
+		return;
+	}
+
 	//points + associated SF values
 	BaseClass::swapPoints(firstIndex, secondIndex);
 
@@ -2437,7 +2756,8 @@ void ccPointCloud::glChunkSFPointer(const CC_DRAW_CONTEXT& context, size_t chunk
 		&&	m_vboManager.vbos[chunkIndex]
 		&&	m_vboManager.vbos[chunkIndex]->isCreated())
 	{
-		assert(m_vboManager.colorIsSF && m_vboManager.sourceSF == m_currentDisplayedScalarField);
+		//(the VBOs may still contain the previous colors during an asynchronous update)
+		assert(m_vboManager.colorsUpdate.inProgress || (m_vboManager.colorIsSF && m_vboManager.sourceSF == m_currentDisplayedScalarField));
 		//we can use VBOs directly
 		if (m_vboManager.vbos[chunkIndex]->bind())
 		{
@@ -2458,17 +2778,25 @@ void ccPointCloud::glChunkSFPointer(const CC_DRAW_CONTEXT& context, size_t chunk
 	{
 		//we must convert the scalar values to RGB colors in a dedicated static array
 		ScalarType* _sf = ccChunk::Start(*m_currentDisplayedScalarField, chunkIndex);
-		ColorCompType* _sfColors = s_rgbBuffer4ub;
 		size_t chunkSize = ccChunk::Size(chunkIndex, m_currentDisplayedScalarField->size());
-		for (size_t j = 0; j < chunkSize; j += decimStep, _sf += decimStep)
+		if (decimStep == 1)
+		{
+			//batch conversion
+			m_currentDisplayedScalarField->getColors(_sf, static_cast<unsigned>(chunkSize), reinterpret_cast<ccColor::Rgba*>(s_rgbBuffer4ub));
+		}
+		else
 		{
-			//convert the scalar value to a RGB color
-			const ccColor::Rgb* col = m_currentDisplayedScalarField->getColor(*_sf);
-			assert(col);
-			*_sfColors++ = col->r;
-			*_sfColors++ = col->g;
-			*_sfColors++ = col->b;
-			*_sfColors++ = ccColor::MAX;
+			ColorCompType* _sfColors = s_rgbBuffer4ub;
+			for (size_t j = 0; j < chunkSize; j += decimStep, _sf += decimStep)
+			{
+				//convert the scalar value to a RGB color
+				const ccColor::Rgb* col = m_currentDisplayedScalarField->getColor(*_sf);
+				assert(col);
+				*_sfColors++ = col->r;
+				*_sfColors++ = col->g;
+				*_sfColors++ = col->b;
+				*_sfColors++ = ccColor::MAX;
+			}
 		}
 		glFunc->glColorPointer(4, GL_UNSIGNED_BYTE, 0, s_rgbBuffer4ub);
 	}
@@ -2613,6 +2941,16 @@ struct DisplayDesc : LODLevelDesc
 	LODIndexSet* indexMap;
 };
 
+//! Returns the current camera parameters (with the actual OpenGL viewport and matrices)
+static void GetCurrentGLCamera(CC_DRAW_CONTEXT& context, QOpenGLFunctions_2_1* glFunc, ccGLCameraParameters& camera)
+{
+	context.display->getGLCameraParameters(camera);
+	//replace the viewport and matrices by the real ones
+	glFunc->glGetIntegerv(GL_VIEWPORT, camera.viewport);
+	glFunc->glGetDoublev(GL_PROJECTION_MATRIX, camera.projectionMat.data());
+	glFunc->glGetDoublev(GL_MODELVIEW_MATRIX, camera.modelViewMat.data());
+}
+
 void ccPointCloud::drawMeOnly(CC_DRAW_CONTEXT& context)
 {
 	if (m_points.empty())
@@ -2661,6 +2999,48 @@ void ccPointCloud::drawMeOnly(CC_DRAW_CONTEXT& context)
 			}
 		}
 
+		//pending (deferred) transformation
+		if (m_hasPendingTransformation)
+		{
+			glFunc->glMatrixMode(GL_MODELVIEW);
+			glFunc->glPushMatrix();
+			glFunc->glMultMatrixf(m_pendingTransformation.data());
+		}
+
+		//scheduling pass: the cloud only registers its LOD structure (see ccLODPointBudget)
+		if (MACRO_SchedulingPass(context))
+		{
+			if (!context.lodPointBudget)
+			{
+				//nothing to do
+			}
+			else if (	context.decimateCloudOnMove
+					&&	size() > context.minLODPointCount
+					&&	m_lod
+					&&	m_lod->isInitialized()
+					&&	m_lod->maxLevel() != 0)
+			{
+				ccGLCameraParameters camera;
+				GetCurrentGLCamera(context, glFunc, camera);
+				Frustum frustum(camera.modelViewMat, camera.projectionMat);
+
+				m_lod->flagVisibility(frustum, m_clipPlanes.empty() ? nullptr : &m_clipPlanes);
+				context.lodPointBudget->addCloud(m_lod, camera);
+			}
+			else
+			{
+				//the cloud will be displayed entirely (or decimated if its LOD structure is not ready)
+				context.lodPointBudget->addFixedPoints(std::min(size(), context.minLODPointCount));
+			}
+
+			if (m_hasPendingTransformation)
+			{
+				glFunc->glMatrixMode(GL_MODELVIEW);
+				glFunc->glPopMatrix();
+			}
+			return;
+		}
+
 		// L.O.D. display
 		DisplayDesc toDisplay(0, size());
 		if (!entityPickingMode)
@@ -2696,17 +3076,39 @@ void ccPointCloud::drawMeOnly(CC_DRAW_CONTEXT& context)
 							context.moreLODPointsAvailable = underConstruction;
 							context.higherLODLevelsAvailable = false;
 						}
+						else if (context.lodPointBudget)
+						{
+							//point budget mode: the index map has already been built (see ccLODPointBudget)
+							toDisplay.indexMap = context.lodPointBudget->indexMap(m_lod);
+							if (!toDisplay.indexMap)
+							{
+								//the structure was not ready yet during the point budget pass
+								context.moreLODPointsAvailable = true;
+							}
+							else if (toDisplay.indexMap->empty())
+							{
+								//nothing to draw
+								if (m_hasPendingTransformation)
+								{
+									glFunc->glMatrixMode(GL_MODELVIEW);
+									glFunc->glPopMatrix();
+								}
+								return;
+							}
+							else
+							{
+								toDisplay.startIndex = 0;
+								toDisplay.count = static_cast<unsigned>(toDisplay.indexMap->size());
+								toDisplay.endIndex = toDisplay.count;
+							}
+						}
 						else if (context.stereoPassIndex == 0)
 						{
 							if (context.currentLODLevel == 0)
 							{
 								//get the current viewport and OpenGL matrices
 								ccGLCameraParameters camera;
-								context.display->getGLCameraParameters(camera);
-								//replace the viewport and matrices by the real ones
-								glFunc->glGetIntegerv(GL_VIEWPORT, camera.viewport);
-								glFunc->glGetDoublev(GL_PROJECTION_MATRIX, camera.projectionMat.data());
-								glFunc->glGetDoublev(GL_MODELVIEW_MATRIX, camera.modelViewMat.data());
+								GetCurrentGLCamera(context, glFunc, camera);
 								//camera frustum
 								Frustum frustum(camera.modelViewMat, camera.projectionMat);
 
@@ -2732,6 +3134,13 @@ void ccPointCloud::drawMeOnly(CC_DRAW_CONTEXT& context)
 							//could we draw more points at the next level?
 							context.moreLODPointsAvailable = (remainingPointsAtThisLevel != 0);
 							context.higherLODLevelsAvailable = (!m_lod->allDisplayed() && context.currentLODLevel + 1 <= maxLevel);
+
+							//prepare the next index map in the background while the current one is displayed
+							if (toDisplay.indexMap && (context.moreLODPointsAvailable || context.higherLODLevelsAvailable))
+							{
+								unsigned char nextLevel = (context.moreLODPointsAvailable ? context.currentLODLevel : static_cast<unsigned char>(context.currentLODLevel + 1));
+								m_lod->prepareNextIndexMap(nextLevel, MAX_POINT_COUNT_PER_LOD_RENDER_PASS);
+							}
 						}
 					}
 				}
@@ -2741,6 +3150,11 @@ void ccPointCloud::drawMeOnly(CC_DRAW_CONTEXT& context)
 					//if we don't have a LoD map, we can only display points at level 0!
 					if (context.currentLODLevel != 0)
 					{
+						if (m_hasPendingTransformation)
+						{
+							glFunc->glMatrixMode(GL_MODELVIEW);
+							glFunc->glPopMatrix();
+						}
 						return;
 					}
 
@@ -3314,6 +3728,12 @@ void ccPointCloud::drawMeOnly(CC_DRAW_CONTEXT& context)
 		{
 			drawNormalsAsLines(context);
 		}
+
+		if (m_hasPendingTransformation)
+		{
+			glFunc->glMatrixMode(GL_MODELVIEW);
+			glFunc->glPopMatrix();
+		}
 	}
 	else if (MACRO_Draw2D(context))
 	{
@@ -3529,6 +3949,13 @@ bool ccPointCloud::removeVisiblePoints(VisibilityTableType* visTable/*=nullptr*/
 		return false;
 	}
 
+	//the points will be swapped (see swapPoints)
+	if (!detachSharedArrays())
+	{
+		ccLog::Error("[removeVisiblePoints] Not enough memory");
+		return false;
+	}
+
 	//we drop the octree before modifying this cloud's contents
 	deleteOctree();
 	clearLOD();
@@ -3602,6 +4029,9 @@ void ccPointCloud::setCurrentDisplayedScalarField(int index)
 
 void ccPointCloud::deleteScalarField(int index)
 {
+	//the displayed SF may be converted to colors in the background
+	cancelVBOColorsUpdate();
+
 	//we 'store' the currently displayed SF, as the SF order may be mixed up
 	setCurrentInScalarField(m_currentDisplayedScalarFieldIndex);
 
@@ -3618,6 +4048,9 @@ void ccPointCloud::deleteScalarField(int index)
 
 void ccPointCloud::deleteAllScalarFields()
 {
+	//the displayed SF may be converted to colors in the background
+	cancelVBOColorsUpdate();
+
 	//the father does all the work
 	BaseClass::deleteAllScalarFields();
 
@@ -3642,15 +4075,21 @@ bool ccPointCloud::convertCurrentScalarFieldToColors(bool mixWithExistingColor/*
 		{
 			return false;
 		}
-
-		for (unsigned i = 0; i < count; i++)
+		if (!detachColors())
 		{
-			const ccColor::Rgb* col = getPointScalarValueColor(i);
-			setPointColor(i, col ? *col : ccColor::blackRGB);
+			return false;
 		}
+
+		//hidden values are converted to black
+		m_currentDisplayedScalarField->getColors(m_currentDisplayedScalarField->data(), count, m_rgbaColors->data(), ccColor::black);
 	}
 	else //mix with existing colors
 	{
+		if (!detachColors())
+		{
+			return false;
+		}
+
 		for (unsigned i = 0; i < count; i++)
 		{
 			const ccColor::Rgb* col = getPointScalarValueColor(i);
@@ -4335,7 +4774,7 @@ bool ccPointCloud::toFile_MeOnly(QFile& out, short dataVersion) const
 	}
 
 	//points array (dataVersion>=20)
-	if (!ccSerializationHelper::GenericArrayToFile<CCVector3, 3, PointCoordinateType>(m_points, out))
+	if (!ccSerializationHelper::GenericArrayToFile<CCVector3, 3, PointCoordinateType>(m_points, out, dataVersion))
 		return false;
 
 	//colors array (dataVersion>=20)
@@ -4473,6 +4912,20 @@ bool ccPointCloud::toFile_MeOnly(QFile& out, short dataVersion) const
 		}
 	}
 
+	//LOD structure (dataVersion >= 58)
+	if (dataVersion >= 58)
+	{
+		bool withLOD = (s_lodFileStorage && m_lod && m_lod->isInitialized());
+		if (out.write((const char*)&withLOD, sizeof(bool)) < 0)
+		{
+			return WriteError();
+		}
+		if (withLOD && !m_lod->toFile(out, dataVersion))
+		{
+			return false;
+		}
+	}
+
 	return true;
 }
 
@@ -4747,6 +5200,28 @@ bool ccPointCloud::fromFile_MeOnly(QFile& in, short dataVersion, int flags, Load
 		}
 	}
 
+	//LOD structure (dataVersion >= 58)
+	if (dataVersion >= 58)
+	{
+		bool withLOD = false;
+		if (in.read((char*)&withLOD, sizeof(bool)) < 0)
+		{
+			return ReadError();
+		}
+		if (withLOD)
+		{
+			//the structure can be used right away (no need to wait for its construction)
+			if (!m_lod)
+			{
+				m_lod = new ccPointCloudLOD;
+			}
+			if (!m_lod->fromFile(in, dataVersion, size()))
+			{
+				return false;
+			}
+		}
+	}
+
 	//notifyGeometryUpdate(); //FIXME: we can't call it now as the dependent 'pointers' are not valid yet!
 
 	//We should update the VBOs (just in case)
@@ -4924,6 +5399,11 @@ short ccPointCloud::minimumFileVersion_MeOnly() const
 		}
 	}
 
+	if (s_lodFileStorage && m_lod && m_lod->isInitialized())
+	{
+		minVersion = std::max(minVersion, static_cast<short>(58));
+	}
+
 	return minVersion;
 }
 
@@ -5068,7 +5548,7 @@ static bool CatchGLErrors(GLenum err, const char* context)
 //DGM: normals are so slow to display that it's a waste of memory and time to load them in VBOs!
 #define DONT_LOAD_NORMALS_IN_VBOS
 
-bool ccPointCloud::updateVBOs(const CC_DRAW_CONTEXT& context, const glDrawParams& glParams)
+bool ccPointCloud::updateVBOs(CC_DRAW_CONTEXT& context, const glDrawParams& glParams)
 {
 	if (isColorOverridden())
 	{
@@ -5117,12 +5597,24 @@ bool ccPointCloud::updateVBOs(const CC_DRAW_CONTEXT& context, const glDrawParams
 		{
 			return true;
 		}
+
+		//if only the colors have changed, they are updated asynchronously (as long as the VBOs layout remains the same)
+		if (	m_vboManager.updateFlags == vboSet::UPDATE_COLORS
+			&&	m_vboManager.hasColors
+			&&	m_vboManager.vbos.size() == ccChunk::Count(m_points)
+			&&	updateVBOColorsAsync(context, glParams))
+		{
+			return true;
+		}
 	}
 	else
 	{
 		m_vboManager.updateFlags = vboSet::UPDATE_ALL;
 	}
 
+	//the VBOs are going to be entirely updated
+	cancelVBOColorsUpdate();
+
 	size_t chunksCount = ccChunk::Count(m_points);
 	//allocate per-chunk descriptors if necessary
 	if (m_vboManager.vbos.size() != chunksCount)
@@ -5215,23 +5707,12 @@ bool ccPointCloud::updateVBOs(const CC_DRAW_CONTEXT& context, const glDrawParams
 				{
 					if (glParams.showSF)
 					{
-						//copy SF colors in static array
-						{
-							assert(m_vboManager.sourceSF);
-							ColorCompType* _sfColors = s_rgbBuffer4ub;
-							ScalarType* _sf = ccChunk::Start(*m_vboManager.sourceSF, chunkIndex);
-							for (int j = 0; j < chunkSize; j++, _sf++)
-							{
-								//we need to convert scalar value to color into a temporary structure
-								const ccColor::Rgb* col = _sf ? m_vboManager.sourceSF->getColor(*_sf) : nullptr;
-								if (!col)
-									col = &ccColor::lightGreyRGB;
-								*_sfColors++ = col->r;
-								*_sfColors++ = col->g;
-								*_sfColors++ = col->b;
-								*_sfColors++ = ccColor::MAX;
-							}
-						}
+						//convert the SF values to colors in the static array (hidden values are displayed in light grey)
+						assert(m_vboManager.sourceSF);
+						m_vboManager.sourceSF->getColors(	ccChunk::Start(*m_vboManager.sourceSF, chunkIndex),
+															static_cast<unsigned>(chunkSize),
+															reinterpret_cast<ccColor::Rgba*>(s_rgbBuffer4ub),
+															ccColor::lightGrey);
 						//then send them in VRAM
 						m_vboManager.vbos[chunkIndex]->write(m_vboManager.vbos[chunkIndex]->rgbShift, s_rgbBuffer4ub, sizeof(ColorCompType) * chunkSize * 4);
 						//upadte 'modification' flag for current displayed SF
@@ -5321,14 +5802,162 @@ bool ccPointCloud::updateVBOs(const CC_DRAW_CONTEXT& context, const glDrawParams
 	return true;
 }
 
+//! Maximum number of chunks updated per frame during an asynchronous VBO colors update
+static const size_t s_maxVBOColorsChunksPerFrame = 8;
+
+bool ccPointCloud::updateVBOColorsAsync(CC_DRAW_CONTEXT& context, const glDrawParams& glParams)
+{
+	if (!glParams.showSF && !glParams.showColors)
+	{
+		//the VBOs layout changes
+		return false;
+	}
+
+	vboSet::ColorsUpdate& update = m_vboManager.colorsUpdate;
+
+	bool colorIsSF = glParams.showSF;
+	ccScalarField* sourceSF = (colorIsSF ? m_currentDisplayedScalarField : nullptr);
+	assert(!colorIsSF || sourceSF);
+	assert(colorIsSF || m_rgbaColors);
+
+	if (sourceSF && sourceSF->currentSize() < size())
+	{
+		//the scalar field is being resized
+		cancelVBOColorsUpdate();
+		return false;
+	}
+
+	//is the current update (if any) still valid?
+	if (	update.inProgress
+		&&	(	update.colorIsSF != colorIsSF
+			||	update.sourceSF != sourceSF
+			||	update.colorsVersion != m_displayDataVersions.colors
+			||	(sourceSF && sourceSF->getModificationCount() != update.sfModificationCount) ) )
+	{
+		//the chunks already updated are outdated
+		cancelVBOColorsUpdate();
+	}
+
+	if (!update.inProgress)
+	{
+		//start a new update
+		update.inProgress = true;
+		update.colorIsSF = colorIsSF;
+		update.sourceSF = sourceSF;
+		update.sfModificationCount = (sourceSF ? sourceSF->getModificationCount() : 0);
+		update.colorsVersion = m_displayDataVersions.colors;
+		update.nextChunk = 0;
+
+		if (sourceSF)
+		{
+			//the flag will be raised again (with the modification count) if the SF is modified in the meantime
+			sourceSF->setModificationFlag(false);
+		}
+	}
+
+	//the display parameters are read once per frame
+	ccScalarField::ColorConverter converter;
+	if (sourceSF)
+	{
+		converter = sourceSF->getColorConverter(ccColor::lightGrey); //hidden values are displayed in light grey
+	}
+
+	//update a limited number of chunks per frame, in the back color regions (the front ones are displayed until all of them are ready)
+	size_t chunksCount = m_vboManager.vbos.size();
+	size_t updatedChunks = 0;
+	while (update.nextChunk < chunksCount && updatedChunks < s_maxVBOColorsChunksPerFrame)
+	{
+		size_t chunkIndex = update.nextChunk++;
+		VBO* vbo = m_vboManager.vbos[chunkIndex];
+		if (!vbo)
+		{
+			//this chunk couldn't be loaded in a VBO
+			continue;
+		}
+
+		int chunkSize = static_cast<int>(ccChunk::Size(chunkIndex, m_points));
+		const void* colors = nullptr;
+		if (sourceSF)
+		{
+			//convert the SF values of this chunk to colors in the static array
+			converter.convert(ccChunk::Start(*sourceSF, chunkIndex), static_cast<unsigned>(chunkSize), reinterpret_cast<ccColor::Rgba*>(s_rgbBuffer4ub));
+			colors = s_rgbBuffer4ub;
+		}
+		else
+		{
+			//the RGB colors can be uploaded directly
+			colors = ccChunk::Start(*m_rgbaColors, chunkIndex);
+		}
+
+		if (!vbo->bind())
+		{
+			//we'll try the synchronous update
+			cancelVBOColorsUpdate();
+			return false;
+		}
+		vbo->write(vbo->rgbBackShift, colors, sizeof(ColorCompType) * chunkSize * 4);
+		vbo->release();
+
+		++updatedChunks;
+	}
+
+	//if an error is detected
+	QOpenGLFunctions_2_1* glFunc = context.glFunctions<QOpenGLFunctions_2_1>();
+	assert(glFunc != nullptr);
+	if (glFunc && CatchGLErrors(glFunc->glGetError(), "ccPointCloud::updateVBOColorsAsync"))
+	{
+		//we'll try the synchronous update
+		cancelVBOColorsUpdate();
+		return false;
+	}
+
+	if (update.nextChunk < chunksCount)
+	{
+		//more chunks to update
+		context.pendingVBOUpdates = true;
+		return true;
+	}
+
+	//all the chunks have been updated: the back color regions are now displayed
+	for (VBO* vbo : m_vboManager.vbos)
+	{
+		if (vbo)
+		{
+			vbo->swapColorRegions();
+		}
+	}
+	m_vboManager.hasColors = true;
+	m_vboManager.colorIsSF = colorIsSF;
+	m_vboManager.sourceSF = sourceSF;
+	m_vboManager.updateFlags &= (~vboSet::UPDATE_COLORS);
+
+	update.inProgress = false;
+	update.sourceSF = nullptr;
+	update.nextChunk = 0;
+
+	return true;
+}
+
+void ccPointCloud::cancelVBOColorsUpdate()
+{
+	//the back color regions are simply left as is (they will be entirely overwritten by the next update)
+	vboSet::ColorsUpdate& update = m_vboManager.colorsUpdate;
+	update.inProgress = false;
+	update.sourceSF = nullptr;
+	update.nextChunk = 0;
+}
+
 int ccPointCloud::VBO::init(int count, bool withColors, bool withNormals, bool* reallocated/*=nullptr*/)
 {
 	//required memory
 	int totalSizeBytes = sizeof(PointCoordinateType) * count * 3;
+	int colorRegions[2] { 0, 0 };
 	if (withColors)
 	{
-		rgbShift = totalSizeBytes;
-		totalSizeBytes += sizeof(ColorCompType) * count * 4;
+		//two color regions (see ccPointCloud::updateVBOColorsAsync)
+		colorRegions[0] = totalSizeBytes;
+		colorRegions[1] = colorRegions[0] + static_cast<int>(sizeof(ColorCompType)) * count * 4;
+		totalSizeBytes = colorRegions[1] + static_cast<int>(sizeof(ColorCompType)) * count * 4;
 	}
 	if (withNormals)
 	{
@@ -5355,6 +5984,7 @@ int ccPointCloud::VBO::init(int count, bool withColors, bool withNormals, bool*
 		return -1;
 	}
 
+	bool sameLayout = false;
 	if (totalSizeBytes != size())
 	{
 		allocate(totalSizeBytes);
@@ -5371,7 +6001,15 @@ int ccPointCloud::VBO::init(int count, bool withColors, bool withNormals, bool*
 	}
 	else
 	{
-		//nothing to do
+		//the content is kept
+		sameLayout = true;
+	}
+
+	//the displayed color region is kept if the content is kept (it may be the second one)
+	if (!sameLayout || rgbShift != colorRegions[1] || rgbBackShift != colorRegions[0])
+	{
+		rgbShift = colorRegions[0];
+		rgbBackShift = colorRegions[1];
 	}
 
 	release();
@@ -5386,6 +6024,13 @@ size_t ccPointCloud::vboSize() const
 
 void ccPointCloud::releaseVBOs()
 {
+	//the other entities displaying the cloud data should update their own VBOs as well
+	++m_displayDataVersions.points;
+	++m_displayDataVersions.colors;
+	++m_displayDataVersions.normals;
+
+	cancelVBOColorsUpdate();
+
 	if (m_vboManager.state == vboSet::NEW)
 		return;
 
@@ -6032,6 +6677,16 @@ void ccPointCloud::clearLOD()
 	}
 }
 
+void ccPointCloud::SetLODFileStorage(bool state)
+{
+	s_lodFileStorage = state;
+}
+
+bool ccPointCloud::LODFileStorage()
+{
+	return s_lodFileStorage;
+}
+
 void ccPointCloud::clearFWFData()
 {
 	m_fwfWaveforms.resize(0);
@@ -6107,6 +6762,10 @@ bool ccPointCloud::enhanceRGBWithIntensitySF(int sfIdx, bool useCustomIntensityR
 		assert(false);
 		return false;
 	}
+	if (!detachColors())
+	{
+		return false;
+	}
 
 	//apply Broovey transform to each point (color)
 	if (!useCustomIntensityRange)
@@ -6364,11 +7023,15 @@ bool ccPointCloud::exportCoordToSF(bool exportDims[3])
 			return false;
 		}
 
-		for (unsigned k = 0; k < ptsCount; ++k)
+		//single pass over the points (no intermediate column)
+		const CCVector3* points = m_points.data();
+		ParallelForBlocks(ptsCount, [&](unsigned first, unsigned last)
 		{
-			ScalarType s = static_cast<ScalarType>(getPoint(k)->u[d]);
-			sf->setValue(k, s);
-		}
+			for (unsigned k = first; k < last; ++k)
+			{
+				sf->setValue(k, static_cast<ScalarType>(points[k].u[d]));
+			}
+		});
 		sf->computeMinAndMax();
 
 		setCurrentDisplayedScalarField(sfIndex);
@@ -6378,6 +7041,67 @@ bool ccPointCloud::exportCoordToSF(bool exportDims[3])
 	return true;
 }
 
+const PointCoordinateType* ccPointCloud::getCoordinateColumn(unsigned char dim) const
+{
+	if (dim > 2)
+	{
+		assert(false);
+		return nullptr;
+	}
+
+	unsigned count = size();
+	if (count == 0)
+	{
+		return nullptr;
+	}
+
+	CoordinateColumn& column = m_coordColumns[dim];
+	if (	column.valid
+		&&	column.pointsVersion == m_displayDataVersions.points
+		&&	column.values.size() == count)
+	{
+		//the cached column is still up to date
+		return column.values.data();
+	}
+
+	column.valid = false;
+	try
+	{
+		column.values.resize(count);
+	}
+	catch (const std::bad_alloc&)
+	{
+		column.values.clear();
+		column.values.shrink_to_fit();
+		return nullptr;
+	}
+
+	const CCVector3* points = m_points.data();
+	PointCoordinateType* values = column.values.data();
+	ParallelForBlocks(count, [&](unsigned first, unsigned last)
+	{
+		for (unsigned i = first; i < last; ++i)
+		{
+			values[i] = points[i].u[dim];
+		}
+	});
+
+	column.pointsVersion = m_displayDataVersions.points;
+	column.valid = true;
+
+	return values;
+}
+
+void ccPointCloud::releaseCoordinateColumns() const
+{
+	for (CoordinateColumn& column : m_coordColumns)
+	{
+		column.values.clear();
+		column.values.shrink_to_fit();
+		column.valid = false;
+	}
+}
+
 bool ccPointCloud::exportNormalToSF(bool exportDims[3])
 {
 	if (!exportDims[0] && !exportDims[1] && !exportDims[2])
@@ -15,16 +15,52 @@
 //#                                                                        #
 //##########################################################################
 
+#ifdef CC_CORE_LIB_USES_TBB
+#include <tbb/parallel_for.h>
+#endif
+
 #include "ccPointCloudLOD.h"
 
 //Local
+#include "ccChunk.h"
+#include "ccGLMatrix.h"
 #include "ccPointCloud.h"
+#include "ccSerializableObject.h"
 
 //Qt
 #include <QAtomicInt>
 #include <QElapsedTimer>
+#include <QFile>
 #include <QThread>
 
+//system
+#include <algorithm>
+#include <future>
+
+#if defined(_OPENMP)
+//OpenMP
+#include <omp.h>
+#endif
+
+//! Calls func(i) for i in [0, count[ (in parallel)
+template <typename Func> static void ParallelFor(int count, const Func& func)
+{
+#ifdef CC_CORE_LIB_USES_TBB
+	tbb::parallel_for(0, count, [&](int i)
+#else
+#if defined(_OPENMP)
+	#pragma omp parallel for num_threads(omp_get_max_threads())
+#endif
+	for (int i = 0; i < count; ++i)
+#endif
+	{
+		func(i);
+	}
+#ifdef CC_CORE_LIB_USES_TBB
+	);
+#endif
+}
+
 //! Thread for background computation
 class ccPointCloudLODThread : public QThread
 {
@@ -130,6 +166,105 @@ protected:
 		return static_cast<uint8_t>(currentTruncatedCellCode & 7);
 	}
 
+	//! Returns the number of children of a node (i.e. the number of non empty sub-cells)
+	uint32_t countChildren(const ccPointCloudLOD::Node& node) const
+	{
+		assert(m_octree);
+
+		const ccOctree::cellsContainer& cellCodes = m_octree->pointsAndTheirCellCodes();
+		const unsigned char bitDec = CCCoreLib::DgmOctree::GET_BIT_SHIFT(node.level + 1);
+
+		uint32_t childCount = 0;
+		CCCoreLib::DgmOctree::CellCode previousTruncatedCellCode = 0;
+		for (uint32_t i = 0; i < node.pointCount; ++i)
+		{
+			CCCoreLib::DgmOctree::CellCode truncatedCellCode = (cellCodes[node.firstCodeIndex + i].theCode >> bitDec);
+			if (i == 0 || truncatedCellCode != previousTruncatedCellCode)
+			{
+				++childCount;
+				previousTruncatedCellCode = truncatedCellCode;
+			}
+		}
+
+		return childCount;
+	}
+
+	//! Subdivides the leaf cells of a given level that have more than a given number of points
+	/** The cells are processed in parallel: the children of each cell are counted first,
+		so that they can be stored in the next level in the same order as a sequential
+		subdivision, then they are filled.
+		\return false if there's not enough memory
+	**/
+	bool subdivideLevel(uint8_t currentLevel, uint32_t maxCountPerCell)
+	{
+		ccPointCloudLOD::Level& level = m_lod.m_levels[currentLevel];
+		ccPointCloudLOD::Level& nextLevel = m_lod.m_levels[currentLevel + 1];
+		const int cellCount = static_cast<int>(level.data.size());
+
+		//index of the first child of each cell (in the next level)
+		std::vector<uint32_t> firstChildIndexes;
+		try
+		{
+			firstChildIndexes.resize(level.data.size() + 1, 0);
+		}
+		catch (const std::bad_alloc&)
+		{
+			return false;
+		}
+
+		//count the children
+		ParallelFor(cellCount, [&](int i)
+		{
+			const ccPointCloudLOD::Node& node = level.data[i];
+			//do we need to subdivide this cell?
+			if (node.childCount == 0 && node.pointCount > maxCountPerCell)
+			{
+				firstChildIndexes[i + 1] = countChildren(node);
+			}
+		});
+
+		firstChildIndexes[0] = static_cast<uint32_t>(nextLevel.data.size());
+		for (int i = 0; i < cellCount; ++i)
+		{
+			firstChildIndexes[i + 1] += firstChildIndexes[i];
+		}
+
+		//reserve the children cells
+		try
+		{
+			nextLevel.data.resize(firstChildIndexes.back(), ccPointCloudLOD::Node(static_cast<uint8_t>(currentLevel + 1)));
+		}
+		catch (const std::bad_alloc&)
+		{
+			return false;
+		}
+
+		//fill the children cells
+		ParallelFor(cellCount, [&](int i)
+		{
+			ccPointCloudLOD::Node& node = level.data[i];
+			uint32_t codeIndex = 0;
+			for (uint32_t childNodeIndex = firstChildIndexes[i]; childNodeIndex < firstChildIndexes[i + 1]; ++childNodeIndex)
+			{
+				ccPointCloudLOD::Node& childNode = nextLevel.data[childNodeIndex];
+				childNode.firstCodeIndex = node.firstCodeIndex + codeIndex;
+
+				uint8_t childIndex = fillNode_flat(childNode);
+				if (m_earlyStop)
+				{
+					// abort requested
+					return;
+				}
+
+				node.childIndexes[childIndex] = static_cast<int32_t>(childNodeIndex);
+				node.childCount++;
+				codeIndex += childNode.pointCount;
+			}
+		});
+
+		return true;
+	}
+
 	//! Called by run() before quiting (in case the process has to be aborted)
 	void abortConstruction()
 	{
@@ -246,30 +381,18 @@ protected:
 			//now we can prepare the next level
 			if (currentLevel + 1 < m_maxLevel)
 			{
-				for (ccPointCloudLOD::Node& node : level.data)
+				if (!subdivideLevel(currentLevel, m_maxCountPerCell))
 				{
-					//do we need to subdivide this cell?
-					if (node.pointCount > m_maxCountPerCell)
-					{
-						for (uint32_t i = 0; i < node.pointCount;)
-						{
-							int32_t childNodeIndex = m_lod.newCell(node.level + 1);
-							ccPointCloudLOD::Node& childNode = m_lod.node(childNodeIndex, node.level + 1);
-							childNode.firstCodeIndex = node.firstCodeIndex + i;
-
-							uint8_t childIndex = fillNode_flat(childNode);
-							if (m_earlyStop)
-							{
-								// abort requested
-								abortConstruction();
-								return;
-							}
-
-							node.childIndexes[childIndex] = childNodeIndex;
-							node.childCount++;
-							i += childNode.pointCount;
-						}
-					}
+					//not enough memory
+					ccLog::Warning(QString("[LoD] Failed to compute LOD structure on cloud '%1' (not enough memory)").arg(m_cloud.getName()));
+					m_earlyStop = 1;
+				}
+
+				if (m_earlyStop)
+				{
+					// abort requested
+					abortConstruction();
+					return;
 				}
 			}
 		}
@@ -301,34 +424,14 @@ protected:
 			biggestLevel = std::min<uint8_t>(biggestLevel, 10);
 			for (uint8_t currentLevel = 0; currentLevel < biggestLevel; ++currentLevel)
 			{
-				ccPointCloudLOD::Level& level = m_lod.m_levels[currentLevel];
-				assert(!level.data.empty());
+				assert(!m_lod.m_levels[currentLevel].data.empty());
 
 				size_t cellCountBefore = m_lod.m_levels[currentLevel + 1].data.size();
-				for (ccPointCloudLOD::Node& node : level.data)
+				if (!subdivideLevel(currentLevel, 16))
 				{
-					//do we need to subdivide this cell?
-					if (node.childCount == 0 && node.pointCount > 16)
-					{
-						for (uint32_t i = 0; i < node.pointCount;)
-						{
-							int32_t childNodeIndex = m_lod.newCell(node.level + 1);
-							ccPointCloudLOD::Node& childNode = m_lod.node(childNodeIndex, node.level + 1);
-							childNode.firstCodeIndex = node.firstCodeIndex + i;
-
-							uint8_t childIndex = fillNode_flat(childNode);
-							if (m_earlyStop)
-							{
-								// abort requested
-								abortConstruction();
-								return;
-							}
-
-							node.childIndexes[childIndex] = childNodeIndex;
-							node.childCount++;
-							i += childNode.pointCount;
-						}
-					}
+					//not enough memory
+					ccLog::Warning(QString("[LoD] Failed to compute LOD structure on cloud '%1' (not enough memory)").arg(m_cloud.getName()));
+					m_earlyStop = 1;
 				}
 
 				size_t cellCountAfter = m_lod.m_levels[currentLevel + 1].data.size();
@@ -367,7 +470,7 @@ protected:
 
 ccPointCloudLOD::ccPointCloudLOD()
 	: m_indexMap(0)
-	, m_lastIndexMap(0)
+	, m_nextIndexMap(0)
 	, m_octree(nullptr)
 	, m_thread(nullptr)
 	, m_state(NOT_INITIALIZED)
@@ -392,7 +495,9 @@ size_t ccPointCloudLOD::memory() const
 	size_t nodeSize = sizeof(Node);
 	size_t nodesSize = totalNodeCount * nodeSize;
 
-	return nodesSize + thisSize;
+	size_t indexesSize = m_pointIndexes.capacity() * sizeof(unsigned);
+
+	return nodesSize + indexesSize + thisSize;
 }
 
 bool ccPointCloudLOD::init(ccPointCloud* cloud)
@@ -431,6 +536,8 @@ void ccPointCloudLOD::clearData()
 	m_levels.front().data.front() = Node();
 
 	m_octree.clear();
+	m_pointIndexes.clear();
+	m_pointIndexes.shrink_to_fit();
 }
 
 bool ccPointCloudLOD::initInternal(ccOctree::Shared octree)
@@ -461,18 +568,6 @@ bool ccPointCloudLOD::initInternal(ccOctree::Shared octree)
 	return true;
 }
 
-int32_t ccPointCloudLOD::newCell(unsigned char level)
-{
-	assert(level != 0);
-	assert(level < m_levels.size());
-	Level& l = m_levels[level];
-
-	//assert(l.data.size() < l.data.capacity());
-	l.data.emplace_back(level);
-
-	return static_cast<int32_t>(l.data.size()) - 1;
-}
-
 void ccPointCloudLOD::shrink_to_fit()
 {
 	QMutexLocker locker(&m_mutex);
@@ -499,6 +594,9 @@ void ccPointCloudLOD::clear()
 	{
 		m_thread->stop();
 	}
+
+	waitForNextIndexMap();
+	m_nextIndexMapParams.ready = false;
 	
 	m_mutex.lock();
 
@@ -510,6 +608,8 @@ void ccPointCloudLOD::clear()
 
 	m_levels.clear();
 	m_octree.clear();
+	m_pointIndexes.clear();
+	m_pointIndexes.shrink_to_fit();
 	m_state = NOT_INITIALIZED;
 
 	m_mutex.unlock();
@@ -526,105 +626,144 @@ void ccPointCloudLOD::resetVisibility()
 
 	for (Level& level : m_levels)
 	{
-		for (Node& n : level.data)
+		ParallelFor(static_cast<int>(level.data.size()), [&](int i)
 		{
+			Node& n = level.data[i];
 			n.displayedPointCount = 0;
 			n.intersection = Frustum::INSIDE;
-		}
+		});
 	}
 }
 
-class PointCloudLODVisibilityFlagger
+//! Tests the visibility of a cell
+static uint8_t TestCellVisibility(const ccPointCloudLOD::Node& node, const Frustum& frustum, const ccClipPlaneSet* clipPlanes)
 {
-public:
-	
-	PointCloudLODVisibilityFlagger(	ccPointCloudLOD& lod,
-									const Frustum& frustum,
-									unsigned char maxLevel)
-		: m_lod(lod)
-		, m_frustum(frustum)
-		, m_maxLevel(maxLevel)
-		, m_hasClipPlanes(false)
-	{}
-
-	void setClipPlanes(const ccClipPlaneSet& clipPlanes)
+	uint8_t intersection = frustum.sphereInFrustum(node.center, node.radius);
+	if (clipPlanes && intersection != Frustum::OUTSIDE)
 	{
-		try
+		for (const ccClipPlane& clipPlane : *clipPlanes)
 		{
-			m_clipPlanes = clipPlanes;
-		}
-		catch (const std::bad_alloc&)
-		{
-			//not enough memory
-			m_hasClipPlanes = false;
+			//distance from center to clip plane
+			//we assume the plane normal (= 3 first coefficients) is normalized!
+			double dist = clipPlane.equation.x * node.center.x
+						+ clipPlane.equation.y * node.center.y
+						+ clipPlane.equation.z * node.center.z
+						+ clipPlane.equation.w /* / CCVector3d::vnorm(clipPlane.equation.u) */;
+
+			if (dist < node.radius)
+			{
+				if (dist <= -node.radius)
+				{
+					intersection = Frustum::OUTSIDE;
+					break;
+				}
+				else
+				{
+					intersection = Frustum::INTERSECT;
+				}
+			}
 		}
-		m_hasClipPlanes = !m_clipPlanes.empty();
 	}
 
-	void propagateFlag(ccPointCloudLOD::Node& node, uint8_t flag)
+	return intersection;
+}
+
+uint32_t ccPointCloudLOD::flagVisibility(const Frustum& frustum, ccClipPlaneSet* clipPlanes/*=nullptr*/)
+{
+	//the index map prepared in the background (if any) is deprecated
+	waitForNextIndexMap();
+	m_nextIndexMapParams.ready = false;
+
+	if (m_state != INITIALIZED)
+	{
+		assert(false);
+		m_currentState = RenderParams();
+		return 0;
+	}
+
+	resetVisibility();
+
+	if (clipPlanes && clipPlanes->empty())
 	{
-		node.intersection = flag;
+		clipPlanes = nullptr;
+	}
 
-		if (node.childCount)
+	//number of visible points per cell
+	try
+	{
+		for (Level& level : m_levels)
 		{
-			for (int i = 0; i < 8; ++i)
-			{
-				if (node.childIndexes[i] >= 0)
-				{
-					propagateFlag(m_lod.node(node.childIndexes[i], node.level + 1), flag);
-				}
-			}
+			level.visibleCounts.resize(level.data.size());
 		}
 	}
+	catch (const std::bad_alloc&)
+	{
+		//not enough memory: all the points will be considered as visible
+		ccLog::Warning("[LoD] Not enough memory to test the cells visibility");
+		m_currentState.visiblePoints = root().pointCount;
+		return m_currentState.visiblePoints;
+	}
 
-	uint32_t flag(ccPointCloudLOD::Node& node)
+	//the levels are processed top-down (the cells of each level are tested in parallel)
+	root().intersection = TestCellVisibility(root(), frustum, clipPlanes);
+	for (size_t levelIndex = 0; levelIndex + 1 < m_levels.size(); ++levelIndex)
 	{
-		node.intersection = m_frustum.sphereInFrustum(node.center, node.radius);
-		if (m_hasClipPlanes && node.intersection != Frustum::OUTSIDE)
+		Level& level = m_levels[levelIndex];
+		std::vector<Node>& children = m_levels[levelIndex + 1].data;
+
+		ParallelFor(static_cast<int>(level.data.size()), [&](int i)
 		{
-			for (const ccClipPlane& clipPlane : m_clipPlanes)
+			const Node& node = level.data[i];
+			if (node.childCount == 0 || node.intersection == Frustum::INSIDE)
 			{
-				//distance from center to clip plane
-				//we assume the plane normal (= 3 first coefficients) is normalized!
-				double dist = clipPlane.equation.x * node.center.x
-							+ clipPlane.equation.y * node.center.y
-							+ clipPlane.equation.z * node.center.z
-							+ clipPlane.equation.w /* / CCVector3d::vnorm(clipPlane.equation.u) */;
+				//no need to propagate the visibility to the children as the default value should already be 'INSIDE'
+				return;
+			}
 
-				if (dist < node.radius)
+			for (int32_t childIndex : node.childIndexes)
+			{
+				if (childIndex >= 0)
 				{
-					if (dist <= -node.radius)
+					Node& childNode = children[childIndex];
+					if (node.intersection == Frustum::OUTSIDE)
 					{
-						node.intersection = Frustum::OUTSIDE;
-						break;
+						//be sure that all children nodes are flagged as outside!
+						childNode.intersection = Frustum::OUTSIDE;
 					}
-					else
+					else //INTERSECT: we have to test the children
 					{
-						node.intersection = Frustum::INTERSECT;
+						childNode.intersection = TestCellVisibility(childNode, frustum, clipPlanes);
 					}
 				}
 			}
-		}
+		});
+	}
 
-		uint32_t visibleCount = 0;
-		switch (node.intersection)
+	//then the number of visible points are computed bottom-up
+	for (size_t levelIndex = m_levels.size(); levelIndex-- != 0; )
+	{
+		Level& level = m_levels[levelIndex];
+		const Level* childLevel = (levelIndex + 1 < m_levels.size() ? &m_levels[levelIndex + 1] : nullptr);
+
+		ParallelFor(static_cast<int>(level.data.size()), [&](int i)
 		{
-		case Frustum::INSIDE:
-			visibleCount = node.pointCount;
-			//no need to propagate the visibility to the children as the default value should already be 'INSIDE'
-			break;
+			Node& node = level.data[i];
 
-		case Frustum::INTERSECT:
-			//we have to test the children
+			uint32_t visibleCount = 0;
+			switch (node.intersection)
 			{
-				if (node.level < m_maxLevel && node.childCount)
+			case Frustum::INSIDE:
+				visibleCount = node.pointCount;
+				break;
+
+			case Frustum::INTERSECT:
+				if (childLevel && node.childCount)
 				{
-					for (int i = 0; i < 8; ++i)
+					for (int32_t childIndex : node.childIndexes)
 					{
-						if (node.childIndexes[i] >= 0)
+						if (childIndex >= 0)
 						{
-							ccPointCloudLOD::Node& childNode = m_lod.node(node.childIndexes[i], node.level + 1);
-							visibleCount += flag(childNode);
+							visibleCount += childLevel->visibleCounts[childIndex];
 						}
 					}
 
@@ -639,50 +778,24 @@ public:
 					//we have to consider that all points are visible
 					visibleCount = node.pointCount;
 				}
-			}
-			break;
-
-		case Frustum::OUTSIDE:
-			//be sure that all children nodes are flagged as outside!
-			propagateFlag(node, Frustum::OUTSIDE);
-			break;
-		}
-
-		return visibleCount;
-	}
-
-	ccPointCloudLOD& m_lod;
-	const Frustum& m_frustum;
-	unsigned char m_maxLevel;
-	ccClipPlaneSet m_clipPlanes;
-	bool m_hasClipPlanes;
-};
-
-uint32_t ccPointCloudLOD::flagVisibility(const Frustum& frustum, ccClipPlaneSet* clipPlanes/*=nullptr*/)
-{
-	if (m_state != INITIALIZED)
-	{
-		assert(false);
-		m_currentState = RenderParams();
-		return 0;
-	}
+				break;
 
-	resetVisibility();
+			case Frustum::OUTSIDE:
+				break;
+			}
 
-	PointCloudLODVisibilityFlagger lodVisibility(*this, frustum, static_cast<unsigned char>(m_levels.size()));
-	if (clipPlanes)
-	{
-		lodVisibility.setClipPlanes(*clipPlanes);
+			level.visibleCounts[i] = visibleCount;
+		});
 	}
 
-	m_currentState.visiblePoints = lodVisibility.flag(root());
+	m_currentState.visiblePoints = m_levels.front().visibleCounts.front();
 
 	return m_currentState.visiblePoints;
 }
 
-uint32_t ccPointCloudLOD::addNPointsToIndexMap(Node& node, uint32_t count)
+uint32_t ccPointCloudLOD::addNPointsToIndexMap(Node& node, uint32_t count, unsigned* indexes)
 {
-	if (m_indexMap.capacity() == 0 || m_octree.isNull())
+	if (!hasPointIndexes())
 	{
 		assert(false);
 		return 0;
@@ -724,7 +837,7 @@ uint32_t ccPointCloudLOD::addNPointsToIndexMap(Node& node, uint32_t count)
 					}
 				}
 				
-				uint32_t childDisplayedCount = addNPointsToIndexMap(childNode, childMaxCount);
+				uint32_t childDisplayedCount = addNPointsToIndexMap(childNode, childMaxCount, indexes + displayedCount);
 				//assert(childDisplayedCount == childMaxCount || !displayAll || childNode.intersection != Frustum::INSIDE);
 				assert(childDisplayedCount <= childMaxCount);
 
@@ -740,13 +853,20 @@ uint32_t ccPointCloudLOD::addNPointsToIndexMap(Node& node, uint32_t count)
 		uint32_t iStop = std::min(node.displayedPointCount + count, node.pointCount);
 
 		displayedCount = iStop - node.displayedPointCount;
-		assert(m_indexMap.size() + displayedCount <= m_indexMap.capacity());
 
-		const ccOctree::cellsContainer& cellCodes = m_octree->pointsAndTheirCellCodes();
-		for (uint32_t i = node.displayedPointCount; i < iStop; ++i)
+		if (m_octree)
+		{
+			const ccOctree::cellsContainer& cellCodes = m_octree->pointsAndTheirCellCodes();
+			for (uint32_t i = node.displayedPointCount; i < iStop; ++i)
+			{
+				*indexes++ = cellCodes[node.firstCodeIndex + i].theIndex;
+			}
+		}
+		else
 		{
-			unsigned pointIndex = cellCodes[node.firstCodeIndex + i].theIndex;
-			m_indexMap.push_back(pointIndex);
+			std::copy(	m_pointIndexes.begin() + node.firstCodeIndex + node.displayedPointCount,
+						m_pointIndexes.begin() + node.firstCodeIndex + iStop,
+						indexes);
 		}
 	}
 
@@ -755,57 +875,112 @@ uint32_t ccPointCloudLOD::addNPointsToIndexMap(Node& node, uint32_t count)
 	return displayedCount;
 }
 
-LODIndexSet& ccPointCloudLOD::getIndexMap(unsigned char level, unsigned& maxCount, unsigned& remainingPointsAtThisLevel)
+uint32_t ccPointCloudLOD::fillIndexMap(unsigned char level, LODIndexSet& indexMap)
+{
+	Level& l = m_levels[level];
+
+	//each cell has its own segment in the index map
+	size_t startIndex = indexMap.size();
+	uint32_t plannedCount = 0;
+	for (CellQuota& quota : m_cellQuotas)
+	{
+		quota.offset = plannedCount;
+		plannedCount += quota.maxCount;
+	}
+	//DGM: the segments of the cells partially inside the frustum may be larger than needed
+	try
+	{
+		indexMap.resize(startIndex + plannedCount);
+	}
+	catch (const std::bad_alloc&)
+	{
+		//not enough memory
+		indexMap.resize(startIndex);
+		return 0;
+	}
+
+	//the cells are processed in parallel (their sub-trees are disjoint)
+	ParallelFor(static_cast<int>(m_cellQuotas.size()), [&](int i)
+	{
+		CellQuota& quota = m_cellQuotas[i];
+		quota.displayedCount = (quota.maxCount != 0 ? addNPointsToIndexMap(l.data[quota.cellIndex], quota.maxCount, indexMap.data() + startIndex + quota.offset) : 0);
+	});
+
+	//eventually, we remove the gaps between the segments
+	size_t currentIndex = startIndex;
+	for (const CellQuota& quota : m_cellQuotas)
+	{
+		if (quota.displayedCount != 0 && currentIndex != startIndex + quota.offset)
+		{
+			std::copy(	indexMap.begin() + startIndex + quota.offset,
+						indexMap.begin() + startIndex + quota.offset + quota.displayedCount,
+						indexMap.begin() + currentIndex);
+		}
+		currentIndex += quota.displayedCount;
+	}
+	indexMap.resize(currentIndex);
+
+	return static_cast<uint32_t>(currentIndex - startIndex);
+}
+
+void ccPointCloudLOD::computeIndexMap(unsigned char level, unsigned& maxCount, unsigned& remainingPointsAtThisLevel, LODIndexSet& indexMap, RenderParams& state)
 {
 	remainingPointsAtThisLevel = 0;
-	m_lastIndexMap.clear();
+	indexMap.clear();
 
-	if (m_octree.isNull() || level >= m_levels.size())
+	if (!hasPointIndexes() || level >= m_levels.size())
 	{
 		assert(false);
 		maxCount = 0;
-		return m_lastIndexMap; //empty
+		return; //empty
 	}
 
 	if (m_state != INITIALIZED)
 	{
 		maxCount = 0;
-		return m_lastIndexMap; //empty
+		return; //empty
 	}
 
-	if (m_currentState.displayedPoints >= m_currentState.visiblePoints)
+	if (state.displayedPoints >= state.visiblePoints)
 	{
 		//assert(false);
 		maxCount = 0;
-		return m_lastIndexMap; //empty
+		return; //empty
 	}
 
-	m_indexMap.clear();
 	try
 	{
-		m_indexMap.reserve(maxCount);
+		indexMap.reserve(maxCount);
+		m_cellQuotas.reserve(m_levels[level].data.size());
 	}
 	catch (const std::bad_alloc&)
 	{
 		//not enough memory
-		return m_lastIndexMap; //empty
+		maxCount = 0;
+		return; //empty
 	}
 
 	Level& l = m_levels[level];
 	uint32_t thisPassDisplayCount = 0;
 
+	//the number of points to display for each cell is determined first (sequentially),
+	//then the index map is filled in parallel (see fillIndexMap)
+	uint32_t plannedCount = 0;
+
 	bool earlyStop = false;
 	size_t earlyStopIndex = 0;
 
 	//special case: we have to finish/continue at the same level than the previous run
-	if (m_currentState.unfinishedLevel == level)
+	if (state.unfinishedLevel == level)
 	{
-		bool displayAll = (m_currentState.unfinishedPoints <= maxCount);
+		bool displayAll = (state.unfinishedPoints <= maxCount);
 
 		//display all leaf cells of the current level
+		m_cellQuotas.clear();
 		for (size_t i = 0; i < l.data.size(); ++i)
 		{
-			Node& node = l.data[i];
+			const size_t cellIndex = i;
+			const Node& node = l.data[i];
 
 			if (node.childCount) //skip non leaf cells
 				continue;
@@ -823,13 +998,13 @@ LODIndexSet& ccPointCloudLOD::getIndexMap(unsigned char level, unsigned& maxCoun
 			}
 			else
 			{
-				double ratio = static_cast<double>(nodeRemainingCount) / m_currentState.unfinishedPoints;
+				double ratio = static_cast<double>(nodeRemainingCount) / state.unfinishedPoints;
 				nodeMaxCount = static_cast<uint32_t>(ceil(ratio * maxCount));
 				//safety check
-				if (m_indexMap.size() + nodeMaxCount >= maxCount)
+				if (plannedCount + nodeMaxCount >= maxCount)
 				{
-					assert(maxCount >= m_indexMap.size());
-					nodeMaxCount = maxCount - static_cast<uint32_t>(m_indexMap.size());
+					assert(maxCount >= plannedCount);
+					nodeMaxCount = maxCount - plannedCount;
 
 					earlyStop = true;
 					earlyStopIndex = i;
@@ -838,16 +1013,21 @@ LODIndexSet& ccPointCloudLOD::getIndexMap(unsigned char level, unsigned& maxCoun
 				}
 			}
 
-			uint32_t nodeDisplayCount = addNPointsToIndexMap(node, nodeMaxCount);
-			assert(nodeDisplayCount <= nodeMaxCount);
-			
-			thisPassDisplayCount += nodeDisplayCount;
-			assert(thisPassDisplayCount == m_indexMap.size());
+			m_cellQuotas.emplace_back(static_cast<uint32_t>(cellIndex), nodeMaxCount);
+			plannedCount += nodeMaxCount;
+		}
+
+		thisPassDisplayCount += fillIndexMap(level, indexMap);
+		assert(thisPassDisplayCount == indexMap.size());
+
+		for (const CellQuota& quota : m_cellQuotas)
+		{
+			const Node& node = l.data[quota.cellIndex];
 			remainingPointsAtThisLevel += (node.pointCount - node.displayedPointCount);
 		}
 	}
 	
-	uint32_t totalRemainingCount = m_currentState.visiblePoints - m_currentState.displayedPoints;
+	uint32_t totalRemainingCount = state.visiblePoints - state.displayedPoints;
 	//remove the already displayed points (= unfinished from previous run)
 	assert(totalRemainingCount >= thisPassDisplayCount);
 	totalRemainingCount -= thisPassDisplayCount;
@@ -859,13 +1039,16 @@ LODIndexSet& ccPointCloudLOD::getIndexMap(unsigned char level, unsigned& maxCoun
 		assert(!earlyStop && remainingPointsAtThisLevel == 0);
 
 		uint32_t mapFreeSize = maxCount - thisPassDisplayCount;
+		plannedCount = thisPassDisplayCount;
 
 		bool displayAll = (mapFreeSize > totalRemainingCount);
 
 		//for all cells of the input level
+		m_cellQuotas.clear();
 		for (size_t i = 0; i < l.data.size(); ++i)
 		{
-			Node& node = l.data[i];
+			const size_t cellIndex = i;
+			const Node& node = l.data[i];
 
 			assert(node.intersection != UNDEFINED);
 			if (node.intersection == Frustum::OUTSIDE)
@@ -884,10 +1067,10 @@ LODIndexSet& ccPointCloudLOD::getIndexMap(unsigned char level, unsigned& maxCoun
 				double ratio = static_cast<double>(nodeRemainingCount) / totalRemainingCount;
 				nodeMaxCount = static_cast<uint32_t>(ceil(ratio * mapFreeSize));
 				//safety check
-				if (m_indexMap.size() + nodeMaxCount >= maxCount)
+				if (plannedCount + nodeMaxCount >= maxCount)
 				{
-					assert(maxCount >= m_indexMap.size());
-					nodeMaxCount = maxCount - static_cast<uint32_t>(m_indexMap.size());
+					assert(maxCount >= plannedCount);
+					nodeMaxCount = maxCount - plannedCount;
 
 					earlyStop = true;
 					earlyStopIndex = i;
@@ -896,12 +1079,16 @@ LODIndexSet& ccPointCloudLOD::getIndexMap(unsigned char level, unsigned& maxCoun
 				}
 			}
 
-			uint32_t nodeDisplayCount = addNPointsToIndexMap(node, nodeMaxCount);
-			assert(nodeDisplayCount <= nodeMaxCount);
+			m_cellQuotas.emplace_back(static_cast<uint32_t>(cellIndex), nodeMaxCount);
+			plannedCount += nodeMaxCount;
+		}
 
-			thisPassDisplayCount += nodeDisplayCount;
-			assert(thisPassDisplayCount == m_indexMap.size());
+		thisPassDisplayCount += fillIndexMap(level, indexMap);
+		assert(thisPassDisplayCount == indexMap.size());
 
+		for (const CellQuota& quota : m_cellQuotas)
+		{
+			const Node& node = l.data[quota.cellIndex];
 			if (node.childCount == 0)
 			{
 				remainingPointsAtThisLevel += (node.pointCount - node.displayedPointCount);
@@ -909,15 +1096,15 @@ LODIndexSet& ccPointCloudLOD::getIndexMap(unsigned char level, unsigned& maxCoun
 		}
 	}
 
-	maxCount = static_cast<unsigned>(m_indexMap.size());
-	m_currentState.displayedPoints += static_cast<uint32_t>(m_indexMap.size());
+	maxCount = static_cast<unsigned>(indexMap.size());
+	state.displayedPoints += static_cast<uint32_t>(indexMap.size());
 
 	if (earlyStop)
 	{
 		//be sure to properly finish to count the number of 'unfinished' points!
 		for (size_t i = earlyStopIndex+1; i < l.data.size(); ++i)
 		{
-			Node& node = l.data[i];
+			const Node& node = l.data[i];
 
 			if (node.childCount) //skip non leaf nodes
 				continue;
@@ -933,17 +1120,501 @@ LODIndexSet& ccPointCloudLOD::getIndexMap(unsigned char level, unsigned& maxCoun
 
 	if (remainingPointsAtThisLevel)
 	{
-		m_currentState.unfinishedLevel = static_cast<int>(level);
-		m_currentState.unfinishedPoints = remainingPointsAtThisLevel;
+		state.unfinishedLevel = static_cast<int>(level);
+		state.unfinishedPoints = remainingPointsAtThisLevel;
 	}
 	else
 	{
-		m_currentState.unfinishedLevel = -1;
-		m_currentState.unfinishedPoints = 0;
+		state.unfinishedLevel = -1;
+		state.unfinishedPoints = 0;
 	}
-	
-	m_lastIndexMap = m_indexMap;
+}
+
+LODIndexSet& ccPointCloudLOD::getIndexMap(unsigned char level, unsigned& maxCount, unsigned& remainingPointsAtThisLevel)
+{
+	waitForNextIndexMap();
+
+	if (m_nextIndexMapParams.ready)
+	{
+		m_nextIndexMapParams.ready = false;
+
+		//the index map has already been prepared in the background (see prepareNextIndexMap)
+		//DGM: otherwise it is simply discarded, as the structure state hasn't been updated yet
+		if (m_nextIndexMapParams.level == level && m_nextIndexMapParams.maxCount == maxCount)
+		{
+			//we can now update the structure state
+			swapDisplayedPointCounts(m_nextIndexMapParams.displayedPointCounts);
+			m_currentState = m_nextIndexMapParams.state;
+
+			m_indexMap.swap(m_nextIndexMap);
+			maxCount = m_nextIndexMapParams.count;
+			remainingPointsAtThisLevel = m_nextIndexMapParams.remainingPointsAtThisLevel;
+			return m_indexMap;
+		}
+	}
+
+	computeIndexMap(level, maxCount, remainingPointsAtThisLevel, m_indexMap, m_currentState);
 	return m_indexMap;
 }
 
+void ccPointCloudLOD::prepareNextIndexMap(unsigned char level, unsigned maxCount)
+{
+	waitForNextIndexMap();
+	m_nextIndexMapParams.ready = false;
+
+	if (m_state != INITIALIZED || allDisplayed() || level >= m_levels.size())
+	{
+		//nothing to prepare
+		return;
+	}
+
+	//the cells state is saved so that it can be restored once the index map is prepared
+	//(the structure state is only updated when the index map is used, see getIndexMap)
+	try
+	{
+		saveDisplayedPointCounts(m_nextIndexMapParams.displayedPointCounts);
+	}
+	catch (const std::bad_alloc&)
+	{
+		//not enough memory: the index map will be computed by the next call to getIndexMap
+		return;
+	}
+	m_nextIndexMapParams.level = level;
+	m_nextIndexMapParams.maxCount = maxCount;
+	m_nextIndexMapParams.state = m_currentState;
+
+	try
+	{
+		m_nextIndexMapTask = std::async(std::launch::async, [this, level, maxCount]()
+		{
+			unsigned count = maxCount;
+			unsigned remainingPointsAtThisLevel = 0;
+			computeIndexMap(level, count, remainingPointsAtThisLevel, m_nextIndexMap, m_nextIndexMapParams.state);
+
+			//restore the cells state (and keep the updated one for later)
+			swapDisplayedPointCounts(m_nextIndexMapParams.displayedPointCounts);
+
+			m_nextIndexMapParams.count = count;
+			m_nextIndexMapParams.remainingPointsAtThisLevel = remainingPointsAtThisLevel;
+			m_nextIndexMapParams.ready = true;
+		});
+	}
+	catch (const std::system_error&)
+	{
+		//failed to launch the thread: the index map will be computed by the next call to getIndexMap
+	}
+}
+
+void ccPointCloudLOD::saveDisplayedPointCounts(std::vector<uint32_t>& counts) const
+{
+	size_t nodeCount = 0;
+	for (const Level& level : m_levels)
+	{
+		nodeCount += level.data.size();
+	}
+	counts.resize(nodeCount);
+
+	size_t offset = 0;
+	for (const Level& level : m_levels)
+	{
+		uint32_t* _counts = counts.data() + offset;
+		ParallelFor(static_cast<int>(level.data.size()), [&](int i)
+		{
+			_counts[i] = level.data[i].displayedPointCount;
+		});
+		offset += level.data.size();
+	}
+}
+
+void ccPointCloudLOD::swapDisplayedPointCounts(std::vector<uint32_t>& counts)
+{
+	size_t offset = 0;
+	for (Level& level : m_levels)
+	{
+		assert(offset + level.data.size() <= counts.size());
+		uint32_t* _counts = counts.data() + offset;
+		ParallelFor(static_cast<int>(level.data.size()), [&](int i)
+		{
+			std::swap(_counts[i], level.data[i].displayedPointCount);
+		});
+		offset += level.data.size();
+	}
+}
+
+void ccPointCloudLOD::waitForNextIndexMap()
+{
+	if (m_nextIndexMapTask.valid())
+	{
+		m_nextIndexMapTask.get();
+	}
+}
+
+LODIndexSet& ccPointCloudLOD::buildIndexMap(std::vector<SelectedCell>& cells)
+{
+	waitForNextIndexMap();
+	m_nextIndexMapParams.ready = false;
+
+	m_indexMap.clear();
+	m_currentState.unfinishedLevel = -1;
+	m_currentState.unfinishedPoints = 0;
+
+	if (!hasPointIndexes() || m_state != INITIALIZED || cells.empty())
+	{
+		return m_indexMap; //empty
+	}
+
+	//the parent cells must be processed before their children
+	std::stable_sort(cells.begin(), cells.end(), [](const SelectedCell& a, const SelectedCell& b) { return a.level < b.level; });
+
+	try
+	{
+		size_t totalCount = 0;
+		for (const SelectedCell& cell : cells)
+		{
+			totalCount += cell.count;
+		}
+		m_indexMap.reserve(totalCount);
+		m_cellQuotas.reserve(cells.size());
+	}
+	catch (const std::bad_alloc&)
+	{
+		//not enough memory
+		m_indexMap.clear();
+		return m_indexMap;
+	}
+
+	for (size_t first = 0; first < cells.size(); )
+	{
+		unsigned char level = cells[first].level;
+		const Level& l = m_levels[level];
+
+		//the number of points of a cell may have been overestimated
+		//(some of its points may have already been taken by its parent)
+		m_cellQuotas.clear();
+		for (; first < cells.size() && cells[first].level == level; ++first)
+		{
+			const SelectedCell& cell = cells[first];
+			const Node& node = l.data[cell.index];
+			if (node.intersection == Frustum::OUTSIDE)
+				continue;
+			uint32_t count = std::min(cell.count, node.pointCount - node.displayedPointCount);
+			if (count != 0)
+			{
+				m_cellQuotas.emplace_back(static_cast<uint32_t>(cell.index), count);
+			}
+		}
+
+		fillIndexMap(level, m_indexMap);
+	}
+
+	m_currentState.displayedPoints = static_cast<uint32_t>(m_indexMap.size());
+
+	return m_indexMap;
+}
+
+bool ccPointCloudLOD::detachFromOctree()
+{
+	if (!m_octree)
+	{
+		//nothing to do
+		return true;
+	}
+
+	const ccOctree::cellsContainer& cellCodes = m_octree->pointsAndTheirCellCodes();
+	try
+	{
+		m_pointIndexes.resize(cellCodes.size());
+	}
+	catch (const std::bad_alloc&)
+	{
+		//not enough memory
+		return false;
+	}
+
+	ParallelFor(static_cast<int>(cellCodes.size()), [&](int i)
+	{
+		m_pointIndexes[i] = cellCodes[i].theIndex;
+	});
+
+	//the structure doesn't depend on the octree anymore
+	if (m_thread)
+	{
+		QObject::disconnect(m_octree.data(), nullptr, m_thread, nullptr);
+	}
+	m_octree.clear();
+
+	return true;
+}
+
+bool ccPointCloudLOD::transform(const ccGLMatrix& trans)
+{
+	//the index map prepared in the background (if any) is kept, but we must wait for it
+	waitForNextIndexMap();
+
+	QMutexLocker locker(&m_mutex);
+
+	if (m_state != INITIALIZED)
+	{
+		return false;
+	}
+
+	//the octree is not valid anymore
+	if (!detachFromOctree())
+	{
+		return false;
+	}
+
+	//the cells radii are only affected by the scale (if any)
+	const float scale = std::max(	std::max(	trans.getColumnAsVec3D(0).norm(),
+												trans.getColumnAsVec3D(1).norm()),
+												trans.getColumnAsVec3D(2).norm());
+
+	for (Level& level : m_levels)
+	{
+		ParallelFor(static_cast<int>(level.data.size()), [&](int i)
+		{
+			Node& node = level.data[i];
+			node.center = trans * node.center;
+			node.radius *= scale;
+		});
+	}
+
+	return true;
+}
+
+//! Size of a node in BIN files (dataVersion>=58)
+/** pointCount (4 bytes) + radius (4 bytes) + center (12 bytes) + childIndexes (32 bytes) + firstCodeIndex (4 bytes) + childCount (1 byte)
+**/
+static const size_t c_nodeFileSize = 57;
+
+bool ccPointCloudLOD::toFile(QFile& out, short dataVersion) const
+{
+	assert(out.isOpen() && (out.openMode() & QIODevice::WriteOnly));
+	if (dataVersion < 58)
+	{
+		assert(false);
+		return false;
+	}
+
+	QMutexLocker locker(&m_mutex);
+
+	if (m_state != INITIALIZED || !hasPointIndexes())
+	{
+		assert(false);
+		return false;
+	}
+
+	//points indexes, sorted by cell (dataVersion>=58)
+	{
+		uint32_t indexCount = static_cast<uint32_t>(m_octree ? m_octree->pointsAndTheirCellCodes().size() : m_pointIndexes.size());
+		if (out.write((const char*)&indexCount, 4) < 0)
+			return ccSerializableObject::WriteError();
+
+		if (m_octree)
+		{
+			//we write the indexes by chunks
+			const ccOctree::cellsContainer& cellCodes = m_octree->pointsAndTheirCellCodes();
+			std::vector<uint32_t> buffer;
+			try
+			{
+				buffer.resize(std::min<size_t>(indexCount, ccChunk::SIZE));
+			}
+			catch (const std::bad_alloc&)
+			{
+				return ccSerializableObject::MemoryError();
+			}
+			for (uint32_t first = 0; first < indexCount; first += static_cast<uint32_t>(buffer.size()))
+			{
+				uint32_t count = std::min<uint32_t>(indexCount - first, static_cast<uint32_t>(buffer.size()));
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					buffer[i] = cellCodes[first + i].theIndex;
+				}
+				if (out.write((const char*)buffer.data(), sizeof(uint32_t) * count) < 0)
+					return ccSerializableObject::WriteError();
+			}
+		}
+		else if (indexCount != 0)
+		{
+			if (out.write((const char*)m_pointIndexes.data(), sizeof(uint32_t) * static_cast<qint64>(indexCount)) < 0)
+				return ccSerializableObject::WriteError();
+		}
+	}
+
+	//levels (dataVersion>=58)
+	{
+		uint8_t levelCount = static_cast<uint8_t>(m_levels.size());
+		if (out.write((const char*)&levelCount, 1) < 0)
+			return ccSerializableObject::WriteError();
+
+		std::vector<char> buffer;
+		for (const Level& level : m_levels)
+		{
+			uint32_t nodeCount = static_cast<uint32_t>(level.data.size());
+			if (out.write((const char*)&nodeCount, 4) < 0)
+				return ccSerializableObject::WriteError();
+
+			try
+			{
+				buffer.resize(nodeCount * c_nodeFileSize);
+			}
+			catch (const std::bad_alloc&)
+			{
+				return ccSerializableObject::MemoryError();
+			}
+
+			char* _buffer = buffer.data();
+			for (const Node& node : level.data)
+			{
+				memcpy(_buffer, &node.pointCount, 4);				_buffer += 4;
+				memcpy(_buffer, &node.radius, 4);					_buffer += 4;
+				memcpy(_buffer, node.center.u, 12);					_buffer += 12;
+				memcpy(_buffer, node.childIndexes.data(), 32);		_buffer += 32;
+				memcpy(_buffer, &node.firstCodeIndex, 4);			_buffer += 4;
+				memcpy(_buffer, &node.childCount, 1);				_buffer += 1;
+			}
+
+			if (out.write(buffer.data(), static_cast<qint64>(buffer.size())) < 0)
+				return ccSerializableObject::WriteError();
+		}
+	}
+
+	return true;
+}
+
+bool ccPointCloudLOD::fromFile(QFile& in, short dataVersion, unsigned pointCount)
+{
+	assert(in.isOpen() && (in.openMode() & QIODevice::ReadOnly));
+	if (dataVersion < 58)
+	{
+		assert(false);
+		return false;
+	}
+
+	//reset the structure
+	clear();
+
+	QMutexLocker locker(&m_mutex);
+
+	//points indexes, sorted by cell (dataVersion>=58)
+	{
+		uint32_t indexCount = 0;
+		if (in.read((char*)&indexCount, 4) < 0)
+			return ccSerializableObject::ReadError();
+		if (indexCount != pointCount)
+			return ccSerializableObject::CorruptError();
+
+		try
+		{
+			m_pointIndexes.resize(indexCount);
+		}
+		catch (const std::bad_alloc&)
+		{
+			return ccSerializableObject::MemoryError();
+		}
+		qint64 byteCount = static_cast<qint64>(sizeof(uint32_t)) * indexCount;
+		if (byteCount != 0 && in.read((char*)m_pointIndexes.data(), byteCount) != byteCount)
+			return ccSerializableObject::ReadError();
+
+		for (uint32_t index : m_pointIndexes)
+		{
+			if (index >= pointCount)
+				return ccSerializableObject::CorruptError();
+		}
+	}
+
+	//levels (dataVersion>=58)
+	{
+		uint8_t levelCount = 0;
+		if (in.read((char*)&levelCount, 1) < 0)
+			return ccSerializableObject::ReadError();
+		if (levelCount == 0 || levelCount > CCCoreLib::DgmOctree::MAX_OCTREE_LEVEL + 1)
+			return ccSerializableObject::CorruptError();
+
+		try
+		{
+			m_levels.resize(levelCount);
+		}
+		catch (const std::bad_alloc&)
+		{
+			return ccSerializableObject::MemoryError();
+		}
+
+		std::vector<char> buffer;
+		for (uint8_t levelIndex = 0; levelIndex < levelCount; ++levelIndex)
+		{
+			Level& level = m_levels[levelIndex];
+
+			uint32_t nodeCount = 0;
+			if (in.read((char*)&nodeCount, 4) < 0)
+				return ccSerializableObject::ReadError();
+			//the first level only contains the root cell
+			if (nodeCount == 0 || (levelIndex == 0 && nodeCount != 1))
+				return ccSerializableObject::CorruptError();
+
+			try
+			{
+				level.data.resize(nodeCount, Node(levelIndex));
+				buffer.resize(nodeCount * c_nodeFileSize);
+			}
+			catch (const std::bad_alloc&)
+			{
+				return ccSerializableObject::MemoryError();
+			}
+
+			if (in.read(buffer.data(), static_cast<qint64>(buffer.size())) != static_cast<qint64>(buffer.size()))
+				return ccSerializableObject::ReadError();
+
+			const char* _buffer = buffer.data();
+			for (Node& node : level.data)
+			{
+				memcpy(&node.pointCount, _buffer, 4);				_buffer += 4;
+				memcpy(&node.radius, _buffer, 4);					_buffer += 4;
+				memcpy(node.center.u, _buffer, 12);					_buffer += 12;
+				memcpy(node.childIndexes.data(), _buffer, 32);		_buffer += 32;
+				memcpy(&node.firstCodeIndex, _buffer, 4);			_buffer += 4;
+				memcpy(&node.childCount, _buffer, 1);				_buffer += 1;
+
+				if (static_cast<size_t>(node.firstCodeIndex) + node.pointCount > pointCount)
+					return ccSerializableObject::CorruptError();
+			}
+		}
+
+		//the children must exist and their points must be a subset of their parent's points
+		for (uint8_t levelIndex = 0; levelIndex < levelCount; ++levelIndex)
+		{
+			const std::vector<Node>* children = (levelIndex + 1 < levelCount ? &m_levels[levelIndex + 1].data : nullptr);
+			for (const Node& node : m_levels[levelIndex].data)
+			{
+				uint8_t childCount = 0;
+				for (int32_t childIndex : node.childIndexes)
+				{
+					if (childIndex < 0)
+					{
+						if (childIndex != -1)
+							return ccSerializableObject::CorruptError();
+						continue;
+					}
+					if (!children || static_cast<size_t>(childIndex) >= children->size())
+						return ccSerializableObject::CorruptError();
+
+					const Node& childNode = (*children)[childIndex];
+					if (	childNode.firstCodeIndex < node.firstCodeIndex
+						||	static_cast<size_t>(childNode.firstCodeIndex) + childNode.pointCount > static_cast<size_t>(node.firstCodeIndex) + node.pointCount)
+					{
+						return ccSerializableObject::CorruptError();
+					}
+					++childCount;
+				}
+				if (childCount != node.childCount)
+					return ccSerializableObject::CorruptError();
+			}
+		}
+	}
+
+	m_state = INITIALIZED;
+
+	return true;
+}
+
 #include "ccPointCloudLOD.moc"
@@ -389,6 +389,9 @@ bool ccRasterGrid::fillWith(	ccGenericPointCloud* cloud,
 
 	std::vector<ScalarType> sfValues; // common vector used to sort SF values in each cell
 
+	//the heights are gathered cell by cell (random access): a contiguous column of heights is more cache friendly
+	const PointCoordinateType* heights = (pc ? pc->getCoordinateColumn(Z) : nullptr);
+
 	//now we can browse through all points belonging to each cell 
 	for (unsigned j = 0; j < height; ++j)
 	{
@@ -408,9 +411,8 @@ bool ccRasterGrid::fillWith(	ccGenericPointCloud* cloud,
 				for (unsigned n = 0; n < aCell.nbPoints; ++n)
 				{
 					unsigned pointIndex = static_cast<unsigned>(pRef - pointRefList.data());
-					const CCVector3* P = cloud->getPoint(pointIndex);
 					cellPointIndexedHeight[n].index = pointIndex;
-					cellPointIndexedHeight[n].val = P->u[Z];
+					cellPointIndexedHeight[n].val = (heights ? heights[pointIndex] : cloud->getPoint(pointIndex)->u[Z]);
 					pRef = reinterpret_cast<void**> (*pRef);
 				}
 
@@ -709,6 +711,12 @@ bool ccRasterGrid::fillWith(	ccGenericPointCloud* cloud,
 		}
 	}
 
+	//the heights column is not needed anymore (no need to keep a copy of the Z coordinates in memory)
+	if (heights)
+	{
+		pc->releaseCoordinateColumns();
+	}
+
 	//compute the number of non empty cells
 	updateNonEmptyCellCount();
 
@@ -0,0 +1,259 @@
+//##########################################################################
+//#                                                                        #
+//#                              CLOUDCOMPARE                              #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU General Public License as published by  #
+//#  the Free Software Foundation; version 2 or later of the License.      #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#                    COPYRIGHT: CloudCompare project                     #
+//#                                                                        #
+//##########################################################################
+
+#include "ccIncludeGL.h"
+
+#include "ccRenderScheduler.h"
+
+//Local
+#include "ccGenericMesh.h"
+#include "ccHObject.h"
+#include "ccLog.h"
+#include "ccPointCloud.h"
+
+//system
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+ccRenderScheduler::ccRenderScheduler()
+	: m_triangleBudget(0)
+	, m_displayedTriangles(0)
+	, m_frontToBack(false)
+{
+}
+
+void ccRenderScheduler::reset(unsigned pointBudget, unsigned triangleBudget, bool frontToBack)
+{
+	m_entities.clear();
+	m_entityIndexes.clear();
+	m_lodPointBudget.reset(pointBudget);
+	m_triangleBudget = std::max(triangleBudget, 1u);
+	m_displayedTriangles = 0;
+	m_frontToBack = frontToBack;
+}
+
+void ccRenderScheduler::ProjectBoundingBox(const ccBBox& box, const ccGLCameraParameters& camera, double& area_pix, double& depth)
+{
+	CCVector3d C = box.getCenter().toDouble();
+	double radius = box.getDiagNormd() / 2;
+
+	//the second diagonal term of the projection matrix is 1/tan(fov/2) in perspective mode,
+	//and 2/(top-bottom) in orthographic mode
+	double radius_pix = radius * camera.projectionMat.data()[5] * (camera.viewport[3] / 2.0);
+	double centerDepth = -(camera.modelViewMat * C).z;
+	depth = centerDepth - radius;
+
+	//the projected area can't be bigger than the screen
+	double screenArea = static_cast<double>(camera.viewport[2]) * camera.viewport[3];
+	if (camera.perspective)
+	{
+		if (centerDepth <= radius)
+		{
+			//the camera is inside (or very close to) the entity
+			area_pix = screenArea;
+			return;
+		}
+		radius_pix /= centerDepth;
+	}
+
+	area_pix = std::min(M_PI * radius_pix * radius_pix, screenArea);
+}
+
+void ccRenderScheduler::addEntity(ccHObject* entity, const ccGLCameraParameters& camera)
+{
+	if (!entity)
+	{
+		assert(false);
+		return;
+	}
+
+	if (m_entityIndexes.find(entity) != m_entityIndexes.end())
+	{
+		//already registered
+		return;
+	}
+
+	Entity desc;
+	desc.entity = entity;
+	if (entity->isA(CC_TYPES::POINT_CLOUD))
+	{
+		desc.primitiveCount = static_cast<ccPointCloud*>(entity)->size();
+	}
+	else if (entity->isKindOf(CC_TYPES::MESH))
+	{
+		ccGenericMesh* mesh = static_cast<ccGenericMesh*>(entity);
+		desc.isMesh = true;
+		desc.primitiveCount = mesh->size();
+		//default decimation (in case the triangle budget can't be dispatched)
+		if (desc.primitiveCount > m_triangleBudget)
+		{
+			desc.decimationStep = static_cast<unsigned>(ceil(static_cast<double>(desc.primitiveCount) * 3 / m_triangleBudget));
+		}
+	}
+	else
+	{
+		//only the clouds and the meshes are scheduled
+		return;
+	}
+
+	if (desc.primitiveCount == 0)
+	{
+		return;
+	}
+
+	ccBBox box = entity->getOwnBB();
+	if (!box.isValid())
+	{
+		return;
+	}
+	desc.modelViewMat = camera.modelViewMat;
+	ProjectBoundingBox(box, camera, desc.area_pix, desc.depth);
+
+	try
+	{
+		m_entityIndexes[entity] = m_entities.size();
+		m_entities.push_back(desc);
+	}
+	catch (const std::bad_alloc&)
+	{
+		//not enough memory: the entity will be displayed as usual
+		m_entityIndexes.erase(entity);
+	}
+}
+
+void ccRenderScheduler::dispatchTriangleBudget()
+{
+	m_displayedTriangles = 0;
+
+	std::vector<Entity*> meshes;
+	try
+	{
+		for (Entity& desc : m_entities)
+		{
+			if (desc.isMesh)
+			{
+				meshes.push_back(&desc);
+			}
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		//not enough memory: each mesh keeps its default decimation
+		ccLog::Warning("[LoD] Not enough memory to dispatch the triangle budget");
+		return;
+	}
+
+	//the triangles are shared proportionally to the projected size of the meshes: the meshes that
+	//need less than their share are processed first, so that the remaining triangles go to the others
+	static const double s_minArea_pix = 1.0;
+	std::sort(meshes.begin(), meshes.end(), [](const Entity* a, const Entity* b)
+	{
+		return a->primitiveCount / std::max(a->area_pix, s_minArea_pix) < b->primitiveCount / std::max(b->area_pix, s_minArea_pix);
+	});
+
+	double remainingArea = 0.0;
+	for (const Entity* mesh : meshes)
+	{
+		remainingArea += std::max(mesh->area_pix, s_minArea_pix);
+	}
+
+	double remainingBudget = m_triangleBudget;
+	for (Entity* mesh : meshes)
+	{
+		double area = std::max(mesh->area_pix, s_minArea_pix);
+		double share = remainingBudget * (area / remainingArea);
+		double count = std::min(static_cast<double>(mesh->primitiveCount), share);
+		remainingBudget -= count;
+		remainingArea -= area;
+
+		//same decimation scheme as the standard mesh LOD (see ccGenericMesh::drawMeOnly)
+		if (count < mesh->primitiveCount)
+		{
+			mesh->decimationStep = static_cast<unsigned>(ceil(static_cast<double>(mesh->primitiveCount) * 3 / std::max(count, 1.0)));
+		}
+		else
+		{
+			mesh->decimationStep = 1;
+		}
+		m_displayedTriangles += mesh->primitiveCount / mesh->decimationStep;
+	}
+}
+
+void ccRenderScheduler::dispatch()
+{
+	m_lodPointBudget.dispatch();
+
+	dispatchTriangleBudget();
+
+	if (m_frontToBack)
+	{
+		//the closest entities first
+		std::stable_sort(m_entities.begin(), m_entities.end(), [](const Entity& a, const Entity& b) { return a.depth < b.depth; });
+
+		for (size_t i = 0; i < m_entities.size(); ++i)
+		{
+			m_entityIndexes[m_entities[i].entity] = i;
+		}
+	}
+}
+
+bool ccRenderScheduler::isDeferred(const ccHObject* entity) const
+{
+	return m_frontToBack && m_entityIndexes.find(entity) != m_entityIndexes.end();
+}
+
+unsigned ccRenderScheduler::meshDecimationStep(const ccHObject* mesh) const
+{
+	auto it = m_entityIndexes.find(mesh);
+	if (it == m_entityIndexes.end())
+	{
+		return 0;
+	}
+
+	return m_entities[it->second].decimationStep;
+}
+
+void ccRenderScheduler::drawEntities(CC_DRAW_CONTEXT& context)
+{
+	if (!m_frontToBack || m_entities.empty())
+	{
+		return;
+	}
+
+	//get the set of OpenGL functions (version 2.1)
+	QOpenGLFunctions_2_1* glFunc = context.glFunctions<QOpenGLFunctions_2_1>();
+	assert(glFunc != nullptr);
+
+	if (glFunc == nullptr)
+		return;
+
+	glFunc->glMatrixMode(GL_MODELVIEW);
+	glFunc->glPushMatrix();
+
+	for (const Entity& desc : m_entities)
+	{
+		//restore the modelview matrix of the entity (as it was during the scheduling pass)
+		glFunc->glMatrixMode(GL_MODELVIEW);
+		glFunc->glLoadMatrixd(desc.modelViewMat.data());
+
+		desc.entity->drawEntityOnly(context);
+	}
+
+	glFunc->glMatrixMode(GL_MODELVIEW);
+	glFunc->glPopMatrix();
+}
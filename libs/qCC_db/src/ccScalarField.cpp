@@ -15,9 +15,14 @@
 //#                                                                        #
 //##########################################################################
 
+#ifdef CC_CORE_LIB_USES_TBB
+#include <tbb/parallel_for.h>
+#endif
+
 #include "ccScalarField.h"
 
 //Local
+#include "ccChunk.h"
 #include "ccColorScalesManager.h"
 
 //CCCoreLib
@@ -25,6 +30,14 @@
 
 //system
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+#if defined(_OPENMP)
+//OpenMP
+#include <omp.h>
+#endif
 
 using namespace CCCoreLib;
 
@@ -40,6 +53,7 @@ ccScalarField::ccScalarField(const char* name/*=nullptr*/)
 	, m_colorScale(nullptr)
 	, m_colorRampSteps(0)
 	, m_modified(true)
+	, m_modificationCount(0)
 	, m_globalShift(0)
 {
 	setColorRampSteps(ccColorScale::DEFAULT_STEPS);
@@ -59,56 +73,63 @@ ccScalarField::ccScalarField(const ccScalarField& sf)
 	, m_colorRampSteps(sf.m_colorRampSteps)
 	, m_histogram(sf.m_histogram)
 	, m_modified(sf.m_modified)
+	, m_modificationCount(0)
 	, m_globalShift(sf.m_globalShift)
 {
 	computeMinAndMax();
 }
 
-ScalarType ccScalarField::normalize(ScalarType d) const
+//! Normalizes a scalar value between 0 and 1 (see ccScalarField::normalize)
+static ScalarType NormalizeValue(	ScalarType d,
+									const ccScalarField::Range& displayRange,
+									const ccScalarField::Range& saturationRange,
+									const ccScalarField::Range& logSaturationRange,
+									bool logScale,
+									bool symmetricalScale)
 {
-	if (/*!ValidValue(d) || */!m_displayRange.isInRange(d)) //NaN values are also rejected by 'isInRange'!
+	if (/*!ValidValue(d) || */!displayRange.isInRange(d)) //NaN values are also rejected by 'isInRange'!
 	{
 		return static_cast<ScalarType>(-1);
 	}
 
 	//most probable path first!
-	if (!m_logScale)
+	if (!logScale)
 	{
-		if (!m_symmetricalScale)
+		if (!symmetricalScale)
 		{
-			if (d <= m_saturationRange.start())
+			if (d <= saturationRange.start())
 				return 0;
-			else if (d >= m_saturationRange.stop())
+			else if (d >= saturationRange.stop())
 				return static_cast<ScalarType>(1);
-			return (d - m_saturationRange.start()) / m_saturationRange.range();
+			return (d - saturationRange.start()) / saturationRange.range();
 		}
 		else //symmetric scale
 		{
-			if (std::abs(d) <= m_saturationRange.start())
+			if (std::abs(d) <= saturationRange.start())
 				return static_cast<ScalarType>(0.5);
 			
 			if (d >= 0)
 			{
-				if (d >= m_saturationRange.stop())
+				if (d >= saturationRange.stop())
 					return static_cast<ScalarType>(1);
-				return (static_cast<ScalarType>(1) + (d - m_saturationRange.start()) / m_saturationRange.range()) / 2;
+				return (static_cast<ScalarType>(1) + (d - saturationRange.start()) / saturationRange.range()) / 2;
 			}
 			else
 			{
-				if (d <= -m_saturationRange.stop())
+				if (d <= -saturationRange.stop())
 					return 0;
-				return (static_cast<ScalarType>(1) + (d + m_saturationRange.start()) / m_saturationRange.range()) / 2;
+				return (static_cast<ScalarType>(1) + (d + saturationRange.start()) / saturationRange.range()) / 2;
 			}
 		}
 	}
 	else //log scale
 	{
 		ScalarType dLog = log10(std::max(static_cast<ScalarType>(std::abs(d)), CCCoreLib::ZERO_TOLERANCE_SCALAR));
-		if (dLog <= m_logSaturationRange.start())
+		if (dLog <= logSaturationRange.start())
 			return 0;
-		else if (dLog >= m_logSaturationRange.stop())
+		else if (dLog >= logSaturationRange.stop())
 			return static_cast<ScalarType>(1);
-		return (dLog - m_logSaturationRange.start()) / m_logSaturationRange.range();
+		return (dLog - logSaturationRange.start()) / logSaturationRange.range();
 	}
 
 	//can't get here normally!
@@ -116,6 +137,11 @@ ScalarType ccScalarField::normalize(ScalarType d) const
 	return static_cast<ScalarType>(-1);
 }
 
+ScalarType ccScalarField::normalize(ScalarType d) const
+{
+	return NormalizeValue(d, m_displayRange, m_saturationRange, m_logSaturationRange, m_logScale, m_symmetricalScale);
+}
+
 void ccScalarField::setColorScale(ccColorScale::Shared scale)
 {
 	if (m_colorScale != scale)
@@ -131,7 +157,7 @@ void ccScalarField::setColorScale(ccColorScale::Shared scale)
 		if (isAbsolute || wasAbsolute != isAbsolute)
 			updateSaturationBounds();
 
-		m_modified = true;
+		setModificationFlag(true);
 	}
 }
 
@@ -142,7 +168,7 @@ void ccScalarField::setSymmetricalScale(bool state)
 		m_symmetricalScale = state;
 		updateSaturationBounds();
 
-		m_modified = true;
+		setModificationFlag(true);
 	}
 }
 
@@ -156,70 +182,227 @@ void ccScalarField::setLogScale(bool state)
 			ccLog::Warning("[ccScalarField] Scalar field contains negative values! Log scale will only consider absolute values...");
 		}
 
-		m_modified = true;
+		setModificationFlag(true);
 	}
 }
 
+//! Calls func(chunkIndex) for each chunk of values (in parallel)
+template <typename Func> static void ParallelForChunks(size_t chunkCount, const Func& func)
+{
+#ifdef CC_CORE_LIB_USES_TBB
+	tbb::parallel_for(0, static_cast<int>(chunkCount), [&](int chunkIndex)
+#else
+#if defined(_OPENMP)
+	#pragma omp parallel for num_threads(omp_get_max_threads())
+#endif
+	for (int chunkIndex = 0; chunkIndex < static_cast<int>(chunkCount); ++chunkIndex)
+#endif
+	{
+		func(static_cast<size_t>(chunkIndex));
+	}
+#ifdef CC_CORE_LIB_USES_TBB
+	);
+#endif
+}
+
+//! Computes the statistics of a set of values
+static void ComputeStatistics(const ScalarType* values, size_t count, ccScalarField::Statistics& stats)
+{
+	stats.minVal = stats.maxVal = 0;
+	stats.validCount = stats.nanCount = 0;
+	stats.sum = 0.0;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		ScalarType val = values[i];
+		if (ccScalarField::ValidValue(val))
+		{
+			if (stats.validCount != 0)
+			{
+				if (val < stats.minVal)
+					stats.minVal = val;
+				else if (val > stats.maxVal)
+					stats.maxVal = val;
+			}
+			else
+			{
+				stats.minVal = stats.maxVal = val;
+			}
+			stats.sum += val;
+			++stats.validCount;
+		}
+	}
+	stats.nanCount = static_cast<unsigned>(count) - stats.validCount;
+
+	//second pass (the values are still in the cache) for a numerically stable variance
+	stats.squaredDeviationsSum = 0.0;
+	if (stats.validCount != 0)
+	{
+		double mean = stats.mean();
+		for (size_t i = 0; i < count; ++i)
+		{
+			ScalarType val = values[i];
+			if (ccScalarField::ValidValue(val))
+			{
+				double delta = val - mean;
+				stats.squaredDeviationsSum += delta * delta;
+			}
+		}
+	}
+}
+
+//! Merges the statistics of two sets of values
+static void MergeStatistics(ccScalarField::Statistics& stats, const ccScalarField::Statistics& other)
+{
+	if (other.validCount != 0)
+	{
+		if (stats.validCount != 0)
+		{
+			//see Chan et al., "Updating Formulae and a Pairwise Algorithm for Computing Sample Variances"
+			double delta = other.mean() - stats.mean();
+			double n1 = stats.validCount;
+			double n2 = other.validCount;
+			stats.squaredDeviationsSum += other.squaredDeviationsSum + delta * delta * (n1 * n2 / (n1 + n2));
+			stats.minVal = std::min(stats.minVal, other.minVal);
+			stats.maxVal = std::max(stats.maxVal, other.maxVal);
+		}
+		else
+		{
+			stats.squaredDeviationsSum = other.squaredDeviationsSum;
+			stats.minVal = other.minVal;
+			stats.maxVal = other.maxVal;
+		}
+		stats.sum += other.sum;
+		stats.validCount += other.validCount;
+	}
+	stats.nanCount += other.nanCount;
+}
+
 void ccScalarField::computeMinAndMax()
 {
-	ScalarField::computeMinAndMax();
+	const unsigned count = currentSize();
+	const size_t chunkCount = ccChunk::Count(count);
+
+	//the statistics of each chunk are computed in parallel, then merged
+	std::vector<Statistics> chunkStatistics;
+	try
+	{
+		chunkStatistics.resize(chunkCount);
+	}
+	catch (const std::bad_alloc&)
+	{
+		//not enough memory: we'll scan all the values at once
+		chunkStatistics.clear();
+	}
+
+	if (chunkStatistics.size() == chunkCount)
+	{
+		ParallelForChunks(chunkCount, [&](size_t chunkIndex)
+		{
+			ComputeStatistics(ccChunk::Start(*this, chunkIndex), ccChunk::Size(chunkIndex, count), chunkStatistics[chunkIndex]);
+		});
+
+		m_statistics = Statistics();
+		for (const Statistics& stats : chunkStatistics)
+		{
+			MergeStatistics(m_statistics, stats);
+		}
+	}
+	else
+	{
+		ComputeStatistics(data(), count, m_statistics);
+	}
+
+	m_minVal = m_statistics.minVal;
+	m_maxVal = m_statistics.maxVal;
 
 	m_displayRange.setBounds(m_minVal, m_maxVal);
 
 	//update histogram
 	{
-		if (m_displayRange.maxRange() == 0 || currentSize() == 0)
+		if (m_displayRange.maxRange() == 0 || count == 0)
 		{
 			//can't build histogram of a flat field
 			m_histogram.clear();
 		}
 		else
 		{
-			unsigned count = currentSize();
 			unsigned numberOfClasses = static_cast<unsigned>(ceil(sqrt(static_cast<double>(count))));
 			numberOfClasses = std::max<unsigned>(std::min<unsigned>(numberOfClasses, MAX_HISTOGRAM_SIZE), 4);
 
 			m_histogram.maxValue = 0;
 
-			//reserve memory
-			try
+			//the valid values are all inside [min ; max] (and the NaN values are ignored)
+			if (computeHistogram(m_displayRange.min(), m_displayRange.max(), numberOfClasses, m_histogram))
 			{
-				m_histogram.resize(numberOfClasses);
+				//update 'maxValue'
+				m_histogram.maxValue = *std::max_element(m_histogram.begin(), m_histogram.end());
 			}
-			catch (const std::bad_alloc&)
+			else
 			{
 				ccLog::Warning("[ccScalarField::computeMinAndMax] Failed to update associated histogram!");
 				m_histogram.clear();
 			}
+		}
+	}
+
+	setModificationFlag(true);
+
+	updateSaturationBounds();
+}
+
+bool ccScalarField::computeHistogram(double minVal, double maxVal, size_t binCount, std::vector<unsigned>& histo) const
+{
+	assert(maxVal > minVal && binCount != 0);
+
+	//the values are processed by groups of chunks (one partial histogram per group)
+	const unsigned count = currentSize();
+	const size_t chunkCount = ccChunk::Count(count);
+	const size_t groupCount = std::min<size_t>(chunkCount, 64);
+
+	std::vector< std::vector<unsigned> > partialHistograms;
+	try
+	{
+		histo.resize(binCount);
+		partialHistograms.resize(groupCount, std::vector<unsigned>(binCount, 0));
+	}
+	catch (const std::bad_alloc&)
+	{
+		return false;
+	}
+	std::fill(histo.begin(), histo.end(), 0);
 
-			if (!m_histogram.empty())
+	const double step = (maxVal - minVal) / binCount;
+	ParallelForChunks(groupCount, [&](size_t groupIndex)
+	{
+		std::vector<unsigned>& partialHisto = partialHistograms[groupIndex];
+		for (size_t chunkIndex = groupIndex; chunkIndex < chunkCount; chunkIndex += groupCount)
+		{
+			const ScalarType* values = ccChunk::Start(*this, chunkIndex);
+			size_t chunkSize = ccChunk::Size(chunkIndex, count);
+			for (size_t i = 0; i < chunkSize; ++i)
 			{
-				std::fill(m_histogram.begin(), m_histogram.end(), 0);
+				double val = values[i];
 
-				//compute histogram
+				//we ignore values outside of [minVal,maxVal] (works for NaN values as well)
+				if (val >= minVal && val <= maxVal)
 				{
-					ScalarType step = static_cast<ScalarType>(numberOfClasses) / m_displayRange.maxRange();
-					for (unsigned i = 0; i < count; ++i)
-					{
-						const ScalarType& val = getValue(i);
-
-						if (ValidValue(val))
-						{
-							unsigned bin = static_cast<unsigned>(floor(static_cast<double>(val - m_displayRange.min())*step));
-							++m_histogram[std::min(bin, numberOfClasses - 1)];
-						}
-					}
+					size_t bin = static_cast<size_t>(floor((val - minVal) / step));
+					++partialHisto[std::min(bin, binCount - 1)];
 				}
-
-				//update 'maxValue'
-				m_histogram.maxValue = *std::max_element(m_histogram.begin(), m_histogram.end());
 			}
 		}
-	}
+	});
 
-	m_modified = true;
+	for (const std::vector<unsigned>& partialHisto : partialHistograms)
+	{
+		for (size_t i = 0; i < binCount; ++i)
+		{
+			histo[i] += partialHisto[i];
+		}
+	}
 
-	updateSaturationBounds();
+	return true;
 }
 
 void ccScalarField::updateSaturationBounds()
@@ -267,19 +450,19 @@ void ccScalarField::updateSaturationBounds()
 		}
 	}
 
-	m_modified = true;
+	setModificationFlag(true);
 }
 
 void ccScalarField::setMinDisplayed(ScalarType val)
 {
 	m_displayRange.setStart(val);
-	m_modified = true;
+	setModificationFlag(true);
 }
 	
 void ccScalarField::setMaxDisplayed(ScalarType val)
 {
 	m_displayRange.setStop(val);
-	m_modified = true;
+	setModificationFlag(true);
 }
 
 void ccScalarField::setSaturationStart(ScalarType val)
@@ -292,7 +475,7 @@ void ccScalarField::setSaturationStart(ScalarType val)
 	{
 		m_saturationRange.setStart(val);
 	}
-	m_modified = true;
+	setModificationFlag(true);
 }
 
 void ccScalarField::setSaturationStop(ScalarType val)
@@ -305,7 +488,128 @@ void ccScalarField::setSaturationStop(ScalarType val)
 	{
 		m_saturationRange.setStop(val);
 	}
-	m_modified = true;
+	setModificationFlag(true);
+}
+
+//! Number of values converted to colors by each thread at once (see ccScalarField::getColors)
+static const unsigned s_colorBlockSize = 8192;
+
+//! Converts scalar values to colors (by blocks, in parallel)
+/** \param relativePos returns the relative position of a (displayed) value in the color ramp
+**/
+template <typename RelativePosFunc> static void ConvertToColors(	const ScalarType* values,
+																	unsigned count,
+																	ccColor::Rgba* output,
+																	const ccScalarField::Range& displayRange,
+																	const std::vector<ccColor::Rgba>& lut,
+																	const ccColor::Rgba& outOfRangeColor,
+																	const RelativePosFunc& relativePos)
+{
+	//same quantization as ccColorScale::getColorByRelativePos
+	const double scale = lut.size() * 65535.0;
+	const ScalarType minDisplayed = displayRange.start();
+	const ScalarType maxDisplayed = displayRange.stop();
+
+	int blockCount = static_cast<int>((count + s_colorBlockSize - 1) / s_colorBlockSize);
+#ifdef CC_CORE_LIB_USES_TBB
+	tbb::parallel_for(0, blockCount, [&](int b)
+#else
+#if defined(_OPENMP)
+	#pragma omp parallel for num_threads(omp_get_max_threads())
+#endif
+	for (int b = 0; b < blockCount; ++b)
+#endif
+	{
+		unsigned first = static_cast<unsigned>(b) * s_colorBlockSize;
+		unsigned last = std::min(first + s_colorBlockSize, count);
+		for (unsigned i = first; i < last; ++i)
+		{
+			ScalarType d = values[i];
+			if (d >= minDisplayed && d <= maxDisplayed) //NaN values are also rejected
+			{
+				output[i] = lut[static_cast<unsigned>(relativePos(d) * scale) >> 16];
+			}
+			else
+			{
+				output[i] = outOfRangeColor;
+			}
+		}
+	}
+#ifdef CC_CORE_LIB_USES_TBB
+	);
+#endif
+}
+
+ccScalarField::ColorConverter ccScalarField::getColorConverter(const ccColor::Rgba& hiddenColor/*=ccColor::lightGrey*/) const
+{
+	assert(m_colorScale);
+
+	ColorConverter converter;
+
+	//lookup table (one color per color ramp step)
+	converter.m_lut.resize(m_colorRampSteps);
+	for (unsigned k = 0; k < m_colorRampSteps; ++k)
+	{
+		converter.m_lut[k] = ccColor::Rgba(m_colorScale->getColorByIndex((k * (ccColorScale::MAX_STEPS - 1)) / m_colorRampSteps), ccColor::MAX);
+	}
+
+	converter.m_displayRange = m_displayRange;
+	converter.m_saturationRange = m_saturationRange;
+	converter.m_logSaturationRange = m_logSaturationRange;
+	converter.m_symmetricalScale = m_symmetricalScale;
+	converter.m_logScale = m_logScale;
+	converter.m_outOfRangeColor = (m_showNaNValuesInGrey ? ccColor::lightGrey : hiddenColor);
+
+	return converter;
+}
+
+void ccScalarField::ColorConverter::convert(const ScalarType* values, unsigned count, ccColor::Rgba* output) const
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	//most probable path first (the normalization is specialized for each mode)
+	if (!m_logScale && !m_symmetricalScale && m_saturationRange.range() > 0)
+	{
+		const ScalarType satStart = m_saturationRange.start();
+		const ScalarType invSatRange = static_cast<ScalarType>(1) / m_saturationRange.range();
+		ConvertToColors(values, count, output, m_displayRange, m_lut, m_outOfRangeColor, [=](ScalarType d)
+		{
+			return std::min(std::max((d - satStart) * invSatRange, static_cast<ScalarType>(0)), static_cast<ScalarType>(1));
+		});
+	}
+	else
+	{
+		ConvertToColors(values, count, output, m_displayRange, m_lut, m_outOfRangeColor, [this](ScalarType d)
+		{
+			return NormalizeValue(d, m_displayRange, m_saturationRange, m_logSaturationRange, m_logScale, m_symmetricalScale);
+		});
+	}
+}
+
+void ccScalarField::getColors(const ScalarType* values, unsigned count, ccColor::Rgba* output, const ccColor::Rgba& hiddenColor/*=ccColor::lightGrey*/) const
+{
+	assert(m_colorScale);
+	if (count == 0)
+	{
+		return;
+	}
+
+	try
+	{
+		getColorConverter(hiddenColor).convert(values, count, output);
+	}
+	catch (const std::bad_alloc&)
+	{
+		//not enough memory (very unlikely): we use the standard (slower) way
+		for (unsigned i = 0; i < count; ++i)
+		{
+			const ccColor::Rgb* col = getColor(values[i]);
+			output[i] = (col ? ccColor::Rgba(*col, ccColor::MAX) : hiddenColor);
+		}
+	}
 }
 
 void ccScalarField::setColorRampSteps(unsigned steps)
@@ -317,7 +621,77 @@ void ccScalarField::setColorRampSteps(unsigned steps)
 	else
 		m_colorRampSteps = steps;
 
-	m_modified = true;
+	setModificationFlag(true);
+}
+
+//! Saves the (integer) values of a scalar field with a narrower type
+template <typename T> static bool ToTypedFile(const std::vector<ScalarType>& values, QFile& out, short dataVersion)
+{
+	std::vector<T> typedValues;
+	try
+	{
+		typedValues.resize(values.size());
+	}
+	catch (const std::bad_alloc&)
+	{
+		return ccSerializableObject::MemoryError();
+	}
+
+	for (size_t i = 0; i < values.size(); ++i)
+	{
+		typedValues[i] = static_cast<T>(values[i]);
+	}
+
+	return ccSerializationHelper::GenericArrayToFile<T, 1, T>(typedValues, out, dataVersion);
+}
+
+//! Whether scalar fields with integer values are saved with a narrower type in BIN files
+static std::atomic<bool> s_integerFileStorage(false);
+
+void ccScalarField::SetIntegerFileStorage(bool state)
+{
+	s_integerFileStorage = state;
+}
+
+bool ccScalarField::IntegerFileStorage()
+{
+	return s_integerFileStorage;
+}
+
+ccScalarField::FileStorageType ccScalarField::narrowestFileStorageType() const
+{
+	if (empty())
+	{
+		return FileStorageType::NATIVE;
+	}
+
+	ScalarType minVal = std::numeric_limits<ScalarType>::max();
+	ScalarType maxVal = std::numeric_limits<ScalarType>::lowest();
+	for (ScalarType val : *this)
+	{
+		//NaN and non integer values can't be stored as integers
+		if (std::isnan(val) || val != std::floor(val))
+		{
+			return FileStorageType::NATIVE;
+		}
+		minVal = std::min(minVal, val);
+		maxVal = std::max(maxVal, val);
+	}
+
+	if (minVal >= 0)
+	{
+		if (maxVal <= std::numeric_limits<uint8_t>::max())
+			return FileStorageType::UINT8;
+		if (maxVal <= std::numeric_limits<uint16_t>::max())
+			return FileStorageType::UINT16;
+	}
+	if (	minVal >= static_cast<ScalarType>(std::numeric_limits<int32_t>::min())
+		&&	maxVal <  static_cast<ScalarType>(std::numeric_limits<int32_t>::max()) )
+	{
+		return FileStorageType::INT32;
+	}
+
+	return FileStorageType::NATIVE;
 }
 
 bool ccScalarField::toFile(QFile& out, short dataVersion) const
@@ -334,8 +708,38 @@ bool ccScalarField::toFile(QFile& out, short dataVersion) const
 		return WriteError();
 
 	//data (dataVersion>=20)
-	if (!ccSerializationHelper::GenericArrayToFile<ScalarType, 1, ScalarType>(*this, out))
-		return WriteError();
+	{
+		FileStorageType storageType = FileStorageType::NATIVE;
+		if (dataVersion >= 57)
+		{
+			//storage type (dataVersion>=57)
+			if (s_integerFileStorage)
+			{
+				storageType = narrowestFileStorageType();
+			}
+			if (out.write((const char*)&storageType, 1) < 0)
+				return WriteError();
+		}
+
+		bool result = false;
+		switch (storageType)
+		{
+		case FileStorageType::UINT8:
+			result = ToTypedFile<uint8_t>(*this, out, dataVersion);
+			break;
+		case FileStorageType::UINT16:
+			result = ToTypedFile<uint16_t>(*this, out, dataVersion);
+			break;
+		case FileStorageType::INT32:
+			result = ToTypedFile<int32_t>(*this, out, dataVersion);
+			break;
+		default:
+			result = ccSerializationHelper::GenericArrayToFile<ScalarType, 1, ScalarType>(*this, out, dataVersion);
+			break;
+		}
+		if (!result)
+			return WriteError();
+	}
 
 	//displayed values & saturation boundaries (dataVersion>=20)
 	double dValue = (double)m_displayRange.start();
@@ -419,8 +823,33 @@ bool ccScalarField::fromFile(QFile& in, short dataVersion, int flags, LoadedIDMa
 			return ReadError();
 	}
 
+	//storage type (dataVersion >= 57)
+	FileStorageType storageType = FileStorageType::NATIVE;
+	if (dataVersion >= 57)
+	{
+		if (in.read((char*)&storageType, 1) != 1)
+			return ReadError();
+	}
+
 	//data (dataVersion >= 20)
 	bool result = false;
+	if (storageType == FileStorageType::UINT8)
+	{
+		result = ccSerializationHelper::GenericArrayFromTypedFile<ScalarType, 1, ScalarType, uint8_t>(*this, in, dataVersion);
+	}
+	else if (storageType == FileStorageType::UINT16)
+	{
+		result = ccSerializationHelper::GenericArrayFromTypedFile<ScalarType, 1, ScalarType, uint16_t>(*this, in, dataVersion);
+	}
+	else if (storageType == FileStorageType::INT32)
+	{
+		result = ccSerializationHelper::GenericArrayFromTypedFile<ScalarType, 1, ScalarType, int32_t>(*this, in, dataVersion);
+	}
+	else if (storageType != FileStorageType::NATIVE)
+	{
+		return CorruptError();
+	}
+	else
 	{
 		bool fileScalarIsFloat = (flags & ccSerializableObject::DF_SCALAR_VAL_32_BITS);
 		if (fileScalarIsFloat && sizeof(ScalarType) == 8) //file is 'float' and current type is 'double'
@@ -624,7 +1053,7 @@ bool ccScalarField::fromFile(QFile& in, short dataVersion, int flags, LoadedIDMa
 	m_logSaturationRange.setStart((ScalarType)minLogSaturation);
 	m_logSaturationRange.setStop((ScalarType)maxLogSaturation);
 
-	m_modified = true;
+	setModificationFlag(true);
 
 	return true;
 }
@@ -635,6 +1064,11 @@ short ccScalarField::minimumFileVersion() const
 	short minVersion = (m_globalShift != 0 ? 42 : 27);
 
 	minVersion = std::max(minVersion, ccSerializationHelper::GenericArrayToFileMinVersion());
+	if (s_integerFileStorage)
+	{
+		//integer values can be stored with a narrower type (dataVersion>=57)
+		minVersion = std::max<short>(minVersion, 57);
+	}
 	if (m_colorScale)
 	{
 		minVersion = std::max(minVersion, m_colorScale->minimumFileVersion());
@@ -655,13 +1089,13 @@ bool ccScalarField::mayHaveHiddenValues() const
 void ccScalarField::showNaNValuesInGrey(bool state)
 {
 	m_showNaNValuesInGrey = state;
-	m_modified = true;
+	setModificationFlag(true);
 }
 
 void ccScalarField::alwaysShowZero(bool state)
 {
 	m_alwaysShowZero = state;
-	m_modified = true;
+	setModificationFlag(true);
 }
 
 void ccScalarField::importParametersFrom(const ccScalarField* sf)
@@ -0,0 +1,665 @@
+//##########################################################################
+//#                                                                        #
+//#                              CLOUDCOMPARE                              #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU General Public License as published by  #
+//#  the Free Software Foundation; version 2 or later of the License.      #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          COPYRIGHT: EDF R&D / TELECOM ParisTech (ENST-TSI)             #
+//#                                                                        #
+//##########################################################################
+
+#ifdef CC_CORE_LIB_USES_TBB
+#include <tbb/parallel_for.h>
+#endif
+
+#include "ccSerializableObject.h"
+
+//Qt
+#include <QByteArray>
+
+//System
+#include <atomic>
+#include <cstring>
+
+#if defined(_OPENMP)
+//OpenMP
+#include <omp.h>
+#endif
+
+constexpr qint64 ccSerializationHelper::MaxChunkByteSize;
+
+//! Number of bytes read or written in a row
+/** Apparently Qt and/or Windows don't like to read too many bytes in a row...
+**/
+static const qint64 s_ioChunkByteSize = (static_cast<qint64>(1) << 24); //16 Mb
+
+//! Size of the compressed chunks of the 'generic arrays' (before compression)
+static const qint64 s_compressedChunkByteSize = (static_cast<qint64>(1) << 22); //4 Mb
+//! Number of compressed chunks processed at once
+static const int s_compressedChunkCountPerStep = 64;
+//! Deflate compression level (fast, as most of the gain comes from the shuffling)
+static const int s_deflateLevel = 3;
+
+//! Compression of the 'generic arrays'
+static std::atomic<ccSerializationHelper::ArrayCompression> s_arrayCompression(ccSerializationHelper::ArrayCompression::NONE);
+
+void ccSerializationHelper::SetArrayCompression(ArrayCompression compression)
+{
+	s_arrayCompression = compression;
+}
+
+ccSerializationHelper::ArrayCompression ccSerializationHelper::GetArrayCompression()
+{
+	return s_arrayCompression;
+}
+
+//! Maximum size of the raw chunks of the 'generic arrays' (0 = MaxChunkByteSize)
+static std::atomic<qint64> s_arrayChunkByteSize(0);
+
+void ccSerializationHelper::SetArrayChunkByteSize(qint64 byteSize)
+{
+	s_arrayChunkByteSize = std::max<qint64>(0, byteSize);
+}
+
+qint64 ccSerializationHelper::GetArrayChunkByteSize()
+{
+	qint64 byteSize = s_arrayChunkByteSize;
+	return (byteSize != 0 ? byteSize : MaxChunkByteSize);
+}
+
+short ccSerializationHelper::GenericArrayToFileMinVersion(size_t elementCount/*=0*/)
+{
+	if (s_arrayCompression != ArrayCompression::NONE)
+	{
+		return 56;
+	}
+	return (static_cast<::uint64_t>(elementCount) > std::numeric_limits<::uint32_t>::max() ? 55 : 20);
+}
+
+//! Byte-shuffles values (optionally delta coded with the value 'deltaStride' values before)
+/** The i-th bytes of all the values are stored together.
+**/
+template <class T> static void ShuffleValues(const char* in, char* out, size_t valueCount, size_t deltaStride)
+{
+	for (size_t v = 0; v < valueCount; ++v)
+	{
+		T value;
+		memcpy(&value, in + v * sizeof(T), sizeof(T));
+		if (deltaStride != 0 && v >= deltaStride)
+		{
+			T previous;
+			memcpy(&previous, in + (v - deltaStride) * sizeof(T), sizeof(T));
+			value = static_cast<T>(value - previous);
+		}
+
+		const char* bytes = reinterpret_cast<const char*>(&value);
+		for (size_t b = 0; b < sizeof(T); ++b)
+		{
+			out[b * valueCount + v] = bytes[b];
+		}
+	}
+}
+
+//! Inverse of ShuffleValues
+template <class T> static void UnshuffleValues(const char* in, char* out, size_t valueCount, size_t deltaStride)
+{
+	for (size_t v = 0; v < valueCount; ++v)
+	{
+		T value;
+		char* bytes = reinterpret_cast<char*>(&value);
+		for (size_t b = 0; b < sizeof(T); ++b)
+		{
+			bytes[b] = in[b * valueCount + v];
+		}
+
+		if (deltaStride != 0 && v >= deltaStride)
+		{
+			T previous;
+			memcpy(&previous, out + (v - deltaStride) * sizeof(T), sizeof(T));
+			value = static_cast<T>(value + previous);
+		}
+		memcpy(out + v * sizeof(T), &value, sizeof(T));
+	}
+}
+
+//! Byte-shuffles (or un-shuffles) a chunk, depending on the size of the components
+/** Delta coding is applied between the same components of consecutive elements.
+**/
+static void ShuffleChunk(const char* in, char* out, size_t byteCount, size_t elementSize, size_t componentSize, bool delta, bool inverse)
+{
+	switch (componentSize)
+	{
+	case 2:
+		(inverse ? UnshuffleValues<::uint16_t> : ShuffleValues<::uint16_t>)(in, out, byteCount / 2, delta ? elementSize / 2 : 0);
+		break;
+	case 4:
+		(inverse ? UnshuffleValues<::uint32_t> : ShuffleValues<::uint32_t>)(in, out, byteCount / 4, delta ? elementSize / 4 : 0);
+		break;
+	case 8:
+		(inverse ? UnshuffleValues<::uint64_t> : ShuffleValues<::uint64_t>)(in, out, byteCount / 8, delta ? elementSize / 8 : 0);
+		break;
+	default:
+		//bytes (nothing to shuffle)
+		(inverse ? UnshuffleValues<::uint8_t> : ShuffleValues<::uint8_t>)(in, out, byteCount, delta ? elementSize : 0);
+		break;
+	}
+}
+
+//! Compresses a chunk of a 'generic array'
+static bool EncodeChunk(const char* data,
+						size_t byteCount,
+						size_t elementSize,
+						size_t componentSize,
+						ccSerializationHelper::ArrayCompression compression,
+						QByteArray& encoded)
+{
+	try
+	{
+		if (compression == ccSerializationHelper::ArrayCompression::DEFLATE)
+		{
+			encoded = qCompress(reinterpret_cast<const uchar*>(data), static_cast<int>(byteCount), s_deflateLevel);
+		}
+		else
+		{
+			std::vector<char> shuffled(byteCount);
+			ShuffleChunk(data, shuffled.data(), byteCount, elementSize, componentSize, compression == ccSerializationHelper::ArrayCompression::DELTA, false);
+			encoded = qCompress(reinterpret_cast<const uchar*>(shuffled.data()), static_cast<int>(byteCount), s_deflateLevel);
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		return false;
+	}
+
+	return !encoded.isEmpty();
+}
+
+//! Decompresses a chunk of a 'generic array'
+static bool DecodeChunk(const char* encoded,
+						::uint64_t encodedByteCount,
+						char* data,
+						size_t byteCount,
+						size_t elementSize,
+						size_t componentSize,
+						ccSerializationHelper::ArrayCompression compression)
+{
+	try
+	{
+		QByteArray decoded = qUncompress(reinterpret_cast<const uchar*>(encoded), static_cast<int>(encodedByteCount));
+		if (static_cast<size_t>(decoded.size()) != byteCount)
+		{
+			return false;
+		}
+
+		if (compression == ccSerializationHelper::ArrayCompression::DEFLATE)
+		{
+			memcpy(data, decoded.constData(), byteCount);
+		}
+		else
+		{
+			ShuffleChunk(decoded.constData(), data, byteCount, elementSize, componentSize, compression == ccSerializationHelper::ArrayCompression::DELTA, true);
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+//! Reads or writes a block of data in a file, chunk by chunk, in parallel
+/** Each chunk is processed with its own file handle, so that the threads
+	don't have to share (and seek) the same file position.
+**/
+static bool ParallelIO(const QString& filename, qint64 startPos, char* data, qint64 byteCount, bool write)
+{
+	int chunkCount = static_cast<int>((byteCount + s_ioChunkByteSize - 1) / s_ioChunkByteSize);
+	std::atomic<bool> success(true);
+
+	auto processChunk = [&](int chunkIndex)
+	{
+		if (!success)
+		{
+			//no need to go further
+			return;
+		}
+
+		QFile file(filename);
+		if (!file.open(write ? QIODevice::ReadWrite | QIODevice::Unbuffered : QIODevice::ReadOnly | QIODevice::Unbuffered))
+		{
+			success = false;
+			return;
+		}
+
+		qint64 offset = static_cast<qint64>(chunkIndex) * s_ioChunkByteSize;
+		qint64 chunkByteCount = std::min(s_ioChunkByteSize, byteCount - offset);
+		if (!file.seek(startPos + offset))
+		{
+			success = false;
+			return;
+		}
+
+		qint64 processedByteCount = (write ? file.write(data + offset, chunkByteCount) : file.read(data + offset, chunkByteCount));
+		if (processedByteCount != chunkByteCount)
+		{
+			success = false;
+		}
+	};
+
+#ifdef CC_CORE_LIB_USES_TBB
+	tbb::parallel_for(0, chunkCount, processChunk);
+#else
+#if defined(_OPENMP)
+	#pragma omp parallel for num_threads(omp_get_max_threads())
+#endif
+	for (int i = 0; i < chunkCount; ++i)
+	{
+		processChunk(i);
+	}
+#endif
+
+	return success;
+}
+
+bool ccSerializationHelper::ReadRawData(QFile& in, char* data, qint64 byteCount)
+{
+	assert(in.isOpen() && (in.openMode() & QIODevice::ReadOnly));
+
+	if (byteCount > s_ioChunkByteSize && !in.fileName().isEmpty())
+	{
+		qint64 startPos = in.pos();
+		if (startPos + byteCount > in.size())
+		{
+			//truncated file
+			return false;
+		}
+
+		if (!ParallelIO(in.fileName(), startPos, data, byteCount, false))
+		{
+			return false;
+		}
+		return in.seek(startPos + byteCount);
+	}
+
+	while (byteCount > 0)
+	{
+		qint64 chunkByteCount = std::min(s_ioChunkByteSize, byteCount);
+		if (in.read(data, chunkByteCount) != chunkByteCount)
+		{
+			return false;
+		}
+		byteCount -= chunkByteCount;
+		data += chunkByteCount;
+	}
+
+	return true;
+}
+
+bool ccSerializationHelper::WriteRawData(QFile& out, const char* data, qint64 byteCount)
+{
+	assert(out.isOpen() && (out.openMode() & QIODevice::WriteOnly));
+
+	if (byteCount > s_ioChunkByteSize && !out.fileName().isEmpty())
+	{
+		//the buffered data must be written first
+		if (!out.flush())
+		{
+			return false;
+		}
+		qint64 startPos = out.pos();
+		if (!ParallelIO(out.fileName(), startPos, const_cast<char*>(data), byteCount, true))
+		{
+			return false;
+		}
+		return out.seek(startPos + byteCount);
+	}
+
+	while (byteCount > 0)
+	{
+		qint64 chunkByteCount = std::min(s_ioChunkByteSize, byteCount);
+		if (out.write(data, chunkByteCount) != chunkByteCount)
+		{
+			return false;
+		}
+		byteCount -= chunkByteCount;
+		data += chunkByteCount;
+	}
+
+	return true;
+}
+
+bool ccSerializationHelper::WriteArrayData(	QFile& out,
+											short dataVersion,
+											const char* data,
+											size_t elementCount,
+											size_t elementSize,
+											size_t componentSize)
+{
+	::uint64_t elementCount64 = static_cast<::uint64_t>(elementCount);
+	if (dataVersion < 55)
+	{
+		if (elementCount64 > std::numeric_limits<::uint32_t>::max())
+		{
+			assert(false);
+			ccLog::Error("Array is too big for this file version");
+			return false;
+		}
+
+		//element count = array size (dataVersion>=20)
+		::uint32_t elementCount32 = static_cast<::uint32_t>(elementCount64);
+		if (out.write((const char*)&elementCount32, 4) < 0)
+			return ccSerializableObject::WriteError();
+
+		//array data (dataVersion>=20)
+		if (!WriteRawData(out, data, static_cast<qint64>(elementCount64 * elementSize)))
+			return ccSerializableObject::WriteError();
+
+		return true;
+	}
+
+	//element count = array size (dataVersion>=55)
+	if (out.write((const char*)&elementCount64, 8) < 0)
+		return ccSerializableObject::WriteError();
+
+	ArrayCompression compression = ArrayCompression::NONE;
+	if (dataVersion >= 56)
+	{
+		if (elementCount64 != 0)
+		{
+			compression = s_arrayCompression;
+		}
+
+		//compression (dataVersion>=56)
+		::uint8_t compressionCode = static_cast<::uint8_t>(compression);
+		if (out.write((const char*)&compressionCode, 1) < 0)
+			return ccSerializableObject::WriteError();
+	}
+
+	if (compression == ArrayCompression::NONE)
+	{
+		//chunk size (dataVersion>=55)
+		::uint64_t rawChunkSize = std::max<::uint64_t>(1, static_cast<::uint64_t>(GetArrayChunkByteSize()) / elementSize);
+		::uint64_t chunkSize = (elementCount64 > rawChunkSize ? rawChunkSize : 0);
+		if (out.write((const char*)&chunkSize, 8) < 0)
+			return ccSerializableObject::WriteError();
+
+		//chunk table (dataVersion>=55)
+		for (::uint64_t firstIndex = 0; chunkSize != 0 && firstIndex < elementCount64; firstIndex += chunkSize)
+		{
+			::uint64_t chunkByteCount = std::min(chunkSize, elementCount64 - firstIndex) * elementSize;
+			if (out.write((const char*)&chunkByteCount, 8) < 0)
+				return ccSerializableObject::WriteError();
+		}
+
+		//array data (dataVersion>=20)
+		if (!WriteRawData(out, data, static_cast<qint64>(elementCount64 * elementSize)))
+			return ccSerializableObject::WriteError();
+
+		return true;
+	}
+
+	//chunk size (dataVersion>=55)
+	::uint64_t chunkSize = std::max<::uint64_t>(1, static_cast<::uint64_t>(s_compressedChunkByteSize) / elementSize);
+	if (out.write((const char*)&chunkSize, 8) < 0)
+		return ccSerializableObject::WriteError();
+
+	//chunk table (dataVersion>=55)
+	//--> filled once the chunks have been compressed
+	::uint64_t chunkCount = (elementCount64 + chunkSize - 1) / chunkSize;
+	std::vector<::uint64_t> chunkByteCounts;
+	std::vector<QByteArray> encodedChunks;
+	try
+	{
+		chunkByteCounts.resize(static_cast<size_t>(chunkCount), 0);
+		encodedChunks.resize(s_compressedChunkCountPerStep);
+	}
+	catch (const std::bad_alloc&)
+	{
+		return ccSerializableObject::MemoryError();
+	}
+	qint64 chunkTablePos = out.pos();
+	if (out.write((const char*)chunkByteCounts.data(), static_cast<qint64>(chunkCount * 8)) < 0)
+		return ccSerializableObject::WriteError();
+
+	//compressed chunks (dataVersion>=56)
+	for (::uint64_t firstChunk = 0; firstChunk < chunkCount; firstChunk += s_compressedChunkCountPerStep)
+	{
+		int stepChunkCount = static_cast<int>(std::min<::uint64_t>(s_compressedChunkCountPerStep, chunkCount - firstChunk));
+		std::atomic<bool> success(true);
+
+		auto encodeChunk = [&](int i)
+		{
+			::uint64_t firstElement = (firstChunk + i) * chunkSize;
+			size_t byteCount = static_cast<size_t>(std::min(chunkSize, elementCount64 - firstElement) * elementSize);
+			if (!EncodeChunk(data + firstElement * elementSize, byteCount, elementSize, componentSize, compression, encodedChunks[i]))
+			{
+				success = false;
+			}
+		};
+
+#ifdef CC_CORE_LIB_USES_TBB
+		tbb::parallel_for(0, stepChunkCount, encodeChunk);
+#else
+#if defined(_OPENMP)
+		#pragma omp parallel for num_threads(omp_get_max_threads())
+#endif
+		for (int i = 0; i < stepChunkCount; ++i)
+		{
+			encodeChunk(i);
+		}
+#endif
+
+		if (!success)
+		{
+			return ccSerializableObject::MemoryError();
+		}
+
+		for (int i = 0; i < stepChunkCount; ++i)
+		{
+			if (!WriteRawData(out, encodedChunks[i].constData(), encodedChunks[i].size()))
+				return ccSerializableObject::WriteError();
+			chunkByteCounts[firstChunk + i] = static_cast<::uint64_t>(encodedChunks[i].size());
+			encodedChunks[i].clear();
+		}
+	}
+
+	//now we can fill the chunk table
+	qint64 endPos = out.pos();
+	if (	!out.seek(chunkTablePos)
+		||	out.write((const char*)chunkByteCounts.data(), static_cast<qint64>(chunkCount * 8)) < 0
+		||	!out.seek(endPos) )
+	{
+		return ccSerializableObject::WriteError();
+	}
+
+	return true;
+}
+
+bool ccSerializationHelper::ReadArrayHeader(QFile& in,
+											short dataVersion,
+											size_t fileElementSize,
+											ArrayHeader& header)
+{
+	assert(in.isOpen() && (in.openMode() & QIODevice::ReadOnly));
+
+	if (dataVersion < 20)
+		return ccSerializableObject::CorruptError();
+
+	header = ArrayHeader();
+
+	//component count (dataVersion>=20)
+	if (in.read((char*)&header.componentCount, 1) < 0)
+		return ccSerializableObject::ReadError();
+
+	if (dataVersion < 55)
+	{
+		//element count = array size (dataVersion>=20)
+		::uint32_t elementCount32 = 0;
+		if (in.read((char*)&elementCount32, 4) < 0)
+			return ccSerializableObject::ReadError();
+		header.elementCount = elementCount32;
+	}
+	else
+	{
+		//element count = array size (dataVersion>=55)
+		if (in.read((char*)&header.elementCount, 8) < 0)
+			return ccSerializableObject::ReadError();
+		if (header.elementCount > std::numeric_limits<size_t>::max() / fileElementSize)
+			return ccSerializableObject::CorruptError();
+
+		//compression (dataVersion>=56)
+		if (dataVersion >= 56)
+		{
+			::uint8_t compressionCode = 0;
+			if (in.read((char*)&compressionCode, 1) < 0)
+				return ccSerializableObject::ReadError();
+			if (compressionCode > static_cast<::uint8_t>(ArrayCompression::DELTA))
+				return ccSerializableObject::CorruptError();
+			header.compression = static_cast<ArrayCompression>(compressionCode);
+		}
+
+		//chunk size (dataVersion>=55)
+		::uint64_t chunkSize = 0;
+		if (in.read((char*)&chunkSize, 8) < 0)
+			return ccSerializableObject::ReadError();
+
+		//chunk table (dataVersion>=55)
+		if (chunkSize != 0 && header.elementCount != 0)
+		{
+			header.chunkSize = std::min(chunkSize, header.elementCount);
+			::uint64_t chunkCount = header.chunkCount();
+			if (chunkCount * 8 > static_cast<::uint64_t>(in.size() - in.pos()))
+				return ccSerializableObject::CorruptError();
+
+			try
+			{
+				header.chunkByteCounts.resize(static_cast<size_t>(chunkCount));
+			}
+			catch (const std::bad_alloc&)
+			{
+				return ccSerializableObject::MemoryError();
+			}
+			if (!ReadRawData(in, (char*)header.chunkByteCounts.data(), static_cast<qint64>(chunkCount * 8)))
+				return ccSerializableObject::ReadError();
+
+			::uint64_t totalByteCount = 0;
+			for (::uint64_t i = 0; i < chunkCount; ++i)
+			{
+				::uint64_t chunkByteCount = header.chunkByteCounts[i];
+				::uint64_t rawByteCount = std::min(header.chunkSize, header.elementCount - i * header.chunkSize) * fileElementSize;
+				if (header.compression == ArrayCompression::NONE ? chunkByteCount != rawByteCount
+																 : (chunkByteCount == 0 || chunkByteCount > static_cast<::uint64_t>(std::numeric_limits<int>::max()) || rawByteCount > static_cast<::uint64_t>(std::numeric_limits<int>::max())))
+				{
+					return ccSerializableObject::CorruptError();
+				}
+				totalByteCount += chunkByteCount;
+			}
+			if (totalByteCount > static_cast<::uint64_t>(in.size() - in.pos()))
+				return ccSerializableObject::CorruptError();
+		}
+		else if (header.compression != ArrayCompression::NONE && header.elementCount != 0)
+		{
+			//compressed arrays always have a chunk table
+			return ccSerializableObject::CorruptError();
+		}
+	}
+
+	if (header.chunkSize == 0)
+	{
+		//raw data are read by 'virtual' chunks
+		header.chunkSize = std::max<::uint64_t>(1, static_cast<::uint64_t>(MaxChunkByteSize) / fileElementSize);
+	}
+
+	return true;
+}
+
+bool ccSerializationHelper::ReadArrayData(	QFile& in,
+											const ArrayHeader& header,
+											size_t fileElementSize,
+											size_t fileComponentSize,
+											::uint64_t firstChunk,
+											::uint64_t chunkCount,
+											char* data)
+{
+	assert(firstChunk + chunkCount <= header.chunkCount());
+
+	::uint64_t firstElement = firstChunk * header.chunkSize;
+	::uint64_t lastElement = std::min(header.elementCount, (firstChunk + chunkCount) * header.chunkSize);
+
+	if (header.compression == ArrayCompression::NONE)
+	{
+		if (!ReadRawData(in, data, static_cast<qint64>((lastElement - firstElement) * fileElementSize)))
+			return ccSerializableObject::ReadError();
+
+		return true;
+	}
+
+	std::vector<char> encodedData;
+	std::vector<qint64> encodedOffsets;
+	for (::uint64_t stepFirstChunk = firstChunk; stepFirstChunk < firstChunk + chunkCount; stepFirstChunk += s_compressedChunkCountPerStep)
+	{
+		int stepChunkCount = static_cast<int>(std::min<::uint64_t>(s_compressedChunkCountPerStep, firstChunk + chunkCount - stepFirstChunk));
+
+		try
+		{
+			encodedOffsets.resize(stepChunkCount + 1);
+			encodedOffsets[0] = 0;
+			for (int i = 0; i < stepChunkCount; ++i)
+			{
+				encodedOffsets[i + 1] = encodedOffsets[i] + static_cast<qint64>(header.chunkByteCounts[stepFirstChunk + i]);
+			}
+			encodedData.resize(static_cast<size_t>(encodedOffsets.back()));
+		}
+		catch (const std::bad_alloc&)
+		{
+			return ccSerializableObject::MemoryError();
+		}
+
+		if (!ReadRawData(in, encodedData.data(), encodedOffsets.back()))
+			return ccSerializableObject::ReadError();
+
+		std::atomic<bool> success(true);
+		auto decodeChunk = [&](int i)
+		{
+			::uint64_t chunkFirstElement = (stepFirstChunk + i) * header.chunkSize;
+			size_t byteCount = static_cast<size_t>(std::min(header.chunkSize, header.elementCount - chunkFirstElement) * fileElementSize);
+			if (!DecodeChunk(	encodedData.data() + encodedOffsets[i],
+								header.chunkByteCounts[stepFirstChunk + i],
+								data + (chunkFirstElement - firstElement) * fileElementSize,
+								byteCount,
+								fileElementSize,
+								fileComponentSize,
+								header.compression))
+			{
+				success = false;
+			}
+		};
+
+#ifdef CC_CORE_LIB_USES_TBB
+		tbb::parallel_for(0, stepChunkCount, decodeChunk);
+#else
+#if defined(_OPENMP)
+		#pragma omp parallel for num_threads(omp_get_max_threads())
+#endif
+		for (int i = 0; i < stepChunkCount; ++i)
+		{
+			decodeChunk(i);
+		}
+#endif
+
+		if (!success)
+		{
+			return ccSerializableObject::CorruptError();
+		}
+	}
+
+	return true;
+}
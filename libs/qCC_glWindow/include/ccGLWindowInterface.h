@@ -24,6 +24,7 @@
 #include <ccGenericGLDisplay.h>
 #include <ccGLUtils.h>
 #include <ccBBox.h>
+#include <ccRenderScheduler.h>
 
 //qCC
 #include "ccGuiParameters.h"
@@ -1250,6 +1251,9 @@ protected: //members
 	//! LOD refresh signal should be ignored
 	bool m_LODPendingIgnore;
 
+	//! Scene-level render scheduler (point budget mode)
+	ccRenderScheduler m_renderScheduler;
+
 	//! Internal timer
 	QElapsedTimer m_timer;
 
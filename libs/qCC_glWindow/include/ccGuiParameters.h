@@ -78,6 +78,10 @@ public:
 		bool decimateCloudOnMove;
 		//! Min cloud size for decimation
 		unsigned minLoDCloudSize;
+		//! Whether to display a fixed number of points per frame (LOD point budget)
+		bool usePointBudget;
+		//! Number of points displayed per frame (point budget mode)
+		unsigned pointBudget;
 		//! Display cross in the middle of the screen
 		bool displayCross;
 		//! Whether to use VBOs for faster display
@@ -1756,6 +1756,7 @@ void ccGLWindowInterface::getContext(CC_DRAW_CONTEXT& CONTEXT)
 	CONTEXT.higherLODLevelsAvailable = false;
 	CONTEXT.moreLODPointsAvailable = false;
 	CONTEXT.currentLODLevel = 0;
+	CONTEXT.pendingVBOUpdates = false;
 
 	//scalar field color-bar
 	CONTEXT.sfColorScaleToDisplay = nullptr;
@@ -4719,6 +4720,13 @@ void ccGLWindowInterface::doPaintGL()
 			//just in case
 			m_LODPendingRefresh = false;
 		}
+
+		//some VBOs are still being updated (asynchronously)
+		if (CONTEXT.pendingVBOUpdates && !m_currentLODState.inProgress)
+		{
+			static const int vboUpdateRefreshTime_ms = 20;
+			QTimer::singleShot(vboUpdateRefreshTime_ms, [&]() { redraw(); });
+		}
 	}
 #ifdef DEBUG_TIMINGS
 	debugTimings.push_back(m_timer.nsecsElapsed());
@@ -4884,6 +4892,41 @@ void ccGLWindowInterface::draw3D(CC_DRAW_CONTEXT& CONTEXT, RenderingParams& rend
 		}
 	}
 
+	//point budget mode: all the displayed clouds and meshes are registered first, so that the
+	//point and triangle budgets can be shared globally and the entities drawn front to back
+	//(see ccRenderScheduler)
+	if (	MACRO_LODActivated(CONTEXT)
+		&&	CONTEXT.decimateCloudOnMove
+		&&	getDisplayParameters().usePointBudget)
+	{
+		CONTEXT.renderScheduler = &m_renderScheduler;
+		CONTEXT.lodPointBudget = &m_renderScheduler.lodPointBudget();
+
+		if (renderingParams.pass == MONO_OR_LEFT_RENDERING_PASS) //the second pass uses the same budgets
+		{
+			//the entities can only be re-ordered if the modelview matrix is the same for the whole frame
+			//(i.e. not in stereo mode) and if they are all redrawn (i.e. not for the next LOD levels)
+			bool frontToBack = (!m_stereoModeEnabled && CONTEXT.currentLODLevel == 0);
+			m_renderScheduler.reset(getDisplayParameters().pointBudget, CONTEXT.minLODTriangleCount, frontToBack);
+
+			CONTEXT.drawingFlags |= CC_SCHEDULING_PASS;
+			if (m_globalDBRoot)
+			{
+				m_globalDBRoot->draw(CONTEXT);
+			}
+			if (m_winDBRoot)
+			{
+				m_winDBRoot->draw(CONTEXT);
+			}
+			CONTEXT.drawingFlags &= (~CC_SCHEDULING_PASS);
+
+			m_renderScheduler.dispatch();
+		}
+
+		//the scheduled entities are drawn first (front to back)
+		m_renderScheduler.drawEntities(CONTEXT);
+	}
+
 	//we draw 3D entities
 	if (m_globalDBRoot)
 	{
@@ -4954,6 +4997,8 @@ void ccGLWindowInterface::draw3D(CC_DRAW_CONTEXT& CONTEXT, RenderingParams& rend
 	//reset context
 	CONTEXT.colorRampShader = nullptr;
 	CONTEXT.customRenderingShader = nullptr;
+	CONTEXT.lodPointBudget = nullptr;
+	CONTEXT.renderScheduler = nullptr;
 
 	//we disable shader (if any)
 	if (m_activeShader)
@@ -4996,6 +5041,12 @@ void ccGLWindowInterface::fullRenderingPass(CC_DRAW_CONTEXT& CONTEXT, RenderingP
 		diagStrings << QString("FBO2 %1").arg(m_fbo2 && renderingParams.useFBO ? "ON" : "OFF");
 		diagStrings << QString("GL filter %1").arg(m_fbo && renderingParams.useFBO && m_activeGLFilter ? "ON" : "OFF");
 		diagStrings << QString("LOD %1 (level %2)").arg(m_currentLODState.inProgress ? "ON" : "OFF").arg(m_currentLODState.level);
+		if (getDisplayParameters().usePointBudget)
+		{
+			const ccLODPointBudget& pointBudget = m_renderScheduler.lodPointBudget();
+			diagStrings << QString("Point budget: %1 / %2").arg(pointBudget.displayedPoints()).arg(pointBudget.pointBudget());
+			diagStrings << QString("Scheduled entities: %1 (decimated triangles: %2)").arg(m_renderScheduler.entityCount()).arg(m_renderScheduler.displayedTriangles());
+		}
 	}
 
 	ccQOpenGLFunctions* glFunc = functions();
@@ -84,6 +84,8 @@ void ccGui::ParamStruct::reset()
 	minLoDMeshSize				= 2500000;
 	decimateCloudOnMove			= true;
 	minLoDCloudSize				= 50000000;
+	usePointBudget				= false;
+	pointBudget					= 5000000;
 	useVBOs						= true;
 	displayCross				= true;
 	pickingCursorShape			= Qt::CrossCursor;
@@ -141,6 +143,8 @@ void ccGui::ParamStruct::fromPersistentSettings()
 	minLoDMeshSize				=                                      settings.value("minLoDMeshSize",       2500000 ).toUInt();
 	decimateCloudOnMove			=                                      settings.value("cloudDecimation",         true ).toBool();
 	minLoDCloudSize				=                                      settings.value("minLoDCloudSize",     50000000 ).toUInt();
+	usePointBudget				=                                      settings.value("usePointBudget",          false).toBool();
+	pointBudget					=                                      settings.value("pointBudget",          5000000 ).toUInt();
 	useVBOs						=                                      settings.value("useVBOs",                 true ).toBool();
 	displayCross				=                                      settings.value("crossDisplayed",          true ).toBool();
 	labelMarkerSize				= static_cast<unsigned>(std::max(0,    settings.value("labelMarkerSize",         5    ).toInt()));
@@ -183,6 +187,8 @@ void ccGui::ParamStruct::toPersistentSettings() const
 	settings.setValue("minLoDMeshSize",	          minLoDMeshSize);
 	settings.setValue("cloudDecimation",          decimateCloudOnMove);
 	settings.setValue("minLoDCloudSize",	      minLoDCloudSize);
+	settings.setValue("usePointBudget",           usePointBudget);
+	settings.setValue("pointBudget",              pointBudget);
 	settings.setValue("useVBOs",                  useVBOs);
 	settings.setValue("crossDisplayed",           displayCross);
 	settings.setValue("labelMarkerSize",          labelMarkerSize);
@@ -90,4 +90,22 @@ protected:
 													double quaternionScale,
 													LoadParameters& parameters,
 													bool showLabelsIn2D = false);
+
+	//! Loads raw (8 bits) ASCII data with a predefined format
+	/** Fast path of loadCloudFromFormatedAsciiStream: the lines are parsed
+		in parallel, directly from the input buffer (no QString conversion).
+		Quaternions and labels are not supported. The input buffer must be
+		8 bits data, without BOM.
+	**/
+	CC_FILE_ERROR loadCloudFromFormatedAsciiBuffer(	const char* data,
+													qint64 dataSize,
+													QString filenameOrTitle,
+													ccHObject& container,
+													const AsciiOpenDlg::Sequence& openSequence,
+													char separator,
+													bool commaAsDecimal,
+													unsigned approximateNumberOfLines,
+													unsigned maxCloudSize,
+													unsigned skipLines,
+													LoadParameters& parameters);
 };
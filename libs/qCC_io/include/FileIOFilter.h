@@ -25,6 +25,7 @@
 #include "ccGlobalShiftManager.h"
 
 class QWidget;
+class ccPointCloud;
 
 //! Typical I/O filter errors
 enum CC_FILE_ERROR {CC_FERR_NO_ERROR,
@@ -57,6 +58,51 @@ class FileIOFilter
 public:
 	virtual ~FileIOFilter() = default;
 	
+	//! Points filter applied at loading time
+	/** Only supported by some filters (e.g. LAS). Only the points satisfying
+		all the active criteria are loaded. Coordinates are expressed in the
+		file coordinate system (i.e. before any Global Shift is applied).
+	**/
+	struct PointsFilter
+	{
+		//! Default constructor
+		PointsFilter()
+			: useBox(false)
+			, boxMin(0, 0)
+			, boxMax(0, 0)
+			, useGpsTimeRange(false)
+			, minGpsTime(0.0)
+			, maxGpsTime(0.0)
+			, useSpatialIndex(true)
+		{}
+
+		//! Returns whether at least one criterion is active
+		inline bool isActive() const { return hasSpatialCriterion() || !classifications.empty() || !returnNumbers.empty() || useGpsTimeRange; }
+		//! Returns whether a spatial (2D) criterion is active
+		inline bool hasSpatialCriterion() const { return useBox || polygon.size() >= 3; }
+
+		//! Whether to only keep the points inside a 2D (XY) box
+		bool useBox;
+		//! 2D box min corner
+		CCVector2d boxMin;
+		//! 2D box max corner
+		CCVector2d boxMax;
+		//! 2D (XY) polygon inside which points are kept (ignored if less than 3 vertices)
+		std::vector<CCVector2d> polygon;
+		//! Classification values to keep (all if empty)
+		std::vector<int> classifications;
+		//! Return numbers to keep (all if empty)
+		std::vector<int> returnNumbers;
+		//! Whether to only keep the points inside a GPS time range
+		bool useGpsTimeRange;
+		//! GPS time range min (inclusive)
+		double minGpsTime;
+		//! GPS time range max (inclusive)
+		double maxGpsTime;
+		//! Whether a spatial index can be used (and created if necessary) to skip the points outside of the spatial criterion
+		bool useSpatialIndex;
+	};
+
 	//! Generic loading parameters
 	struct LoadParameters
 	{
@@ -88,6 +134,8 @@ public:
 		QWidget* parentWidget;
 		//! Session start (whether the load action is the first of a session)
 		bool sessionStart;
+		//! Points filter (optional, only supported by some filters)
+		PointsFilter pointsFilter;
 	};
 	
 	//! Generic saving parameters
@@ -105,6 +153,49 @@ public:
 		QWidget* parentWidget;
 	};
 	
+	//! Streamed (block by block) cloud reader
+	/** Used to process clouds that don't fit in memory (see createStreamedReader).
+		All the blocks have the same structure (scalar fields, colors, etc.)
+		and the same Global Shift.
+	**/
+	class StreamedReader
+	{
+	public:
+		virtual ~StreamedReader() = default;
+
+		//! Returns the total number of points in the file
+		virtual qint64 pointCount() const = 0;
+
+		//! Reads the next block of points
+		/** \param block empty cloud to fill
+			\param maxCount maximum number of points to read
+			\return error (an empty block without error means that all the points have been read)
+		**/
+		virtual CC_FILE_ERROR readBlock(ccPointCloud& block, unsigned maxCount) = 0;
+
+		//! Shared type
+		using Shared = QSharedPointer<StreamedReader>;
+	};
+
+	//! Streamed (block by block) cloud writer
+	/** See createStreamedWriter. All the blocks must have the
+		same structure (scalar fields, colors, etc.) as the first one.
+	**/
+	class StreamedWriter
+	{
+	public:
+		virtual ~StreamedWriter() = default;
+
+		//! Writes a block of points
+		virtual CC_FILE_ERROR writeBlock(ccPointCloud& block) = 0;
+
+		//! Finalizes the file (once all the blocks have been written)
+		virtual CC_FILE_ERROR close() = 0;
+
+		//! Shared type
+		using Shared = QSharedPointer<StreamedWriter>;
+	};
+
 	//! Shared type
 	using Shared = QSharedPointer<FileIOFilter>;
 	
@@ -164,6 +255,42 @@ public: //public interface (to be reimplemented by each I/O filter)
 		return CC_FERR_NOT_IMPLEMENTED;
 	}
 	
+	//! Opens a cloud file to read its points block by block
+	/** Optional: only some filters support streamed reading.
+		\param filename file to read
+		\param parameters generic loading parameters
+		\param[out] result error
+		\return the reader (or a null pointer if an error occurred)
+	**/
+	virtual StreamedReader::Shared createStreamedReader(const QString& filename,
+														LoadParameters& parameters,
+														CC_FILE_ERROR& result)
+	{
+		Q_UNUSED( filename );
+		Q_UNUSED( parameters );
+		
+		result = CC_FERR_NOT_IMPLEMENTED;
+		return {};
+	}
+	
+	//! Creates a cloud file to write its points block by block
+	/** Optional: only some filters support streamed writing.
+		\param filename file to write
+		\param parameters generic saving parameters
+		\param[out] result error
+		\return the writer (or a null pointer if an error occurred)
+	**/
+	virtual StreamedWriter::Shared createStreamedWriter(const QString& filename,
+														const SaveParameters& parameters,
+														CC_FILE_ERROR& result)
+	{
+		Q_UNUSED( filename );
+		Q_UNUSED( parameters );
+		
+		result = CC_FERR_NOT_IMPLEMENTED;
+		return {};
+	}
+	
 	//! Returns whether this I/O filter can save the specified type of entity
 	/** \param type entity type
 		\param multiple whether the filter can save multiple instances of this entity at once
@@ -236,6 +363,14 @@ public: //static methods
 													const SaveParameters& parameters,
 													const QString& fileFilter);
 	
+	//! Writes a block of a streamed cloud with a given writer
+	/** As with SaveToFile, the deferred transformation of the block (if any) is applied first.
+		\param writer streamed writer
+		\param block block of points
+		eturn error type (if any)
+	**/
+	QCC_IO_LIB_API static CC_FILE_ERROR WriteStreamedBlock(StreamedWriter& writer, ccPointCloud& block);
+	
 	//! Shortcut to the ccGlobalShiftManager mechanism specific for files
 	/** \param[in] P sample point (typically the first loaded)
 		\param[out] Pshift global shift
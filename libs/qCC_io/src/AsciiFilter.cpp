@@ -18,10 +18,13 @@
 #include "AsciiFilter.h"
 
 //Qt
+#include <QBuffer>
 #include <QFile>
 #include <QFileInfo>
 #include <QSharedPointer>
 #include <QTextStream>
+#include <QThread>
+#include <QtConcurrentMap>
 
 //CClib
 #include <ScalarField.h>
@@ -36,8 +39,11 @@
 #include <ccCoordinateSystem.h>
 
 //System
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstring>
+#include <limits>
 
 //Qt
 #include <QScopedPointer>
@@ -112,6 +118,175 @@ bool AsciiFilter::canSave(CC_CLASS_ENUM type, bool& multiple, bool& exclusive) c
 	return false;
 }
 
+//! Powers of 10 that can be exactly represented by a double
+static const double s_exactPowersOf10[] = {	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+											1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+											1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+//! Number of points formatted at once by a single thread (see AsciiFilter::saveToFile)
+static const unsigned s_asciiSaveBlockSize = 16384;
+
+//! Appends an unsigned integer to a text buffer
+static inline void AppendUInt(std::string& buffer, uint64_t value, int minDigitCount = 1)
+{
+	char digits[24];
+	int digitCount = 0;
+	do
+	{
+		digits[digitCount++] = static_cast<char>('0' + value % 10);
+		value /= 10;
+	}
+	while (value != 0);
+	while (digitCount < minDigitCount)
+	{
+		digits[digitCount++] = '0';
+	}
+
+	while (digitCount != 0)
+	{
+		buffer.push_back(digits[--digitCount]);
+	}
+}
+
+//! Appends a value with a fixed number of decimals to a text buffer
+/** Same output as QString::number(value, 'f', precision). Most values are
+	converted with integer arithmetic, the others (large values, high precisions,
+	values too close to a rounding tie or negative values rounded to zero) are
+	delegated to Qt.
+**/
+static void AppendFixed(std::string& buffer, double value, int precision)
+{
+	if (precision >= 0 && precision <= 15)
+	{
+		double scaled = std::abs(value) * s_exactPowersOf10[precision];
+		if (scaled < 9007199254740992.0) //2^53 (also rejects NaN and infinite values)
+		{
+			double integral = std::floor(scaled);
+			double fraction = scaled - integral;
+			uint64_t rounded = static_cast<uint64_t>(integral) + (fraction > 0.5 ? 1 : 0);
+			//the product may be inexact (by half an ulp at most): we must not be too close to a tie
+			//(the sign of negative values rounded to zero is also left to Qt)
+			if (std::abs(fraction - 0.5) > scaled * 4.0e-16 && (rounded != 0 || !std::signbit(value)))
+			{
+				if (value < 0)
+				{
+					buffer.push_back('-');
+				}
+				if (precision == 0)
+				{
+					AppendUInt(buffer, rounded);
+				}
+				else
+				{
+					auto decimalScale = static_cast<uint64_t>(s_exactPowersOf10[precision]);
+					AppendUInt(buffer, rounded / decimalScale);
+					buffer.push_back('.');
+					AppendUInt(buffer, rounded % decimalScale, precision);
+				}
+				return;
+			}
+		}
+	}
+
+	QByteArray text = QByteArray::number(value, 'f', precision);
+	buffer.append(text.constData(), static_cast<size_t>(text.size()));
+}
+
+//! Block of points formatted by a single thread (see AsciiFilter::saveToFile)
+struct AsciiPointBlock
+{
+	unsigned firstIndex = 0;
+	unsigned lastIndex = 0;
+	std::string text;
+};
+
+//! Output format of each point (see AsciiFilter::saveToFile)
+struct AsciiPointFormat
+{
+	const ccGenericPointCloud* cloud = nullptr;
+	std::vector<ccScalarField*> scalarFields;
+	char separator = ' ';
+	int coordPrecision = 8;
+	int sfPrecision = 6;
+	int normalPrecision = 6;
+	bool writeColors = false;
+	bool writeNorms = false;
+	bool saveFloatColors = false;
+	bool saveAlphaChannel = false;
+	bool saveSFBeforeColor = false;
+
+	void appendColor(std::string& buffer, unsigned index) const
+	{
+		const ccColor::Rgba& col = cloud->getPointColor(index);
+		const ColorCompType components[4] = { col.r, col.g, col.b, col.a };
+		const unsigned componentCount = (saveAlphaChannel ? 4 : 3);
+		for (unsigned c = 0; c < componentCount; ++c)
+		{
+			buffer.push_back(separator);
+			if (saveFloatColors)
+			{
+				QByteArray text = QByteArray::number(static_cast<double>(components[c]) / ccColor::MAX);
+				buffer.append(text.constData(), static_cast<size_t>(text.size()));
+			}
+			else
+			{
+				AppendUInt(buffer, components[c]);
+			}
+		}
+	}
+
+	//! Formats a block of points (one line per point)
+	void format(AsciiPointBlock& block) const
+	{
+		block.text.clear();
+		block.text.reserve(static_cast<size_t>(block.lastIndex - block.firstIndex) * 64);
+
+		for (unsigned i = block.firstIndex; i < block.lastIndex; ++i)
+		{
+			std::string& line = block.text;
+
+			//write current point coordinates
+			CCVector3d Pglobal = cloud->toGlobal3d<PointCoordinateType>(*cloud->getPoint(i));
+			AppendFixed(line, Pglobal.x, coordPrecision);
+			line.push_back(separator);
+			AppendFixed(line, Pglobal.y, coordPrecision);
+			line.push_back(separator);
+			AppendFixed(line, Pglobal.z, coordPrecision);
+
+			if (writeColors && !saveSFBeforeColor)
+			{
+				appendColor(line, i);
+			}
+
+			//add each associated SF values
+			for (const ccScalarField* sf : scalarFields)
+			{
+				line.push_back(separator);
+				AppendFixed(line, sf->getGlobalShift() + sf->getValue(i), sfPrecision);
+			}
+
+			if (writeColors && saveSFBeforeColor)
+			{
+				appendColor(line, i);
+			}
+
+			if (writeNorms)
+			{
+				//add normal vector
+				const CCVector3& N = cloud->getPointNormal(i);
+				line.push_back(separator);
+				AppendFixed(line, N.x, normalPrecision);
+				line.push_back(separator);
+				AppendFixed(line, N.y, normalPrecision);
+				line.push_back(separator);
+				AppendFixed(line, N.z, normalPrecision);
+			}
+
+			line.push_back('\n');
+		}
+	}
+};
+
 CC_FILE_ERROR AsciiFilter::saveToFile(ccHObject* entity, const QString& filename, const SaveParameters& parameters)
 {
 	assert(entity && !filename.isEmpty());
@@ -214,7 +389,6 @@ CC_FILE_ERROR AsciiFilter::saveToFile(ccHObject* entity, const QString& filename
 	QFile file(filename);
 	if (!file.open(QFile::WriteOnly | QFile::Truncate))
 		return CC_FERR_WRITING;
-	QTextStream stream(&file);
 
 	ccGenericPointCloud* cloud = ccHObjectCaster::ToGenericPointCloud(entity);
 
@@ -239,7 +413,6 @@ CC_FILE_ERROR AsciiFilter::saveToFile(ccHObject* entity, const QString& filename
 		pDlg->setInfo(QObject::tr("Number of points: %1").arg(numberOfPoints));
 		pDlg->start();
 	}
-	CCCoreLib::NormalizedProgress nprogress(pDlg.data(), numberOfPoints);
 
 	//non static parameters
 	int normalPrecision = 2 + sizeof(PointCoordinateType);
@@ -308,102 +481,81 @@ CC_FILE_ERROR AsciiFilter::saveToFile(ccHObject* entity, const QString& filename
 			header.append(AsciiHeaderColumns::Nz());
 		}
 		
-		stream << header << "\n";
+		header.append('\n');
+		file.write(header.toLocal8Bit());
 	}
 
 	if (s_savePointCountHeader)
 	{
-		stream << QString::number(numberOfPoints) << "\n";
+		file.write(QByteArray::number(numberOfPoints) + '\n');
 	}
 
-	CC_FILE_ERROR result = CC_FERR_NO_ERROR;
-	for (unsigned i = 0; i < numberOfPoints; ++i)
+	AsciiPointFormat format;
+	format.cloud = cloud;
+	format.scalarFields = theScalarFields;
+	format.separator = separator.toLatin1();
+	format.coordPrecision = s_outputCoordPrecision;
+	format.sfPrecision = s_outputSFPrecision;
+	format.normalPrecision = normalPrecision;
+	format.writeColors = writeColors;
+	format.writeNorms = writeNorms;
+	format.saveFloatColors = saveFloatColors;
+	format.saveAlphaChannel = saveAlphaChannel;
+	format.saveSFBeforeColor = s_saveSFBeforeColor;
+
+	//the points are formatted by blocks, in parallel, while the previous blocks are written (in order)
+	const unsigned blockCountPerWave = static_cast<unsigned>(std::max(1, QThread::idealThreadCount())) * 2;
+	unsigned nextIndex = 0;
+	auto prepareWave = [&](std::vector<AsciiPointBlock>& wave)
 	{
-		//line for the current point
-		QString line;
-
-		//write current point coordinates
-		const CCVector3* P = cloud->getPoint(i);
-		CCVector3d Pglobal = cloud->toGlobal3d<PointCoordinateType>(*P);
-		line.append(QString::number(Pglobal.x, 'f', s_outputCoordPrecision));
-		line.append(separator);
-		line.append(QString::number(Pglobal.y, 'f', s_outputCoordPrecision));
-		line.append(separator);
-		line.append(QString::number(Pglobal.z, 'f', s_outputCoordPrecision));
-
-		QString colorLine;
-		if (writeColors)
+		wave.clear();
+		while (wave.size() < blockCountPerWave && nextIndex < numberOfPoints)
 		{
-			//add rgb color
-			const ccColor::Rgba& col = cloud->getPointColor(i);
-			if (saveFloatColors)
-			{
-				colorLine.append(separator);
-				colorLine.append(QString::number(static_cast<double>(col.r) / ccColor::MAX));
-				colorLine.append(separator);
-				colorLine.append(QString::number(static_cast<double>(col.g) / ccColor::MAX));
-				colorLine.append(separator);
-				colorLine.append(QString::number(static_cast<double>(col.b) / ccColor::MAX));
-				if (saveAlphaChannel)
-				{
-					colorLine.append(separator);
-					colorLine.append(QString::number(static_cast<double>(col.a) / ccColor::MAX));
-				}
-			}
-			else
-			{
-				colorLine.append(separator);
-				colorLine.append(QString::number(col.r));
-				colorLine.append(separator);
-				colorLine.append(QString::number(col.g));
-				colorLine.append(separator);
-				colorLine.append(QString::number(col.b));
-				if (saveAlphaChannel)
-				{
-					colorLine.append(separator);
-					colorLine.append(QString::number(col.a));
-				}
-			}
-
-			if (!s_saveSFBeforeColor)
-			{
-				line.append(colorLine);
-			}
+			AsciiPointBlock block;
+			block.firstIndex = nextIndex;
+			block.lastIndex = nextIndex + std::min(s_asciiSaveBlockSize, numberOfPoints - nextIndex);
+			wave.push_back(block);
+			nextIndex = block.lastIndex;
 		}
+	};
+	auto formatBlock = [&format](AsciiPointBlock& block) { format.format(block); };
 
-		if (writeSF)
+	std::vector<AsciiPointBlock> currentWave;
+	std::vector<AsciiPointBlock> nextWave;
+	prepareWave(currentWave);
+	QtConcurrent::blockingMap(currentWave, formatBlock);
+
+	CC_FILE_ERROR result = CC_FERR_NO_ERROR;
+	while (!currentWave.empty())
+	{
+		prepareWave(nextWave);
+		QFuture<void> future = QtConcurrent::map(nextWave, formatBlock);
+
+		for (const AsciiPointBlock& block : currentWave)
 		{
-			//add each associated SF values
-			for (std::vector<ccScalarField*>::const_iterator it = theScalarFields.begin(); it != theScalarFields.end(); ++it)
+			if (file.write(block.text.data(), static_cast<qint64>(block.text.size())) != static_cast<qint64>(block.text.size()))
 			{
-				line.append(separator);
-				double sfVal = (*it)->getGlobalShift() + (*it)->getValue(i);
-				line.append(QString::number(sfVal, 'f', s_outputSFPrecision));
+				result = CC_FERR_WRITING;
+				break;
 			}
 		}
 
-		if (writeColors && s_saveSFBeforeColor)
-			line.append(colorLine);
+		future.waitForFinished();
 
-		if (writeNorms)
+		if (pDlg && result == CC_FERR_NO_ERROR)
 		{
-			//add normal vector
-			const CCVector3& N = cloud->getPointNormal(i);
-			line.append(separator);
-			line.append(QString::number(N.x, 'f', normalPrecision));
-			line.append(separator);
-			line.append(QString::number(N.y, 'f', normalPrecision));
-			line.append(separator);
-			line.append(QString::number(N.z, 'f', normalPrecision));
+			pDlg->update(100.0f * currentWave.back().lastIndex / numberOfPoints);
+			if (pDlg->isCancelRequested())
+			{
+				result = CC_FERR_CANCELED_BY_USER;
+			}
 		}
-
-		stream << line << "\n";
-
-		if (pDlg && !nprogress.oneStep())
+		if (result != CC_FERR_NO_ERROR)
 		{
-			result = CC_FERR_CANCELED_BY_USER;
 			break;
 		}
+
+		std::swap(currentWave, nextWave);
 	}
 
 	return result;
@@ -482,6 +634,73 @@ CC_FILE_ERROR AsciiFilter::loadStream(	QTextStream& stream,
 	bool showLabelsIn2D = openDialog.showLabelsIn2D();
 	double quaternionScale = openDialog.getQuaternionScale();
 
+	//fast path: the raw data is parsed directly (and in parallel)
+	//if it's accessible and there's no quaternion nor label to load
+	bool rawDataCanBeParsed = true;
+	for (const AsciiOpenDlg::SequenceItem& item : openSequence)
+	{
+		if (item.type == ASCII_OPEN_DLG_Label || (item.type >= ASCII_OPEN_DLG_QuatW && item.type <= ASCII_OPEN_DLG_QuatZ))
+		{
+			rawDataCanBeParsed = false;
+			break;
+		}
+	}
+	if (rawDataCanBeParsed)
+	{
+		const char* rawData = nullptr;
+		qint64 rawDataSize = 0;
+		QFile* file = qobject_cast<QFile*>(stream.device());
+		uchar* mappedData = nullptr;
+		if (file)
+		{
+			//the file is mapped in memory (if possible)
+			mappedData = file->map(0, file->size());
+			if (mappedData)
+			{
+				rawData = reinterpret_cast<const char*>(mappedData);
+				rawDataSize = file->size();
+			}
+		}
+		else if (QBuffer* buffer = qobject_cast<QBuffer*>(stream.device()))
+		{
+			rawData = buffer->data().constData();
+			rawDataSize = buffer->data().size();
+		}
+
+		//the UTF-8 BOM is skipped (as the text stream does)
+		if (rawData && rawDataSize >= 3 && memcmp(rawData, "\xEF\xBB\xBF", 3) == 0)
+		{
+			rawData += 3;
+			rawDataSize -= 3;
+		}
+
+		//UTF-16 data can't be parsed directly
+		if (rawData && !(rawDataSize >= 2 && (memcmp(rawData, "\xFF\xFE", 2) == 0 || memcmp(rawData, "\xFE\xFF", 2) == 0)))
+		{
+			CC_FILE_ERROR result = loadCloudFromFormatedAsciiBuffer(rawData,
+																	rawDataSize,
+																	filenameOrTitle,
+																	container,
+																	openSequence,
+																	separator,
+																	commaAsDecimal,
+																	approximateNumberOfLines,
+																	maxCloudSize,
+																	skipLineCount,
+																	parameters);
+			if (mappedData)
+			{
+				file->unmap(mappedData);
+			}
+			return result;
+		}
+
+		if (mappedData)
+		{
+			file->unmap(mappedData);
+		}
+	}
+
 	return loadCloudFromFormatedAsciiStream(stream,
 											filenameOrTitle,
 											container,
@@ -1189,3 +1408,628 @@ CC_FILE_ERROR AsciiFilter::loadCloudFromFormatedAsciiStream(QTextStream& stream,
 
 	return result;
 }
+
+//! Part of a line (see SplitLine)
+struct AsciiPart
+{
+	const char* begin;
+	const char* end;
+};
+
+//! Range of lines parsed by a single thread (see AsciiFilter::loadCloudFromFormatedAsciiBuffer)
+struct AsciiLineRange
+{
+	const char* begin = nullptr;
+	const char* end = nullptr;
+	//! Number of lines in the range
+	unsigned lineCount = 0;
+
+	//! Points (global coordinates)
+	std::vector<CCVector3d> points;
+	std::vector<CCVector3> normals;
+	std::vector<ccColor::Rgba> colors;
+	//! Scalar values (interleaved)
+	std::vector<ScalarType> scalars;
+	//! Corrupted lines (local index, number of parts or -1 if a non numerical value was found)
+	std::vector<std::pair<unsigned, int>> corruptedLines;
+	//! Whether the buffers couldn't be allocated
+	bool memoryError = false;
+
+	void clear()
+	{
+		lineCount = 0;
+		points.clear();
+		normals.clear();
+		colors.clear();
+		scalars.clear();
+		corruptedLines.clear();
+		memoryError = false;
+	}
+};
+
+//! Parsing parameters shared by all the ranges
+struct AsciiParsingContext
+{
+	const cloudAttributesDescriptor* desc = nullptr;
+	int maxPartIndex = -1;
+	char separator = ' ';
+	char decimalPoint = '.';
+	bool hasColors = false;
+};
+
+//! Default size of the ranges of lines parsed by each thread
+static const qint64 s_asciiRangeByteSize = (4 << 20); //4 Mb
+
+static inline bool IsSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+//! Returns the end of the current line (or the end of the data)
+static inline const char* FindLineEnd(const char* begin, const char* end)
+{
+	const char* lineEnd = static_cast<const char*>(memchr(begin, '\n', end - begin));
+	return lineEnd ? lineEnd : end;
+}
+
+//! Splits a line in parts
+/** Same behavior as QString::simplified().split(separator, QString::SkipEmptyParts).
+	Only the first parts.size() parts are stored.
+	\return the total number of parts
+**/
+static int SplitLine(const char* begin, const char* end, char separator, std::vector<AsciiPart>& parts)
+{
+	const size_t maxPartCount = parts.size();
+	int partCount = 0;
+
+	while (begin != end && IsSpace(*begin))
+		++begin;
+	while (end != begin && IsSpace(*(end - 1)))
+		--end;
+
+	if (IsSpace(separator))
+	{
+		while (begin != end)
+		{
+			const char* partBegin = begin;
+			while (begin != end && !IsSpace(*begin))
+				++begin;
+			if (static_cast<size_t>(partCount) < maxPartCount)
+				parts[partCount] = { partBegin, begin };
+			++partCount;
+			while (begin != end && IsSpace(*begin))
+				++begin;
+		}
+	}
+	else
+	{
+		const char* partBegin = begin;
+		for (const char* c = begin; ; ++c)
+		{
+			if (c == end || *c == separator)
+			{
+				if (c != partBegin)
+				{
+					if (static_cast<size_t>(partCount) < maxPartCount)
+					{
+						AsciiPart part{ partBegin, c };
+						while (part.begin != part.end && IsSpace(*part.begin))
+							++part.begin;
+						while (part.end != part.begin && IsSpace(*(part.end - 1)))
+							--part.end;
+						parts[partCount] = part;
+					}
+					++partCount;
+				}
+				if (c == end)
+					break;
+				partBegin = c + 1;
+			}
+		}
+	}
+
+	return partCount;
+}
+
+//! Converts a part of a line to a double
+/** Plain decimal values (the vast majority in practice) are converted directly
+	(this conversion is exact as long as the mantissa has less than 53 bits and
+	the exponent is small, see Clinger's fast path). Qt handles the other ones.
+	\return false (and value = 0) if the part is not a valid number
+**/
+static bool PartToDouble(const AsciiPart& part, char decimalPoint, double& value)
+{
+	const char* c = part.begin;
+	const char* end = part.end;
+
+	bool negative = false;
+	if (c != end && (*c == '-' || *c == '+'))
+	{
+		negative = (*c == '-');
+		++c;
+	}
+
+	uint64_t mantissa = 0;
+	int significantDigits = 0;
+	int exponent = 0;
+	bool hasDigits = false;
+	for (; c != end && *c >= '0' && *c <= '9'; ++c)
+	{
+		mantissa = mantissa * 10 + static_cast<unsigned>(*c - '0');
+		if (mantissa != 0)
+			++significantDigits;
+		hasDigits = true;
+	}
+	if (c != end && *c == decimalPoint)
+	{
+		for (++c; c != end && *c >= '0' && *c <= '9'; ++c)
+		{
+			mantissa = mantissa * 10 + static_cast<unsigned>(*c - '0');
+			if (mantissa != 0)
+				++significantDigits;
+			--exponent;
+			hasDigits = true;
+		}
+	}
+
+	bool fastPath = (hasDigits && significantDigits < 16);
+	if (fastPath && c != end && (*c == 'e' || *c == 'E'))
+	{
+		++c;
+		bool negativeExp = false;
+		if (c != end && (*c == '-' || *c == '+'))
+		{
+			negativeExp = (*c == '-');
+			++c;
+		}
+		int exp10 = 0;
+		bool hasExpDigits = false;
+		for (; c != end && *c >= '0' && *c <= '9'; ++c)
+		{
+			if (exp10 < 10000)
+				exp10 = exp10 * 10 + (*c - '0');
+			hasExpDigits = true;
+		}
+		exponent += (negativeExp ? -exp10 : exp10);
+		fastPath = hasExpDigits;
+	}
+
+	if (fastPath && c == end && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22)
+	{
+		value = static_cast<double>(mantissa);
+		value = (exponent < 0 ? value / s_exactPowersOf10[-exponent] : value * s_exactPowersOf10[exponent]);
+		if (negative)
+			value = -value;
+		return true;
+	}
+
+	//slow path
+	QByteArray buffer(part.begin, static_cast<int>(part.end - part.begin));
+	if (decimalPoint != '.')
+	{
+		if (buffer.contains('.'))
+		{
+			value = 0.0;
+			return false;
+		}
+		buffer.replace(decimalPoint, '.');
+	}
+	bool ok = false;
+	value = buffer.toDouble(&ok);
+	if (!ok)
+		value = 0.0;
+	return ok;
+}
+
+static inline double PartToDouble(const AsciiPart& part, char decimalPoint)
+{
+	double value = 0.0;
+	PartToDouble(part, decimalPoint, value);
+	return value;
+}
+
+//! Converts a part of a line to an integer (same behavior as QString::toInt)
+static int PartToInt(const AsciiPart& part)
+{
+	const char* c = part.begin;
+	bool negative = false;
+	if (c != part.end && (*c == '-' || *c == '+'))
+	{
+		negative = (*c == '-');
+		++c;
+	}
+	if (c == part.end)
+		return 0;
+
+	int64_t value = 0;
+	for (; c != part.end; ++c)
+	{
+		if (*c < '0' || *c > '9')
+			return 0;
+		value = value * 10 + (*c - '0');
+		if (value > (int64_t(1) << 31))
+			return 0;
+	}
+	if (negative)
+		value = -value;
+
+	return (value >= std::numeric_limits<int>::min() && value <= std::numeric_limits<int>::max() ? static_cast<int>(value) : 0);
+}
+
+//! Parses a single line (without the end of line character(s))
+static void ParseLine(const AsciiParsingContext& context, const char* begin, const char* end, std::vector<AsciiPart>& parts, AsciiLineRange& range)
+{
+	unsigned lineIndex = range.lineCount++;
+
+	if (begin == end || (end - begin >= 2 && begin[0] == '/' && begin[1] == '/'))
+	{
+		//empty lines and comments are ignored
+		return;
+	}
+
+	int partCount = SplitLine(begin, end, context.separator, parts);
+	if (partCount <= context.maxPartIndex)
+	{
+		range.corruptedLines.emplace_back(lineIndex, partCount);
+		return;
+	}
+
+	const cloudAttributesDescriptor& desc = *context.desc;
+	const char decimalPoint = context.decimalPoint;
+
+	//read the point coordinates
+	CCVector3d P(0, 0, 0);
+	if (	(desc.xCoordIndex >= 0 && !PartToDouble(parts[desc.xCoordIndex], decimalPoint, P.x))
+		||	(desc.yCoordIndex >= 0 && !PartToDouble(parts[desc.yCoordIndex], decimalPoint, P.y))
+		||	(desc.zCoordIndex >= 0 && !PartToDouble(parts[desc.zCoordIndex], decimalPoint, P.z)) )
+	{
+		range.corruptedLines.emplace_back(lineIndex, -1);
+		return;
+	}
+	range.points.push_back(P);
+
+	//Normal vector
+	if (desc.hasNorms)
+	{
+		CCVector3 N(0, 0, 0);
+		if (desc.xNormIndex >= 0)
+			N.x = static_cast<PointCoordinateType>(PartToDouble(parts[desc.xNormIndex], decimalPoint));
+		if (desc.yNormIndex >= 0)
+			N.y = static_cast<PointCoordinateType>(PartToDouble(parts[desc.yNormIndex], decimalPoint));
+		if (desc.zNormIndex >= 0)
+			N.z = static_cast<PointCoordinateType>(PartToDouble(parts[desc.zNormIndex], decimalPoint));
+		range.normals.push_back(N);
+	}
+
+	//Colors
+	if (desc.hasRGBColors)
+	{
+		ccColor::Rgba col(0, 0, 0, 255);
+		if (desc.iRgbaIndex >= 0 || desc.fRgbaIndex >= 0)
+		{
+			uint32_t rgba = 0;
+			if (desc.iRgbaIndex >= 0)
+			{
+				rgba = static_cast<uint32_t>(PartToInt(parts[desc.iRgbaIndex]));
+			}
+			else
+			{
+				const float rgbaf = static_cast<float>(PartToDouble(parts[desc.fRgbaIndex], decimalPoint));
+				memcpy(&rgba, &rgbaf, sizeof(uint32_t));
+			}
+			col.a = ((rgba >> 24) & 0x0000ff);
+			col.r = ((rgba >> 16) & 0x0000ff);
+			col.g = ((rgba >>  8) & 0x0000ff);
+			col.b = ((rgba      ) & 0x0000ff);
+		}
+		else
+		{
+			ColorCompType* components[4] = { &col.r, &col.g, &col.b, &col.a };
+			const int indexes[4] = { desc.redIndex, desc.greenIndex, desc.blueIndex, desc.alphaIndex };
+			for (unsigned c = 0; c < 4; ++c)
+			{
+				if (indexes[c] >= 0)
+				{
+					float multiplier = desc.hasFloatRGBColors[c] ? static_cast<float>(ccColor::MAX) : 1.0f;
+					*components[c] = static_cast<ColorCompType>(static_cast<float>(PartToDouble(parts[indexes[c]], decimalPoint)) * multiplier);
+				}
+			}
+		}
+		range.colors.push_back(col);
+	}
+	else if (desc.greyIndex >= 0)
+	{
+		ColorCompType grey = static_cast<ColorCompType>(PartToInt(parts[desc.greyIndex]));
+		range.colors.emplace_back(grey, grey, grey, ccColor::MAX);
+	}
+
+	//Scalar values
+	for (int sfIndex : desc.scalarIndexes)
+	{
+		range.scalars.push_back(static_cast<ScalarType>(PartToDouble(parts[sfIndex], decimalPoint)));
+	}
+}
+
+//! Parses all the lines of a range
+static void ParseRange(const AsciiParsingContext& context, AsciiLineRange& range)
+{
+	try
+	{
+		std::vector<AsciiPart> parts(static_cast<size_t>(context.maxPartIndex + 1));
+
+		//rough estimation of the number of points (to limit the reallocations)
+		size_t estimatedPointCount = static_cast<size_t>(range.end - range.begin) / 32 + 1;
+		range.points.reserve(estimatedPointCount);
+
+		for (const char* lineBegin = range.begin; lineBegin != range.end; )
+		{
+			const char* lineEnd = FindLineEnd(lineBegin, range.end);
+			const char* contentEnd = (lineEnd != lineBegin && *(lineEnd - 1) == '\r' ? lineEnd - 1 : lineEnd);
+			ParseLine(context, lineBegin, contentEnd, parts, range);
+			lineBegin = (lineEnd == range.end ? lineEnd : lineEnd + 1);
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		range.memoryError = true;
+	}
+}
+
+//! Finalizes a cloud loaded by AsciiFilter::loadCloudFromFormatedAsciiBuffer
+static void FinalizeCloud(cloudAttributesDescriptor& cloudDesc)
+{
+	if (cloudDesc.cloud->size() < cloudDesc.cloud->capacity())
+		cloudDesc.cloud->resize(cloudDesc.cloud->size());
+
+	if (!cloudDesc.scalarFields.empty())
+	{
+		for (size_t j = 0; j < cloudDesc.scalarFields.size(); ++j)
+		{
+			cloudDesc.scalarFields[j]->resizeSafe(cloudDesc.cloud->size(), true, CCCoreLib::NAN_VALUE);
+			cloudDesc.scalarFields[j]->computeMinAndMax();
+		}
+		cloudDesc.cloud->setCurrentDisplayedScalarField(0);
+		cloudDesc.cloud->showSF(true);
+	}
+}
+
+CC_FILE_ERROR AsciiFilter::loadCloudFromFormatedAsciiBuffer(const char* data,
+															qint64 dataSize,
+															QString filenameOrTitle,
+															ccHObject& container,
+															const AsciiOpenDlg::Sequence& openSequence,
+															char separator,
+															bool commaAsDecimal,
+															unsigned approximateNumberOfLines,
+															unsigned maxCloudSize,
+															unsigned skipLines,
+															LoadParameters& parameters)
+{
+	const char* dataEnd = data + dataSize;
+
+	//we may have to "slice" clouds when opening them if they are too big!
+	maxCloudSize = std::min(maxCloudSize, CC_MAX_NUMBER_OF_POINTS_PER_CLOUD);
+	unsigned chunkRank = 1;
+
+	//we initialize the loading accelerator structure and point cloud
+	int maxPartIndex = -1;
+	cloudAttributesDescriptor cloudDesc = prepareCloud(openSequence, std::min(maxCloudSize, approximateNumberOfLines), maxPartIndex, chunkRank);
+	if (!cloudDesc.cloud)
+	{
+		return CC_FERR_NOT_ENOUGH_MEMORY;
+	}
+
+	//we skip lines as defined on input
+	for (unsigned i = 0; i < skipLines && data != dataEnd; )
+	{
+		const char* lineEnd = FindLineEnd(data, dataEnd);
+		if (lineEnd != data && !(lineEnd == data + 1 && *data == '\r'))
+		{
+			//empty lines are ignored
+			++i;
+		}
+		data = (lineEnd == dataEnd ? lineEnd : lineEnd + 1);
+	}
+
+	//the descriptor of the first cloud is used for parsing (all the clouds share the same sequence)
+	const cloudAttributesDescriptor parsingDesc = cloudDesc;
+	AsciiParsingContext context;
+	context.desc = &parsingDesc;
+	context.maxPartIndex = maxPartIndex;
+	context.separator = separator;
+	context.decimalPoint = (commaAsDecimal ? ',' : '.');
+	const size_t sfCount = cloudDesc.scalarFields.size();
+
+	//first point: check for 'big' coordinates
+	CCVector3d Pshift(0, 0, 0);
+	bool preserveCoordinateShift = true;
+	{
+		AsciiLineRange firstLines;
+		std::vector<AsciiPart> parts(static_cast<size_t>(maxPartIndex + 1));
+		for (const char* lineBegin = data; lineBegin != dataEnd && firstLines.points.empty(); )
+		{
+			const char* lineEnd = FindLineEnd(lineBegin, dataEnd);
+			const char* contentEnd = (lineEnd != lineBegin && *(lineEnd - 1) == '\r' ? lineEnd - 1 : lineEnd);
+			ParseLine(context, lineBegin, contentEnd, parts, firstLines);
+			lineBegin = (lineEnd == dataEnd ? lineEnd : lineEnd + 1);
+		}
+
+		if (!firstLines.points.empty() && HandleGlobalShift(firstLines.points.front(), Pshift, preserveCoordinateShift, parameters))
+		{
+			if (preserveCoordinateShift)
+			{
+				cloudDesc.cloud->setGlobalShift(Pshift);
+			}
+			ccLog::Warning("[ASCIIFilter::loadFile] Cloud has been recentered! Translation: (%.2f ; %.2f ; %.2f)", Pshift.x, Pshift.y, Pshift.z);
+		}
+	}
+
+	//progress indicator
+	QScopedPointer<ccProgressDialog> pDlg(nullptr);
+	if (parameters.parentWidget)
+	{
+		pDlg.reset(new ccProgressDialog(true, parameters.parentWidget));
+		pDlg->setMethodTitle(QObject::tr("Open ASCII data [%1]").arg(filenameOrTitle));
+		pDlg->setInfo(QObject::tr("Approximate number of points: %1").arg(approximateNumberOfLines));
+		pDlg->start();
+	}
+
+	//the data is processed by 'waves' of ranges (one wave is parsed in parallel, then merged)
+	const int threadCount = std::max(1, QThread::idealThreadCount());
+	std::vector<AsciiLineRange> ranges(static_cast<size_t>(threadCount) * 4);
+	std::vector<AsciiLineRange*> waveRanges;
+	waveRanges.reserve(ranges.size());
+
+	unsigned linesRead = 0;
+	unsigned pointsRead = 0;
+	CC_FILE_ERROR result = CC_FERR_NO_ERROR;
+
+	//makes room for (at least) one more point in the current cloud
+	auto makeRoom = [&](const char* parsedEnd, size_t pendingPoints) -> bool
+	{
+		//estimate of the remaining number of points (based on the average line size so far)
+		double bytesPerPoint = static_cast<double>(parsedEnd - data) / std::max<size_t>(1, pointsRead + pendingPoints);
+		double remainingPoints = pendingPoints + static_cast<double>(dataEnd - parsedEnd) / std::max(1.0, bytesPerPoint);
+		unsigned estimate = static_cast<unsigned>(std::min(std::ceil(remainingPoints * 1.02) + 1.0, static_cast<double>(maxCloudSize)));
+
+		unsigned currentSize = cloudDesc.cloud->size();
+		if (currentSize < maxCloudSize)
+		{
+			ccLog::PrintDebug("[ASCII] We choose to enlarge existing clouds");
+			unsigned newCapacity = static_cast<unsigned>(std::min<qint64>(maxCloudSize, static_cast<qint64>(currentSize) + estimate));
+			if (!cloudDesc.cloud->reserve(newCapacity))
+			{
+				ccLog::Error("Not enough memory! Process stopped ...");
+				return false;
+			}
+		}
+		else
+		{
+			ccLog::PrintDebug("[ASCII] We choose to instantiate new clouds");
+
+			//we store the current cloud
+			FinalizeCloud(cloudDesc);
+			container.addChild(cloudDesc.cloud);
+			cloudDesc.reset();
+
+			//and create new one
+			int dummyMaxPartIndex = -1;
+			cloudDesc = prepareCloud(openSequence, estimate, dummyMaxPartIndex, ++chunkRank);
+			if (!cloudDesc.cloud)
+			{
+				ccLog::Error("Not enough memory! Process stopped ...");
+				return false;
+			}
+			if (preserveCoordinateShift)
+			{
+				cloudDesc.cloud->setGlobalShift(Pshift);
+			}
+		}
+
+		if (pDlg)
+		{
+			pDlg->setInfo(QObject::tr("Approximate number of points: %1").arg(pointsRead + static_cast<unsigned>(std::ceil(remainingPoints))));
+		}
+		return true;
+	};
+
+	for (const char* waveBegin = data; waveBegin != dataEnd && result == CC_FERR_NO_ERROR; )
+	{
+		//we split the next part of the data in ranges of complete lines
+		waveRanges.clear();
+		const char* rangeBegin = waveBegin;
+		for (AsciiLineRange& range : ranges)
+		{
+			if (rangeBegin == dataEnd)
+				break;
+
+			const char* rangeEnd = dataEnd;
+			if (dataEnd - rangeBegin > s_asciiRangeByteSize)
+			{
+				rangeEnd = FindLineEnd(rangeBegin + s_asciiRangeByteSize - 1, dataEnd);
+				if (rangeEnd != dataEnd)
+					++rangeEnd;
+			}
+
+			range.clear();
+			range.begin = rangeBegin;
+			range.end = rangeEnd;
+			waveRanges.push_back(&range);
+			rangeBegin = rangeEnd;
+		}
+		waveBegin = rangeBegin;
+
+		QtConcurrent::blockingMap(waveRanges, [&context](AsciiLineRange* range) { ParseRange(context, *range); });
+
+		//we merge the ranges (in order)
+		for (const AsciiLineRange* range : waveRanges)
+		{
+			if (range->memoryError)
+			{
+				ccLog::Error("Not enough memory! Process stopped ...");
+				result = CC_FERR_NOT_ENOUGH_MEMORY;
+				break;
+			}
+
+			for (const std::pair<unsigned, int>& corruptedLine : range->corruptedLines)
+			{
+				unsigned lineNumber = linesRead + corruptedLine.first + 1;
+				if (corruptedLine.second < 0)
+					ccLog::Warning("[AsciiFilter::Load] Line %i is corrupted (non numerical value found)", lineNumber);
+				else
+					ccLog::Warning("[AsciiFilter::Load] Line %i is corrupted (found %i part(s) on %i expected)!", lineNumber, corruptedLine.second, maxPartIndex + 1);
+			}
+
+			const size_t pointCount = range->points.size();
+			for (size_t i = 0; i < pointCount; ++i)
+			{
+				if (cloudDesc.cloud->size() == cloudDesc.cloud->capacity() && !makeRoom(range->end, pointCount - i))
+				{
+					result = CC_FERR_NOT_ENOUGH_MEMORY;
+					break;
+				}
+
+				cloudDesc.cloud->addPoint((range->points[i] + Pshift).toPC());
+				if (cloudDesc.hasNorms)
+				{
+					cloudDesc.cloud->addNorm(range->normals[i]);
+				}
+				if (cloudDesc.hasRGBColors || cloudDesc.greyIndex >= 0)
+				{
+					cloudDesc.cloud->addColor(range->colors[i]);
+				}
+				for (size_t j = 0; j < cloudDesc.scalarFields.size() && j < sfCount; ++j)
+				{
+					cloudDesc.scalarFields[j]->emplace_back(range->scalars[i * sfCount + j]);
+				}
+				++pointsRead;
+			}
+			if (result != CC_FERR_NO_ERROR)
+			{
+				break;
+			}
+
+			linesRead += range->lineCount;
+		}
+
+		//we update the progress info
+		if (pDlg && result == CC_FERR_NO_ERROR)
+		{
+			pDlg->update(static_cast<float>(100.0 * (waveBegin - data) / std::max<qint64>(1, dataEnd - data)));
+			if (pDlg->isCancelRequested())
+			{
+				result = CC_FERR_CANCELED_BY_USER;
+			}
+		}
+	}
+
+	if (cloudDesc.cloud)
+	{
+		FinalizeCloud(cloudDesc);
+
+		//add cloud to output
+		container.addChild(cloudDesc.cloud);
+	}
+
+	return result;
+}
@@ -31,6 +31,9 @@
 #include "RasterGridFilter.h"
 #include "ShpFilter.h"
 
+//qCC_db
+#include <ccPointCloud.h>
+
 //Qt
 #include <QFileInfo>
 
@@ -438,6 +441,20 @@ CC_FILE_ERROR FileIOFilter::SaveToFile(	ccHObject* entities,
 		completeFileName += QString(".%1").arg(filter->getDefaultExtension());
 	}
 	
+	//the deferred transformations (if any) must be applied before saving the clouds
+	{
+		ccHObject::Container clouds;
+		if (entities->isKindOf(CC_TYPES::POINT_CLOUD))
+		{
+			clouds.push_back(entities);
+		}
+		entities->filterChildren(clouds, true, CC_TYPES::POINT_CLOUD);
+		for (ccHObject* cloud : clouds)
+		{
+			static_cast<ccGenericPointCloud*>(cloud)->applyPendingTransformation();
+		}
+	}
+
 	CC_FILE_ERROR result = CC_FERR_NO_ERROR;
 	try
 	{
@@ -479,6 +496,14 @@ CC_FILE_ERROR FileIOFilter::SaveToFile(	ccHObject* entities,
 	return SaveToFile(entities, filename, parameters, filter);
 }
 
+CC_FILE_ERROR FileIOFilter::WriteStreamedBlock(StreamedWriter& writer, ccPointCloud& block)
+{
+	//the deferred transformation (if any) must be applied before saving the block
+	block.applyPendingTransformation();
+
+	return writer.writeBlock(block);
+}
+
 void FileIOFilter::DisplayErrorMessage(CC_FILE_ERROR err, const QString& action, const QString& filename)
 {
 	QString errorStr;
@@ -0,0 +1,276 @@
+#include <limits>
+#include <random>
+
+#include "TestAsciiFilter.h"
+
+#include "AsciiFilter.h"
+#include "FileIOFilter.h"
+#include "ccHObject.h"
+#include "ccPointCloud.h"
+#include "ccScalarField.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+//! Gives access to the (protected) parsing methods of AsciiFilter
+class AsciiFilterTester : public AsciiFilter
+{
+public:
+	static AsciiOpenDlg::Sequence XYZSFSequence()
+	{
+		AsciiOpenDlg::Sequence sequence;
+		sequence.emplace_back(ASCII_OPEN_DLG_X, "X");
+		sequence.emplace_back(ASCII_OPEN_DLG_Y, "Y");
+		sequence.emplace_back(ASCII_OPEN_DLG_Z, "Z");
+		sequence.emplace_back(ASCII_OPEN_DLG_Scalar, "SF");
+		return sequence;
+	}
+
+	//! Parallel parsing, directly from the raw data
+	CC_FILE_ERROR parseBuffer(const QByteArray& data, ccHObject& container, unsigned skipLines, LoadParameters& parameters)
+	{
+		return loadCloudFromFormatedAsciiBuffer(data.constData(),
+												data.size(),
+												"buffer",
+												container,
+												XYZSFSequence(),
+												' ',
+												false,
+												1000,
+												CC_MAX_NUMBER_OF_POINTS_PER_CLOUD,
+												skipLines,
+												parameters);
+	}
+
+	//! Sequential parsing, through a text stream
+	CC_FILE_ERROR parseStream(const QByteArray& data, ccHObject& container, unsigned skipLines, LoadParameters& parameters)
+	{
+		QTextStream stream(data);
+		return loadCloudFromFormatedAsciiStream(stream,
+												"stream",
+												container,
+												XYZSFSequence(),
+												' ',
+												false,
+												1000,
+												data.size(),
+												CC_MAX_NUMBER_OF_POINTS_PER_CLOUD,
+												skipLines,
+												1.0,
+												parameters);
+	}
+};
+
+static void SetDefaultLoadParameters(FileIOFilter::LoadParameters& params)
+{
+	params.alwaysDisplayLoadDialog = false;
+	params.shiftHandlingMode = ccGlobalShiftManager::Mode::NO_DIALOG;
+	params.parentWidget = nullptr;
+}
+
+//! Generates ASCII data with various number formats (and several MB, so that it is parsed by several threads)
+static QByteArray GenerateAsciiData(unsigned lineCount)
+{
+	std::mt19937 generator(0);
+	std::uniform_real_distribution<double> distribution(-10000.0, 10000.0);
+	std::uniform_int_distribution<int> formatDistribution(0, 4);
+
+	QByteArray data;
+	data.reserve(lineCount * 64);
+	data.append("// X Y Z SF\r\n");
+	for (unsigned i = 0; i < lineCount; ++i)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			double value = distribution(generator);
+			QString str;
+			switch (formatDistribution(generator))
+			{
+			case 0:
+				str = QString::number(value, 'f', 3);
+				break;
+			case 1:
+				str = QString::number(value, 'e', 6);
+				break;
+			case 2:
+				str = QString::number(static_cast<int>(value));
+				break;
+			case 3:
+				//more significant digits than the fast path of the parser handles
+				str = QString::number(value, 'f', 14);
+				break;
+			default:
+				str = QString::number(value, 'g', 17);
+				break;
+			}
+			data.append(str.toLatin1());
+			data.append(j < 3 ? " " : (i % 2 ? "\r\n" : "\n"));
+		}
+
+		if (i % 1000 == 0)
+		{
+			//empty line
+			data.append("\n");
+		}
+	}
+
+	return data;
+}
+
+static ccPointCloud* SingleCloud(const ccHObject& container)
+{
+	ccHObject::Container clouds;
+	container.filterChildren(clouds, true, CC_TYPES::POINT_CLOUD, true);
+	return (clouds.size() == 1 ? static_cast<ccPointCloud*>(clouds.front()) : nullptr);
+}
+
+void TestAsciiFilter::testParallelAndSequentialParsing() const
+{
+	const unsigned lineCount = 250000;
+	const QByteArray data = GenerateAsciiData(lineCount);
+
+	FileIOFilter::LoadParameters params;
+	SetDefaultLoadParameters(params);
+	AsciiFilterTester filter;
+
+	ccHObject parallelContainer;
+	QCOMPARE(filter.parseBuffer(data, parallelContainer, 1, params), CC_FERR_NO_ERROR);
+	ccHObject sequentialContainer;
+	QCOMPARE(filter.parseStream(data, sequentialContainer, 1, params), CC_FERR_NO_ERROR);
+
+	ccPointCloud* parallelCloud = SingleCloud(parallelContainer);
+	ccPointCloud* sequentialCloud = SingleCloud(sequentialContainer);
+	QVERIFY(parallelCloud);
+	QVERIFY(sequentialCloud);
+	QCOMPARE(parallelCloud->size(), lineCount);
+	QCOMPARE(sequentialCloud->size(), lineCount);
+	QVERIFY(parallelCloud->getGlobalShift() == sequentialCloud->getGlobalShift());
+	QCOMPARE(parallelCloud->getNumberOfScalarFields(), 1u);
+	QCOMPARE(sequentialCloud->getNumberOfScalarFields(), 1u);
+
+	const CCCoreLib::ScalarField* parallelSF = parallelCloud->getScalarField(0);
+	const CCCoreLib::ScalarField* sequentialSF = sequentialCloud->getScalarField(0);
+	for (unsigned i = 0; i < lineCount; ++i)
+	{
+		if (!(*parallelCloud->getPoint(i) == *sequentialCloud->getPoint(i)))
+		{
+			QFAIL(qPrintable(QString("Point #%1 differs").arg(i)));
+		}
+		if (parallelSF->getValue(i) != sequentialSF->getValue(i))
+		{
+			QFAIL(qPrintable(QString("Scalar value #%1 differs").arg(i)));
+		}
+	}
+}
+
+void TestAsciiFilter::testUtf8BOM() const
+{
+	const QByteArray data = "1.5 2.5 3.5\n4.5 5.5 6.5\n7.5 8.5 9.5\n";
+	const QByteArray dataWithBOM = QByteArray("\xEF\xBB\xBF") + data;
+
+	FileIOFilter::LoadParameters params;
+	SetDefaultLoadParameters(params);
+
+	AsciiFilter filter;
+	ccHObject container;
+	QCOMPARE(filter.loadAsciiData(data, "data", container, params), CC_FERR_NO_ERROR);
+	ccHObject containerWithBOM;
+	QCOMPARE(filter.loadAsciiData(dataWithBOM, "data with BOM", containerWithBOM, params), CC_FERR_NO_ERROR);
+
+	ccPointCloud* cloud = SingleCloud(container);
+	ccPointCloud* cloudWithBOM = SingleCloud(containerWithBOM);
+	QVERIFY(cloud);
+	QVERIFY(cloudWithBOM);
+
+	//the first line must not be lost (nor corrupted)
+	QCOMPARE(cloudWithBOM->size(), 3u);
+	QCOMPARE(cloudWithBOM->size(), cloud->size());
+	QVERIFY(*cloudWithBOM->getPoint(0) == CCVector3(1.5f, 2.5f, 3.5f));
+	for (unsigned i = 0; i < cloud->size(); ++i)
+	{
+		QVERIFY(*cloudWithBOM->getPoint(i) == *cloud->getPoint(i));
+	}
+}
+
+void TestAsciiFilter::testExportMatchesQStringNumber_data() const
+{
+	QTest::addColumn<int>("precision");
+
+	QTest::newRow("0 decimals") << 0;
+	QTest::newRow("2 decimals") << 2;
+	QTest::newRow("6 decimals") << 6;
+	QTest::newRow("8 decimals") << 8;
+	QTest::newRow("12 decimals") << 12;
+	QTest::newRow("15 decimals") << 15;
+	QTest::newRow("17 decimals") << 17;
+}
+
+void TestAsciiFilter::testExportMatchesQStringNumber() const
+{
+	QFETCH(int, precision);
+
+	//values that are difficult to format
+	const std::vector<float> specialValues{	0.0f, -0.0f, 0.5f, -0.5f, 1.5f, -2.5f,
+											0.125f, -0.375f, //exact ties
+											1.0e-9f, -1.0e-9f, -4.0e-3f, //negative values rounded to zero
+											0.9999999f, -9.9999995f, 99.995f, 0.0049999f, //rounding carries
+											123456.789f, -98765.4321f, 16777216.0f, -3.0e7f,
+											1.0e20f, -3.4e38f }; //large magnitudes
+	const unsigned randomCount = 100000;
+	const unsigned pointCount = static_cast<unsigned>(specialValues.size()) + randomCount;
+
+	ccPointCloud cloud("cloud");
+	QVERIFY(cloud.reserve(pointCount));
+	int sfIdx = cloud.addScalarField("values");
+	QVERIFY(sfIdx >= 0);
+	ccScalarField* sf = static_cast<ccScalarField*>(cloud.getScalarField(sfIdx));
+
+	std::mt19937 generator(0);
+	std::uniform_real_distribution<float> distribution(-1000.0f, 1000.0f);
+	for (unsigned i = 0; i < pointCount; ++i)
+	{
+		float value = (i < specialValues.size() ? specialValues[i] : distribution(generator));
+		//the X coordinate is shifted (large magnitudes), not the Y and Z ones
+		cloud.addPoint(CCVector3(value, -value, value / 3));
+		//invalid scalar values are exported as 'nan'
+		sf->addElement(i % 7 == 3 ? CCCoreLib::NAN_VALUE : static_cast<ScalarType>(value));
+	}
+	cloud.setGlobalShift(CCVector3d(-1.0e9, 0.0, 0.0));
+	sf->setGlobalShift(0.25);
+	sf->computeMinAndMax();
+
+	QTemporaryDir tmpDir;
+	QVERIFY(tmpDir.isValid());
+	const QString filePath = tmpDir.path() + "/export.txt";
+
+	AsciiFilter::SetOutputCoordsPrecision(precision);
+	AsciiFilter::SetOutputSFPrecision(precision);
+	AsciiFilter::SetOutputSeparatorIndex(0); //space
+	AsciiFilter::SaveColumnsNamesHeader(false);
+	AsciiFilter::SavePointCountHeader(false);
+
+	FileIOFilter::SaveParameters params;
+	params.alwaysDisplaySaveDialog = false;
+	AsciiFilter filter;
+	QCOMPARE(filter.saveToFile(&cloud, filePath, params), CC_FERR_NO_ERROR);
+
+	QFile file(filePath);
+	QVERIFY(file.open(QFile::ReadOnly));
+	for (unsigned i = 0; i < pointCount; ++i)
+	{
+		const QByteArray line = file.readLine().trimmed();
+		const CCVector3d Pglobal = cloud.toGlobal3d<PointCoordinateType>(*cloud.getPoint(i));
+		const QString expectedLine = QString::number(Pglobal.x, 'f', precision)
+									+ ' ' + QString::number(Pglobal.y, 'f', precision)
+									+ ' ' + QString::number(Pglobal.z, 'f', precision)
+									+ ' ' + QString::number(sf->getGlobalShift() + sf->getValue(i), 'f', precision);
+		if (QString::fromLatin1(line) != expectedLine)
+		{
+			QFAIL(qPrintable(QString("Line #%1: '%2' instead of '%3'").arg(i).arg(QString::fromLatin1(line), expectedLine)));
+		}
+	}
+	QVERIFY(file.readLine().trimmed().isEmpty());
+}
+
+QTEST_MAIN(TestAsciiFilter)
@@ -0,0 +1,22 @@
+#ifndef CC_TEST_ASCIIFILTER_HEADER
+#define CC_TEST_ASCIIFILTER_HEADER
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class TestAsciiFilter : public QObject
+{
+Q_OBJECT
+private slots:
+	/* Loading */
+	void testParallelAndSequentialParsing() const;
+
+	void testUtf8BOM() const;
+
+	/* Saving */
+	void testExportMatchesQStringNumber_data() const;
+	void testExportMatchesQStringNumber() const;
+};
+
+
+#endif //CC_TEST_ASCIIFILTER_HEADER
@@ -0,0 +1,668 @@
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "TestBinFilter.h"
+
+#include "BinFilter.h"
+#include "FileIOFilter.h"
+#include "ccHObject.h"
+#include "ccPointCloud.h"
+#include "ccPointCloudLOD.h"
+#include "ccScalarField.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+static const unsigned s_pointCount = 10000;
+
+static ccPointCloud* CreateCloud(unsigned pointCount, bool withSF = false)
+{
+	ccPointCloud* cloud = new ccPointCloud("cloud");
+	if (!cloud->reserve(pointCount))
+	{
+		delete cloud;
+		return nullptr;
+	}
+
+	std::mt19937 generator(0);
+	std::uniform_real_distribution<PointCoordinateType> distribution(0, 100);
+	for (unsigned i = 0; i < pointCount; ++i)
+	{
+		cloud->addPoint(CCVector3(distribution(generator), distribution(generator), distribution(generator)));
+	}
+
+	if (withSF)
+	{
+		int sfIdx = cloud->addScalarField("values");
+		if (sfIdx < 0)
+		{
+			delete cloud;
+			return nullptr;
+		}
+		CCCoreLib::ScalarField* sf = cloud->getScalarField(sfIdx);
+		for (unsigned i = 0; i < pointCount; ++i)
+		{
+			sf->setValue(i, static_cast<ScalarType>(i) / 4);
+		}
+		sf->computeMinAndMax();
+	}
+
+	return cloud;
+}
+
+static ccPointCloud* CreateCloudWithLOD()
+{
+	ccPointCloud* cloud = CreateCloud(s_pointCount);
+
+	//the LOD structure is built in the background
+	if (cloud && !cloud->initLOD())
+	{
+		delete cloud;
+		return nullptr;
+	}
+
+	return cloud;
+}
+
+static bool WaitForLOD(const ccPointCloud& cloud)
+{
+	const ccPointCloudLOD* lod = cloud.getLOD();
+	if (!lod)
+	{
+		return false;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+	while (!lod->isInitialized() && !lod->isBroken() && timer.elapsed() < 60000)
+	{
+		QTest::qWait(10);
+	}
+
+	return lod->isInitialized();
+}
+
+static CC_FILE_ERROR SaveCloud(ccPointCloud* cloud, const QString& filePath)
+{
+	FileIOFilter::SaveParameters params;
+	params.alwaysDisplaySaveDialog = false;
+	BinFilter filter;
+	return filter.saveToFile(cloud, filePath, params);
+}
+
+//! Saves a cloud with a given BIN version (instead of the minimum one deduced by BinFilter)
+static bool SaveCloudWithVersion(ccPointCloud* cloud, const QString& filePath, short dataVersion)
+{
+	QFile out(filePath);
+	if (!out.open(QFile::WriteOnly))
+	{
+		return false;
+	}
+
+	//same header as BinFilter::SaveFileV2
+	char firstBytes[5] = "CCB2";
+	char flags = 0;
+	if (sizeof(PointCoordinateType) == 8)
+		flags |= static_cast<char>(ccSerializableObject::DF_POINT_COORDS_64_BITS);
+	if (sizeof(ScalarType) == 4)
+		flags |= static_cast<char>(ccSerializableObject::DF_SCALAR_VAL_32_BITS);
+	firstBytes[3] = 48 + flags;
+	uint32_t binVersion = static_cast<uint32_t>(dataVersion);
+
+	return out.write(firstBytes, 4) == 4
+	    && out.write(reinterpret_cast<const char*>(&binVersion), 4) == 4
+	    && cloud->toFile(out, dataVersion);
+}
+
+static CC_FILE_ERROR LoadCloud(const QString& filePath, ccHObject& container, ccPointCloud*& cloud)
+{
+	FileIOFilter::LoadParameters params;
+	params.alwaysDisplayLoadDialog = false;
+	params.shiftHandlingMode = ccGlobalShiftManager::Mode::NO_DIALOG;
+	BinFilter filter;
+	CC_FILE_ERROR error = filter.loadFile(filePath, container, params);
+
+	ccHObject::Container clouds;
+	container.filterChildren(clouds, true, CC_TYPES::POINT_CLOUD, true);
+	cloud = (clouds.size() == 1 ? static_cast<ccPointCloud*>(clouds.front()) : nullptr);
+
+	return error;
+}
+
+void TestBinFilter::cleanup()
+{
+	ccPointCloud::SetLODFileStorage(false);
+	ccScalarField::SetIntegerFileStorage(false);
+	ccSerializationHelper::SetArrayChunkByteSize(0);
+	ccSerializationHelper::SetArrayCompression(ccSerializationHelper::ArrayCompression::NONE);
+}
+
+void TestBinFilter::testChunkedArrayRoundTrip() const
+{
+	//big enough to be written and read by several threads
+	const size_t elementCount = 2000000;
+	std::vector<CCVector3> points(elementCount);
+	std::mt19937 generator(0);
+	std::uniform_real_distribution<PointCoordinateType> distribution(-1000, 1000);
+	for (CCVector3& P : points)
+	{
+		P = CCVector3(distribution(generator), distribution(generator), distribution(generator));
+	}
+
+	QTemporaryDir tmpDir;
+	QVERIFY(tmpDir.isValid());
+	const QString filePath = tmpDir.path() + "/array.bin";
+
+	//small chunks, so that the chunk table is used without a huge array
+	const qint64 chunkByteSize = 4096;
+	ccSerializationHelper::SetArrayChunkByteSize(chunkByteSize);
+	QCOMPARE(ccSerializationHelper::GetArrayChunkByteSize(), chunkByteSize);
+	{
+		QFile out(filePath);
+		QVERIFY(out.open(QFile::WriteOnly));
+		QVERIFY((ccSerializationHelper::GenericArrayToFile<CCVector3, 3, PointCoordinateType>(points, out, 55)));
+	}
+
+	QFile in(filePath);
+	QVERIFY(in.open(QFile::ReadOnly));
+
+	//component count (1 byte), element count (64 bits), chunk size (64 bits) and chunk table
+	const uint64_t chunkSize = chunkByteSize / sizeof(CCVector3);
+	const uint64_t chunkCount = (elementCount + chunkSize - 1) / chunkSize;
+	QByteArray header = in.read(17);
+	QCOMPARE(header.size(), 17);
+	uint64_t storedCount = 0;
+	uint64_t storedChunkSize = 0;
+	memcpy(&storedCount, header.constData() + 1, 8);
+	memcpy(&storedChunkSize, header.constData() + 9, 8);
+	QCOMPARE(static_cast<int>(header[0]), 3);
+	QCOMPARE(storedCount, static_cast<uint64_t>(elementCount));
+	QCOMPARE(storedChunkSize, chunkSize);
+	QCOMPARE(in.size(), static_cast<qint64>(17 + chunkCount * 8 + elementCount * sizeof(CCVector3)));
+
+	QVERIFY(in.seek(0));
+	std::vector<CCVector3> loadedPoints;
+	QVERIFY((ccSerializationHelper::GenericArrayFromFile<CCVector3, 3, PointCoordinateType>(loadedPoints, in, 55)));
+	QCOMPARE(loadedPoints.size(), elementCount);
+	QVERIFY(memcmp(loadedPoints.data(), points.data(), elementCount * sizeof(CCVector3)) == 0);
+	QCOMPARE(in.pos(), in.size());
+}
+
+void TestBinFilter::testBin55CloudRoundTrip() const
+{
+	const unsigned pointCount = 100000;
+	QScopedPointer<ccPointCloud> cloud(CreateCloud(pointCount, true));
+	QVERIFY(cloud);
+
+	QTemporaryDir tmpDir;
+	QVERIFY(tmpDir.isValid());
+	const QString filePath = tmpDir.path() + "/cloud_55.bin";
+
+	ccSerializationHelper::SetArrayChunkByteSize(4096);
+	QVERIFY(SaveCloudWithVersion(cloud.data(), filePath, 55));
+
+	ccHObject container;
+	ccPointCloud* loadedCloud = nullptr;
+	QCOMPARE(LoadCloud(filePath, container, loadedCloud), CC_FERR_NO_ERROR);
+	QVERIFY(loadedCloud);
+	QCOMPARE(loadedCloud->size(), pointCount);
+	QCOMPARE(loadedCloud->getNumberOfScalarFields(), 1u);
+
+	const CCCoreLib::ScalarField* sf = cloud->getScalarField(0);
+	const CCCoreLib::ScalarField* loadedSF = loadedCloud->getScalarField(0);
+	for (unsigned i = 0; i < pointCount; ++i)
+	{
+		QVERIFY(*loadedCloud->getPoint(i) == *cloud->getPoint(i));
+		QCOMPARE(loadedSF->getValue(i), sf->getValue(i));
+	}
+}
+
+void TestBinFilter::testBin55RejectedByOlderReaders() const
+{
+	//arrays with more than 2^32-1 elements require version 5.5
+	if (sizeof(size_t) > 4)
+	{
+		const size_t hugeCount = static_cast<size_t>(std::numeric_limits<uint32_t>::max()) + 1;
+		QCOMPARE(ccSerializationHelper::GenericArrayToFileMinVersion(hugeCount), static_cast<short>(55));
+	}
+	QCOMPARE(ccSerializationHelper::GenericArrayToFileMinVersion(s_pointCount), static_cast<short>(20));
+
+	QScopedPointer<ccPointCloud> cloud(CreateCloud(s_pointCount, true));
+	QVERIFY(cloud);
+
+	QTemporaryDir tmpDir;
+	QVERIFY(tmpDir.isValid());
+	const QString filePath = tmpDir.path() + "/cloud_newer.bin";
+
+	ccSerializationHelper::SetArrayChunkByteSize(4096);
+	QVERIFY(SaveCloudWithVersion(cloud.data(), filePath, 55));
+
+	//a reader older than the file (e.g. 5.4 for a 5.5 file) must refuse it: we simulate
+	//it with a file version newer than the current one
+	QFile file(filePath);
+	QVERIFY(file.open(QFile::ReadWrite));
+	QVERIFY(file.seek(4));
+	uint32_t newerVersion = ccObject::GetCurrentDBVersion() + 1;
+	QCOMPARE(file.write(reinterpret_cast<const char*>(&newerVersion), 4), static_cast<qint64>(4));
+	file.close();
+
+	ccHObject container;
+	ccPointCloud* loadedCloud = nullptr;
+	QVERIFY(LoadCloud(filePath, container, loadedCloud) != CC_FERR_NO_ERROR);
+	QCOMPARE(container.getChildrenNumber(), 0u);
+}
+
+static std::vector<float> CreateCompressibleValues(size_t count)
+{
+	std::vector<float> values(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		values[i] = static_cast<float>(i % 1000) / 4;
+	}
+	return values;
+}
+
+void TestBinFilter::testCompressedRoundTrip_data() const
+{
+	QTest::addColumn<int>("compression");
+
+	QTest::newRow("deflate") << static_cast<int>(ccSerializationHelper::ArrayCompression::DEFLATE);
+	QTest::newRow("shuffle") << static_cast<int>(ccSerializationHelper::ArrayCompression::SHUFFLE);
+	QTest::newRow("delta") << static_cast<int>(ccSerializationHelper::ArrayCompression::DELTA);
+}
+
+void TestBinFilter::testCompressedRoundTrip() const
+{
+	QFETCH(int, compression);
+
+	const unsigned pointCount = 100000;
+	QScopedPointer<ccPointCloud> cloud(CreateCloud(pointCount, true));
+	QVERIFY(cloud);
+
+	QTemporaryDir tmpDir;
+	QVERIFY(tmpDir.isValid());
+	const QString filePath = tmpDir.path() + "/compressed.bin";
+
+	ccSerializationHelper::SetArrayCompression(static_cast<ccSerializationHelper::ArrayCompression>(compression));
+	QCOMPARE(cloud->minimumFileVersion(), static_cast<short>(56));
+	QCOMPARE(SaveCloud(cloud.data(), filePath), CC_FERR_NO_ERROR);
+
+	//the coordinates are random, but the scalar values are very redundant
+	QVERIFY(QFileInfo(filePath).size() < static_cast<qint64>(pointCount * (sizeof(CCVector3) + sizeof(ScalarType))));
+
+	//the compression is only a saving option
+	ccSerializationHelper::SetArrayCompression(ccSerializationHelper::ArrayCompression::NONE);
+
+	ccHObject container;
+	ccPointCloud* loadedCloud = nullptr;
+	QCOMPARE(LoadCloud(filePath, container, loadedCloud), CC_FERR_NO_ERROR);
+	QVERIFY(loadedCloud);
+	QCOMPARE(loadedCloud->size(), pointCount);
+	QCOMPARE(loadedCloud->getNumberOfScalarFields(), 1u);
+
+	const CCCoreLib::ScalarField* sf = cloud->getScalarField(0);
+	const CCCoreLib::ScalarField* loadedSF = loadedCloud->getScalarField(0);
+	for (unsigned i = 0; i < pointCount; ++i)
+	{
+		QVERIFY(*loadedCloud->getPoint(i) == *cloud->getPoint(i));
+		QCOMPARE(loadedSF->getValue(i), sf->getValue(i));
+	}
+}
+
+void TestBinFilter::testCorruptCompressedBlock() const
+{
+	//several compressed chunks (4 MB each before compression)
+	const std::vector<float> values = CreateCompressibleValues(3000000);
+
+	QTemporaryDir tmpDir;
+	QVERIFY(tmpDir.isValid());
+	const QString filePath = tmpDir.path() + "/compressed_array.bin";
+
+	ccSerializationHelper::SetArrayCompression(ccSerializationHelper::ArrayCompression::SHUFFLE);
+	{
+		QFile out(filePath);
+		QVERIFY(out.open(QFile::WriteOnly));
+		QVERIFY((ccSerializationHelper::GenericArrayToFile<float, 1, float>(values, out, 56)));
+	}
+
+	QFile file(filePath);
+	QVERIFY(file.open(QFile::ReadOnly));
+	const QByteArray data = file.readAll();
+	file.close();
+
+	//component count (1 byte), element count (64 bits), compression (1 byte), chunk size (64 bits) and chunk table
+	QVERIFY(data.size() > 18);
+	uint64_t chunkSize = 0;
+	memcpy(&chunkSize, data.constData() + 10, 8);
+	QVERIFY(chunkSize != 0);
+	const uint64_t chunkCount = (values.size() + chunkSize - 1) / chunkSize;
+	QVERIFY(chunkCount > 1);
+	const int firstChunkPos = static_cast<int>(18 + chunkCount * 8);
+	uint64_t firstChunkByteCount = 0;
+	memcpy(&firstChunkByteCount, data.constData() + 18, 8);
+	QVERIFY(firstChunkPos + static_cast<int>(firstChunkByteCount) <= data.size());
+
+	//sanity check: the original file can be read
+	{
+		QVERIFY(file.open(QFile::ReadOnly));
+		std::vector<float> loadedValues;
+		QVERIFY((ccSerializationHelper::GenericArrayFromFile<float, 1, float>(loadedValues, file, 56)));
+		QVERIFY(loadedValues == values);
+		file.close();
+	}
+
+	//corrupt block: some bytes in the middle of the compressed data of the first chunk
+	{
+		QByteArray corruptData = data;
+		for (int i = 0; i < 16; ++i)
+		{
+			corruptData[firstChunkPos + static_cast<int>(firstChunkByteCount / 2) + i] = static_cast<char>(0xA5 ^ i);
+		}
+		QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+		QCOMPARE(file.write(corruptData), static_cast<qint64>(corruptData.size()));
+		file.close();
+
+		QVERIFY(file.open(QFile::ReadOnly));
+		std::vector<float> loadedValues;
+		QVERIFY(!(ccSerializationHelper::GenericArrayFromFile<float, 1, float>(loadedValues, file, 56)));
+		file.close();
+	}
+
+	//truncated block: the file ends in the middle of the last chunk
+	{
+		QByteArray truncatedData = data.left(data.size() - 100);
+		QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+		QCOMPARE(file.write(truncatedData), static_cast<qint64>(truncatedData.size()));
+		file.close();
+
+		QVERIFY(file.open(QFile::ReadOnly));
+		std::vector<float> loadedValues;
+		QVERIFY(!(ccSerializationHelper::GenericArrayFromFile<float, 1, float>(loadedValues, file, 56)));
+		file.close();
+	}
+}
+
+void TestBinFilter::testTruncatedCompressedFile() const
+{
+	QScopedPointer<ccPointCloud> cloud(CreateCloud(s_pointCount, true));
+	QVERIFY(cloud);
+
+	QTemporaryDir tmpDir;
+	QVERIFY(tmpDir.isValid());
+	const QString filePath = tmpDir.path() + "/compressed_truncated.bin";
+
+	ccSerializationHelper::SetArrayCompression(ccSerializationHelper::ArrayCompression::SHUFFLE);
+	QCOMPARE(SaveCloud(cloud.data(), filePath), CC_FERR_NO_ERROR);
+
+	QFile file(filePath);
+	QVERIFY(file.open(QFile::ReadWrite));
+	QVERIFY(file.resize(file.size() / 2));
+	file.close();
+
+	ccHObject container;
+	ccPointCloud* loadedCloud = nullptr;
+	QVERIFY(LoadCloud(filePath, container, loadedCloud) != CC_FERR_NO_ERROR);
+	QCOMPARE(container.getChildrenNumber(), 0u);
+}
+
+//! Creates a cloud with a single scalar field with integer values in [minValue ; maxValue] (and NaN values every 'nanStep' points, if not 0)
+static ccPointCloud* CreateCloudWithIntegerSF(int minValue, int maxValue, unsigned nanStep = 0)
+{
+	ccPointCloud* cloud = CreateCloud(s_pointCount, true);
+	if (!cloud)
+	{
+		return nullptr;
+	}
+
+	CCCoreLib::ScalarField* sf = cloud->getScalarField(0);
+	const unsigned range = static_cast<unsigned>(static_cast<int64_t>(maxValue) - minValue) + 1;
+	for (unsigned i = 0; i < s_pointCount; ++i)
+	{
+		if (nanStep != 0 && (i % nanStep) == 1)
+		{
+			sf->setValue(i, CCCoreLib::NAN_VALUE);
+		}
+		else
+		{
+			sf->setValue(i, static_cast<ScalarType>(minValue + static_cast<int>((i * 7919u) % range)));
+		}
+	}
+	//make sure the bounds are used
+	sf->setValue(0, static_cast<ScalarType>(minValue));
+	sf->setValue(s_pointCount - 1, static_cast<ScalarType>(maxValue));
+	sf->computeMinAndMax();
+
+	return cloud;
+}
+
+void TestBinFilter::testIntegerSFNotSavedByDefault() const
+{
+	QScopedPointer<ccPointCloud> cloud(CreateCloudWithIntegerSF(0, 255));
+	QVERIFY(cloud);
+
+	QVERIFY(!ccScalarField::IntegerFileStorage());
+	QVERIFY(cloud->minimumFileVersion() < 57);
+
+	QTemporaryDir tmpDir;
+	QVERIFY(tmpDir.isValid());
+	const QString filePath = tmpDir.path() + "/integer_sf_default.bin";
+	QCOMPARE(SaveCloud(cloud.data(), filePath), CC_FERR_NO_ERROR);
+
+	ccHObject container;
+	ccPointCloud* loadedCloud = nullptr;
+	QCOMPARE(LoadCloud(filePath, container, loadedCloud), CC_FERR_NO_ERROR);
+	QVERIFY(loadedCloud);
+	QCOMPARE(loadedCloud->getNumberOfScalarFields(), 1u);
+
+	const CCCoreLib::ScalarField* sf = cloud->getScalarField(0);
+	const CCCoreLib::ScalarField* loadedSF = loadedCloud->getScalarField(0);
+	for (unsigned i = 0; i < s_pointCount; ++i)
+	{
+		QCOMPARE(loadedSF->getValue(i), sf->getValue(i));
+	}
+}
+
+void TestBinFilter::testIntegerSFRoundTrip_data() const
+{
+	QTest::addColumn<int>("minValue");
+	QTest::addColumn<int>("maxValue");
+	QTest::addColumn<int>("storageType");
+
+	QTest::newRow("uint8") << 0 << 255 << static_cast<int>(ccScalarField::FileStorageType::UINT8);
+	QTest::newRow("uint16") << 0 << 65535 << static_cast<int>(ccScalarField::FileStorageType::UINT16);
+	QTest::newRow("int32") << -100000 << 100000 << static_cast<int>(ccScalarField::FileStorageType::INT32);
+}
+
+void TestBinFilter::testIntegerSFRoundTrip() const
+{
+	QFETCH(int, minValue);
+	QFETCH(int, maxValue);
+	QFETCH(int, storageType);
+
+	QScopedPointer<ccPointCloud> cloud(CreateCloudWithIntegerSF(minValue, maxValue));
+	QVERIFY(cloud);
+	const ccScalarField* sf = static_cast<ccScalarField*>(cloud->getScalarField(0));
+	QCOMPARE(static_cast<int>(sf->narrowestFileStorageType()), storageType);
+
+	QTemporaryDir tmpDir;
+	QVERIFY(tmpDir.isValid());
+	const QString filePath = tmpDir.path() + "/integer_sf.bin";
+
+	ccScalarField::SetIntegerFileStorage(true);
+	QVERIFY(cloud->minimumFileVersion() >= 57);
+	QCOMPARE(SaveCloud(cloud.data(), filePath), CC_FERR_NO_ERROR);
+
+	ccHObject container;
+	ccPointCloud* loadedCloud = nullptr;
+	QCOMPARE(LoadCloud(filePath, container, loadedCloud), CC_FERR_NO_ERROR);
+	QVERIFY(loadedCloud);
+	QCOMPARE(loadedCloud->size(), s_pointCount);
+	QCOMPARE(loadedCloud->getNumberOfScalarFields(), 1u);
+
+	const CCCoreLib::ScalarField* loadedSF = loadedCloud->getScalarField(0);
+	for (unsigned i = 0; i < s_pointCount; ++i)
+	{
+		QCOMPARE(loadedSF->getValue(i), sf->getValue(i));
+	}
+	QCOMPARE(loadedSF->getMin(), static_cast<ScalarType>(minValue));
+	QCOMPARE(loadedSF->getMax(), static_cast<ScalarType>(maxValue));
+}
+
+void TestBinFilter::testIntegerSFWithNaNValues() const
+{
+	QScopedPointer<ccPointCloud> cloud(CreateCloudWithIntegerSF(0, 10, 10));
+	QVERIFY(cloud);
+
+	//NaN values can't be stored as integers
+	const ccScalarField* sf = static_cast<ccScalarField*>(cloud->getScalarField(0));
+	QCOMPARE(static_cast<int>(sf->narrowestFileStorageType()), static_cast<int>(ccScalarField::FileStorageType::NATIVE));
+
+	QTemporaryDir tmpDir;
+	QVERIFY(tmpDir.isValid());
+	const QString filePath = tmpDir.path() + "/integer_sf_nan.bin";
+
+	ccScalarField::SetIntegerFileStorage(true);
+	QCOMPARE(SaveCloud(cloud.data(), filePath), CC_FERR_NO_ERROR);
+
+	ccHObject container;
+	ccPointCloud* loadedCloud = nullptr;
+	QCOMPARE(LoadCloud(filePath, container, loadedCloud), CC_FERR_NO_ERROR);
+	QVERIFY(loadedCloud);
+	QCOMPARE(loadedCloud->getNumberOfScalarFields(), 1u);
+
+	const CCCoreLib::ScalarField* loadedSF = loadedCloud->getScalarField(0);
+	for (unsigned i = 0; i < s_pointCount; ++i)
+	{
+		if (std::isnan(sf->getValue(i)))
+		{
+			QVERIFY(std::isnan(loadedSF->getValue(i)));
+		}
+		else
+		{
+			QCOMPARE(loadedSF->getValue(i), sf->getValue(i));
+		}
+	}
+
+	//the NaN values are ignored by the min and max values
+	QCOMPARE(loadedSF->getMin(), static_cast<ScalarType>(0));
+	QCOMPARE(loadedSF->getMax(), static_cast<ScalarType>(10));
+}
+
+void TestBinFilter::testLODNotSavedByDefault() const
+{
+	QScopedPointer<ccPointCloud> cloud(CreateCloudWithLOD());
+	QVERIFY(cloud);
+	QVERIFY(WaitForLOD(*cloud));
+
+	QTemporaryDir tmpDir;
+	QVERIFY(tmpDir.isValid());
+	const QString filePath = tmpDir.path() + "/lod_default.bin";
+
+	QVERIFY(!ccPointCloud::LODFileStorage());
+	QVERIFY(cloud->minimumFileVersion() < 58);
+	QCOMPARE(SaveCloud(cloud.data(), filePath), CC_FERR_NO_ERROR);
+
+	ccHObject container;
+	ccPointCloud* loadedCloud = nullptr;
+	QCOMPARE(LoadCloud(filePath, container, loadedCloud), CC_FERR_NO_ERROR);
+	QVERIFY(loadedCloud);
+	QCOMPARE(loadedCloud->size(), s_pointCount);
+	QVERIFY(!loadedCloud->getLOD() || !loadedCloud->getLOD()->isInitialized());
+}
+
+void TestBinFilter::testLODRoundTrip() const
+{
+	QScopedPointer<ccPointCloud> cloud(CreateCloudWithLOD());
+	QVERIFY(cloud);
+	QVERIFY(WaitForLOD(*cloud));
+
+	QTemporaryDir tmpDir;
+	QVERIFY(tmpDir.isValid());
+	const QString filePath = tmpDir.path() + "/lod.bin";
+
+	ccPointCloud::SetLODFileStorage(true);
+	QCOMPARE(cloud->minimumFileVersion(), static_cast<short>(58));
+	QCOMPARE(SaveCloud(cloud.data(), filePath), CC_FERR_NO_ERROR);
+
+	ccHObject container;
+	ccPointCloud* loadedCloud = nullptr;
+	QCOMPARE(LoadCloud(filePath, container, loadedCloud), CC_FERR_NO_ERROR);
+	QVERIFY(loadedCloud);
+	QCOMPARE(loadedCloud->size(), s_pointCount);
+
+	const ccPointCloudLOD* lod = cloud->getLOD();
+	const ccPointCloudLOD* loadedLOD = loadedCloud->getLOD();
+	QVERIFY(loadedLOD);
+	QVERIFY(loadedLOD->isInitialized());
+	QCOMPARE(loadedLOD->maxLevel(), lod->maxLevel());
+	QCOMPARE(loadedLOD->root().pointCount, s_pointCount);
+	QCOMPARE(loadedLOD->root().childCount, lod->root().childCount);
+	QVERIFY(loadedLOD->root().childIndexes == lod->root().childIndexes);
+}
+
+void TestBinFilter::testLODCorruptIndexes() const
+{
+	QScopedPointer<ccPointCloud> cloud(CreateCloudWithLOD());
+	QVERIFY(cloud);
+	QVERIFY(WaitForLOD(*cloud));
+
+	QTemporaryDir tmpDir;
+	QVERIFY(tmpDir.isValid());
+	const QString filePath = tmpDir.path() + "/lod_corrupt.bin";
+
+	ccPointCloud::SetLODFileStorage(true);
+	QCOMPARE(SaveCloud(cloud.data(), filePath), CC_FERR_NO_ERROR);
+
+	QFile file(filePath);
+	QVERIFY(file.open(QFile::ReadWrite));
+	QByteArray data = file.readAll();
+
+	//look for the points indexes of the LOD structure (the point count followed by a permutation of the indexes)
+	int indexesPos = -1;
+	const int indexesByteCount = static_cast<int>(sizeof(uint32_t) * (s_pointCount + 1));
+	for (int pos = 0; pos + indexesByteCount <= data.size() && indexesPos < 0; ++pos)
+	{
+		uint32_t count = 0;
+		memcpy(&count, data.constData() + pos, sizeof(uint32_t));
+		if (count != s_pointCount)
+		{
+			continue;
+		}
+
+		std::vector<bool> found(s_pointCount, false);
+		bool isPermutation = true;
+		for (unsigned i = 0; i < s_pointCount && isPermutation; ++i)
+		{
+			uint32_t index = 0;
+			memcpy(&index, data.constData() + pos + sizeof(uint32_t) * (i + 1), sizeof(uint32_t));
+			isPermutation = (index < s_pointCount && !found[index]);
+			if (isPermutation)
+			{
+				found[index] = true;
+			}
+		}
+		if (isPermutation)
+		{
+			indexesPos = pos;
+		}
+	}
+	QVERIFY(indexesPos >= 0);
+
+	//replace the first index by an out of range value
+	uint32_t invalidIndex = s_pointCount;
+	memcpy(data.data() + indexesPos + sizeof(uint32_t), &invalidIndex, sizeof(uint32_t));
+	QVERIFY(file.seek(0));
+	QCOMPARE(file.write(data), static_cast<qint64>(data.size()));
+	file.close();
+
+	ccHObject container;
+	ccPointCloud* loadedCloud = nullptr;
+	QVERIFY(LoadCloud(filePath, container, loadedCloud) != CC_FERR_NO_ERROR);
+}
+
+QTEST_MAIN(TestBinFilter)
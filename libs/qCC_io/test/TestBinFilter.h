@@ -0,0 +1,45 @@
+#ifndef CC_TEST_BINFILTER_HEADER
+#define CC_TEST_BINFILTER_HEADER
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class TestBinFilter : public QObject
+{
+Q_OBJECT
+private slots:
+	void cleanup();
+
+	/* 'generic arrays' with 64-bit counts and chunk tables (BIN version 5.5) */
+	void testChunkedArrayRoundTrip() const;
+
+	void testBin55CloudRoundTrip() const;
+
+	void testBin55RejectedByOlderReaders() const;
+
+	/* compressed 'generic arrays' (BIN version 5.6) */
+	void testCompressedRoundTrip_data() const;
+	void testCompressedRoundTrip() const;
+
+	void testCorruptCompressedBlock() const;
+
+	void testTruncatedCompressedFile() const;
+
+	/* scalar fields with integer values (BIN version 5.7) */
+	void testIntegerSFNotSavedByDefault() const;
+
+	void testIntegerSFRoundTrip_data() const;
+	void testIntegerSFRoundTrip() const;
+
+	void testIntegerSFWithNaNValues() const;
+
+	/* LOD structure of point clouds (BIN version 5.8) */
+	void testLODNotSavedByDefault() const;
+
+	void testLODRoundTrip() const;
+
+	void testLODCorruptIndexes() const;
+};
+
+
+#endif //CC_TEST_BINFILTER_HEADER
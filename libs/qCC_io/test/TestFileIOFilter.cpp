@@ -0,0 +1,80 @@
+#include <vector>
+
+#include "TestFileIOFilter.h"
+
+#include "FileIOFilter.h"
+#include "ccPointCloud.h"
+
+//! Streamed writer that only records the coordinates of the blocks it receives
+class RecordingStreamedWriter : public FileIOFilter::StreamedWriter
+{
+public:
+	CC_FILE_ERROR writeBlock(ccPointCloud& block) override
+	{
+		std::vector<CCVector3> points;
+		points.reserve(block.size());
+		for (unsigned i = 0; i < block.size(); ++i)
+		{
+			points.push_back(*block.getPoint(i));
+		}
+		blocks.push_back(points);
+		return CC_FERR_NO_ERROR;
+	}
+
+	CC_FILE_ERROR close() override
+	{
+		return CC_FERR_NO_ERROR;
+	}
+
+	std::vector< std::vector<CCVector3> > blocks;
+};
+
+void TestFileIOFilter::testStreamedBlocksWithDeferredTransformation() const
+{
+	static const unsigned s_blockCount = 3;
+	static const unsigned s_blockSize = 100;
+
+	ccGLMatrix trans;
+	trans.setTranslation(CCVector3(10, 20, 30));
+
+	RecordingStreamedWriter writer;
+	for (unsigned b = 0; b < s_blockCount; ++b)
+	{
+		//each block goes through the same commands as the previous ones (see ccCommandLineParser::saveStream)
+		ccPointCloud block("block");
+		QVERIFY(block.reserve(s_blockSize));
+		for (unsigned i = 0; i < s_blockSize; ++i)
+		{
+			block.addPoint(CCVector3(static_cast<PointCoordinateType>(b * s_blockSize + i), 0, 0));
+		}
+
+		//APPLY_TRANS
+		block.setDeferredTransformations(true);
+		block.applyRigidTransformation(trans);
+		QVERIFY(block.hasPendingTransformation());
+
+		//SAVE_CLOUDS
+		QCOMPARE(FileIOFilter::WriteStreamedBlock(writer, block), CC_FERR_NO_ERROR);
+		QVERIFY(!block.hasPendingTransformation());
+	}
+
+	QCOMPARE(static_cast<unsigned>(writer.blocks.size()), s_blockCount);
+	for (unsigned b = 0; b < s_blockCount; ++b)
+	{
+		const std::vector<CCVector3>& points = writer.blocks[b];
+		QCOMPARE(static_cast<unsigned>(points.size()), s_blockSize);
+		for (unsigned i = 0; i < s_blockSize; ++i)
+		{
+			const CCVector3 expected(static_cast<PointCoordinateType>(b * s_blockSize + i) + 10, 20, 30);
+			if ((points[i] - expected).norm() > 1.0e-4)
+			{
+				QFAIL(qPrintable(QString("Block #%1, point #%2: (%3, %4, %5) instead of (%6, %7, %8)")
+					.arg(b).arg(i)
+					.arg(points[i].x).arg(points[i].y).arg(points[i].z)
+					.arg(expected.x).arg(expected.y).arg(expected.z)));
+			}
+		}
+	}
+}
+
+QTEST_MAIN(TestFileIOFilter)
@@ -0,0 +1,16 @@
+#ifndef CC_TEST_FILEIOFILTER_HEADER
+#define CC_TEST_FILEIOFILTER_HEADER
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class TestFileIOFilter : public QObject
+{
+Q_OBJECT
+private slots:
+	/* Streamed clouds */
+	void testStreamedBlocksWithDeferredTransformation() const;
+};
+
+
+#endif //CC_TEST_FILEIOFILTER_HEADER
@@ -21,6 +21,7 @@
 #include "LasDetails.h"
 #include "LasExtraScalarField.h"
 #include "LasOpenDialog.h"
+#include "LasSaver.h"
 
 // System
 #include <memory>
@@ -35,6 +36,13 @@ class LasIOFilter : public FileIOFilter
 	bool          canSave(CC_CLASS_ENUM type, bool& multiple, bool& exclusive) const override;
 	CC_FILE_ERROR saveToFile(ccHObject* entity, const QString& filename, const SaveParameters& parameters) override;
 
+	StreamedReader::Shared createStreamedReader(const QString& fileName, LoadParameters& parameters, CC_FILE_ERROR& result) override;
+	StreamedWriter::Shared createStreamedWriter(const QString& fileName, const SaveParameters& parameters, CC_FILE_ERROR& result) override;
+
+	/// Determines the parameters to save a cloud in a LAS file
+	/// (the saving dialog is displayed if the parameters require it)
+	static CC_FILE_ERROR SaverParametersFor(ccPointCloud& pointCloud, const SaveParameters& parameters, LasSaver::Parameters& params);
+
   private:
 	struct FileInfo
 	{
@@ -33,6 +33,9 @@
 #include <CCGeom.h>
 #include <ccLog.h>
 
+// qCC_io
+#include <FileIOFilter.h>
+
 /// Dialog shown to the user when opening a LAS file
 class LasOpenDialog : public QDialog
     , public Ui::LASOpenDialog
@@ -77,12 +80,20 @@ class LasOpenDialog : public QDialog
 	/// rgb from the file as 8-bit components.
 	bool shouldForce8bitColors() const;
 
+	/// Returns whether the user wants the points
+	/// to be decoded by several threads.
+	bool shouldLoadInParallel() const;
+
 	/// Returns quiet_NaN if the time shift value should be
 	/// automatically found.
 	///
 	/// Otherwise, returns the value manually specified by the user.
 	double timeShiftValue() const;
 
+	/// Returns the filter the loaded points must satisfy
+	/// (inactive if the user didn't enable it).
+	FileIOFilter::PointsFilter pointsFilter() const;
+
 	/// Returns the action the user wants to do.
 	///
 	/// The action is based on the active tab when the
@@ -0,0 +1,97 @@
+#pragma once
+
+//##########################################################################
+//#                                                                        #
+//#                CLOUDCOMPARE PLUGIN: LAS-IO Plugin                      #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU General Public License as published by  #
+//#  the Free Software Foundation; version 2 of the License.               #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#                   COPYRIGHT: Thomas Montaigu                           #
+//#                                                                        #
+//##########################################################################
+
+#include "LasExtraScalarField.h"
+#include "LasScalarField.h"
+#include "LasScalarFieldLoader.h"
+
+// qCC_db
+#include <FileIOFilter.h>
+
+// Qt
+#include <QString>
+
+// LASzip
+#include <laszip/laszip_api.h>
+
+// System
+#include <array>
+#include <vector>
+
+class ccPointCloud;
+class ccProgressDialog;
+
+/// Loads the points of a LAS/LAZ file using several laszip readers,
+/// each one decoding a distinct range of points on a worker thread.
+///
+/// The cloud, its colors, normals and scalar fields are allocated
+/// beforehand and the decoded values are written directly at their
+/// final index. The resulting cloud is the same as the one produced
+/// by the sequential loading (same point order, same global shift,
+/// same scalar fields and colors).
+///
+/// Waveforms are not handled.
+class LasParallelLoader
+{
+  public:
+	LasParallelLoader(const QString&                            fileName,
+	                  const laszip_header&                      laszipHeader,
+	                  std::vector<LasScalarField>&              standardFields,
+	                  std::vector<LasExtraScalarField>&         extraFields,
+	                  const std::array<LasExtraScalarField, 3>& extraFieldsAsNormals,
+	                  const LasScalarFieldLoader&               loader);
+
+	/// Returns whether it is worth loading the file in parallel
+	static bool IsWorthIt(const laszip_header& laszipHeader, unsigned pointCount);
+
+	/// Loads the points in the (empty) cloud.
+	///
+	/// The reader must have just read the first point of the file, so that
+	/// the decisions depending on the first values (colors depth, GPS time shift)
+	/// are taken the same way as the sequential loader does.
+	///
+	/// On return, the `sf` pointers of the standard fields are set for the fields
+	/// that have to be added to the cloud, and colors/normals are allocated if needed.
+	/// In case of error (or cancellation) the cloud only contains the points
+	/// that were completely decoded from the start of the file (CC_FERR_READING is
+	/// returned if a range failed when it was decoded again).
+	///
+	/// If the memory can't be allocated (CC_FERR_NOT_ENOUGH_MEMORY) the cloud is
+	/// left empty and all the scalar fields (including the extra ones) are released:
+	/// the cloud shouldn't be used.
+	CC_FILE_ERROR load(laszip_POINTER    laszipReader,
+	                   unsigned          pointCount,
+	                   const CCVector3d& globalShift,
+	                   ccPointCloud&     pointCloud,
+	                   ccProgressDialog* progressDialog);
+
+  private:
+	/// Allocates the points, colors, normals and scalar fields
+	bool allocate(unsigned pointCount, bool withColors, bool withNormals, ccPointCloud& pointCloud);
+
+	/// Releases everything that was allocated (after a memory error)
+	void release(ccPointCloud& pointCloud);
+
+	QByteArray                                m_fileName;
+	const laszip_header&                      m_header;
+	std::vector<LasScalarField>&              m_standardFields;
+	std::vector<LasExtraScalarField>&         m_extraFields;
+	const std::array<LasExtraScalarField, 3>& m_extraFieldsAsNormals;
+	const LasScalarFieldLoader&               m_loader;
+};
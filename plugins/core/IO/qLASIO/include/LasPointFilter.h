@@ -0,0 +1,62 @@
+#pragma once
+
+//##########################################################################
+//#                                                                        #
+//#                CLOUDCOMPARE PLUGIN: LAS-IO Plugin                      #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU General Public License as published by  #
+//#  the Free Software Foundation; version 2 of the License.               #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#                   COPYRIGHT: Thomas Montaigu                           #
+//#                                                                        #
+//##########################################################################
+
+// qCC_io
+#include <FileIOFilter.h>
+
+// LASzip
+#include <laszip/laszip_api.h>
+
+// System
+#include <bitset>
+
+/// Tests the points read from a LAS file against
+/// the criteria of a FileIOFilter::PointsFilter.
+class LasPointFilter
+{
+  public:
+	explicit LasPointFilter(const FileIOFilter::PointsFilter& filter);
+
+	/// Returns whether the filter is active (i.e. some points may be rejected)
+	inline bool isActive() const
+	{
+		return m_filter.isActive();
+	}
+
+	/// Returns the 2D (XY) extents of the spatial criterion.
+	///
+	/// Returns false if there is no spatial criterion.
+	bool spatialExtents(CCVector2d& boxMin, CCVector2d& boxMax) const;
+
+	/// Returns whether the point (and its coordinates) satisfies all the criteria
+	bool accepts(const laszip_point& point, const laszip_F64 coordinates[3]) const;
+
+	/// Returns a short description of the active criteria
+	QString description() const;
+
+  private:
+	/// Returns whether a 2D point is inside the polygon
+	bool isInsidePolygon(double x, double y) const;
+
+	FileIOFilter::PointsFilter m_filter;
+	/// Classification values to keep (extended classifications go up to 255)
+	std::bitset<256> m_classifications;
+	/// Return numbers to keep (extended return numbers go up to 15)
+	std::bitset<16> m_returnNumbers;
+};
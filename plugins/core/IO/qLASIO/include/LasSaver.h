@@ -55,6 +55,13 @@ class LasSaver
 
 	CC_FILE_ERROR saveNextPoint();
 
+	/// Sets the next cloud to save in the same file (after all the points
+	/// of the current one have been saved).
+	///
+	/// The cloud must have the same scalar fields (and colors) as the original one.
+	/// Not possible if waveforms or normals (as extra scalar fields) are saved.
+	bool setCloud(ccPointCloud& cloud);
+
 	bool canSaveWaveforms() const;
 
 	QString getLastError() const;
@@ -64,7 +71,7 @@ class LasSaver
 
   private:
 	unsigned                          m_currentPointIndex{0};
-	ccPointCloud&                     m_cloudToSave;
+	ccPointCloud*                     m_cloudToSave;
 	laszip_header                     m_laszipHeader{};
 	laszip_POINTER                    m_laszipWriter{nullptr};
 	LasScalarFieldSaver               m_fieldsSaver;
@@ -53,16 +53,43 @@ class LasScalarFieldLoader
 
 	CC_FILE_ERROR handleExtraScalarFields(const laszip_point& currentPoint);
 
+	/// Returns the value of the standard LAS field `id` for the given point
+	/// (before any conversion to ScalarType).
+	static double StandardFieldValue(LasScalarField::Id id, const laszip_point& currentPoint);
+
+	/// Returns the shift to apply to the RGB components of the point
+	/// so that they fit in a ColorCompType (0 for 8-bit colors, 8 for 16-bit colors).
+	static unsigned char ColorCompShiftFor(const laszip_point& currentPoint, bool force8bitRgbMode);
+
+	/// Returns the time shift automatically chosen for the given (first) GPS time value.
+	static double AutomaticTimeShift(double firstValue);
+
+	/// Returns the shift to apply to the GPS time values, given the
+	/// first (non default) value that will be stored in the scalar field.
+	///
+	/// The manual time shift is used if it was set.
+	double timeShiftFor(double firstValue) const;
+
 	inline void setIgnoreFieldsWithDefaultValues(bool state)
 	{
 		m_ignoreFieldsWithDefaultValues = state;
 	}
 
+	inline bool ignoreFieldsWithDefaultValues() const
+	{
+		return m_ignoreFieldsWithDefaultValues;
+	}
+
 	inline void setForce8bitRgbMode(bool state)
 	{
 		m_force8bitRgbMode = state;
 	}
 
+	inline bool force8bitRgbMode() const
+	{
+		return m_force8bitRgbMode;
+	}
+
 	/// If nan, this value will be ignored and the time shift
 	/// will be taken using the first value encountered.
 	inline void setManualTimeShift(double timeShift)
@@ -70,6 +97,11 @@ class LasScalarFieldLoader
 		m_manualTimeShiftValue = timeShift;
 	}
 
+	inline double manualTimeShift() const
+	{
+		return m_manualTimeShiftValue;
+	}
+
 	inline const std::vector<LasScalarField>& standardFields() const
 	{
 		return m_standardFields;
@@ -87,8 +119,7 @@ class LasScalarFieldLoader
 	/// sfInfo: Info about the current scalar field we are loading the value into
 	/// pointCloud: The point cloud where the scalar field will be loaded into
 	/// currentValue: The current value of the LAS field we are loading.
-	template <typename T>
-	CC_FILE_ERROR handleScalarField(LasScalarField& sfInfo, ccPointCloud& pointCloud, T currentValue);
+	CC_FILE_ERROR handleScalarField(LasScalarField& sfInfo, ccPointCloud& pointCloud, double currentValue);
 
 	/// Same thing as `handleScalarField` but for Gps Time.
 	CC_FILE_ERROR handleGpsTime(LasScalarField& sfInfo, ccPointCloud& pointCloud, double currentValue);
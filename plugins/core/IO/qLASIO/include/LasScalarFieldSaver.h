@@ -21,6 +21,11 @@
 #include "LasExtraScalarField.h"
 #include "LasScalarField.h"
 
+// System
+#include <array>
+#include <string>
+
+class ccPointCloud;
 struct laszip_point;
 
 /// Class with the logic to save a point clouds
@@ -38,11 +43,13 @@ class LasScalarFieldSaver
 	inline void setStandarFields(std::vector<LasScalarField>&& standardFields)
 	{
 		m_standardFields = standardFields;
+		recordScalarFieldNames();
 	}
 
 	inline void setExtraFields(std::vector<LasExtraScalarField>&& extraFields)
 	{
 		m_extraFields = extraFields;
+		recordScalarFieldNames();
 	}
 
 	inline const std::vector<LasExtraScalarField>& extraFields() const
@@ -56,7 +63,19 @@ class LasScalarFieldSaver
 	/// Saves the extra scalar fields values for pointIndex into the given laszip_point
 	void handleExtraFields(size_t pointIndex, laszip_point& point);
 
+	/// Binds the fields to the scalar fields of another cloud.
+	///
+	/// The scalar fields are matched by name with the ones the fields were
+	/// bound to when they were set. This is used to save clouds that share
+	/// the same structure (e.g. blocks of a bigger cloud) in the same file.
+	///
+	/// Returns false if a scalar field is missing.
+	bool bindTo(const ccPointCloud& cloud);
+
   private:
+	/// Stores the names of the scalar fields the fields are bound to
+	void recordScalarFieldNames();
+
 	template <typename T>
 	static void WriteScalarValueAs(ScalarType value, uint8_t* dest)
 	{
@@ -77,4 +96,8 @@ class LasScalarFieldSaver
   private:
 	std::vector<LasScalarField>      m_standardFields;
 	std::vector<LasExtraScalarField> m_extraFields;
+	/// Names of the scalar fields bound to the standard fields
+	std::vector<std::string> m_standardFieldNames;
+	/// Names of the scalar fields bound to the extra fields (per dimension)
+	std::vector<std::array<std::string, LasExtraScalarField::MAX_DIM_SIZE>> m_extraFieldNames;
 };
@@ -0,0 +1,97 @@
+#pragma once
+
+//##########################################################################
+//#                                                                        #
+//#                CLOUDCOMPARE PLUGIN: LAS-IO Plugin                      #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU General Public License as published by  #
+//#  the Free Software Foundation; version 2 of the License.               #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#                   COPYRIGHT: Thomas Montaigu                           #
+//#                                                                        #
+//##########################################################################
+
+// qCC_io
+#include <FileIOFilter.h>
+
+// Qt
+#include <QString>
+
+// LASzip
+#include <laszip/laszip_api.h>
+
+// System
+#include <vector>
+
+class ccProgressDialog;
+
+/// Spatial index of the points of a LAS/LAZ file.
+///
+/// Like the LAX files of LAStools, the XY extents of the file are
+/// subdivided by a quadtree, and each leaf cell stores the intervals
+/// of point indexes (in file order) that fall in it. Points being usually
+/// stored in acquisition (or tiled) order, only a few intervals are needed
+/// per cell, and a spatial query only has to decode the returned intervals.
+///
+/// The index is stored next to the LAS file (see SideFileName).
+class LasSpatialIndex
+{
+  public:
+	/// An interval [start, end[ of point indexes
+	struct Interval
+	{
+		unsigned start;
+		unsigned end;
+
+		inline unsigned count() const
+		{
+			return end - start;
+		}
+	};
+
+	/// Returns the name of the index file associated to a LAS file
+	static QString SideFileName(const QString& lasFileName);
+
+	/// Builds the index by reading all the points of the file.
+	///
+	/// The reader is left positioned on the first point.
+	CC_FILE_ERROR build(laszip_POINTER laszipReader, const laszip_header& laszipHeader, unsigned pointCount, ccProgressDialog* progressDialog);
+
+	/// Loads the index associated to a LAS file.
+	///
+	/// Returns false if the index file doesn't exist, is invalid,
+	/// is older than the LAS file or doesn't correspond to its header.
+	bool load(const QString& lasFileName, const laszip_header& laszipHeader, unsigned pointCount);
+
+	/// Saves the index next to the LAS file
+	bool save(const QString& lasFileName) const;
+
+	/// Returns the (sorted and merged) intervals of the cells intersecting a 2D box
+	std::vector<Interval> query(const CCVector2d& boxMin, const CCVector2d& boxMax) const;
+
+  private:
+	/// Returns the index of the cell containing a 2D point
+	unsigned cellIndex(double x, double y) const;
+
+	/// Returns the number of cells along each dimension
+	inline unsigned cellCountPerDim() const
+	{
+		return 1u << m_level;
+	}
+
+	/// Quadtree depth (leaf cells)
+	unsigned m_level{0};
+	/// Number of points indexed
+	unsigned m_pointCount{0};
+	/// XY extents of the quadtree
+	CCVector2d m_min{0, 0};
+	CCVector2d m_max{0, 0};
+	/// Intervals of each leaf cell (row major order)
+	std::vector<std::vector<Interval>> m_cells;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+//##########################################################################
+//#                                                                        #
+//#                CLOUDCOMPARE PLUGIN: LAS-IO Plugin                      #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU General Public License as published by  #
+//#  the Free Software Foundation; version 2 of the License.               #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#                   COPYRIGHT: Thomas Montaigu                           #
+//#                                                                        #
+//##########################################################################
+
+#include "LasExtraScalarField.h"
+#include "LasPointFilter.h"
+#include "LasScalarField.h"
+
+// qCC_io
+#include <FileIOFilter.h>
+
+// LASzip
+#include <laszip/laszip_api.h>
+
+// System
+#include <memory>
+#include <vector>
+
+/// Reads the points of a LAS/LAZ file block by block.
+///
+/// Contrary to the standard loading, all the standard fields of the point format
+/// (and the extra fields) are always loaded, even if they only contain default values,
+/// so that all the blocks have the same structure. For the same reason, the colors
+/// depth and the GPS time shift are decided once for the whole file.
+///
+/// Waveforms and normals (as extra fields) are not handled.
+class LasStreamedReader : public FileIOFilter::StreamedReader
+{
+  public:
+	LasStreamedReader() = default;
+	~LasStreamedReader() override;
+
+	/// Opens the file and reads its first point (see firstPoint).
+	///
+	/// Only the points satisfying the given filter (if active) will be read.
+	CC_FILE_ERROR open(const QString& fileName, const FileIOFilter::PointsFilter& pointsFilter);
+
+	/// Returns the coordinates of the first point of the file
+	inline const CCVector3d& firstPoint() const
+	{
+		return m_firstPoint;
+	}
+
+	/// Returns the LAS offset of the file
+	CCVector3d lasOffset() const;
+
+	/// Sets the Global Shift applied to all the blocks
+	inline void setGlobalShift(const CCVector3d& globalShift, bool preserveGlobalShift)
+	{
+		m_globalShift         = globalShift;
+		m_preserveGlobalShift = preserveGlobalShift;
+	}
+
+	// Inherited from FileIOFilter::StreamedReader
+	qint64        pointCount() const override;
+	CC_FILE_ERROR readBlock(ccPointCloud& block, unsigned maxCount) override;
+
+  private:
+	laszip_POINTER m_laszipReader{nullptr};
+	laszip_header* m_laszipHeader{nullptr};
+	laszip_point*  m_laszipPoint{nullptr};
+	bool           m_readerIsOpen{false};
+
+	qint64 m_pointCount{0};
+	/// Index (in the file) of the next point to read
+	qint64 m_nextPointIndex{0};
+
+	std::vector<LasScalarField>      m_standardFields;
+	std::vector<LasExtraScalarField> m_extraFields;
+	std::unique_ptr<LasPointFilter>  m_pointFilter;
+
+	CCVector3d m_firstPoint{0, 0, 0};
+	CCVector3d m_globalShift{0, 0, 0};
+	bool       m_preserveGlobalShift{false};
+
+	double        m_timeShift{0.0};
+	bool          m_hasRGB{false};
+	unsigned char m_colorCompShift{0};
+	/// The colors depth is decided with the first point that is not black
+	bool m_colorCompShiftIsSet{false};
+};
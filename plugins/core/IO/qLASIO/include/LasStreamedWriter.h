@@ -0,0 +1,52 @@
+#pragma once
+
+//##########################################################################
+//#                                                                        #
+//#                CLOUDCOMPARE PLUGIN: LAS-IO Plugin                      #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU General Public License as published by  #
+//#  the Free Software Foundation; version 2 of the License.               #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#                   COPYRIGHT: Thomas Montaigu                           #
+//#                                                                        #
+//##########################################################################
+
+#include "LasSaver.h"
+
+// qCC_io
+#include <FileIOFilter.h>
+
+// System
+#include <memory>
+
+/// Writes the points of successive blocks (clouds with the same structure)
+/// in a single LAS/LAZ file.
+///
+/// The saving parameters (point format, fields, scale and offset) are
+/// determined with the first block. As the next blocks may lie outside of
+/// its extents, the original LAS scale (if any) is kept.
+///
+/// Waveforms and normals (as extra fields) are not saved.
+class LasStreamedWriter : public FileIOFilter::StreamedWriter
+{
+  public:
+	LasStreamedWriter(const QString& fileName, const FileIOFilter::SaveParameters& parameters);
+
+	// Inherited from FileIOFilter::StreamedWriter
+	CC_FILE_ERROR writeBlock(ccPointCloud& block) override;
+	CC_FILE_ERROR close() override;
+
+  private:
+	QString                      m_fileName;
+	FileIOFilter::SaveParameters m_parameters;
+	std::unique_ptr<LasSaver>    m_saver;
+	CCVector3d                   m_lasScale{1.0, 1.0, 1.0};
+	CCVector3d                   m_lasOffset{0.0, 0.0, 0.0};
+	qint64                       m_pointCount{0};
+};
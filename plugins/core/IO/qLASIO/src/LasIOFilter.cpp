@@ -19,10 +19,15 @@
 
 #include "LasMetadata.h"
 #include "LasOpenDialog.h"
+#include "LasParallelLoader.h"
+#include "LasPointFilter.h"
 #include "LasSaveDialog.h"
 #include "LasSaver.h"
 #include "LasScalarFieldLoader.h"
 #include "LasScalarFieldSaver.h"
+#include "LasSpatialIndex.h"
+#include "LasStreamedReader.h"
+#include "LasStreamedWriter.h"
 #include "LasVlr.h"
 #include "LasWaveformLoader.h"
 #include "LasWaveformSaver.h"
@@ -211,8 +216,56 @@ CC_FILE_ERROR LasIOFilter::loadFile(const QString&  fileName,
                                          });
 	m_openDialog.filterOutNotChecked(availableScalarFields, availableExtraScalarFields);
 
+	// the points filter given with the loading parameters (e.g. command line) has priority
+	const FileIOFilter::PointsFilter& pointsFilter = (parameters.pointsFilter.isActive() ? parameters.pointsFilter : m_openDialog.pointsFilter());
+	LasPointFilter                    pointFilter(pointsFilter);
+
+	// intervals of points to be read
+	std::vector<LasSpatialIndex::Interval> intervals{{0, static_cast<unsigned>(pointCount)}};
+	if (pointFilter.isActive())
+	{
+		ccLog::Print("[LAS] Points filter: " + pointFilter.description());
+
+		CCVector2d boxMin, boxMax;
+		if (pointsFilter.useSpatialIndex && pointFilter.spatialExtents(boxMin, boxMax))
+		{
+			LasSpatialIndex spatialIndex;
+			if (!spatialIndex.load(fileName, *laszipHeader, static_cast<unsigned>(pointCount)))
+			{
+				ccProgressDialog indexProgressDialog(true, parameters.parentWidget);
+				CC_FILE_ERROR    indexError = spatialIndex.build(laszipReader,
+				                                                 *laszipHeader,
+				                                                 static_cast<unsigned>(pointCount),
+				                                                 parameters.parentWidget ? &indexProgressDialog : nullptr);
+				if (indexError != CC_FERR_NO_ERROR)
+				{
+					laszip_close_reader(laszipReader);
+					laszip_clean(laszipReader);
+					laszip_destroy(laszipReader);
+					return indexError;
+				}
+
+				if (!spatialIndex.save(fileName))
+				{
+					ccLog::Warning(QString("[LAS] Failed to save the spatial index file '%1'").arg(LasSpatialIndex::SideFileName(fileName)));
+				}
+			}
+			intervals = spatialIndex.query(boxMin, boxMax);
+		}
+	}
+
+	unsigned selectedPointCount = 0;
+	for (const LasSpatialIndex::Interval& interval : intervals)
+	{
+		selectedPointCount += interval.count();
+	}
+	if (selectedPointCount < pointCount)
+	{
+		ccLog::Print(QString("[LAS] %1 points out of %2 will be read").arg(selectedPointCount).arg(pointCount));
+	}
+
 	auto pointCloud = std::make_unique<ccPointCloud>(QFileInfo(fileName).fileName());
-	if (!pointCloud->reserve(pointCount))
+	if (!pointCloud->reserve(selectedPointCount))
 	{
 		laszip_close_reader(laszipReader);
 		laszip_clean(laszipReader);
@@ -270,121 +323,198 @@ CC_FILE_ERROR LasIOFilter::loadFile(const QString&  fileName,
 	QScopedPointer<CCCoreLib::NormalizedProgress> normProgress;
 	if (parameters.parentWidget)
 	{
-		normProgress.reset(new CCCoreLib::NormalizedProgress(&progressDialog, pointCount));
+		normProgress.reset(new CCCoreLib::NormalizedProgress(&progressDialog, selectedPointCount));
 		progressDialog.start();
 	}
 
 	CC_FILE_ERROR error{CC_FERR_NO_ERROR};
 	CCVector3d    globalShift(0, 0, 0);
-	for (unsigned i = 0; i < pointCount; ++i)
+
+	// the global shift is determined with the first point
+	auto handleFirstPoint = [&]()
+	{
+		CCVector3d firstPoint(laszipCoordinates);
+
+		CCVector3d lasOffset(laszipHeader->x_offset,
+		                     laszipHeader->y_offset,
+		                     0.0 /*laszipHeader->z_offset*/); // it's never a good idea to shift along Z
+
+		globalShift = GetGlobalShift(parameters,
+		                             preserveGlobalShift,
+		                             lasOffset,
+		                             firstPoint);
+
+		if (preserveGlobalShift)
+		{
+			pointCloud->setGlobalShift(globalShift);
+		}
+
+		if (globalShift.norm2() != 0.0)
+		{
+			ccLog::Warning("[LAS] Cloud has been re-centered! Translation: "
+			               "(%.2f ; %.2f ; %.2f)",
+			               globalShift.x,
+			               globalShift.y,
+			               globalShift.z);
+		}
+	};
+
+	bool loadInParallel = !waveformLoader
+	                      && !pointFilter.isActive()
+	                      && m_openDialog.shouldLoadInParallel()
+	                      && LasParallelLoader::IsWorthIt(*laszipHeader, static_cast<unsigned>(pointCount));
+	if (loadInParallel)
 	{
-		if (laszip_read_point(laszipReader))
+		if (laszip_read_point(laszipReader) || laszip_get_coordinates(laszipReader, laszipCoordinates))
 		{
 			error = CC_FERR_THIRD_PARTY_LIB_FAILURE; // error will be logged later
-			break;
 		}
+		else
+		{
+			handleFirstPoint();
+
+			LasParallelLoader parallelLoader(fileName,
+			                                 *laszipHeader,
+			                                 availableScalarFields,
+			                                 availableExtraScalarFields,
+			                                 extraScalarFieldsToLoadAsNormals,
+			                                 loader);
+
+			error = parallelLoader.load(laszipReader,
+			                            static_cast<unsigned>(pointCount),
+			                            globalShift,
+			                            *pointCloud,
+			                            parameters.parentWidget ? &progressDialog : nullptr);
+
+			if (error == CC_FERR_NOT_ENOUGH_MEMORY)
+			{
+				// the cloud and the scalar fields have been released
+				laszip_close_reader(laszipReader);
+				laszip_clean(laszipReader);
+				laszip_destroy(laszipReader);
+				return error;
+			}
+		}
+	}
 
-		if (laszip_get_coordinates(laszipReader, laszipCoordinates))
+	unsigned nextPointIndex = 0;
+	for (size_t intervalIndex = 0; !loadInParallel && intervalIndex < intervals.size(); ++intervalIndex)
+	{
+		const LasSpatialIndex::Interval& interval = intervals[intervalIndex];
+		if (interval.start != nextPointIndex && laszip_seek_point(laszipReader, interval.start))
 		{
 			error = CC_FERR_THIRD_PARTY_LIB_FAILURE; // error will be logged later
 			break;
 		}
 
-		if (i == 0)
+		for (unsigned i = interval.start; i < interval.end; ++i)
 		{
-			CCVector3d firstPoint(laszipCoordinates);
-
-			CCVector3d lasOffset(laszipHeader->x_offset,
-			                     laszipHeader->y_offset,
-			                     0.0 /*laszipHeader->z_offset*/); // it's never a good idea to shift along Z
-
-			globalShift = GetGlobalShift(parameters,
-			                             preserveGlobalShift,
-			                             lasOffset,
-			                             firstPoint);
+			if (laszip_read_point(laszipReader))
+			{
+				error = CC_FERR_THIRD_PARTY_LIB_FAILURE; // error will be logged later
+				break;
+			}
 
-			if (preserveGlobalShift)
+			if (laszip_get_coordinates(laszipReader, laszipCoordinates))
 			{
-				pointCloud->setGlobalShift(globalShift);
+				error = CC_FERR_THIRD_PARTY_LIB_FAILURE; // error will be logged later
+				break;
 			}
 
-			if (globalShift.norm2() != 0.0)
+			if (pointFilter.isActive() && !pointFilter.accepts(*laszipPoint, laszipCoordinates))
 			{
-				ccLog::Warning("[LAS] Cloud has been re-centered! Translation: "
-				               "(%.2f ; %.2f ; %.2f)",
-				               globalShift.x,
-				               globalShift.y,
-				               globalShift.z);
+				if (normProgress && !normProgress->oneStep())
+				{
+					error = CC_FERR_CANCELED_BY_USER;
+					break;
+				}
+				continue;
 			}
-		}
 
-		currentPoint.x = static_cast<PointCoordinateType>(laszipCoordinates[0] + globalShift.x);
-		currentPoint.y = static_cast<PointCoordinateType>(laszipCoordinates[1] + globalShift.y);
-		currentPoint.z = static_cast<PointCoordinateType>(laszipCoordinates[2] + globalShift.z);
+			if (pointCloud->size() == 0)
+			{
+				handleFirstPoint();
+			}
 
-		pointCloud->addPoint(currentPoint);
+			currentPoint.x = static_cast<PointCoordinateType>(laszipCoordinates[0] + globalShift.x);
+			currentPoint.y = static_cast<PointCoordinateType>(laszipCoordinates[1] + globalShift.y);
+			currentPoint.z = static_cast<PointCoordinateType>(laszipCoordinates[2] + globalShift.z);
 
-		error = loader.handleScalarFields(*pointCloud, *laszipPoint);
-		if (error != CC_FERR_NO_ERROR)
-		{
-			break;
-		}
+			pointCloud->addPoint(currentPoint);
 
-		error = loader.handleExtraScalarFields(*laszipPoint);
-		if (error != CC_FERR_NO_ERROR)
-		{
-			break;
-		}
+			error = loader.handleScalarFields(*pointCloud, *laszipPoint);
+			if (error != CC_FERR_NO_ERROR)
+			{
+				break;
+			}
 
-		if (LasDetails::HasRGB(laszipHeader->point_data_format))
-		{
-			error = loader.handleRGBValue(*pointCloud, *laszipPoint);
+			error = loader.handleExtraScalarFields(*laszipPoint);
 			if (error != CC_FERR_NO_ERROR)
 			{
 				break;
 			}
-		}
 
-		if (waveformLoader)
-		{
-			waveformLoader->loadWaveform(*pointCloud, *laszipPoint);
-		}
+			if (LasDetails::HasRGB(laszipHeader->point_data_format))
+			{
+				error = loader.handleRGBValue(*pointCloud, *laszipPoint);
+				if (error != CC_FERR_NO_ERROR)
+				{
+					break;
+				}
+			}
 
-		if (haveToLoadNormals)
-		{
-			CCVector3 normal{};
-			// Here, the array has 3 values, not because normals have 3 dimensions (x, y, z)
-			// but because extra scalar field may have 3 dimensions.
-			// Regardless of whether the extra scalar field has more than 1 dimensions
-			// we only use the first one for each normal dimension.
-			for (unsigned int normalIndex = 0; normalIndex < 3; ++normalIndex)
+			if (waveformLoader)
 			{
-				const LasExtraScalarField& extraField = extraScalarFieldsToLoadAsNormals[normalIndex];
-				if (extraField.type == LasExtraScalarField::DataType::Undocumented)
+				waveformLoader->loadWaveform(*pointCloud, *laszipPoint);
+			}
+
+			if (haveToLoadNormals)
+			{
+				CCVector3 normal{};
+				// Here, the array has 3 values, not because normals have 3 dimensions (x, y, z)
+				// but because extra scalar field may have 3 dimensions.
+				// Regardless of whether the extra scalar field has more than 1 dimensions
+				// we only use the first one for each normal dimension.
+				for (unsigned int normalIndex = 0; normalIndex < 3; ++normalIndex)
 				{
-					continue;
+					const LasExtraScalarField& extraField = extraScalarFieldsToLoadAsNormals[normalIndex];
+					if (extraField.type == LasExtraScalarField::DataType::Undocumented)
+					{
+						continue;
+					}
+					ScalarType normalsValues[3]{0, 0, 0};
+					error = loader.parseExtraScalarField(extraField, *laszipPoint, normalsValues);
+					if (error != CC_FERR_NO_ERROR)
+					{
+						break;
+					}
+					normal[normalIndex] = normalsValues[0];
 				}
-				ScalarType normalsValues[3]{0, 0, 0};
-				error = loader.parseExtraScalarField(extraField, *laszipPoint, normalsValues);
+
 				if (error != CC_FERR_NO_ERROR)
 				{
 					break;
 				}
-				normal[normalIndex] = normalsValues[0];
+				pointCloud->addNorm(normal);
 			}
 
-			if (error != CC_FERR_NO_ERROR)
+			if (normProgress && !normProgress->oneStep())
 			{
+				error = CC_FERR_CANCELED_BY_USER;
 				break;
 			}
-			pointCloud->addNorm(normal);
 		}
 
-		if (normProgress && !normProgress->oneStep())
+		if (error != CC_FERR_NO_ERROR)
 		{
-			error = CC_FERR_CANCELED_BY_USER;
 			break;
 		}
+		nextPointIndex = interval.end;
+	}
+
+	if (error == CC_FERR_NO_ERROR && pointFilter.isActive() && pointCloud->size() == 0)
+	{
+		ccLog::Warning("[LAS] No point satisfies the filter");
 	}
 
 	for (const LasScalarField& field : loader.standardFields())
@@ -494,32 +624,65 @@ CC_FILE_ERROR LasIOFilter::loadFile(const QString&  fileName,
 	return error;
 }
 
-bool LasIOFilter::canSave(CC_CLASS_ENUM type, bool& multiple, bool& exclusive) const
+FileIOFilter::StreamedReader::Shared LasIOFilter::createStreamedReader(const QString& fileName, LoadParameters& parameters, CC_FILE_ERROR& result)
 {
-	multiple  = false;
-	exclusive = true;
-	return type == CC_TYPES::POINT_CLOUD;
-}
+	QSharedPointer<LasStreamedReader> reader(new LasStreamedReader);
+	result = reader->open(fileName, parameters.pointsFilter);
+	if (result != CC_FERR_NO_ERROR)
+	{
+		return {};
+	}
 
-CC_FILE_ERROR LasIOFilter::saveToFile(ccHObject* entity, const QString& filename, const FileIOFilter::SaveParameters& parameters)
-{
-	if (!entity || filename.isEmpty())
+	if (reader->pointCount() != 0)
 	{
-		return CC_FERR_BAD_ARGUMENT;
+		bool       preserveGlobalShift{true};
+		CCVector3d globalShift = GetGlobalShift(parameters,
+		                                        preserveGlobalShift,
+		                                        reader->lasOffset(),
+		                                        reader->firstPoint());
+		reader->setGlobalShift(globalShift, preserveGlobalShift);
+
+		if (globalShift.norm2() != 0.0)
+		{
+			ccLog::Warning("[LAS] Cloud has been re-centered! Translation: "
+			               "(%.2f ; %.2f ; %.2f)",
+			               globalShift.x,
+			               globalShift.y,
+			               globalShift.z);
+		}
 	}
 
-	if (!entity->isA(CC_TYPES::POINT_CLOUD))
+	return reader;
+}
+
+FileIOFilter::StreamedWriter::Shared LasIOFilter::createStreamedWriter(const QString& fileName, const SaveParameters& parameters, CC_FILE_ERROR& result)
+{
+	if (fileName.isEmpty())
 	{
-		return CC_FERR_BAD_ENTITY_TYPE;
+		result = CC_FERR_BAD_ARGUMENT;
+		return {};
 	}
-	auto* pointCloud = static_cast<ccPointCloud*>(entity);
 
-	LasSaveDialog saveDialog(pointCloud, parameters.parentWidget);
+	// the file is actually created with the first block
+	result = CC_FERR_NO_ERROR;
+	return StreamedWriter::Shared(new LasStreamedWriter(fileName, parameters));
+}
+
+bool LasIOFilter::canSave(CC_CLASS_ENUM type, bool& multiple, bool& exclusive) const
+{
+	multiple  = false;
+	exclusive = true;
+	return type == CC_TYPES::POINT_CLOUD;
+}
+
+CC_FILE_ERROR LasIOFilter::SaverParametersFor(ccPointCloud& pointCloud, const SaveParameters& parameters, LasSaver::Parameters& params)
+{
+	LasSaveDialog saveDialog(&pointCloud, parameters.parentWidget);
 
 	CCVector3d bbMax, bbMin;
-	if (!pointCloud->getOwnGlobalBB(bbMin, bbMax))
+	if (!pointCloud.getOwnGlobalBB(bbMin, bbMax))
 	{
-		if (pointCloud->size() != 0)
+		if (pointCloud.size() != 0)
 		{
 			// it can only be acceptable if the cloud is empty
 			//(yes, some people expect to save empty clouds!)
@@ -533,11 +696,11 @@ CC_FILE_ERROR LasIOFilter::saveToFile(ccHObject* entity, const QString& filename
 
 	// Determine the best LAS offset (required for determing the best LAS scale)
 	CCVector3d lasOffset;
-	bool       hasLASOffset       = LasMetadata::LoadOffsetFrom(*pointCloud, lasOffset);
+	bool       hasLASOffset       = LasMetadata::LoadOffsetFrom(pointCloud, lasOffset);
 	bool       lasOffsetCanBeUsed = hasLASOffset && !ccGlobalShiftManager::NeedShift(bbMax - lasOffset);
 
-	CCVector3d globaShift           = pointCloud->getGlobalShift();
-	bool       hasGlobalShift       = pointCloud->isShifted();
+	CCVector3d globaShift           = pointCloud.getGlobalShift();
+	bool       hasGlobalShift       = pointCloud.isShifted();
 	bool       globalShiftCanBeUsed = hasGlobalShift && !ccGlobalShiftManager::NeedShift(bbMax + globaShift); //'global shift' is the opposite of LAS offset ;)
 
 	bool minBBCornerCanBeUsed = !ccGlobalShiftManager::NeedShift(bbMax - bbMin);
@@ -578,7 +741,7 @@ CC_FILE_ERROR LasIOFilter::saveToFile(ccHObject* entity, const QString& filename
 	// See if we have a scale from an origin las file
 	CCVector3d originalScale;
 	bool       canUseOriginalScale = false;
-	bool       hasScaleMetaData    = LasMetadata::LoadScaleFrom(*pointCloud, originalScale);
+	bool       hasScaleMetaData    = LasMetadata::LoadScaleFrom(pointCloud, originalScale);
 	if (hasScaleMetaData)
 	{
 		// We may not be able to use the previous LAS scale
@@ -601,16 +764,16 @@ CC_FILE_ERROR LasIOFilter::saveToFile(ccHObject* entity, const QString& filename
 
 	// Find the best version for the file or try to use the one from original file
 	LasDetails::LasVersion savedVersion;
-	bool                   hasSavedVersion = LasMetadata::LoadLasVersionFrom(*pointCloud, savedVersion);
-	LasDetails::LasVersion bestVersion     = LasDetails::SelectBestVersion(*pointCloud, hasSavedVersion ? savedVersion.minorVersion : 0);
+	bool                   hasSavedVersion = LasMetadata::LoadLasVersionFrom(pointCloud, savedVersion);
+	LasDetails::LasVersion bestVersion     = LasDetails::SelectBestVersion(pointCloud, hasSavedVersion ? savedVersion.minorVersion : 0);
 
 	saveDialog.setVersionAndPointFormat(bestVersion);
 
 	// Try to pre-fill in the UI any saved extra scalar fields
 	LasVlr vlr;
-	if (LasMetadata::LoadVlrs(*pointCloud, vlr))
+	if (LasMetadata::LoadVlrs(pointCloud, vlr))
 	{
-		LasExtraScalarField::MatchExtraBytesToScalarFields(vlr.extraScalarFields, *pointCloud);
+		LasExtraScalarField::MatchExtraBytesToScalarFields(vlr.extraScalarFields, pointCloud);
 	}
 
 	saveDialog.setExtraScalarFields(vlr.extraScalarFields);
@@ -624,28 +787,25 @@ CC_FILE_ERROR LasIOFilter::saveToFile(ccHObject* entity, const QString& filename
 		}
 	}
 
-	LasSaver::Parameters params;
-	{
-		params.standardFields                      = saveDialog.fieldsToSave();
-		params.extraFields                         = saveDialog.extraFieldsToSave();
-		params.shouldSaveRGB                       = saveDialog.shouldSaveRGB();
-		params.shouldSaveNormalsAsExtraScalarField = saveDialog.shouldSaveNormalsAsExtraScalarField();
-		params.shouldSaveWaveform                  = saveDialog.shouldSaveWaveform();
+	params.standardFields                      = saveDialog.fieldsToSave();
+	params.extraFields                         = saveDialog.extraFieldsToSave();
+	params.shouldSaveRGB                       = saveDialog.shouldSaveRGB();
+	params.shouldSaveNormalsAsExtraScalarField = saveDialog.shouldSaveNormalsAsExtraScalarField();
+	params.shouldSaveWaveform                  = saveDialog.shouldSaveWaveform();
 
-		saveDialog.selectedVersion(params.versionMajor, params.versionMinor);
-		params.pointFormat = saveDialog.selectedPointFormat();
+	saveDialog.selectedVersion(params.versionMajor, params.versionMinor);
+	params.pointFormat = saveDialog.selectedPointFormat();
 
-		params.lasScale  = saveDialog.chosenScale();
-		params.lasOffset = lasOffset;
-	}
+	params.lasScale  = saveDialog.chosenScale();
+	params.lasOffset = lasOffset;
 
 	// In case of command line call, add automatically all remaining scalar fields as extra scalar fields
 	if (!parameters.alwaysDisplaySaveDialog)
 	{
-		uint sfCount = pointCloud->getNumberOfScalarFields();
+		uint sfCount = pointCloud.getNumberOfScalarFields();
 		for (uint index = 0; index < sfCount; index++)
 		{
-			ccScalarField* sf     = static_cast<ccScalarField*>(pointCloud->getScalarField(index));
+			ccScalarField* sf     = static_cast<ccScalarField*>(pointCloud.getScalarField(index));
 			const char*    sfName = sf->getName();
 			bool           found  = false;
 			for (auto& el : params.standardFields)
@@ -688,8 +848,31 @@ CC_FILE_ERROR LasIOFilter::saveToFile(ccHObject* entity, const QString& filename
 		}
 	}
 
-	LasSaver      saver(*pointCloud, params);
-	CC_FILE_ERROR error = saver.open(filename);
+	return CC_FERR_NO_ERROR;
+}
+
+CC_FILE_ERROR LasIOFilter::saveToFile(ccHObject* entity, const QString& filename, const FileIOFilter::SaveParameters& parameters)
+{
+	if (!entity || filename.isEmpty())
+	{
+		return CC_FERR_BAD_ARGUMENT;
+	}
+
+	if (!entity->isA(CC_TYPES::POINT_CLOUD))
+	{
+		return CC_FERR_BAD_ENTITY_TYPE;
+	}
+	auto* pointCloud = static_cast<ccPointCloud*>(entity);
+
+	LasSaver::Parameters params;
+	CC_FILE_ERROR        error = SaverParametersFor(*pointCloud, parameters, params);
+	if (error != CC_FERR_NO_ERROR)
+	{
+		return error;
+	}
+
+	LasSaver saver(*pointCloud, params);
+	error = saver.open(filename);
 	if (error != CC_FERR_NO_ERROR)
 	{
 		return error;
@@ -20,6 +20,7 @@
 // Qt
 #include <QFileDialog>
 #include <QLocale>
+#include <QRegExp>
 #include <QSettings>
 #include <QStringListModel>
 
@@ -149,6 +150,7 @@ void LasOpenDialog::setInfo(int versionMinor, int pointFormatId, qulonglong numP
 
 	force8bitColorsCheckBox->setEnabled(LasDetails::HasRGB(pointFormatId));
 	timeShiftLayout->setEnabled(LasDetails::HasGpsTime(pointFormatId));
+	gpsTimeFilterCheckBox->setEnabled(LasDetails::HasGpsTime(pointFormatId));
 }
 
 void LasOpenDialog::setAvailableScalarFields(const std::vector<LasScalarField>&      scalarFields,
@@ -268,6 +270,11 @@ bool LasOpenDialog::shouldForce8bitColors() const
 	return force8bitColorsCheckBox->isChecked();
 }
 
+bool LasOpenDialog::shouldLoadInParallel() const
+{
+	return parallelLoadingCheckBox->isChecked();
+}
+
 double LasOpenDialog::timeShiftValue() const
 {
 	if (automaticTimeShiftCheckBox->isChecked())
@@ -278,6 +285,69 @@ double LasOpenDialog::timeShiftValue() const
 	return manualTimeShiftSpinBox->value();
 }
 
+FileIOFilter::PointsFilter LasOpenDialog::pointsFilter() const
+{
+	FileIOFilter::PointsFilter filter;
+	if (!filterGroupBox->isChecked())
+	{
+		return filter;
+	}
+
+	if (boxFilterCheckBox->isChecked())
+	{
+		filter.useBox = true;
+		filter.boxMin = CCVector2d(boxMinXSpinBox->value(), boxMinYSpinBox->value());
+		filter.boxMax = CCVector2d(boxMaxXSpinBox->value(), boxMaxYSpinBox->value());
+	}
+
+	for (const QString& vertex : polygonLineEdit->text().split(';', QString::SkipEmptyParts))
+	{
+		QStringList coordinates = vertex.split(QRegExp("[,\\s]+"), QString::SkipEmptyParts);
+		bool        okX{false}, okY{false};
+		if (coordinates.size() == 2)
+		{
+			CCVector2d P(coordinates[0].toDouble(&okX), coordinates[1].toDouble(&okY));
+			if (okX && okY)
+			{
+				filter.polygon.push_back(P);
+				continue;
+			}
+		}
+		ccLog::Warning(QString("[LAS] Invalid polygon vertex '%1' (ignored)").arg(vertex.trimmed()));
+	}
+
+	for (const QString& value : classificationsLineEdit->text().split(QRegExp("[,;\\s]+"), QString::SkipEmptyParts))
+	{
+		bool ok{false};
+		int  classification = value.toInt(&ok);
+		if (ok)
+		{
+			filter.classifications.push_back(classification);
+		}
+	}
+
+	for (const QString& value : returnNumbersLineEdit->text().split(QRegExp("[,;\\s]+"), QString::SkipEmptyParts))
+	{
+		bool ok{false};
+		int  returnNumber = value.toInt(&ok);
+		if (ok)
+		{
+			filter.returnNumbers.push_back(returnNumber);
+		}
+	}
+
+	if (gpsTimeFilterCheckBox->isChecked())
+	{
+		filter.useGpsTimeRange = true;
+		filter.minGpsTime      = minGpsTimeSpinBox->value();
+		filter.maxGpsTime      = maxGpsTimeSpinBox->value();
+	}
+
+	filter.useSpatialIndex = useSpatialIndexCheckBox->isChecked();
+
+	return filter;
+}
+
 bool LasOpenDialog::isChecked(const LasExtraScalarField& lasExtraScalarField) const
 {
 	return IsCheckedIn(lasExtraScalarField.name, availableExtraScalarFields);
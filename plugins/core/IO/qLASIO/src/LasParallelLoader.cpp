@@ -0,0 +1,761 @@
+//##########################################################################
+//#                                                                        #
+//#                CLOUDCOMPARE PLUGIN: LAS-IO Plugin                      #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU General Public License as published by  #
+//#  the Free Software Foundation; version 2 of the License.               #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#                   COPYRIGHT: Thomas Montaigu                           #
+//#                                                                        #
+//##########################################################################
+
+#include "LasParallelLoader.h"
+
+#include "LasDetails.h"
+
+// qCC_db
+#include <ccNormalVectors.h>
+#include <ccPointCloud.h>
+#include <ccProgressDialog.h>
+#include <ccScalarField.h>
+
+// Qt
+#include <QCoreApplication>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentMap>
+
+// System
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+/// Default number of points per chunk in LAZ files.
+///
+/// Ranges are aligned on it so that each chunk is only decoded by a single reader
+/// (laszip_seek_point has to decode the chunk from its start otherwise)
+constexpr unsigned LAZ_DEFAULT_CHUNK_SIZE = 50000;
+/// Below this number of points, the sequential loading is fast enough
+constexpr unsigned MIN_POINT_COUNT_FOR_PARALLEL_LOADING = 20 * LAZ_DEFAULT_CHUNK_SIZE;
+/// Number of ranges per thread (so that faster threads can help the slower ones)
+constexpr unsigned RANGES_PER_THREAD = 4;
+/// Maximum number of points read sequentially to determine the colors depth and the GPS time shift
+constexpr unsigned MAX_PROBED_POINT_COUNT = LAZ_DEFAULT_CHUNK_SIZE;
+/// Number of points decoded by a worker between two updates of the shared progress counter
+constexpr unsigned PROGRESS_STEP = 4096;
+
+namespace
+{
+	/// Decisions that depend on the first (non default) values of the file
+	struct Decisions
+	{
+		/// Shift to apply to the RGB components (-1 if not known yet)
+		int colorCompShift{-1};
+		/// Whether the GPS time shift is known
+		bool timeShiftIsKnown{false};
+		/// The GPS time shift
+		double timeShift{0.0};
+	};
+
+	/// A range of points decoded by a single reader
+	struct LoadingRange
+	{
+		unsigned first{0};
+		unsigned count{0};
+
+		/// Error that stopped the decoding of this range (if any)
+		CC_FILE_ERROR error{CC_FERR_NO_ERROR};
+		/// Number of points of the range that were decoded
+		unsigned decodedCount{0};
+		/// Whether a non-default value was found (one entry per standard field)
+		std::vector<char> hasNonDefaultValue;
+		/// RGB components shift found in this range (only if it was not known beforehand)
+		int localColorCompShift{-1};
+		/// Whether a non-zero GPS time was found in this range
+		bool hasNonZeroTime{false};
+		/// Index of the first non-zero GPS time of this range
+		unsigned firstNonZeroTimeIndex{0};
+		/// First non-zero GPS time of this range
+		double firstNonZeroTime{0.0};
+		/// GPS time shift found in this range (only if it was not known beforehand)
+		double localTimeShift{0.0};
+
+		inline bool isComplete() const
+		{
+			return error == CC_FERR_NO_ERROR && decodedCount == count;
+		}
+	};
+
+	/// Data shared by all the workers
+	struct LoadingContext
+	{
+		const char*                               fileName{nullptr};
+		const std::vector<LasScalarField>*        standardFields{nullptr};
+		const std::vector<LasExtraScalarField>*   extraFields{nullptr};
+		const std::array<LasExtraScalarField, 3>* extraFieldsAsNormals{nullptr};
+		const LasScalarFieldLoader*               loader{nullptr};
+		CCVector3d                                globalShift;
+		Decisions                                 decisions;
+
+		ccPointCloud*          pointCloud{nullptr};
+		RGBAColorsTableType*   colors{nullptr};
+		NormsIndexesTableType* normals{nullptr};
+
+		std::atomic<unsigned> decodedPointCount{0};
+		std::atomic<bool>     cancelRequested{false};
+	};
+} // namespace
+
+static void CloseReader(laszip_POINTER laszipReader)
+{
+	laszip_close_reader(laszipReader);
+	laszip_clean(laszipReader);
+	laszip_destroy(laszipReader);
+}
+
+/// Decodes the current point of a reader and stores it (and its features) at the given index
+static CC_FILE_ERROR DecodePoint(LoadingContext&       context,
+                                 LoadingRange&         range,
+                                 LasScalarFieldLoader& parser,
+                                 laszip_POINTER        laszipReader,
+                                 const laszip_point&   laszipPoint,
+                                 unsigned              pointIndex)
+{
+	laszip_F64 laszipCoordinates[3]{0};
+	if (laszip_get_coordinates(laszipReader, laszipCoordinates))
+	{
+		return CC_FERR_THIRD_PARTY_LIB_FAILURE;
+	}
+
+	context.pointCloud->setPoint(pointIndex,
+	                             CCVector3(static_cast<PointCoordinateType>(laszipCoordinates[0] + context.globalShift.x),
+	                                       static_cast<PointCoordinateType>(laszipCoordinates[1] + context.globalShift.y),
+	                                       static_cast<PointCoordinateType>(laszipCoordinates[2] + context.globalShift.z)));
+
+	const Decisions& decisions = context.decisions;
+
+	for (size_t fieldIndex = 0; fieldIndex < context.standardFields->size(); ++fieldIndex)
+	{
+		const LasScalarField& field = context.standardFields->at(fieldIndex);
+		double                value = LasScalarFieldLoader::StandardFieldValue(field.id, laszipPoint);
+		if (value != 0.0)
+		{
+			range.hasNonDefaultValue[fieldIndex] = 1;
+		}
+
+		if (field.id == LasScalarField::GpsTime)
+		{
+			if (value != 0.0 && !range.hasNonZeroTime)
+			{
+				range.hasNonZeroTime        = true;
+				range.firstNonZeroTimeIndex = pointIndex;
+				range.firstNonZeroTime      = value;
+
+				if (!decisions.timeShiftIsKnown)
+				{
+					// the leading zeros of this range couldn't be shifted yet
+					range.localTimeShift = LasScalarFieldLoader::AutomaticTimeShift(value);
+					for (unsigned j = range.first; j < pointIndex; ++j)
+					{
+						field.sf->setValue(j, static_cast<ScalarType>(0.0 - range.localTimeShift));
+					}
+				}
+			}
+
+			value -= (decisions.timeShiftIsKnown ? decisions.timeShift : range.localTimeShift);
+		}
+
+		field.sf->setValue(pointIndex, static_cast<ScalarType>(value));
+	}
+
+	if (context.colors)
+	{
+		int colorCompShift = (decisions.colorCompShift >= 0 ? decisions.colorCompShift : range.localColorCompShift);
+		if (colorCompShift < 0 && (laszipPoint.rgb[0] | laszipPoint.rgb[1] | laszipPoint.rgb[2]) != 0)
+		{
+			range.localColorCompShift = colorCompShift = LasScalarFieldLoader::ColorCompShiftFor(laszipPoint, context.loader->force8bitRgbMode());
+		}
+
+		if (colorCompShift < 0)
+		{
+			// only black points so far
+			context.colors->setValue(pointIndex, ccColor::black);
+		}
+		else
+		{
+			context.colors->setValue(pointIndex,
+			                         ccColor::Rgba(static_cast<ColorCompType>(laszipPoint.rgb[0] >> colorCompShift),
+			                                       static_cast<ColorCompType>(laszipPoint.rgb[1] >> colorCompShift),
+			                                       static_cast<ColorCompType>(laszipPoint.rgb[2] >> colorCompShift),
+			                                       ccColor::MAX));
+		}
+	}
+
+	for (const LasExtraScalarField& extraField : *context.extraFields)
+	{
+		ScalarType finalValues[3]{0};
+
+		CC_FILE_ERROR error = parser.parseExtraScalarField(extraField, laszipPoint, finalValues);
+		if (error != CC_FERR_NO_ERROR)
+		{
+			return error;
+		}
+
+		for (unsigned dimIndex = 0; dimIndex < extraField.numElements(); ++dimIndex)
+		{
+			if (extraField.scalarFields[dimIndex])
+			{
+				extraField.scalarFields[dimIndex]->setValue(pointIndex, finalValues[dimIndex]);
+			}
+		}
+	}
+
+	if (context.normals)
+	{
+		CCVector3 normal{};
+		// see LasIOFilter::loadFile: only the first dimension of each extra field is used
+		for (unsigned normalIndex = 0; normalIndex < 3; ++normalIndex)
+		{
+			const LasExtraScalarField& extraField = context.extraFieldsAsNormals->at(normalIndex);
+			if (extraField.type == LasExtraScalarField::DataType::Undocumented)
+			{
+				continue;
+			}
+			ScalarType normalsValues[3]{0, 0, 0};
+
+			CC_FILE_ERROR error = parser.parseExtraScalarField(extraField, laszipPoint, normalsValues);
+			if (error != CC_FERR_NO_ERROR)
+			{
+				return error;
+			}
+			normal[normalIndex] = normalsValues[0];
+		}
+		context.normals->setValue(pointIndex, ccNormalVectors::GetNormIndex(normal));
+	}
+
+	return CC_FERR_NO_ERROR;
+}
+
+/// Decodes a range of points with its own reader (worker thread)
+static void DecodeRange(LoadingContext& context, LoadingRange& range)
+{
+	range.error        = CC_FERR_NO_ERROR;
+	range.decodedCount = 0;
+	range.hasNonDefaultValue.assign(context.standardFields->size(), 0);
+	range.localColorCompShift = -1;
+	range.hasNonZeroTime      = false;
+	range.localTimeShift      = 0.0;
+
+	laszip_POINTER laszipReader{nullptr};
+	if (laszip_create(&laszipReader))
+	{
+		range.error = CC_FERR_THIRD_PARTY_LIB_FAILURE;
+		return;
+	}
+
+	laszip_BOOL   isCompressed{false};
+	laszip_point* laszipPoint{nullptr};
+	if (laszip_open_reader(laszipReader, context.fileName, &isCompressed)
+	    || laszip_get_point_pointer(laszipReader, &laszipPoint)
+	    || (range.first != 0 && laszip_seek_point(laszipReader, range.first)))
+	{
+		range.error = CC_FERR_THIRD_PARTY_LIB_FAILURE;
+		CloseReader(laszipReader);
+		return;
+	}
+
+	// the parsing buffers of the loader can't be shared between threads
+	LasScalarFieldLoader parser(*context.loader);
+
+	unsigned notReportedCount = 0;
+	for (unsigned i = 0; i < range.count; ++i)
+	{
+		if (context.cancelRequested)
+		{
+			range.error = CC_FERR_CANCELED_BY_USER;
+			break;
+		}
+
+		if (laszip_read_point(laszipReader))
+		{
+			range.error = CC_FERR_THIRD_PARTY_LIB_FAILURE;
+			break;
+		}
+
+		range.error = DecodePoint(context, range, parser, laszipReader, *laszipPoint, range.first + i);
+		if (range.error != CC_FERR_NO_ERROR)
+		{
+			break;
+		}
+		++range.decodedCount;
+
+		if (++notReportedCount == PROGRESS_STEP)
+		{
+			context.decodedPointCount += notReportedCount;
+			notReportedCount = 0;
+		}
+	}
+	context.decodedPointCount += notReportedCount;
+
+	if (range.error == CC_FERR_THIRD_PARTY_LIB_FAILURE)
+	{
+		laszip_CHAR* errorMsg{nullptr};
+		laszip_get_error(laszipReader, &errorMsg);
+		ccLog::Warning("[LAS] laszip error: '%s'", errorMsg);
+	}
+
+	CloseReader(laszipReader);
+}
+
+LasParallelLoader::LasParallelLoader(const QString&                            fileName,
+                                     const laszip_header&                      laszipHeader,
+                                     std::vector<LasScalarField>&              standardFields,
+                                     std::vector<LasExtraScalarField>&         extraFields,
+                                     const std::array<LasExtraScalarField, 3>& extraFieldsAsNormals,
+                                     const LasScalarFieldLoader&               loader)
+    : m_fileName(qPrintable(fileName))
+    , m_header(laszipHeader)
+    , m_standardFields(standardFields)
+    , m_extraFields(extraFields)
+    , m_extraFieldsAsNormals(extraFieldsAsNormals)
+    , m_loader(loader)
+{
+}
+
+bool LasParallelLoader::IsWorthIt(const laszip_header& laszipHeader, unsigned pointCount)
+{
+	return pointCount >= MIN_POINT_COUNT_FOR_PARALLEL_LOADING
+	       && QThreadPool::globalInstance()->maxThreadCount() > 1
+	       && !LasDetails::HasWaveform(laszipHeader.point_data_format);
+}
+
+bool LasParallelLoader::allocate(unsigned pointCount, bool withColors, bool withNormals, ccPointCloud& pointCloud)
+{
+	if (!pointCloud.resize(pointCount))
+	{
+		return false;
+	}
+	if (withColors && !pointCloud.resizeTheRGBTable())
+	{
+		return false;
+	}
+	if (withNormals && !pointCloud.resizeTheNormsTable())
+	{
+		return false;
+	}
+	for (LasScalarField& field : m_standardFields)
+	{
+		assert(field.sf == nullptr);
+		field.sf = new ccScalarField(field.name());
+		if (!field.sf->resizeSafe(pointCount))
+		{
+			return false;
+		}
+	}
+	for (LasExtraScalarField& extraField : m_extraFields)
+	{
+		for (unsigned dimIndex = 0; dimIndex < extraField.numElements(); ++dimIndex)
+		{
+			if (extraField.scalarFields[dimIndex] && !extraField.scalarFields[dimIndex]->resizeSafe(pointCount))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+void LasParallelLoader::release(ccPointCloud& pointCloud)
+{
+	for (LasScalarField& field : m_standardFields)
+	{
+		if (field.sf)
+		{
+			field.sf->release();
+			field.sf = nullptr;
+		}
+	}
+	for (LasExtraScalarField& extraField : m_extraFields)
+	{
+		for (unsigned dimIndex = 0; dimIndex < extraField.numElements(); ++dimIndex)
+		{
+			if (extraField.scalarFields[dimIndex])
+			{
+				extraField.scalarFields[dimIndex]->release();
+				extraField.scalarFields[dimIndex] = nullptr;
+			}
+		}
+	}
+
+	pointCloud.unallocateColors();
+	pointCloud.unallocateNorms();
+	pointCloud.resize(0);
+}
+
+CC_FILE_ERROR LasParallelLoader::load(laszip_POINTER    laszipReader,
+                                      unsigned          pointCount,
+                                      const CCVector3d& globalShift,
+                                      ccPointCloud&     pointCloud,
+                                      ccProgressDialog* progressDialog)
+{
+	laszip_point* laszipPoint{nullptr};
+	if (laszip_get_point_pointer(laszipReader, &laszipPoint))
+	{
+		return CC_FERR_THIRD_PARTY_LIB_FAILURE;
+	}
+
+	const bool ignoreDefaultValues = m_loader.ignoreFieldsWithDefaultValues();
+	const bool manualTimeShift     = !std::isnan(m_loader.manualTimeShift());
+	const bool hasRGB              = LasDetails::HasRGB(m_header.point_data_format);
+	const auto timeFieldIt         = std::find_if(m_standardFields.begin(),
+                                          m_standardFields.end(),
+                                          [](const LasScalarField& field)
+                                          { return field.id == LasScalarField::GpsTime; });
+	const bool loadTime            = (timeFieldIt != m_standardFields.end());
+	const bool loadNormals         = std::any_of(m_extraFieldsAsNormals.begin(),
+                                         m_extraFieldsAsNormals.end(),
+                                         [](const LasExtraScalarField& e)
+                                         { return e.type != LasExtraScalarField::DataType::Undocumented; });
+
+	// The sequential loader decides of the RGB components shift and of the GPS time shift
+	// with the first non-default values. We look for them in the first points.
+	Decisions decisions;
+	{
+		bool colorIsPending = hasRGB;
+		bool timeIsPending  = loadTime;
+		if (loadTime && manualTimeShift)
+		{
+			decisions.timeShiftIsKnown = true;
+			decisions.timeShift        = m_loader.manualTimeShift();
+			timeIsPending              = false;
+		}
+
+		const unsigned probedPointCount = std::min(pointCount, MAX_PROBED_POINT_COUNT);
+		for (unsigned i = 0; i < probedPointCount && (colorIsPending || timeIsPending); ++i)
+		{
+			// the first point has already been read
+			if (i != 0 && laszip_read_point(laszipReader))
+			{
+				// the workers will report the error
+				break;
+			}
+
+			if (colorIsPending && (!ignoreDefaultValues || (laszipPoint->rgb[0] | laszipPoint->rgb[1] | laszipPoint->rgb[2]) != 0))
+			{
+				decisions.colorCompShift = LasScalarFieldLoader::ColorCompShiftFor(*laszipPoint, m_loader.force8bitRgbMode());
+				colorIsPending           = false;
+			}
+
+			if (timeIsPending && (!ignoreDefaultValues || laszipPoint->gps_time != 0.0))
+			{
+				decisions.timeShiftIsKnown = true;
+				decisions.timeShift        = LasScalarFieldLoader::AutomaticTimeShift(laszipPoint->gps_time);
+				timeIsPending              = false;
+			}
+		}
+	}
+
+	// allocate everything beforehand
+	if (!allocate(pointCount, hasRGB, loadNormals, pointCloud))
+	{
+		release(pointCloud);
+		return CC_FERR_NOT_ENOUGH_MEMORY;
+	}
+
+	// split the file in ranges (aligned on the LAZ chunks)
+	std::vector<LoadingRange> ranges;
+	{
+		const unsigned threadCount = static_cast<unsigned>(std::max(QThreadPool::globalInstance()->maxThreadCount(), 1));
+		unsigned       rangeSize   = static_cast<unsigned>(std::ceil(static_cast<double>(pointCount) / (threadCount * RANGES_PER_THREAD)));
+		rangeSize                  = std::max(1u, (rangeSize + LAZ_DEFAULT_CHUNK_SIZE - 1) / LAZ_DEFAULT_CHUNK_SIZE) * LAZ_DEFAULT_CHUNK_SIZE;
+
+		try
+		{
+			ranges.reserve(pointCount / rangeSize + 1);
+			for (unsigned first = 0; first < pointCount; first += std::min(rangeSize, pointCount - first))
+			{
+				LoadingRange range;
+				range.first = first;
+				range.count = std::min(rangeSize, pointCount - first);
+				ranges.push_back(range);
+			}
+		}
+		catch (const std::bad_alloc&)
+		{
+			release(pointCloud);
+			return CC_FERR_NOT_ENOUGH_MEMORY;
+		}
+		ccLog::Print(QString("[LAS] Loading %1 points with %2 threads (%3 ranges)").arg(pointCount).arg(threadCount).arg(ranges.size()));
+	}
+
+	LoadingContext context;
+	context.fileName             = m_fileName.constData();
+	context.standardFields       = &m_standardFields;
+	context.extraFields          = &m_extraFields;
+	context.extraFieldsAsNormals = &m_extraFieldsAsNormals;
+	context.loader               = &m_loader;
+	context.globalShift          = globalShift;
+	context.decisions            = decisions;
+	context.pointCloud           = &pointCloud;
+	context.colors               = hasRGB ? pointCloud.rgbaColors() : nullptr;
+	context.normals              = loadNormals ? pointCloud.normals() : nullptr;
+
+	QFuture<void> future = QtConcurrent::map(ranges,
+	                                         [&context](LoadingRange& range)
+	                                         { DecodeRange(context, range); });
+	while (!future.isFinished())
+	{
+		QThread::msleep(100);
+		if (progressDialog)
+		{
+			if (progressDialog->isCancelRequested())
+			{
+				context.cancelRequested = true;
+			}
+			progressDialog->update(100.0f * context.decodedPointCount / pointCount);
+			QCoreApplication::processEvents();
+		}
+	}
+
+	// only keep the points that were completely decoded (from the start of the file)
+	CC_FILE_ERROR error          = CC_FERR_NO_ERROR;
+	size_t        completeRanges = 0;
+	while (completeRanges < ranges.size() && ranges[completeRanges].isComplete())
+	{
+		++completeRanges;
+	}
+	if (completeRanges < ranges.size())
+	{
+		const LoadingRange& failedRange = ranges[completeRanges];
+		error                           = (failedRange.error != CC_FERR_NO_ERROR ? failedRange.error : CC_FERR_CANCELED_BY_USER);
+		ranges.resize(completeRanges);
+	}
+	unsigned loadedCount = (ranges.empty() ? 0 : ranges.back().first + ranges.back().count);
+
+	// now we can take the decisions that the first points didn't allow to take,
+	// and fix the ranges that took a different local decision
+	std::vector<LoadingRange*> rangesToDecodeAgain;
+
+	bool keepColors = hasRGB;
+	if (hasRGB && context.decisions.colorCompShift < 0)
+	{
+		for (const LoadingRange& range : ranges)
+		{
+			if (range.localColorCompShift >= 0)
+			{
+				context.decisions.colorCompShift = range.localColorCompShift;
+				break;
+			}
+		}
+
+		// only black colors
+		keepColors = (context.decisions.colorCompShift >= 0);
+
+		for (LoadingRange& range : ranges)
+		{
+			if (range.localColorCompShift >= 0 && range.localColorCompShift != context.decisions.colorCompShift)
+			{
+				rangesToDecodeAgain.push_back(&range);
+			}
+		}
+	}
+
+	bool   keepTime         = loadTime;
+	double firstStoredTime  = 0.0;
+	if (loadTime)
+	{
+		ccScalarField* timeSF = timeFieldIt->sf;
+
+		const LoadingRange* firstRangeWithTime = nullptr;
+		for (const LoadingRange& range : ranges)
+		{
+			if (range.hasNonZeroTime)
+			{
+				firstRangeWithTime = &range;
+				break;
+			}
+		}
+
+		if (!ignoreDefaultValues)
+		{
+			// the first value is used (whatever its value)
+			assert(context.decisions.timeShiftIsKnown);
+			firstStoredTime = (loadedCount != 0 ? timeSF->getValue(0) + context.decisions.timeShift : 0.0);
+		}
+		else if (!firstRangeWithTime)
+		{
+			// only zeros
+			keepTime = false;
+		}
+		else
+		{
+			if (!context.decisions.timeShiftIsKnown)
+			{
+				context.decisions.timeShiftIsKnown = true;
+				context.decisions.timeShift        = firstRangeWithTime->localTimeShift;
+
+				for (LoadingRange& range : ranges)
+				{
+					if (range.first <= firstRangeWithTime->first)
+					{
+						continue;
+					}
+
+					if (!range.hasNonZeroTime)
+					{
+						// only zeros in this range
+						for (unsigned i = range.first; i < range.first + range.count; ++i)
+						{
+							timeSF->setValue(i, static_cast<ScalarType>(0.0 - context.decisions.timeShift));
+						}
+					}
+					else if (range.localTimeShift != context.decisions.timeShift
+					         && std::find(rangesToDecodeAgain.begin(), rangesToDecodeAgain.end(), &range) == rangesToDecodeAgain.end())
+					{
+						rangesToDecodeAgain.push_back(&range);
+					}
+				}
+			}
+
+			// the sequential loader stores the time shift as the value of the (zero) times
+			// preceding the first non-zero one
+			for (unsigned i = 0; i < firstRangeWithTime->firstNonZeroTimeIndex; ++i)
+			{
+				timeSF->setValue(i, static_cast<ScalarType>(context.decisions.timeShift));
+			}
+			firstStoredTime = firstRangeWithTime->firstNonZeroTime;
+		}
+	}
+
+	if (!rangesToDecodeAgain.empty())
+	{
+		ccLog::Print(QString("[LAS] %1 ranges have to be decoded again").arg(rangesToDecodeAgain.size()));
+
+		QtConcurrent::blockingMap(rangesToDecodeAgain,
+		                          [&context](LoadingRange* range)
+		                          { DecodeRange(context, *range); });
+
+		// the points of a range that failed this time are not valid: we only keep
+		// the points preceding the first one of these ranges
+		unsigned firstInvalidIndex = loadedCount;
+		for (const LoadingRange* range : rangesToDecodeAgain)
+		{
+			if (!range->isComplete())
+			{
+				firstInvalidIndex = std::min(firstInvalidIndex, range->first);
+			}
+		}
+
+		if (firstInvalidIndex < loadedCount)
+		{
+			ccLog::Warning(QString("[LAS] Failed to decode again the points starting at index %1").arg(firstInvalidIndex));
+			if (error == CC_FERR_NO_ERROR)
+			{
+				error = CC_FERR_READING;
+			}
+
+			// the ranges are sorted, and the invalid one is the first dropped
+			size_t keptRanges = 0;
+			while (keptRanges < ranges.size() && ranges[keptRanges].first < firstInvalidIndex)
+			{
+				++keptRanges;
+			}
+			ranges.resize(keptRanges);
+			rangesToDecodeAgain.clear();
+			loadedCount = firstInvalidIndex;
+
+			// the decisions may have been taken thanks to the dropped ranges
+			if (keepColors)
+			{
+				keepColors = (loadedCount != 0)
+				             && (decisions.colorCompShift >= 0
+				                 || std::any_of(ranges.begin(),
+				                                ranges.end(),
+				                                [](const LoadingRange& range)
+				                                { return range.localColorCompShift >= 0; }));
+			}
+			if (keepTime && ignoreDefaultValues)
+			{
+				keepTime = std::any_of(ranges.begin(),
+				                       ranges.end(),
+				                       [](const LoadingRange& range)
+				                       { return range.hasNonZeroTime; });
+			}
+		}
+	}
+
+	// release the fields that won't be added to the cloud
+	for (size_t fieldIndex = 0; fieldIndex < m_standardFields.size(); ++fieldIndex)
+	{
+		LasScalarField& field = m_standardFields[fieldIndex];
+
+		bool keepField = true;
+		if (field.id == LasScalarField::GpsTime)
+		{
+			keepField = keepTime;
+		}
+		else if (ignoreDefaultValues)
+		{
+			keepField = std::any_of(ranges.begin(),
+			                        ranges.end(),
+			                        [fieldIndex](const LoadingRange& range)
+			                        { return range.hasNonDefaultValue[fieldIndex] != 0; });
+		}
+
+		if (!keepField)
+		{
+			field.sf->release();
+			field.sf = nullptr;
+		}
+		else if (loadedCount < pointCount)
+		{
+			field.sf->resize(loadedCount);
+		}
+	}
+
+	if (keepTime)
+	{
+		// for consistency with the sequential loader (and its messages)
+		double timeShift = m_loader.timeShiftFor(firstStoredTime);
+		assert(timeShift == context.decisions.timeShift);
+		timeFieldIt->sf->setGlobalShift(timeShift);
+	}
+
+	if (loadedCount < pointCount)
+	{
+		for (LasExtraScalarField& extraField : m_extraFields)
+		{
+			for (unsigned dimIndex = 0; dimIndex < extraField.numElements(); ++dimIndex)
+			{
+				if (extraField.scalarFields[dimIndex])
+				{
+					extraField.scalarFields[dimIndex]->resize(loadedCount);
+				}
+			}
+		}
+		pointCloud.resize(loadedCount);
+	}
+
+	if (!keepColors)
+	{
+		pointCloud.unallocateColors();
+	}
+	else
+	{
+		pointCloud.colorsHaveChanged();
+	}
+	if (loadNormals)
+	{
+		pointCloud.normalsHaveChanged();
+	}
+	pointCloud.invalidateBoundingBox();
+
+	return error;
+}
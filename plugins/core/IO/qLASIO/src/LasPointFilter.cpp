@@ -0,0 +1,195 @@
+//##########################################################################
+//#                                                                        #
+//#                CLOUDCOMPARE PLUGIN: LAS-IO Plugin                      #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU General Public License as published by  #
+//#  the Free Software Foundation; version 2 of the License.               #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#                   COPYRIGHT: Thomas Montaigu                           #
+//#                                                                        #
+//##########################################################################
+
+#include "LasPointFilter.h"
+
+// Qt
+#include <QStringList>
+
+// System
+#include <algorithm>
+
+LasPointFilter::LasPointFilter(const FileIOFilter::PointsFilter& filter)
+    : m_filter(filter)
+{
+	for (int classification : m_filter.classifications)
+	{
+		if (classification >= 0 && classification < static_cast<int>(m_classifications.size()))
+		{
+			m_classifications.set(classification);
+		}
+	}
+
+	for (int returnNumber : m_filter.returnNumbers)
+	{
+		if (returnNumber >= 0 && returnNumber < static_cast<int>(m_returnNumbers.size()))
+		{
+			m_returnNumbers.set(returnNumber);
+		}
+	}
+}
+
+bool LasPointFilter::spatialExtents(CCVector2d& boxMin, CCVector2d& boxMax) const
+{
+	if (!m_filter.hasSpatialCriterion())
+	{
+		return false;
+	}
+
+	bool first = true;
+	if (m_filter.useBox)
+	{
+		boxMin = m_filter.boxMin;
+		boxMax = m_filter.boxMax;
+		first  = false;
+	}
+
+	if (m_filter.polygon.size() >= 3)
+	{
+		CCVector2d polyMin = m_filter.polygon.front();
+		CCVector2d polyMax = polyMin;
+		for (const CCVector2d& P : m_filter.polygon)
+		{
+			polyMin.x = std::min(polyMin.x, P.x);
+			polyMin.y = std::min(polyMin.y, P.y);
+			polyMax.x = std::max(polyMax.x, P.x);
+			polyMax.y = std::max(polyMax.y, P.y);
+		}
+
+		if (first)
+		{
+			boxMin = polyMin;
+			boxMax = polyMax;
+		}
+		else
+		{
+			// both criteria must be satisfied
+			boxMin.x = std::max(boxMin.x, polyMin.x);
+			boxMin.y = std::max(boxMin.y, polyMin.y);
+			boxMax.x = std::min(boxMax.x, polyMax.x);
+			boxMax.y = std::min(boxMax.y, polyMax.y);
+		}
+	}
+
+	return true;
+}
+
+bool LasPointFilter::isInsidePolygon(double x, double y) const
+{
+	// crossing number test (in double precision as LAS coordinates may be large)
+	const std::vector<CCVector2d>& polygon = m_filter.polygon;
+
+	bool   inside = false;
+	size_t count  = polygon.size();
+	for (size_t i = 0, j = count - 1; i < count; j = i++)
+	{
+		const CCVector2d& A = polygon[i];
+		const CCVector2d& B = polygon[j];
+		if ((A.y > y) != (B.y > y) && x < (B.x - A.x) * (y - A.y) / (B.y - A.y) + A.x)
+		{
+			inside = !inside;
+		}
+	}
+
+	return inside;
+}
+
+bool LasPointFilter::accepts(const laszip_point& point, const laszip_F64 coordinates[3]) const
+{
+	if (m_filter.useBox)
+	{
+		if (coordinates[0] < m_filter.boxMin.x || coordinates[0] > m_filter.boxMax.x
+		    || coordinates[1] < m_filter.boxMin.y || coordinates[1] > m_filter.boxMax.y)
+		{
+			return false;
+		}
+	}
+
+	if (!m_filter.classifications.empty())
+	{
+		unsigned classification = (point.extended_point_type ? point.extended_classification : point.classification);
+		if (!m_classifications.test(classification))
+		{
+			return false;
+		}
+	}
+
+	if (!m_filter.returnNumbers.empty())
+	{
+		unsigned returnNumber = (point.extended_point_type ? point.extended_return_number : point.return_number);
+		if (!m_returnNumbers.test(returnNumber))
+		{
+			return false;
+		}
+	}
+
+	if (m_filter.useGpsTimeRange)
+	{
+		if (point.gps_time < m_filter.minGpsTime || point.gps_time > m_filter.maxGpsTime)
+		{
+			return false;
+		}
+	}
+
+	if (m_filter.polygon.size() >= 3 && !isInsidePolygon(coordinates[0], coordinates[1]))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+QString LasPointFilter::description() const
+{
+	QStringList criteria;
+	if (m_filter.useBox)
+	{
+		criteria << QString("box [%1 ; %2] x [%3 ; %4]")
+		                .arg(m_filter.boxMin.x, 0, 'f', 2)
+		                .arg(m_filter.boxMax.x, 0, 'f', 2)
+		                .arg(m_filter.boxMin.y, 0, 'f', 2)
+		                .arg(m_filter.boxMax.y, 0, 'f', 2);
+	}
+	if (m_filter.polygon.size() >= 3)
+	{
+		criteria << QString("polygon (%1 vertices)").arg(m_filter.polygon.size());
+	}
+	if (!m_filter.classifications.empty())
+	{
+		QStringList values;
+		for (int classification : m_filter.classifications)
+		{
+			values << QString::number(classification);
+		}
+		criteria << QString("classification in {%1}").arg(values.join(','));
+	}
+	if (!m_filter.returnNumbers.empty())
+	{
+		QStringList values;
+		for (int returnNumber : m_filter.returnNumbers)
+		{
+			values << QString::number(returnNumber);
+		}
+		criteria << QString("return number in {%1}").arg(values.join(','));
+	}
+	if (m_filter.useGpsTimeRange)
+	{
+		criteria << QString("GPS time in [%1 ; %2]").arg(m_filter.minGpsTime, 0, 'f', 6).arg(m_filter.maxGpsTime, 0, 'f', 6);
+	}
+
+	return criteria.join(", ");
+}
@@ -12,7 +12,7 @@
 constexpr const char* const CC_NORMAL_NAMES[3] = {"Nx", "Ny", "Nz"};
 
 LasSaver::LasSaver(ccPointCloud& cloud, Parameters parameters)
-    : m_cloudToSave(cloud)
+    : m_cloudToSave(&cloud)
 {
 	// restore the global encoding (if any) - must be done before calling initLaszipHeader
 	LasMetadata::LoadGlobalEncoding(cloud, m_laszipHeader.global_encoding);
@@ -104,7 +104,7 @@ void LasSaver::initLaszipHeader(const Parameters& parameters)
 	m_laszipHeader.point_data_format = parameters.pointFormat;
 
 	// TODO global encoding wkt and other
-	if (LasDetails::HasWaveform(m_laszipHeader.point_data_format) && m_cloudToSave.hasFWF())
+	if (LasDetails::HasWaveform(m_laszipHeader.point_data_format) && m_cloudToSave->hasFWF())
 	{
 		// We always store FWF externally
 		m_laszipHeader.global_encoding |= 0b0000'0100;    // bit 2 = Waveform Data Packets External
@@ -116,7 +116,7 @@ void LasSaver::initLaszipHeader(const Parameters& parameters)
 	m_laszipHeader.point_data_record_length = LasDetails::PointFormatSize(m_laszipHeader.point_data_format);
 
 	LasVlr vlr;
-	if (LasMetadata::LoadVlrs(m_cloudToSave, vlr))
+	if (LasMetadata::LoadVlrs(*m_cloudToSave, vlr))
 	{
 		m_laszipHeader.vlrs                              = new laszip_vlr_struct[vlr.numVlrs()];
 		m_laszipHeader.number_of_variable_length_records = vlr.numVlrs();
@@ -150,7 +150,7 @@ LasSaver::~LasSaver() noexcept
 
 	if (m_originallySelectedScalarField != -1)
 	{
-		m_cloudToSave.setCurrentDisplayedScalarField(m_originallySelectedScalarField);
+		m_cloudToSave->setCurrentDisplayedScalarField(m_originallySelectedScalarField);
 
 		// m_originallySelectedScalarField it means we did create temporary
 		// Nx, Ny, Nz scalar fields, so we remove them
@@ -158,10 +158,10 @@ LasSaver::~LasSaver() noexcept
 		{
 			if (m_normalDimWasTemporarillyExported[i])
 			{
-				const int idx = m_cloudToSave.getScalarFieldIndexByName(CC_NORMAL_NAMES[i]);
+				const int idx = m_cloudToSave->getScalarFieldIndexByName(CC_NORMAL_NAMES[i]);
 				if (idx != -1)
 				{
-					m_cloudToSave.deleteScalarField(idx);
+					m_cloudToSave->deleteScalarField(idx);
 				}
 			}
 		}
@@ -208,7 +208,7 @@ CC_FILE_ERROR LasSaver::saveNextPoint()
 		return CC_FILE_ERROR::CC_FERR_INTERNAL;
 	}
 
-	if (m_currentPointIndex >= m_cloudToSave.size())
+	if (m_currentPointIndex >= m_cloudToSave->size())
 	{
 		return CC_FERR_NO_SAVE;
 	}
@@ -222,8 +222,8 @@ CC_FILE_ERROR LasSaver::saveNextPoint()
 	m_laszipPoint->num_extra_bytes     = num_extra_bytes;
 	m_laszipPoint->extended_point_type = m_laszipHeader.point_data_format >= 6;
 
-	const CCVector3* point       = m_cloudToSave.getPoint(m_currentPointIndex);
-	const CCVector3d globalPoint = m_cloudToSave.toGlobal3d<PointCoordinateType>(*point);
+	const CCVector3* point       = m_cloudToSave->getPoint(m_currentPointIndex);
+	const CCVector3d globalPoint = m_cloudToSave->toGlobal3d<PointCoordinateType>(*point);
 
 	if (laszip_set_coordinates(m_laszipWriter, globalPoint.u))
 	{
@@ -242,8 +242,8 @@ CC_FILE_ERROR LasSaver::saveNextPoint()
 
 	if (m_shouldSaveRGB)
 	{
-		assert(LasDetails::HasRGB(m_laszipHeader.point_data_format) && m_cloudToSave.hasColors());
-		const ccColor::Rgba& color = m_cloudToSave.getPointColor(m_currentPointIndex);
+		assert(LasDetails::HasRGB(m_laszipHeader.point_data_format) && m_cloudToSave->hasColors());
+		const ccColor::Rgba& color = m_cloudToSave->getPointColor(m_currentPointIndex);
 		m_laszipPoint->rgb[0]      = static_cast<laszip_U16>(color.r) << 8;
 		m_laszipPoint->rgb[1]      = static_cast<laszip_U16>(color.g) << 8;
 		m_laszipPoint->rgb[2]      = static_cast<laszip_U16>(color.b) << 8;
@@ -268,6 +268,31 @@ CC_FILE_ERROR LasSaver::saveNextPoint()
 	return CC_FERR_NO_ERROR;
 }
 
+bool LasSaver::setCloud(ccPointCloud& cloud)
+{
+	if (m_waveformSaver || m_originallySelectedScalarField != -1)
+	{
+		// the waveforms and the temporary normals scalar fields are tied to the original cloud
+		return false;
+	}
+
+	if (m_shouldSaveRGB && !cloud.hasColors())
+	{
+		ccLog::Warning("[LAS] Cloud has no colors");
+		return false;
+	}
+
+	if (!m_fieldsSaver.bindTo(cloud))
+	{
+		return false;
+	}
+
+	m_cloudToSave       = &cloud;
+	m_currentPointIndex = 0;
+
+	return true;
+}
+
 bool LasSaver::canSaveWaveforms() const
 {
 	return m_waveformSaver != nullptr;
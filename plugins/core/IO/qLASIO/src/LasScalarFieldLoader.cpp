@@ -32,76 +32,111 @@ LasScalarFieldLoader::LasScalarFieldLoader(std::vector<LasScalarField>&      sta
 	createScalarFieldsForExtraBytes(pointCloud);
 }
 
+double LasScalarFieldLoader::StandardFieldValue(LasScalarField::Id id, const laszip_point& currentPoint)
+{
+	switch (id)
+	{
+	case LasScalarField::Intensity:
+		return currentPoint.intensity;
+	case LasScalarField::ReturnNumber:
+		return currentPoint.return_number;
+	case LasScalarField::NumberOfReturns:
+		return currentPoint.number_of_returns;
+	case LasScalarField::ScanDirectionFlag:
+		return currentPoint.scan_direction_flag;
+	case LasScalarField::EdgeOfFlightLine:
+		return currentPoint.edge_of_flight_line;
+	case LasScalarField::Classification:
+		return currentPoint.classification;
+	case LasScalarField::SyntheticFlag:
+		return currentPoint.synthetic_flag;
+	case LasScalarField::KeypointFlag:
+		return currentPoint.keypoint_flag;
+	case LasScalarField::WithheldFlag:
+		return currentPoint.withheld_flag;
+	case LasScalarField::ScanAngleRank:
+		return currentPoint.scan_angle_rank;
+	case LasScalarField::UserData:
+		return currentPoint.user_data;
+	case LasScalarField::PointSourceId:
+		return currentPoint.point_source_ID;
+	case LasScalarField::GpsTime:
+		return currentPoint.gps_time;
+	case LasScalarField::ExtendedScanAngle:
+		return currentPoint.extended_scan_angle * SCAN_ANGLE_SCALE;
+	case LasScalarField::ExtendedScannerChannel:
+		return currentPoint.extended_scanner_channel;
+	case LasScalarField::OverlapFlag:
+		return currentPoint.extended_classification_flags & LasDetails::OVERLAP_FLAG_BIT_MASK;
+	case LasScalarField::ExtendedClassification:
+		return currentPoint.extended_classification;
+	case LasScalarField::ExtendedReturnNumber:
+		return currentPoint.extended_return_number;
+	case LasScalarField::ExtendedNumberOfReturns:
+		return currentPoint.extended_number_of_returns;
+	case LasScalarField::NearInfrared:
+		return currentPoint.rgb[3];
+	}
+
+	assert(false);
+	return 0.0;
+}
+
+unsigned char LasScalarFieldLoader::ColorCompShiftFor(const laszip_point& currentPoint, bool force8bitRgbMode)
+{
+	uint16_t currentOredRGB = currentPoint.rgb[0] | currentPoint.rgb[1] | currentPoint.rgb[2];
+	// LAS colors use 16bits (as they should)
+	return (!force8bitRgbMode && currentOredRGB > 255) ? 8 : 0;
+}
+
+double LasScalarFieldLoader::AutomaticTimeShift(double firstValue)
+{
+	return static_cast<int64_t>(firstValue / 10000.0) * 10000.0;
+}
+
+double LasScalarFieldLoader::timeShiftFor(double firstValue) const
+{
+	double timeShift;
+	if (std::isnan(m_manualTimeShiftValue))
+	{
+		timeShift = AutomaticTimeShift(firstValue);
+	}
+	else
+	{
+		timeShift = m_manualTimeShiftValue;
+	}
+
+	double shiftedValue = firstValue - timeShift;
+	if (shiftedValue < 1.0e5)
+	{
+		ccLog::Warning("[LAS] Time SF has been shifted to prevent a loss of accuracy (%.2f)", timeShift);
+	}
+	else if (timeShift > 0.0)
+	{
+		ccLog::Warning("[LAS] Time SF has been shifted but accuracy may not be preserved (%.2f)",
+		               timeShift);
+	}
+	else
+	{
+		ccLog::Warning("[LAS] Time SF has not been shifted. Accuracy may not be preserved.");
+	}
+
+	return timeShift;
+}
+
 CC_FILE_ERROR LasScalarFieldLoader::handleScalarFields(ccPointCloud&       pointCloud,
                                                        const laszip_point& currentPoint)
 {
 	CC_FILE_ERROR error = CC_FERR_NO_ERROR;
 	for (LasScalarField& lasScalarField : m_standardFields)
 	{
-		switch (lasScalarField.id)
+		if (lasScalarField.id == LasScalarField::GpsTime)
 		{
-		case LasScalarField::Intensity:
-			error = handleScalarField(lasScalarField, pointCloud, currentPoint.intensity);
-			break;
-		case LasScalarField::ReturnNumber:
-			error = handleScalarField(lasScalarField, pointCloud, currentPoint.return_number);
-			break;
-		case LasScalarField::NumberOfReturns:
-			error = handleScalarField(lasScalarField, pointCloud, currentPoint.number_of_returns);
-			break;
-		case LasScalarField::ScanDirectionFlag:
-			error = handleScalarField(lasScalarField, pointCloud, currentPoint.scan_direction_flag);
-			break;
-		case LasScalarField::EdgeOfFlightLine:
-			error = handleScalarField(lasScalarField, pointCloud, currentPoint.edge_of_flight_line);
-			break;
-		case LasScalarField::Classification:
-			error = handleScalarField(lasScalarField, pointCloud, currentPoint.classification);
-			break;
-		case LasScalarField::SyntheticFlag:
-			error = handleScalarField(lasScalarField, pointCloud, currentPoint.synthetic_flag);
-			break;
-		case LasScalarField::KeypointFlag:
-			error = handleScalarField(lasScalarField, pointCloud, currentPoint.keypoint_flag);
-			break;
-		case LasScalarField::WithheldFlag:
-			error = handleScalarField(lasScalarField, pointCloud, currentPoint.withheld_flag);
-			break;
-		case LasScalarField::ScanAngleRank:
-			error = handleScalarField(lasScalarField, pointCloud, currentPoint.scan_angle_rank);
-			break;
-		case LasScalarField::UserData:
-			error = handleScalarField(lasScalarField, pointCloud, currentPoint.user_data);
-			break;
-		case LasScalarField::PointSourceId:
-			error = handleScalarField(lasScalarField, pointCloud, currentPoint.point_source_ID);
-			break;
-		case LasScalarField::GpsTime:
 			error = handleGpsTime(lasScalarField, pointCloud, currentPoint.gps_time);
-			break;
-		case LasScalarField::ExtendedScanAngle:
-			error = handleScalarField(
-			    lasScalarField, pointCloud, currentPoint.extended_scan_angle * SCAN_ANGLE_SCALE);
-			break;
-		case LasScalarField::ExtendedScannerChannel:
-			error = handleScalarField(lasScalarField, pointCloud, currentPoint.extended_scanner_channel);
-			break;
-		case LasScalarField::OverlapFlag:
-			error =
-			    handleScalarField(lasScalarField, pointCloud, currentPoint.extended_classification_flags & LasDetails::OVERLAP_FLAG_BIT_MASK);
-			break;
-		case LasScalarField::ExtendedClassification:
-			error = handleScalarField(lasScalarField, pointCloud, currentPoint.extended_classification);
-			break;
-		case LasScalarField::ExtendedReturnNumber:
-			error = handleScalarField(lasScalarField, pointCloud, currentPoint.extended_return_number);
-			break;
-		case LasScalarField::ExtendedNumberOfReturns:
-			error = handleScalarField(lasScalarField, pointCloud, currentPoint.extended_number_of_returns);
-			break;
-		case LasScalarField::NearInfrared:
-			error = handleScalarField(lasScalarField, pointCloud, currentPoint.rgb[3]);
-			break;
+		}
+		else
+		{
+			error = handleScalarField(lasScalarField, pointCloud, StandardFieldValue(lasScalarField.id, currentPoint));
 		}
 
 		if (error != CC_FERR_NO_ERROR)
@@ -112,6 +147,7 @@ CC_FILE_ERROR LasScalarFieldLoader::handleScalarFields(ccPointCloud&       point
 
 	return CC_FERR_NO_ERROR;
 }
+
 CC_FILE_ERROR LasScalarFieldLoader::parseExtraScalarField(
     const LasExtraScalarField& extraField,
     const laszip_point&        currentPoint,
@@ -163,11 +199,7 @@ CC_FILE_ERROR LasScalarFieldLoader::handleRGBValue(ccPointCloud& pointCloud, con
 			return CC_FERR_NOT_ENOUGH_MEMORY;
 		}
 
-		if (!m_force8bitRgbMode && currentOredRGB > 255)
-		{
-			// LAS colors use 16bits (as they should)
-			m_colorCompShift = 8;
-		}
+		m_colorCompShift = ColorCompShiftFor(currentPoint, m_force8bitRgbMode);
 
 		if (pointCloud.size() != 0)
 		{
@@ -217,13 +249,12 @@ CC_FILE_ERROR LasScalarFieldLoader::handleExtraScalarFields(const laszip_point&
 	return CC_FERR_NO_ERROR;
 }
 
-template <typename T>
 CC_FILE_ERROR
-LasScalarFieldLoader::handleScalarField(LasScalarField& sfInfo, ccPointCloud& pointCloud, T currentValue)
+LasScalarFieldLoader::handleScalarField(LasScalarField& sfInfo, ccPointCloud& pointCloud, double currentValue)
 {
 	if (!sfInfo.sf)
 	{
-		if (m_ignoreFieldsWithDefaultValues && currentValue == T{})
+		if (m_ignoreFieldsWithDefaultValues && currentValue == 0.0)
 		{
 			return CC_FERR_NO_ERROR;
 		}
@@ -236,7 +267,7 @@ LasScalarFieldLoader::handleScalarField(LasScalarField& sfInfo, ccPointCloud& po
 
 		for (unsigned j = 0; j < pointCloud.size() - 1; ++j)
 		{
-			newSf->addElement(static_cast<ScalarType>(T{}));
+			newSf->addElement(0);
 		}
 	}
 
@@ -263,31 +294,7 @@ LasScalarFieldLoader::handleGpsTime(LasScalarField& sfInfo, ccPointCloud& pointC
 			return CC_FERR_NOT_ENOUGH_MEMORY;
 		}
 
-		double timeShift;
-		if (std::isnan(m_manualTimeShiftValue))
-		{
-			timeShift = static_cast<int64_t>(currentValue / 10000.0) * 10000.0;
-		}
-		else
-		{
-			timeShift = m_manualTimeShiftValue;
-		}
-
-		double shiftedValue = currentValue - timeShift;
-		if (shiftedValue < 1.0e5)
-		{
-			ccLog::Warning("[LAS] Time SF has been shifted to prevent a loss of accuracy (%.2f)", timeShift);
-		}
-		else if (timeShift > 0.0)
-		{
-			ccLog::Warning("[LAS] Time SF has been shifted but accuracy may not be preserved (%.2f)",
-			               timeShift);
-		}
-		else
-		{
-			ccLog::Warning("[LAS] Time SF has not been shifted. Accuracy may not be preserved.");
-		}
-
+		double timeShift = timeShiftFor(currentValue);
 		newSf->setGlobalShift(timeShift);
 		for (unsigned j = 0; j < pointCloud.size() - 1; ++j)
 		{
@@ -17,6 +17,8 @@
 
 #include "LasScalarFieldSaver.h"
 
+#include <ccLog.h>
+#include <ccPointCloud.h>
 #include <ccScalarField.h>
 #include <laszip/laszip_api.h>
 
@@ -25,6 +27,70 @@ LasScalarFieldSaver::LasScalarFieldSaver(std::vector<LasScalarField>&&      stan
     : m_standardFields(standardFields)
     , m_extraFields(extraFields)
 {
+	recordScalarFieldNames();
+}
+
+void LasScalarFieldSaver::recordScalarFieldNames()
+{
+	m_standardFieldNames.clear();
+	for (const LasScalarField& field : m_standardFields)
+	{
+		m_standardFieldNames.emplace_back(field.sf ? field.sf->getName() : "");
+	}
+
+	m_extraFieldNames.clear();
+	for (const LasExtraScalarField& field : m_extraFields)
+	{
+		std::array<std::string, LasExtraScalarField::MAX_DIM_SIZE> names;
+		for (unsigned i = 0; i < field.numElements(); ++i)
+		{
+			if (field.scalarFields[i])
+			{
+				names[i] = field.scalarFields[i]->getName();
+			}
+		}
+		m_extraFieldNames.push_back(names);
+	}
+}
+
+bool LasScalarFieldSaver::bindTo(const ccPointCloud& cloud)
+{
+	auto findScalarField = [&cloud](const std::string& name) -> ccScalarField*
+	{
+		int sfIdx = cloud.getScalarFieldIndexByName(name.c_str());
+		return (sfIdx >= 0 ? static_cast<ccScalarField*>(cloud.getScalarField(sfIdx)) : nullptr);
+	};
+
+	assert(m_standardFieldNames.size() == m_standardFields.size());
+	for (size_t i = 0; i < m_standardFields.size(); ++i)
+	{
+		m_standardFields[i].sf = findScalarField(m_standardFieldNames[i]);
+		if (!m_standardFields[i].sf)
+		{
+			ccLog::Warning("[LAS] Scalar field '%s' is missing", m_standardFieldNames[i].c_str());
+			return false;
+		}
+	}
+
+	assert(m_extraFieldNames.size() == m_extraFields.size());
+	for (size_t i = 0; i < m_extraFields.size(); ++i)
+	{
+		for (unsigned j = 0; j < m_extraFields[i].numElements(); ++j)
+		{
+			if (m_extraFieldNames[i][j].empty())
+			{
+				continue;
+			}
+			m_extraFields[i].scalarFields[j] = findScalarField(m_extraFieldNames[i][j]);
+			if (!m_extraFields[i].scalarFields[j])
+			{
+				ccLog::Warning("[LAS] Scalar field '%s' is missing", m_extraFieldNames[i][j].c_str());
+				return false;
+			}
+		}
+	}
+
+	return true;
 }
 
 void LasScalarFieldSaver::handleScalarFields(size_t pointIndex, laszip_point& point)
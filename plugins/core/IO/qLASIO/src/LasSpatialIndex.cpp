@@ -0,0 +1,338 @@
+//##########################################################################
+//#                                                                        #
+//#                CLOUDCOMPARE PLUGIN: LAS-IO Plugin                      #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU General Public License as published by  #
+//#  the Free Software Foundation; version 2 of the License.               #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#                   COPYRIGHT: Thomas Montaigu                           #
+//#                                                                        #
+//##########################################################################
+
+#include "LasSpatialIndex.h"
+
+// qCC_db
+#include <ccLog.h>
+#include <ccProgressDialog.h>
+
+// CCCoreLib
+#include <GenericProgressCallback.h>
+
+// Qt
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+
+// System
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+/// Index file signature
+constexpr char INDEX_FILE_SIGNATURE[] = "CCLASIDX";
+/// Index file version
+constexpr quint32 INDEX_FILE_VERSION = 1;
+/// Average number of points per leaf cell we aim for
+constexpr double TARGET_POINT_COUNT_PER_CELL = 50000.0;
+/// Maximum depth of the quadtree
+constexpr unsigned MAX_LEVEL = 10;
+/// Intervals of a cell separated by less than this number of points are merged
+/// (it's faster to decode a few extra points than to seek)
+constexpr unsigned MAX_MERGED_GAP = 1000;
+
+/// Merges the (sorted) intervals that overlap or are separated by a small gap
+static void MergeIntervals(std::vector<LasSpatialIndex::Interval>& intervals, unsigned maxGap)
+{
+	if (intervals.empty())
+	{
+		return;
+	}
+
+	size_t last = 0;
+	for (size_t i = 1; i < intervals.size(); ++i)
+	{
+		if (intervals[i].start <= intervals[last].end + maxGap)
+		{
+			intervals[last].end = std::max(intervals[last].end, intervals[i].end);
+		}
+		else
+		{
+			intervals[++last] = intervals[i];
+		}
+	}
+	intervals.resize(last + 1);
+}
+
+QString LasSpatialIndex::SideFileName(const QString& lasFileName)
+{
+	QFileInfo fileInfo(lasFileName);
+	return fileInfo.absolutePath() + "/" + fileInfo.completeBaseName() + ".ccx";
+}
+
+unsigned LasSpatialIndex::cellIndex(double x, double y) const
+{
+	const unsigned cellCount = cellCountPerDim();
+	const double   sizeX     = m_max.x - m_min.x;
+	const double   sizeY     = m_max.y - m_min.y;
+
+	// points may lie (slightly) outside of the header extents
+	auto i = static_cast<int>(sizeX > 0 ? std::floor((x - m_min.x) / sizeX * cellCount) : 0);
+	auto j = static_cast<int>(sizeY > 0 ? std::floor((y - m_min.y) / sizeY * cellCount) : 0);
+	i      = std::max(0, std::min(i, static_cast<int>(cellCount) - 1));
+	j      = std::max(0, std::min(j, static_cast<int>(cellCount) - 1));
+
+	return static_cast<unsigned>(j) * cellCount + static_cast<unsigned>(i);
+}
+
+CC_FILE_ERROR LasSpatialIndex::build(laszip_POINTER       laszipReader,
+                                     const laszip_header& laszipHeader,
+                                     unsigned             pointCount,
+                                     ccProgressDialog*    progressDialog)
+{
+	m_pointCount = pointCount;
+	m_min        = CCVector2d(laszipHeader.min_x, laszipHeader.min_y);
+	m_max        = CCVector2d(laszipHeader.max_x, laszipHeader.max_y);
+	m_level      = 0;
+	while (m_level < MAX_LEVEL && std::pow(4.0, m_level) * TARGET_POINT_COUNT_PER_CELL < pointCount)
+	{
+		++m_level;
+	}
+
+	m_cells.clear();
+	try
+	{
+		m_cells.resize(static_cast<size_t>(cellCountPerDim()) * cellCountPerDim());
+	}
+	catch (const std::bad_alloc&)
+	{
+		return CC_FERR_NOT_ENOUGH_MEMORY;
+	}
+
+	QScopedPointer<CCCoreLib::NormalizedProgress> normProgress;
+	if (progressDialog)
+	{
+		progressDialog->setMethodTitle("LAS spatial index");
+		progressDialog->setInfo(QString("Indexing %1 points").arg(pointCount));
+		normProgress.reset(new CCCoreLib::NormalizedProgress(progressDialog, pointCount));
+		progressDialog->start();
+	}
+
+	if (laszip_seek_point(laszipReader, 0))
+	{
+		return CC_FERR_THIRD_PARTY_LIB_FAILURE;
+	}
+
+	laszip_F64 laszipCoordinates[3]{0};
+	try
+	{
+		for (unsigned i = 0; i < pointCount; ++i)
+		{
+			if (laszip_read_point(laszipReader) || laszip_get_coordinates(laszipReader, laszipCoordinates))
+			{
+				return CC_FERR_THIRD_PARTY_LIB_FAILURE;
+			}
+
+			std::vector<Interval>& intervals = m_cells[cellIndex(laszipCoordinates[0], laszipCoordinates[1])];
+			if (!intervals.empty() && intervals.back().end == i)
+			{
+				++intervals.back().end;
+			}
+			else
+			{
+				intervals.push_back({i, i + 1});
+			}
+
+			if (normProgress && !normProgress->oneStep())
+			{
+				return CC_FERR_CANCELED_BY_USER;
+			}
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		return CC_FERR_NOT_ENOUGH_MEMORY;
+	}
+
+	size_t intervalCount = 0;
+	for (std::vector<Interval>& intervals : m_cells)
+	{
+		MergeIntervals(intervals, MAX_MERGED_GAP);
+		intervals.shrink_to_fit();
+		intervalCount += intervals.size();
+	}
+	ccLog::Print(QString("[LAS] Spatial index built: %1 x %1 cells, %2 intervals").arg(cellCountPerDim()).arg(intervalCount));
+
+	if (laszip_seek_point(laszipReader, 0))
+	{
+		return CC_FERR_THIRD_PARTY_LIB_FAILURE;
+	}
+
+	return CC_FERR_NO_ERROR;
+}
+
+bool LasSpatialIndex::load(const QString& lasFileName, const laszip_header& laszipHeader, unsigned pointCount)
+{
+	QFileInfo indexFileInfo(SideFileName(lasFileName));
+	if (!indexFileInfo.exists())
+	{
+		return false;
+	}
+	if (indexFileInfo.lastModified() < QFileInfo(lasFileName).lastModified())
+	{
+		ccLog::Warning("[LAS] Spatial index is older than the file, it will be rebuilt");
+		return false;
+	}
+
+	QFile file(indexFileInfo.absoluteFilePath());
+	if (!file.open(QFile::ReadOnly))
+	{
+		return false;
+	}
+
+	QDataStream stream(&file);
+	stream.setByteOrder(QDataStream::ByteOrder::LittleEndian);
+
+	char signature[sizeof(INDEX_FILE_SIGNATURE) - 1]{0};
+	if (stream.readRawData(signature, sizeof(signature)) != sizeof(signature)
+	    || memcmp(signature, INDEX_FILE_SIGNATURE, sizeof(signature)) != 0)
+	{
+		ccLog::Warning("[LAS] Invalid spatial index file");
+		return false;
+	}
+
+	quint32 version{0}, storedPointCount{0}, level{0};
+	double  minX{0}, minY{0}, maxX{0}, maxY{0};
+	stream >> version >> storedPointCount >> minX >> minY >> maxX >> maxY >> level;
+	if (stream.status() != QDataStream::Ok || version != INDEX_FILE_VERSION || level > MAX_LEVEL)
+	{
+		ccLog::Warning("[LAS] Invalid spatial index file");
+		return false;
+	}
+
+	if (storedPointCount != pointCount
+	    || minX != laszipHeader.min_x || minY != laszipHeader.min_y
+	    || maxX != laszipHeader.max_x || maxY != laszipHeader.max_y)
+	{
+		ccLog::Warning("[LAS] Spatial index doesn't match the file, it will be rebuilt");
+		return false;
+	}
+
+	m_pointCount = storedPointCount;
+	m_level      = level;
+	m_min        = CCVector2d(minX, minY);
+	m_max        = CCVector2d(maxX, maxY);
+	m_cells.clear();
+
+	try
+	{
+		m_cells.resize(static_cast<size_t>(cellCountPerDim()) * cellCountPerDim());
+		for (std::vector<Interval>& intervals : m_cells)
+		{
+			quint32 intervalCount{0};
+			stream >> intervalCount;
+			if (intervalCount > m_pointCount)
+			{
+				stream.setStatus(QDataStream::ReadCorruptData);
+			}
+			if (stream.status() != QDataStream::Ok)
+			{
+				break;
+			}
+
+			intervals.resize(intervalCount);
+			for (Interval& interval : intervals)
+			{
+				quint32 start{0}, end{0};
+				stream >> start >> end;
+				if (start >= end || end > m_pointCount)
+				{
+					stream.setStatus(QDataStream::ReadCorruptData);
+					break;
+				}
+				interval = {start, end};
+			}
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		m_cells.clear();
+		return false;
+	}
+
+	if (stream.status() != QDataStream::Ok)
+	{
+		ccLog::Warning("[LAS] Malformed spatial index file");
+		m_cells.clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool LasSpatialIndex::save(const QString& lasFileName) const
+{
+	QFile file(SideFileName(lasFileName));
+	if (!file.open(QFile::WriteOnly))
+	{
+		return false;
+	}
+
+	QDataStream stream(&file);
+	stream.setByteOrder(QDataStream::ByteOrder::LittleEndian);
+
+	stream.writeRawData(INDEX_FILE_SIGNATURE, sizeof(INDEX_FILE_SIGNATURE) - 1);
+	stream << INDEX_FILE_VERSION << static_cast<quint32>(m_pointCount);
+	stream << m_min.x << m_min.y << m_max.x << m_max.y;
+	stream << static_cast<quint32>(m_level);
+
+	for (const std::vector<Interval>& intervals : m_cells)
+	{
+		stream << static_cast<quint32>(intervals.size());
+		for (const Interval& interval : intervals)
+		{
+			stream << static_cast<quint32>(interval.start) << static_cast<quint32>(interval.end);
+		}
+	}
+
+	return stream.status() == QDataStream::Ok;
+}
+
+std::vector<LasSpatialIndex::Interval> LasSpatialIndex::query(const CCVector2d& boxMin, const CCVector2d& boxMax) const
+{
+	std::vector<Interval> result;
+	if (m_cells.empty())
+	{
+		return result;
+	}
+
+	// as points outside of the header extents are indexed in the border cells,
+	// the box is clamped the same way
+	const unsigned cellCount = cellCountPerDim();
+	const unsigned minIndex  = cellIndex(boxMin.x, boxMin.y);
+	const unsigned maxIndex  = cellIndex(boxMax.x, boxMax.y);
+	const unsigned minI      = minIndex % cellCount;
+	const unsigned minJ      = minIndex / cellCount;
+	const unsigned maxI      = maxIndex % cellCount;
+	const unsigned maxJ      = maxIndex / cellCount;
+
+	for (unsigned j = minJ; j <= maxJ; ++j)
+	{
+		for (unsigned i = minI; i <= maxI; ++i)
+		{
+			const std::vector<Interval>& intervals = m_cells[j * cellCount + i];
+			result.insert(result.end(), intervals.begin(), intervals.end());
+		}
+	}
+
+	std::sort(result.begin(), result.end(), [](const Interval& a, const Interval& b)
+	          { return a.start < b.start; });
+	MergeIntervals(result, 0);
+
+	return result;
+}
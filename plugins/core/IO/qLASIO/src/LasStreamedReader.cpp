@@ -0,0 +1,270 @@
+//##########################################################################
+//#                                                                        #
+//#                CLOUDCOMPARE PLUGIN: LAS-IO Plugin                      #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU General Public License as published by  #
+//#  the Free Software Foundation; version 2 of the License.               #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#                   COPYRIGHT: Thomas Montaigu                           #
+//#                                                                        #
+//##########################################################################
+
+#include "LasStreamedReader.h"
+
+#include "LasMetadata.h"
+#include "LasScalarFieldLoader.h"
+
+// qCC_db
+#include <ccLog.h>
+#include <ccPointCloud.h>
+#include <ccScalarField.h>
+
+// System
+#include <algorithm>
+
+LasStreamedReader::~LasStreamedReader()
+{
+	if (m_laszipReader)
+	{
+		if (m_readerIsOpen)
+		{
+			laszip_close_reader(m_laszipReader);
+		}
+		laszip_clean(m_laszipReader);
+		laszip_destroy(m_laszipReader);
+	}
+}
+
+CC_FILE_ERROR LasStreamedReader::open(const QString& fileName, const FileIOFilter::PointsFilter& pointsFilter)
+{
+	laszip_BOOL  isCompressed{false};
+	laszip_CHAR* errorMsg{nullptr};
+
+	if (laszip_create(&m_laszipReader))
+	{
+		m_laszipReader = nullptr;
+		ccLog::Warning("[LAS] Failed to create reader");
+		return CC_FERR_THIRD_PARTY_LIB_FAILURE;
+	}
+
+	if (laszip_open_reader(m_laszipReader, qPrintable(fileName), &isCompressed))
+	{
+		laszip_get_error(m_laszipReader, &errorMsg);
+		ccLog::Warning("[LAS] laszip error: '%s'", errorMsg);
+		return CC_FERR_THIRD_PARTY_LIB_FAILURE;
+	}
+	m_readerIsOpen = true;
+
+	if (laszip_get_header_pointer(m_laszipReader, &m_laszipHeader) || laszip_get_point_pointer(m_laszipReader, &m_laszipPoint))
+	{
+		laszip_get_error(m_laszipReader, &errorMsg);
+		ccLog::Warning("[LAS] laszip error: '%s'", errorMsg);
+		return CC_FERR_THIRD_PARTY_LIB_FAILURE;
+	}
+
+	if (m_laszipHeader->version_minor == 4)
+	{
+		m_pointCount = static_cast<qint64>(m_laszipHeader->extended_number_of_point_records);
+	}
+	else
+	{
+		m_pointCount = static_cast<qint64>(m_laszipHeader->number_of_point_records);
+	}
+
+	m_standardFields = LasScalarField::ForPointFormat(m_laszipHeader->point_data_format);
+	m_extraFields    = LasExtraScalarField::ParseExtraScalarFields(*m_laszipHeader);
+	m_hasRGB         = LasDetails::HasRGB(m_laszipHeader->point_data_format);
+
+	LasPointFilter pointFilter(pointsFilter);
+	if (pointFilter.isActive())
+	{
+		ccLog::Print("[LAS] Points filter: " + pointFilter.description());
+		m_pointFilter = std::make_unique<LasPointFilter>(pointFilter);
+	}
+
+	if (m_pointCount != 0)
+	{
+		// the first point is used to determine the Global Shift and the GPS time shift
+		laszip_F64 laszipCoordinates[3]{0};
+		if (laszip_read_point(m_laszipReader)
+		    || laszip_get_coordinates(m_laszipReader, laszipCoordinates)
+		    || laszip_seek_point(m_laszipReader, 0))
+		{
+			laszip_get_error(m_laszipReader, &errorMsg);
+			ccLog::Warning("[LAS] laszip error: '%s'", errorMsg);
+			return CC_FERR_THIRD_PARTY_LIB_FAILURE;
+		}
+
+		m_firstPoint = CCVector3d(laszipCoordinates);
+		m_timeShift  = LasScalarFieldLoader::AutomaticTimeShift(m_laszipPoint->gps_time);
+	}
+
+	return CC_FERR_NO_ERROR;
+}
+
+CCVector3d LasStreamedReader::lasOffset() const
+{
+	if (!m_laszipHeader)
+	{
+		assert(false);
+		return {0.0, 0.0, 0.0};
+	}
+
+	return {m_laszipHeader->x_offset,
+	        m_laszipHeader->y_offset,
+	        0.0 /*m_laszipHeader->z_offset*/}; // it's never a good idea to shift along Z
+}
+
+qint64 LasStreamedReader::pointCount() const
+{
+	return m_pointCount;
+}
+
+CC_FILE_ERROR LasStreamedReader::readBlock(ccPointCloud& block, unsigned maxCount)
+{
+	if (!m_readerIsOpen || block.size() != 0)
+	{
+		assert(false);
+		return CC_FERR_BAD_ARGUMENT;
+	}
+
+	if (m_nextPointIndex >= m_pointCount || maxCount == 0)
+	{
+		// nothing left to read
+		return CC_FERR_NO_ERROR;
+	}
+
+	const auto capacity = static_cast<unsigned>(std::min<qint64>(maxCount, m_pointCount - m_nextPointIndex));
+	if (!block.reserve(capacity) || (m_hasRGB && !block.reserveTheRGBTable()))
+	{
+		return CC_FERR_NOT_ENOUGH_MEMORY;
+	}
+
+	std::vector<LasScalarField> standardFields = m_standardFields;
+	for (LasScalarField& field : standardFields)
+	{
+		field.sf = new ccScalarField(field.name());
+		if (!field.sf->reserveSafe(capacity))
+		{
+			for (LasScalarField& otherField : standardFields)
+			{
+				if (otherField.sf)
+				{
+					otherField.sf->release();
+				}
+			}
+			return CC_FERR_NOT_ENOUGH_MEMORY;
+		}
+		if (field.id == LasScalarField::GpsTime)
+		{
+			field.sf->setGlobalShift(m_timeShift);
+		}
+	}
+
+	// the extra fields scalar fields are created by the loader
+	std::vector<LasScalarField>      noStandardFields;
+	std::vector<LasExtraScalarField> extraFields = m_extraFields;
+	LasScalarFieldLoader             loader(noStandardFields, extraFields, block);
+
+	CC_FILE_ERROR error = CC_FERR_NO_ERROR;
+	laszip_F64    laszipCoordinates[3]{0};
+	for (; m_nextPointIndex < m_pointCount && block.size() < capacity; ++m_nextPointIndex)
+	{
+		if (laszip_read_point(m_laszipReader) || laszip_get_coordinates(m_laszipReader, laszipCoordinates))
+		{
+			error = CC_FERR_THIRD_PARTY_LIB_FAILURE;
+			break;
+		}
+
+		if (m_pointFilter && !m_pointFilter->accepts(*m_laszipPoint, laszipCoordinates))
+		{
+			continue;
+		}
+
+		block.addPoint(CCVector3(static_cast<PointCoordinateType>(laszipCoordinates[0] + m_globalShift.x),
+		                         static_cast<PointCoordinateType>(laszipCoordinates[1] + m_globalShift.y),
+		                         static_cast<PointCoordinateType>(laszipCoordinates[2] + m_globalShift.z)));
+
+		for (LasScalarField& field : standardFields)
+		{
+			double value = (field.id == LasScalarField::GpsTime ? m_laszipPoint->gps_time - m_timeShift
+			                                                    : LasScalarFieldLoader::StandardFieldValue(field.id, *m_laszipPoint));
+			field.sf->addElement(static_cast<ScalarType>(value));
+		}
+
+		error = loader.handleExtraScalarFields(*m_laszipPoint);
+		if (error != CC_FERR_NO_ERROR)
+		{
+			break;
+		}
+
+		if (m_hasRGB)
+		{
+			if (!m_colorCompShiftIsSet && (m_laszipPoint->rgb[0] | m_laszipPoint->rgb[1] | m_laszipPoint->rgb[2]) != 0)
+			{
+				m_colorCompShift      = LasScalarFieldLoader::ColorCompShiftFor(*m_laszipPoint, false);
+				m_colorCompShiftIsSet = true;
+			}
+
+			block.addColor(ccColor::Rgb(static_cast<ColorCompType>(m_laszipPoint->rgb[0] >> m_colorCompShift),
+			                            static_cast<ColorCompType>(m_laszipPoint->rgb[1] >> m_colorCompShift),
+			                            static_cast<ColorCompType>(m_laszipPoint->rgb[2] >> m_colorCompShift)));
+		}
+	}
+
+	if (error == CC_FERR_THIRD_PARTY_LIB_FAILURE)
+	{
+		laszip_CHAR* errorMsg{nullptr};
+		laszip_get_error(m_laszipReader, &errorMsg);
+		ccLog::Warning("[LAS] laszip error: '%s'", errorMsg);
+	}
+
+	for (const LasScalarField& field : standardFields)
+	{
+		field.sf->computeMinAndMax();
+		if (block.addScalarField(field.sf) < 0)
+		{
+			field.sf->release();
+		}
+	}
+
+	for (const LasExtraScalarField& field : loader.extraFields())
+	{
+		for (unsigned i = 0; i < field.numElements(); ++i)
+		{
+			assert(field.scalarFields[i] != nullptr);
+			field.scalarFields[i]->computeMinAndMax();
+			if (block.addScalarField(field.scalarFields[i]) < 0)
+			{
+				field.scalarFields[i]->release();
+			}
+		}
+	}
+
+	int idx = block.getScalarFieldIndexByName(LasNames::Intensity);
+	if (idx != -1)
+	{
+		block.setCurrentDisplayedScalarField(idx);
+	}
+	else if (block.getNumberOfScalarFields() > 0)
+	{
+		block.setCurrentDisplayedScalarField(0);
+	}
+	block.showColors(block.hasColors());
+	block.showSF(!block.hasColors() && block.hasDisplayedScalarField());
+
+	if (m_preserveGlobalShift)
+	{
+		block.setGlobalShift(m_globalShift);
+	}
+
+	LasMetadata::SaveMetadataInto(*m_laszipHeader, block, m_extraFields);
+
+	return error;
+}
@@ -0,0 +1,121 @@
+//##########################################################################
+//#                                                                        #
+//#                CLOUDCOMPARE PLUGIN: LAS-IO Plugin                      #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU General Public License as published by  #
+//#  the Free Software Foundation; version 2 of the License.               #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#                   COPYRIGHT: Thomas Montaigu                           #
+//#                                                                        #
+//##########################################################################
+
+#include "LasStreamedWriter.h"
+
+#include "LasIOFilter.h"
+#include "LasMetadata.h"
+
+// qCC_db
+#include <ccLog.h>
+#include <ccPointCloud.h>
+
+// System
+#include <limits>
+
+LasStreamedWriter::LasStreamedWriter(const QString& fileName, const FileIOFilter::SaveParameters& parameters)
+    : m_fileName(fileName)
+    , m_parameters(parameters)
+{
+}
+
+CC_FILE_ERROR LasStreamedWriter::writeBlock(ccPointCloud& block)
+{
+	if (!m_saver)
+	{
+		LasSaver::Parameters params;
+		CC_FILE_ERROR        error = LasIOFilter::SaverParametersFor(block, m_parameters, params);
+		if (error != CC_FERR_NO_ERROR)
+		{
+			return error;
+		}
+
+		// these can't be bound to the next blocks
+		params.shouldSaveNormalsAsExtraScalarField = false;
+		params.shouldSaveWaveform                  = false;
+
+		// the scale chosen for the first block may be too small for the whole cloud
+		CCVector3d originalScale;
+		if (LasMetadata::LoadScaleFrom(block, originalScale))
+		{
+			params.lasScale = originalScale;
+		}
+		m_lasScale  = params.lasScale;
+		m_lasOffset = params.lasOffset;
+
+		m_saver = std::make_unique<LasSaver>(block, params);
+		error   = m_saver->open(m_fileName);
+		if (error != CC_FERR_NO_ERROR)
+		{
+			m_saver.reset();
+			return error;
+		}
+	}
+	else if (!m_saver->setCloud(block))
+	{
+		ccLog::Warning("[LAS] The block doesn't have the same structure as the first one");
+		return CC_FERR_BAD_ENTITY_TYPE;
+	}
+
+	// make sure the LAS (integer) coordinates won't overflow
+	CCVector3d bbMin, bbMax;
+	if (block.size() != 0 && block.getOwnGlobalBB(bbMin, bbMax))
+	{
+		for (unsigned d = 0; d < 3; ++d)
+		{
+			double minValue = (bbMin.u[d] - m_lasOffset.u[d]) / m_lasScale.u[d];
+			double maxValue = (bbMax.u[d] - m_lasOffset.u[d]) / m_lasScale.u[d];
+			if (std::min(minValue, maxValue) < std::numeric_limits<laszip_I32>::lowest()
+			    || std::max(minValue, maxValue) > std::numeric_limits<laszip_I32>::max())
+			{
+				ccLog::Warning("[LAS] Some points are too far from the LAS offset to be saved with the current LAS scale");
+				return CC_FERR_WRITING;
+			}
+		}
+	}
+
+	for (unsigned i = 0; i < block.size(); ++i)
+	{
+		CC_FILE_ERROR error = m_saver->saveNextPoint();
+		if (error != CC_FERR_NO_ERROR)
+		{
+			if (error == CC_FERR_THIRD_PARTY_LIB_FAILURE)
+			{
+				ccLog::Warning(QString("[LAS] laszip error :'%1'").arg(m_saver->getLastError()));
+			}
+			return error;
+		}
+	}
+	m_pointCount += block.size();
+
+	return CC_FERR_NO_ERROR;
+}
+
+CC_FILE_ERROR LasStreamedWriter::close()
+{
+	if (!m_saver)
+	{
+		// no block has been written
+		return CC_FERR_NO_SAVE;
+	}
+
+	// the header (point counts, extents) is updated when the writer is closed
+	m_saver.reset();
+	ccLog::Print(QString("[LAS] %1 points saved in '%2'").arg(m_pointCount).arg(m_fileName));
+
+	return CC_FERR_NO_ERROR;
+}
@@ -30,6 +30,7 @@
 
 //qCC_db
 #include <ccClipBox.h>
+#include <ccMultiReferenceCloud.h>
 #include <ccPointCloud.h>
 #include <ccProgressDialog.h>
 #include <ccRasterGrid.h>
@@ -680,9 +681,8 @@ bool ccClippingBoxTool::ExtractSlicesAndContours
 				int gridDim[3]{ 0, 0, 0 };
 				unsigned cellCount = ComputeGridDimensions(localBox, repeatDimensions, indexMins, indexMaxs, gridDim, gridOrigin, cellSizePlusGap);
 
-				//we'll potentially create up to one (ref.) cloud per input loud and per cell
-				std::vector<CCCoreLib::ReferenceCloud*> refClouds;
-				refClouds.resize(cellCount * clouds.size(), nullptr);
+				//we'll potentially create up to one subset per input cloud and per cell
+				std::vector<ccMultiReferenceCloud> cloudSubsets(clouds.size());
 
 				if (progressDialog)
 				{
@@ -708,6 +708,19 @@ bool ccClippingBoxTool::ExtractSlicesAndContours
 					}
 					QApplication::processEvents();
 
+					//cell index of each point
+					std::vector<unsigned> pointCellIndexes;
+					try
+					{
+						pointCellIndexes.resize(pointCount, ccMultiReferenceCloud::InvalidIndex);
+					}
+					catch (const std::bad_alloc&)
+					{
+						ccLog::Error("Not enough memory!");
+						error = true;
+						break;
+					}
+
 					CCCoreLib::NormalizedProgress nProgress(progressDialog, pointCount);
 					for (unsigned i = 0; i < pointCount; ++i)
 					{
@@ -733,24 +746,21 @@ bool ccClippingBoxTool::ExtractSlicesAndContours
 							&&	(P.z - static_cast<PointCoordinateType>(zi))*cellSizePlusGap.z <= cellSize.z))
 						{
 							int cloudIndex = ((zi - indexMins[2]) * static_cast<int>(gridDim[1]) + (yi - indexMins[1])) * static_cast<int>(gridDim[0]) + (xi - indexMins[0]);
-							assert(cloudIndex >= 0 && static_cast<size_t>(cloudIndex)* clouds.size() + ci < refClouds.size());
+							assert(cloudIndex >= 0 && static_cast<unsigned>(cloudIndex) < cellCount);
 
-							CCCoreLib::ReferenceCloud*& destCloud = refClouds[cloudIndex * clouds.size() + ci];
-							if (!destCloud)
-							{
-								destCloud = new CCCoreLib::ReferenceCloud(cloud);
-								++subCloudsCount;
-							}
-
-							if (!destCloud->addPointIndex(i))
-							{
-								ccLog::Error("Not enough memory!");
-								error = true;
-								break;
-							}
+							pointCellIndexes[i] = static_cast<unsigned>(cloudIndex);
 						}
 					}
 
+					//sort the points by cell (in a single flat array)
+					if (!cloudSubsets[ci].build(pointCellIndexes, cellCount))
+					{
+						ccLog::Error("Not enough memory!");
+						error = true;
+						break;
+					}
+					subCloudsCount += cloudSubsets[ci].nonEmptySubsetCount();
+
 					nProgress.oneStep();
 				} //project points into grid
 
@@ -774,17 +784,28 @@ bool ccClippingBoxTool::ExtractSlicesAndContours
 						for (int k = indexMins[2]; k <= indexMaxs[2]; ++k)
 						{
 							int cloudIndex = ((k - indexMins[2]) * static_cast<int>(gridDim[1]) + (j - indexMins[1])) * static_cast<int>(gridDim[0]) + (i - indexMins[0]);
-							assert(cloudIndex >= 0 && static_cast<size_t>(cloudIndex)* clouds.size() < refClouds.size());
+							assert(cloudIndex >= 0 && static_cast<unsigned>(cloudIndex) < cellCount);
 
 							for (size_t ci = 0; ci != clouds.size(); ++ci)
 							{
 								ccGenericPointCloud* cloud = clouds[ci];
-								CCCoreLib::ReferenceCloud* destCloud = refClouds[cloudIndex * clouds.size() + ci];
-								if (destCloud) //some slices can be empty!
+								const ccMultiReferenceCloud& subsets = cloudSubsets[ci];
+								if (subsets.subsetCount() != 0 && subsets.subsetSize(cloudIndex) != 0) //some slices can be empty!
 								{
+									CCCoreLib::ReferenceCloud destCloud(cloud);
+									if (!subsets.getSubset(cloudIndex, destCloud))
+									{
+										ccLog::Error("Not enough memory!");
+										error = true;
+										i = indexMaxs[0];
+										j = indexMaxs[1];
+										k = indexMaxs[2];
+										break;
+									}
+
 									//generate slice from previous selection
 									int warnings = 0;
-									ccPointCloud* sliceCloud = cloud->isA(CC_TYPES::POINT_CLOUD) ? static_cast<ccPointCloud*>(cloud)->partialClone(destCloud, &warnings) : ccPointCloud::From(destCloud, cloud);
+									ccPointCloud* sliceCloud = cloud->isA(CC_TYPES::POINT_CLOUD) ? static_cast<ccPointCloud*>(cloud)->partialClone(&destCloud, &warnings) : ccPointCloud::From(&destCloud, cloud);
 									warningsIssued |= (warnings != 0);
 
 									if (sliceCloud)
@@ -847,12 +868,7 @@ bool ccClippingBoxTool::ExtractSlicesAndContours
 				} //now create the real clouds
 
 				//release memory
-				{
-					for (size_t i = 0; i < refClouds.size(); ++i)
-						if (refClouds[i])
-							delete refClouds[i];
-					refClouds.clear();
-				}
+				cloudSubsets.clear();
 
 				cloudSliceCount = outputSlices.size();
 
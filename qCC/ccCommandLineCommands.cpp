@@ -21,6 +21,7 @@
 
 //qCC_io
 #include <AsciiFilter.h>
+#include <BinFilter.h>
 #include <PlyFilter.h>
 
 //qCC
@@ -49,10 +50,20 @@ constexpr char COMMAND_ASCII_EXPORT_PRECISION[]			= "PREC";
 constexpr char COMMAND_ASCII_EXPORT_SEPARATOR[]			= "SEP";
 constexpr char COMMAND_ASCII_EXPORT_ADD_COL_HEADER[]	= "ADD_HEADER";
 constexpr char COMMAND_ASCII_EXPORT_ADD_PTS_COUNT[]		= "ADD_PTS_COUNT";
+constexpr char COMMAND_BIN_EXPORT_COMPRESSION[]			= "COMPRESSION";	//+NONE/DEFLATE/SHUFFLE/DELTA
+constexpr char COMMAND_BIN_EXPORT_INTEGER_SF[]			= "INTEGER_SF";
+constexpr char COMMAND_BIN_EXPORT_LOD[]					= "LOD";
 constexpr char COMMAND_MESH_EXPORT_FORMAT[]				= "M_EXPORT_FMT";
 constexpr char COMMAND_HIERARCHY_EXPORT_FORMAT[]		= "H_EXPORT_FMT";
 constexpr char COMMAND_OPEN[]							= "O";				//+file name
 constexpr char COMMAND_OPEN_SKIP_LINES[]				= "SKIP";			//+number of lines to skip
+constexpr char COMMAND_OPEN_FILTER_BOX[]				= "FILTER_BOX";		//+Xmin:Ymin:Xmax:Ymax
+constexpr char COMMAND_OPEN_FILTER_POLYGON[]			= "FILTER_POLYGON";	//+X1:Y1:X2:Y2:X3:Y3...
+constexpr char COMMAND_OPEN_FILTER_CLASSIFICATION[]		= "FILTER_CLASS";	//+C1:C2:...
+constexpr char COMMAND_OPEN_FILTER_RETURN_NUMBER[]		= "FILTER_RETURN";	//+R1:R2:...
+constexpr char COMMAND_OPEN_FILTER_GPS_TIME[]			= "FILTER_GPS_TIME";//+Tmin:Tmax
+constexpr char COMMAND_OPEN_NO_SPATIAL_INDEX[]			= "NO_SPATIAL_INDEX";
+constexpr char COMMAND_OPEN_STREAM[]					= "STREAM";			//+block size (number of points)
 constexpr char COMMAND_COMMAND_FILE[]					= "COMMAND_FILE";	//+file name
 constexpr char COMMAND_SUBSAMPLE[]						= "SS";				//+ method (RANDOM/SPATIAL/OCTREE) + parameter (resp. point count / spatial step / octree level)
 constexpr char COMMAND_EXTRACT_CC[]						= "EXTRACT_CC";
@@ -472,6 +483,70 @@ bool CommandChangeCloudOutputFormat::process(ccCommandLineInterface& cmd)
 			
 			AsciiFilter::SavePointCountHeader(true);
 		}
+		else if (ccCommandLineInterface::IsCommand(argument, COMMAND_BIN_EXPORT_COMPRESSION))
+		{
+			//local option confirmed, we can move on
+			cmd.arguments().pop_front();
+			
+			if (cmd.arguments().empty())
+			{
+				return cmd.error(QObject::tr("Missing parameter: compression mode after '%1'").arg(COMMAND_BIN_EXPORT_COMPRESSION));
+			}
+			
+			if (fileFilter != BinFilter::GetFileFilter())
+			{
+				cmd.warning(QObject::tr("Argument '%1' is only applicable to BIN format!").arg(argument));
+			}
+			
+			QString compressionStr = cmd.arguments().takeFirst().toUpper();
+			ccSerializationHelper::ArrayCompression compression = ccSerializationHelper::ArrayCompression::NONE;
+			if (compressionStr == "NONE")
+			{
+				compression = ccSerializationHelper::ArrayCompression::NONE;
+			}
+			else if (compressionStr == "DEFLATE")
+			{
+				compression = ccSerializationHelper::ArrayCompression::DEFLATE;
+			}
+			else if (compressionStr == "SHUFFLE")
+			{
+				compression = ccSerializationHelper::ArrayCompression::SHUFFLE;
+			}
+			else if (compressionStr == "DELTA")
+			{
+				compression = ccSerializationHelper::ArrayCompression::DELTA;
+			}
+			else
+			{
+				return cmd.error(QObject::tr("Invalid compression mode! ('%1')").arg(compressionStr));
+			}
+			
+			ccSerializationHelper::SetArrayCompression(compression);
+		}
+		else if (ccCommandLineInterface::IsCommand(argument, COMMAND_BIN_EXPORT_INTEGER_SF))
+		{
+			//local option confirmed, we can move on
+			cmd.arguments().pop_front();
+			
+			if (fileFilter != BinFilter::GetFileFilter())
+			{
+				cmd.warning(QObject::tr("Argument '%1' is only applicable to BIN format!").arg(argument));
+			}
+			
+			ccScalarField::SetIntegerFileStorage(true);
+		}
+		else if (ccCommandLineInterface::IsCommand(argument, COMMAND_BIN_EXPORT_LOD))
+		{
+			//local option confirmed, we can move on
+			cmd.arguments().pop_front();
+			
+			if (fileFilter != BinFilter::GetFileFilter())
+			{
+				cmd.warning(QObject::tr("Argument '%1' is only applicable to BIN format!").arg(argument));
+			}
+			
+			ccPointCloud::SetLODFileStorage(true);
+		}
 		else
 		{
 			break; //as soon as we encounter an unrecognized argument, we break the local loop to go back to the main one!
@@ -571,6 +646,29 @@ CommandLoad::CommandLoad()
 	: ccCommandLineInterface::Command(QObject::tr("Load"), COMMAND_OPEN)
 {}
 
+//! Reads a set of colon-separated numerical values (e.g. 'X1:Y1:X2:Y2')
+static bool ReadColonSeparatedValues(ccCommandLineInterface& cmd, const char* option, std::vector<double>& values)
+{
+	if (cmd.arguments().empty())
+	{
+		return cmd.error(QObject::tr("Missing parameter: values after '%1'").arg(option));
+	}
+
+	QStringList tokens = cmd.arguments().takeFirst().split(':', QString::SkipEmptyParts);
+	values.clear();
+	for (const QString& token : tokens)
+	{
+		bool ok = true;
+		values.push_back(token.toDouble(&ok));
+		if (!ok)
+		{
+			return cmd.error(QObject::tr("Invalid parameter: '%1' is not a valid number (after '%2')").arg(token, option));
+		}
+	}
+
+	return true;
+}
+
 bool CommandLoad::process(ccCommandLineInterface& cmd)
 {
 	if (cmd.arguments().empty())
@@ -581,11 +679,133 @@ bool CommandLoad::process(ccCommandLineInterface& cmd)
 	//optional parameters
 	int skipLines = 0;
 	ccCommandLineInterface::GlobalShiftOptions globalShiftOptions;
+	FileIOFilter::PointsFilter pointsFilter;
+	unsigned blockSize = 0;
 
 	while (!cmd.arguments().empty())
 	{
 		QString argument = cmd.arguments().front();
-		if (ccCommandLineInterface::IsCommand(argument, COMMAND_OPEN_SKIP_LINES))
+		std::vector<double> values;
+		if (ccCommandLineInterface::IsCommand(argument, COMMAND_OPEN_FILTER_BOX))
+		{
+			//local option confirmed, we can move on
+			cmd.arguments().pop_front();
+
+			if (!ReadColonSeparatedValues(cmd, COMMAND_OPEN_FILTER_BOX, values))
+			{
+				//error message already issued
+				return false;
+			}
+			if (values.size() != 4)
+			{
+				return cmd.error(QObject::tr("Invalid parameter: box extents after '%1' (expected format is 'Xmin:Ymin:Xmax:Ymax')").arg(COMMAND_OPEN_FILTER_BOX));
+			}
+
+			pointsFilter.useBox = true;
+			pointsFilter.boxMin = CCVector2d(values[0], values[1]);
+			pointsFilter.boxMax = CCVector2d(values[2], values[3]);
+		}
+		else if (ccCommandLineInterface::IsCommand(argument, COMMAND_OPEN_FILTER_POLYGON))
+		{
+			//local option confirmed, we can move on
+			cmd.arguments().pop_front();
+
+			if (!ReadColonSeparatedValues(cmd, COMMAND_OPEN_FILTER_POLYGON, values))
+			{
+				//error message already issued
+				return false;
+			}
+			if (values.size() < 6 || (values.size() % 2) != 0)
+			{
+				return cmd.error(QObject::tr("Invalid parameter: polygon vertices after '%1' (expected format is 'X1:Y1:X2:Y2:X3:Y3...')").arg(COMMAND_OPEN_FILTER_POLYGON));
+			}
+
+			pointsFilter.polygon.clear();
+			for (size_t i = 0; i + 1 < values.size(); i += 2)
+			{
+				pointsFilter.polygon.emplace_back(values[i], values[i + 1]);
+			}
+		}
+		else if (ccCommandLineInterface::IsCommand(argument, COMMAND_OPEN_FILTER_CLASSIFICATION))
+		{
+			//local option confirmed, we can move on
+			cmd.arguments().pop_front();
+
+			if (!ReadColonSeparatedValues(cmd, COMMAND_OPEN_FILTER_CLASSIFICATION, values))
+			{
+				//error message already issued
+				return false;
+			}
+
+			pointsFilter.classifications.clear();
+			for (double value : values)
+			{
+				pointsFilter.classifications.push_back(static_cast<int>(value));
+			}
+		}
+		else if (ccCommandLineInterface::IsCommand(argument, COMMAND_OPEN_FILTER_RETURN_NUMBER))
+		{
+			//local option confirmed, we can move on
+			cmd.arguments().pop_front();
+
+			if (!ReadColonSeparatedValues(cmd, COMMAND_OPEN_FILTER_RETURN_NUMBER, values))
+			{
+				//error message already issued
+				return false;
+			}
+
+			pointsFilter.returnNumbers.clear();
+			for (double value : values)
+			{
+				pointsFilter.returnNumbers.push_back(static_cast<int>(value));
+			}
+		}
+		else if (ccCommandLineInterface::IsCommand(argument, COMMAND_OPEN_FILTER_GPS_TIME))
+		{
+			//local option confirmed, we can move on
+			cmd.arguments().pop_front();
+
+			if (!ReadColonSeparatedValues(cmd, COMMAND_OPEN_FILTER_GPS_TIME, values))
+			{
+				//error message already issued
+				return false;
+			}
+			if (values.size() != 2)
+			{
+				return cmd.error(QObject::tr("Invalid parameter: GPS time range after '%1' (expected format is 'Tmin:Tmax')").arg(COMMAND_OPEN_FILTER_GPS_TIME));
+			}
+
+			pointsFilter.useGpsTimeRange = true;
+			pointsFilter.minGpsTime = values[0];
+			pointsFilter.maxGpsTime = values[1];
+		}
+		else if (ccCommandLineInterface::IsCommand(argument, COMMAND_OPEN_NO_SPATIAL_INDEX))
+		{
+			//local option confirmed, we can move on
+			cmd.arguments().pop_front();
+
+			pointsFilter.useSpatialIndex = false;
+		}
+		else if (ccCommandLineInterface::IsCommand(argument, COMMAND_OPEN_STREAM))
+		{
+			//local option confirmed, we can move on
+			cmd.arguments().pop_front();
+
+			if (cmd.arguments().empty())
+			{
+				return cmd.error(QObject::tr("Missing parameter: block size after '%1'").arg(COMMAND_OPEN_STREAM));
+			}
+
+			bool ok;
+			blockSize = cmd.arguments().takeFirst().toUInt(&ok);
+			if (!ok || blockSize == 0)
+			{
+				return cmd.error(QObject::tr("Invalid parameter: block size after '%1'").arg(COMMAND_OPEN_STREAM));
+			}
+
+			cmd.print(QObject::tr("The cloud will be streamed by blocks of %1 points").arg(blockSize));
+		}
+		else if (ccCommandLineInterface::IsCommand(argument, COMMAND_OPEN_SKIP_LINES))
 		{
 			//local option confirmed, we can move on
 			cmd.arguments().pop_front();
@@ -626,14 +846,26 @@ bool CommandLoad::process(ccCommandLineInterface& cmd)
 		AsciiFilter::SetDefaultSkippedLineCount(skipLines);
 	}
 	
-	//open specified file
-	QString filename(cmd.arguments().takeFirst());
-	if (!cmd.importFile(filename, globalShiftOptions))
+	if (cmd.arguments().empty())
 	{
-		return false;
+		return cmd.error(QObject::tr("Missing parameter: filename after \"-%1\"").arg(COMMAND_OPEN));
 	}
 
-	return true;
+	//the points filter only applies to this file
+	if (pointsFilter.isActive())
+	{
+		cmd.print(QObject::tr("Points will be filtered at loading time (if supported by the file format)"));
+	}
+	cmd.fileLoadingParams().pointsFilter = pointsFilter;
+
+	//open specified file
+	QString filename(cmd.arguments().takeFirst());
+	bool success = (blockSize != 0 ? cmd.importFileAsStream(filename, globalShiftOptions, blockSize)
+	                               : cmd.importFile(filename, globalShiftOptions));
+
+	cmd.fileLoadingParams().pointsFilter = FileIOFilter::PointsFilter();
+
+	return success;
 }
 
 CommandLoadCommandFile::CommandLoadCommandFile()
@@ -2299,6 +2531,9 @@ bool CommandApplyTransformation::process(ccCommandLineInterface& cmd)
 	//add clouds to the vector
 	for (CLCloudDesc& desc : cmd.clouds())
 	{
+		//successive transformations are only composed (they will be applied
+		//to the points before the next command that needs them, or when saving)
+		desc.pc->setDeferredTransformations(true);
 		entities.push_back({ desc.pc, &desc });
 	}
 
@@ -2601,6 +2836,16 @@ bool CommandSFConvertToRGB::process(ccCommandLineInterface& cmd)
 		}
 		else
 		{
+			if (cmd.isCloudStreamed())
+			{
+				//a relative color scale would be applied to the range of the current block, not to the range of the whole cloud
+				ccScalarField* sf = static_cast<ccScalarField*>(desc.pc->getScalarField(activeSFIndex));
+				if (!sf->getColorScale() || sf->getColorScale()->isRelative())
+				{
+					return cmd.error(QObject::tr("Only absolute color scales can be used with \"-%1\" while a cloud is streamed").arg(COMMAND_SF_CONVERT_TO_RGB));
+				}
+			}
+
 			int displaySFIndex = desc.pc->getCurrentDisplayedScalarFieldIndex();
 			desc.pc->setCurrentDisplayedScalarField(activeSFIndex);
 			
@@ -2889,6 +3134,12 @@ bool CommandFilterBySFValue::process(ccCommandLineInterface& cmd)
 	}
 	
 	cmd.print(QObject::tr("\tInterval: [%1 - %2]").arg(minValStr, maxValStr));
+
+	if (cmd.isCloudStreamed() && (useValForMin != USE_NONE || useValForMax != USE_NONE))
+	{
+		//the statistics would be those of the current block, not of the whole cloud
+		return cmd.error(QObject::tr("Only explicit values can be used with \"-%1\" while a cloud is streamed (MIN, MAX, N_SIGMA, etc. depend on the whole cloud)").arg(COMMAND_FILTER_SF_BY_VALUE));
+	}
 	
 	if (cmd.clouds().empty() && cmd.meshes().empty())
 	{
@@ -7339,6 +7590,25 @@ bool CommandMoment::process(ccCommandLineInterface& cmd)
 
 	if (ccLibAlgorithms::ComputeGeomCharacteristic(CCCoreLib::GeometricalAnalysisTools::MomentOrder1, 0, kernelSize, entities, nullptr, cmd.widgetParent()))
 	{
+		const QString sfName = CC_MOMENT_ORDER1_FIELD_NAME + QString(" (%1)").arg(kernelSize);
+		for (const CLCloudDesc& desc : cmd.clouds())
+		{
+			int sfIdx = desc.pc->getScalarFieldIndexByName(qPrintable(sfName));
+			ccScalarField* sf = (sfIdx >= 0 ? static_cast<ccScalarField*>(desc.pc->getScalarField(sfIdx)) : nullptr);
+			if (!sf)
+			{
+				continue;
+			}
+
+			//the statistics are computed along with the min and max values
+			sf->computeMinAndMax();
+			const ccScalarField::Statistics& stats = sf->getStatistics();
+			if (stats.validCount != 0)
+			{
+				cmd.print(QObject::tr("\tCloud '%1': mean = %2 / std. dev. = %3 (%4 valid values)").arg(desc.pc->getName()).arg(stats.mean()).arg(sqrt(stats.variance())).arg(stats.validCount));
+			}
+		}
+
 		//save output
 		if (cmd.autoSaveMode() && !cmd.saveClouds(QObject::tr("MOMENT_KERNEL_%2").arg(kernelSize)))
 		{
@@ -144,6 +144,7 @@ struct CommandApplyTransformation : public ccCommandLineInterface::Command
 	CommandApplyTransformation();
 
 	bool process(ccCommandLineInterface& cmd) override;
+	bool supportsDeferredTransformations() const override { return true; }
 };
 
 struct CommandDropGlobalShift : public ccCommandLineInterface::Command
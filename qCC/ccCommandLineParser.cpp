@@ -9,6 +9,7 @@
 //qCC_db
 #include <ccGenericMesh.h>
 #include <ccHObjectCaster.h>
+#include <ccPointCloud.h>
 #include <ccProgressDialog.h>
 
 //qCC_io
@@ -23,6 +24,7 @@
 //Qt
 #include <QDateTime>
 #include <QElapsedTimer>
+#include <QFileInfo>
 #include <QMessageBox>
 
 //system
@@ -222,6 +224,18 @@ ccCommandLineParser::~ccCommandLineParser()
 	}
 }
 
+bool ccCommandLineParser::registerCommand(Command::Shared command, StreamUsage streamUsage)
+{
+	if (!registerCommand(command))
+	{
+		return false;
+	}
+
+	m_streamUsages.insert(command->m_keyword, streamUsage);
+
+	return true;
+}
+
 bool ccCommandLineParser::registerCommand(Command::Shared command)
 {
 	if (!command)
@@ -564,15 +578,13 @@ void ccCommandLineParser::removeMeshes(bool onlyLast/*=false*/)
 	}
 }
 
-bool ccCommandLineParser::importFile(QString filename, const GlobalShiftOptions& globalShiftOptions, FileIOFilter::Shared filter)
-{
-	printHigh(QString("Opening file: '%1'").arg(filename));
-
-	//whether Global (coordinate) shift has already been defined
-	static bool s_firstCoordinatesShiftEnabled = false;
-	//global shift (if defined)
-	static CCVector3d s_firstGlobalShift;
+//whether Global (coordinate) shift has already been defined
+static bool s_firstCoordinatesShiftEnabled = false;
+//global shift (if defined)
+static CCVector3d s_firstGlobalShift;
 
+void ccCommandLineParser::prepareGlobalShift(const GlobalShiftOptions& globalShiftOptions)
+{
 	//default Global Shift handling parameters
 	m_loadingParameters.shiftHandlingMode = ccGlobalShiftManager::NO_DIALOG;
 	m_loadingParameters.coordinatesShiftEnabled = false;
@@ -602,6 +614,28 @@ bool ccCommandLineParser::importFile(QString filename, const GlobalShiftOptions&
 		//nothing to do
 		break;
 	}
+}
+
+void ccCommandLineParser::storeGlobalShift(const GlobalShiftOptions& globalShiftOptions)
+{
+	if (globalShiftOptions.mode != GlobalShiftOptions::NO_GLOBAL_SHIFT)
+	{
+		static bool s_firstTime = true;
+		if (s_firstTime)
+		{
+			// remember the first Global Shift parameters used
+			s_firstCoordinatesShiftEnabled = m_loadingParameters.coordinatesShiftEnabled;
+			s_firstGlobalShift = m_loadingParameters.coordinatesShift;
+			s_firstTime = false;
+		}
+	}
+}
+
+bool ccCommandLineParser::importFile(QString filename, const GlobalShiftOptions& globalShiftOptions, FileIOFilter::Shared filter)
+{
+	printHigh(QString("Opening file: '%1'").arg(filename));
+
+	prepareGlobalShift(globalShiftOptions);
 
 	CC_FILE_ERROR result = CC_FERR_NO_ERROR;
 	ccHObject* db = nullptr;
@@ -619,17 +653,7 @@ bool ccCommandLineParser::importFile(QString filename, const GlobalShiftOptions&
 		return false/*cmd.error(QString("Failed to open file '%1'").arg(filename))*/; //Error message already issued
 	}
 
-	if (globalShiftOptions.mode != GlobalShiftOptions::NO_GLOBAL_SHIFT)
-	{
-		static bool s_firstTime = true;
-		if (s_firstTime)
-		{
-			// remember the first Global Shift parameters used
-			s_firstCoordinatesShiftEnabled = m_loadingParameters.coordinatesShiftEnabled;
-			s_firstGlobalShift = m_loadingParameters.coordinatesShift;
-			s_firstTime = false;
-		}
-	}
+	storeGlobalShift(globalShiftOptions);
 
 	std::unordered_set<unsigned> verticesIDs;
 	//first look for meshes inside loaded DB (so that we don't consider mesh vertices as clouds!)
@@ -723,8 +747,256 @@ bool ccCommandLineParser::importFile(QString filename, const GlobalShiftOptions&
 	return true;
 }
 
+bool ccCommandLineParser::importFileAsStream(QString filename, const GlobalShiftOptions& globalShiftOptions, unsigned blockSize)
+{
+	printHigh(QString("Opening file (as a stream): '%1'").arg(filename));
+
+	if (m_stream)
+	{
+		return error("Only one cloud can be streamed at a time");
+	}
+	if (!m_clouds.empty())
+	{
+		return error("Loaded clouds can't be processed with a streamed cloud (they must be cleared first)");
+	}
+	if (blockSize == 0)
+	{
+		assert(false);
+		return error("Invalid block size");
+	}
+
+	FileIOFilter::Shared filter = FileIOFilter::FindBestFilterForExtension(QFileInfo(filename).suffix());
+	if (!filter)
+	{
+		return error(QString("Can't guess file format: unhandled file extension '%1'").arg(QFileInfo(filename).suffix()));
+	}
+
+	prepareGlobalShift(globalShiftOptions);
+
+	CC_FILE_ERROR result = CC_FERR_NO_ERROR;
+	FileIOFilter::StreamedReader::Shared reader = filter->createStreamedReader(filename, m_loadingParameters, result);
+	if (!reader)
+	{
+		if (result == CC_FERR_NOT_IMPLEMENTED)
+		{
+			return error(QString("This file format can't be streamed: '%1'").arg(filename));
+		}
+		FileIOFilter::DisplayErrorMessage(result, "loading", filename);
+		return false;
+	}
+
+	storeGlobalShift(globalShiftOptions);
+
+	m_stream.reset(new Stream);
+	m_stream->reader = reader;
+	m_stream->filename = filename;
+	m_stream->blockSize = blockSize;
+	//the blocks can't be saved individually
+	m_stream->autoSaveMode = m_autoSaveMode;
+	m_autoSaveMode = false;
+
+	print(QString("Stream of %1 points (blocks of %2 points)").arg(reader->pointCount()).arg(blockSize));
+
+	//the first block is loaded right away, so that the next commands can be applied to it
+	return loadNextStreamBlock();
+}
+
+bool ccCommandLineParser::loadNextStreamBlock()
+{
+	assert(m_stream);
+
+	while (true)
+	{
+		removeClouds();
+
+		ccPointCloud* block = new ccPointCloud(QFileInfo(m_stream->filename).completeBaseName());
+		CC_FILE_ERROR result = m_stream->reader->readBlock(*block, m_stream->blockSize);
+		if (result != CC_FERR_NO_ERROR)
+		{
+			delete block;
+			FileIOFilter::DisplayErrorMessage(result, "loading", m_stream->filename);
+			return false;
+		}
+
+		if (block->size() == 0)
+		{
+			//all the points have been read
+			delete block;
+			return true;
+		}
+
+		m_stream->readPointCount += block->size();
+		printVerbose(QString("[STREAM] %1 / %2 points read").arg(m_stream->readPointCount).arg(m_stream->reader->pointCount()));
+		m_clouds.emplace_back(block, m_stream->filename, -1);
+
+		if (!applyStreamCommands())
+		{
+			return false;
+		}
+
+		if (!m_clouds.empty())
+		{
+			return true;
+		}
+		//all the points of this block have been removed, let's try the next one
+	}
+}
+
+void ccCommandLineParser::applyPendingTransformations()
+{
+	for (CLCloudDesc& desc : m_clouds)
+	{
+		if (desc.pc)
+		{
+			desc.pc->setDeferredTransformations(false);
+		}
+	}
+}
+
+bool ccCommandLineParser::applyStreamCommands()
+{
+	assert(m_stream);
+
+	//the commands consume their own arguments
+	QStringList remainingArguments;
+	std::swap(remainingArguments, m_arguments);
+
+	bool success = true;
+	for (const QStringList& command : m_stream->commands)
+	{
+		if (m_clouds.empty())
+		{
+			//all the points of the block have been removed
+			break;
+		}
+
+		m_arguments = command;
+		QString keyword = m_arguments.takeFirst().mid(1).toUpper();
+		assert(m_commands.contains(keyword));
+		if (!m_commands[keyword]->supportsDeferredTransformations())
+		{
+			applyPendingTransformations();
+		}
+		success = m_commands[keyword]->process(*this);
+		if (!success)
+		{
+			break;
+		}
+	}
+
+	std::swap(remainingArguments, m_arguments);
+
+	return success;
+}
+
+bool ccCommandLineParser::saveStream(const QString& suffix, const QString* outputFileName)
+{
+	assert(m_stream);
+
+	if (m_clouds.empty() && !loadNextStreamBlock())
+	{
+		closeStream();
+		return false;
+	}
+	if (m_clouds.empty())
+	{
+		closeStream();
+		return error("No point left in the streamed cloud");
+	}
+
+	FileIOFilter::Shared filter = FileIOFilter::GetFilter(m_cloudExportFormat, false);
+	if (!filter)
+	{
+		closeStream();
+		return error(QString("Unhandled output format for clouds: '%1'").arg(m_cloudExportFormat));
+	}
+
+	CLCloudDesc desc = m_clouds.front();
+	if (outputFileName)
+	{
+		CommandSave::SetFileDesc(desc, *outputFileName);
+	}
+	QString outputFilename = getExportFilename(desc, m_cloudExportExt, suffix);
+
+	FileIOFilter::SaveParameters parameters;
+	{
+		//no dialog by default for command line mode!
+		parameters.alwaysDisplaySaveDialog = false;
+		if (!silentMode() && ccConsole::TheInstance())
+		{
+			parameters.parentWidget = ccConsole::TheInstance()->parentWidget();
+		}
+	}
+
+	CC_FILE_ERROR result = CC_FERR_NO_ERROR;
+	FileIOFilter::StreamedWriter::Shared writer = filter->createStreamedWriter(outputFilename, parameters, result);
+	if (!writer)
+	{
+		closeStream();
+		if (result == CC_FERR_NOT_IMPLEMENTED)
+		{
+			return error(QString("The currently selected output format for clouds (%1) doesn't handle streamed clouds!").arg(m_cloudExportFormat));
+		}
+		FileIOFilter::DisplayErrorMessage(result, "saving", outputFilename);
+		return false;
+	}
+
+	print(QString("[STREAM] Processing and saving all the blocks in '%1'").arg(outputFilename));
+
+	while (!m_clouds.empty())
+	{
+		for (CLCloudDesc& blockDesc : m_clouds)
+		{
+			result = FileIOFilter::WriteStreamedBlock(*writer, *blockDesc.pc);
+			if (result != CC_FERR_NO_ERROR)
+			{
+				FileIOFilter::DisplayErrorMessage(result, "saving", outputFilename);
+				closeStream();
+				return false;
+			}
+		}
+
+		if (!loadNextStreamBlock())
+		{
+			closeStream();
+			return false;
+		}
+	}
+
+	closeStream();
+
+	result = writer->close();
+	if (result != CC_FERR_NO_ERROR)
+	{
+		FileIOFilter::DisplayErrorMessage(result, "saving", outputFilename);
+		return false;
+	}
+
+	print(QString("[I/O] File '%1' saved successfully").arg(outputFilename));
+
+	return true;
+}
+
+void ccCommandLineParser::closeStream()
+{
+	if (!m_stream)
+	{
+		return;
+	}
+
+	removeClouds();
+	m_autoSaveMode = m_stream->autoSaveMode;
+	m_stream.reset();
+}
+
 bool ccCommandLineParser::saveClouds(QString suffix/*=QString()*/, bool allAtOnce/*=false*/, const QString* allAtOnceFileName/*=nullptr*/)
 {
+	if (m_stream)
+	{
+		//the blocks of the streamed cloud are all saved in the same file
+		return saveStream(suffix, allAtOnce ? allAtOnceFileName : nullptr);
+	}
+
 	//all-at-once: all clouds in a single file
 	if (allAtOnce)
 	{
@@ -847,17 +1119,17 @@ void ccCommandLineParser::registerBuiltInCommands()
 	registerCommand(Command::Shared(new CommandDensity));
 	registerCommand(Command::Shared(new CommandSFGradient));
 	registerCommand(Command::Shared(new CommandRoughness));
-	registerCommand(Command::Shared(new CommandApplyTransformation));
+	registerCommand(Command::Shared(new CommandApplyTransformation), StreamUsage::PerBlock);
 	registerCommand(Command::Shared(new CommandDropGlobalShift));
-	registerCommand(Command::Shared(new CommandFilterBySFValue));
+	registerCommand(Command::Shared(new CommandFilterBySFValue), StreamUsage::PerBlock);
 	registerCommand(Command::Shared(new CommandMergeClouds));
 	registerCommand(Command::Shared(new CommandMergeMeshes));
-	registerCommand(Command::Shared(new CommandSetActiveSF));
+	registerCommand(Command::Shared(new CommandSetActiveSF), StreamUsage::PerBlock);
 	registerCommand(Command::Shared(new CommandSetGlobalShift));
-	registerCommand(Command::Shared(new CommandRemoveAllSFs));
-	registerCommand(Command::Shared(new CommandRemoveSF));
-	registerCommand(Command::Shared(new CommandRemoveRGB));
-	registerCommand(Command::Shared(new CommandRemoveNormals));
+	registerCommand(Command::Shared(new CommandRemoveAllSFs), StreamUsage::PerBlock);
+	registerCommand(Command::Shared(new CommandRemoveSF), StreamUsage::PerBlock);
+	registerCommand(Command::Shared(new CommandRemoveRGB), StreamUsage::PerBlock);
+	registerCommand(Command::Shared(new CommandRemoveNormals), StreamUsage::PerBlock);
 	registerCommand(Command::Shared(new CommandRemoveScanGrids));
 	registerCommand(Command::Shared(new CommandRemoveSensors));
 	registerCommand(Command::Shared(new CommandMatchBBCenters));
@@ -870,9 +1142,9 @@ void ccCommandLineParser::registerBuiltInCommands()
 	registerCommand(Command::Shared(new CommandCompressFWF));
 	registerCommand(Command::Shared(new CommandExtractVertices));
 	registerCommand(Command::Shared(new CommandCrossSection));
-	registerCommand(Command::Shared(new CommandCrop));
+	registerCommand(Command::Shared(new CommandCrop), StreamUsage::PerBlock);
 	registerCommand(Command::Shared(new CommandCrop2D));
-	registerCommand(Command::Shared(new CommandCoordToSF));
+	registerCommand(Command::Shared(new CommandCoordToSF), StreamUsage::PerBlock);
 	registerCommand(Command::Shared(new CommandSFToCoord));
 	registerCommand(Command::Shared(new CommandColorBanding));
 	registerCommand(Command::Shared(new CommandColorLevels));
@@ -881,32 +1153,32 @@ void ccCommandLineParser::registerBuiltInCommands()
     registerCommand(Command::Shared(new CommandCPS));
 	registerCommand(Command::Shared(new CommandStatTest));
 	registerCommand(Command::Shared(new CommandDelaunayTri));
-	registerCommand(Command::Shared(new CommandSFArithmetic));
-	registerCommand(Command::Shared(new CommandSFOperation));
+	registerCommand(Command::Shared(new CommandSFArithmetic), StreamUsage::PerBlock);
+	registerCommand(Command::Shared(new CommandSFOperation), StreamUsage::PerBlock);
     registerCommand(Command::Shared(new CommandSFOperationSF));
     registerCommand(Command::Shared(new CommandSFInterpolation));
     registerCommand(Command::Shared(new CommandColorInterpolation));
 	registerCommand(Command::Shared(new CommandRenameEntities));
-	registerCommand(Command::Shared(new CommandSFRename));
-	registerCommand(Command::Shared(new CommandSFAddConst));
+	registerCommand(Command::Shared(new CommandSFRename), StreamUsage::PerBlock);
+	registerCommand(Command::Shared(new CommandSFAddConst), StreamUsage::PerBlock);
 	registerCommand(Command::Shared(new CommandSFAddId));
 	registerCommand(Command::Shared(new CommandICP));
-	registerCommand(Command::Shared(new CommandChangeCloudOutputFormat));
+	registerCommand(Command::Shared(new CommandChangeCloudOutputFormat), StreamUsage::Global);
 	registerCommand(Command::Shared(new CommandChangeMeshOutputFormat));
 	registerCommand(Command::Shared(new CommandChangeHierarchyOutputFormat));
 	registerCommand(Command::Shared(new CommandChangePLYExportFormat));
 	registerCommand(Command::Shared(new CommandForceNormalsComputation));
-	registerCommand(Command::Shared(new CommandSaveClouds));
+	registerCommand(Command::Shared(new CommandSaveClouds), StreamUsage::Global);
 	registerCommand(Command::Shared(new CommandSaveMeshes));
 	registerCommand(Command::Shared(new CommandAutoSave));
-	registerCommand(Command::Shared(new CommandLogFile));
+	registerCommand(Command::Shared(new CommandLogFile), StreamUsage::Global);
 	registerCommand(Command::Shared(new CommandSelectEntities));
 	registerCommand(Command::Shared(new CommandClear));
 	registerCommand(Command::Shared(new CommandClearClouds));
 	registerCommand(Command::Shared(new CommandPopClouds));
 	registerCommand(Command::Shared(new CommandClearMeshes));
 	registerCommand(Command::Shared(new CommandPopMeshes));
-	registerCommand(Command::Shared(new CommandSetNoTimestamp));
+	registerCommand(Command::Shared(new CommandSetNoTimestamp), StreamUsage::Global);
 	registerCommand(Command::Shared(new CommandVolume25D));
 	registerCommand(Command::Shared(new CommandRasterize));
 	registerCommand(Command::Shared(new CommandOctreeNormal));
@@ -916,17 +1188,42 @@ void ccCommandLineParser::registerBuiltInCommands()
 	registerCommand(Command::Shared(new CommandClearNormals));
 	registerCommand(Command::Shared(new CommandInvertNormal));
 	registerCommand(Command::Shared(new CommandComputeMeshVolume));
-	registerCommand(Command::Shared(new CommandSFColorScale));
-	registerCommand(Command::Shared(new CommandSFConvertToRGB));
+	registerCommand(Command::Shared(new CommandSFColorScale), StreamUsage::PerBlock);
+	registerCommand(Command::Shared(new CommandSFConvertToRGB), StreamUsage::PerBlock);
 	registerCommand(Command::Shared(new CommandMoment));
 	registerCommand(Command::Shared(new CommandFeature));
 	registerCommand(Command::Shared(new CommandRGBConvertToSF));
 	registerCommand(Command::Shared(new CommandFlipTriangles));
-	registerCommand(Command::Shared(new CommandSetVerbosity));
+	registerCommand(Command::Shared(new CommandSetVerbosity), StreamUsage::Global);
+}
+
+bool ccCommandLineParser::prepareStreamCommand(const QString& keyword)
+{
+	assert(m_stream);
+
+	StreamUsage usage = m_streamUsages.value(keyword, StreamUsage::None);
+	if (usage == StreamUsage::None)
+	{
+		return error(QString("Command '-%1' can't be used while a cloud is streamed (only point-local commands can)").arg(keyword));
+	}
+
+	//if all the points of the current block have been removed, we move to the next one
+	if (m_clouds.empty() && !loadNextStreamBlock())
+	{
+		return false;
+	}
+
+	if (m_clouds.empty() && usage == StreamUsage::PerBlock)
+	{
+		return error("No point left in the streamed cloud");
+	}
+
+	return true;
 }
 
 void ccCommandLineParser::cleanup()
 {
+	closeStream();
 	removeClouds();
 	removeMeshes();
 }
@@ -968,12 +1265,31 @@ int ccCommandLineParser::start(QDialog* parent/*=nullptr*/)
 		if (m_commands.contains(keyword))
 		{
 			assert(m_commands[keyword]);
+			if (m_stream && !prepareStreamCommand(keyword))
+			{
+				success = false;
+				break;
+			}
+
 			QElapsedTimer eTimerSubProcess;
 			eTimerSubProcess.start();
 			QString processName = m_commands[keyword]->m_name.toUpper();
 			printHigh(QString("[%1]").arg(processName));
+			QStringList argumentsBefore = m_arguments;
+			if (!m_commands[keyword]->supportsDeferredTransformations())
+			{
+				applyPendingTransformations();
+			}
 			success = m_commands[keyword]->process(*this);
 			printHigh(QString("[%2] finished in %1 s.").arg(eTimerSubProcess.elapsed() / 1.0e3, 0, 'f', 2).arg(processName));
+
+			if (success && m_stream && m_streamUsages.value(keyword) == StreamUsage::PerBlock)
+			{
+				//record the command and its arguments, to apply it to the next blocks
+				QStringList command = argumentsBefore.mid(0, argumentsBefore.size() - m_arguments.size());
+				command.prepend(argument);
+				m_stream->commands.push_back(command);
+			}
 		}
 		//silent mode (i.e. no console)
 		else if (keyword == COMMAND_SILENT_MODE)
@@ -996,6 +1312,19 @@ int ccCommandLineParser::start(QDialog* parent/*=nullptr*/)
 		}
 	}
 
+	if (success && m_stream)
+	{
+		if (m_stream->autoSaveMode)
+		{
+			success = saveClouds();
+		}
+		else
+		{
+			warning("The streamed cloud has not been saved (use -SAVE_CLOUDS)");
+		}
+	}
+	closeStream();
+
 	print(QString("Processed finished in %1 s.").arg(eTimer.elapsed() / 1.0e3, 0, 'f', 2));
 
 	return success ? EXIT_SUCCESS : EXIT_FAILURE;
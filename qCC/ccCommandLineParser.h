@@ -23,6 +23,9 @@
 //Local
 #include "ccPluginManager.h"
 
+//system
+#include <memory>
+
 class ccProgressDialog;
 class QDialog;
 
@@ -66,6 +69,8 @@ public:
 	bool saveClouds(QString suffix = QString(), bool allAtOnce = false, const QString* allAtOnceFileName = nullptr) override;
 	bool saveMeshes(QString suffix = QString(), bool allAtOnce = false, const QString* allAtOnceFileName = nullptr) override;
 	bool importFile(QString filename, const GlobalShiftOptions& globalShiftOptions, FileIOFilter::Shared filter = FileIOFilter::Shared(nullptr)) override;
+	bool importFileAsStream(QString filename, const GlobalShiftOptions& globalShiftOptions, unsigned blockSize) override;
+	bool isCloudStreamed() const override { return m_stream != nullptr; }
 	QString cloudExportFormat() const override { return m_cloudExportFormat; }
 	QString cloudExportExt() const override { return m_cloudExportExt; }
 	QString meshExportFormat() const override { return m_meshExportFormat; }
@@ -90,6 +95,61 @@ protected: //other methods
 	//! Parses the command line
 	int start(QDialog* parent = nullptr);
 
+	//! How a command can be used while a cloud is streamed
+	enum class StreamUsage
+	{
+		None,		//!< can't be used
+		Global,		//!< applied once (doesn't modify the clouds)
+		PerBlock	//!< point-local command, applied to each block
+	};
+
+	//! Registers a built-in command and how it can be used while a cloud is streamed
+	bool registerCommand(Command::Shared command, StreamUsage streamUsage);
+
+protected:
+
+	//! Applies the pending (deferred) transformations of the loaded clouds (if any)
+	/** And disables the deferred transformations mode.
+	**/
+	void applyPendingTransformations();
+
+private: //streamed cloud
+
+	//! Prepares the global shift loading parameters
+	void prepareGlobalShift(const GlobalShiftOptions& globalShiftOptions);
+	//! Remembers the first global shift used (if necessary)
+	void storeGlobalShift(const GlobalShiftOptions& globalShiftOptions);
+
+	//! Checks that a command can be applied to the streamed cloud
+	bool prepareStreamCommand(const QString& keyword);
+	//! Loads the next (non empty) block of the streamed cloud and applies the recorded commands to it
+	/** The clouds set is empty once all the blocks have been read.
+	**/
+	bool loadNextStreamBlock();
+	//! Applies the recorded (point-local) commands to the current block
+	bool applyStreamCommands();
+	//! Processes all the remaining blocks and saves them in a single file (with the current block)
+	bool saveStream(const QString& suffix, const QString* outputFileName);
+	//! Closes the streamed cloud
+	void closeStream();
+
+	//! Streamed cloud
+	struct Stream
+	{
+		//! Block reader
+		FileIOFilter::StreamedReader::Shared reader;
+		//! Filename
+		QString filename;
+		//! Maximum number of points per block
+		unsigned blockSize = 0;
+		//! Number of points read so far
+		qint64 readPointCount = 0;
+		//! Point-local commands (and their arguments) to apply to each block
+		std::vector<QStringList> commands;
+		//! Auto-save mode (disabled while the cloud is streamed)
+		bool autoSaveMode = false;
+	};
+
 private: //members
 
 	//! Current cloud(s) export format (can be modified with the 'COMMAND_CLOUD_EXPORT_FORMAT' option)
@@ -114,6 +174,12 @@ private: //members
 	//! Registered commands
 	QMap< QString, Command::Shared > m_commands;
 
+	//! How the registered commands can be used while a cloud is streamed
+	QMap< QString, StreamUsage > m_streamUsages;
+
+	//! Streamed cloud (if any)
+	std::unique_ptr<Stream> m_stream;
+
 	//! Oprhan entities
 	ccHObject m_orphans;
 
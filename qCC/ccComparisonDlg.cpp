@@ -402,10 +402,10 @@ bool ccComparisonDlg::computeApproxDistances()
 		ccLog::Print("[computeApproxDistances] Time: %3.2f s.", elapsedTime_ms / 1.0e3);
 
 		//display approx. dist. statistics
-		ScalarType mean;
-		ScalarType variance;
 		sf->computeMinAndMax();
-		sf->computeMeanAndVariance(mean,&variance);
+		const ccScalarField::Statistics& stats = static_cast<ccScalarField*>(sf)->getStatistics();
+		ScalarType mean = static_cast<ScalarType>(stats.mean());
+		ScalarType variance = static_cast<ScalarType>(stats.variance());
 
 		approxStats->setColumnCount(2);
 		approxStats->setRowCount(5);
@@ -884,10 +884,10 @@ bool ccComparisonDlg::computeDistances()
 		ccLog::Print("[ComputeDistances] Time: %3.2f s.", elapsedTime_ms / 1.0e3);
 
 		//display some statics about the computed distances
-		ScalarType mean;
-		ScalarType variance;
 		sf->computeMinAndMax();
-		sf->computeMeanAndVariance(mean, &variance);
+		const ccScalarField::Statistics& stats = static_cast<ccScalarField*>(sf)->getStatistics();
+		ScalarType mean = static_cast<ScalarType>(stats.mean());
+		ScalarType variance = static_cast<ScalarType>(stats.variance());
 		ccLog::Print("[ComputeDistances] " + tr("Mean distance = %1 / std deviation = %2").arg(mean).arg(sqrt(variance)));
 
 		m_compCloud->setCurrentDisplayedScalarField(sfIdx);
@@ -33,6 +33,7 @@
 #include <ccColorScalesManager.h>
 #include <ccFacet.h>
 #include <ccGenericPrimitive.h>
+#include <ccMultiReferenceCloud.h>
 #include <ccOctreeProxy.h>
 #include <ccPointCloud.h>
 #include <ccPointCloudInterpolator.h>
@@ -73,6 +74,7 @@
 
 // System
 #include <unordered_set>
+#include <algorithm>
 #include <array>
 
 namespace ccEntityAction
@@ -1293,29 +1295,53 @@ namespace ccEntityAction
 				tooManyCloudsQuestionAsked = true;
 			}
 
+			// sort the points by class (in a single pass)
+			ccMultiReferenceCloud classSubsets;
+			std::vector<int> classValues(classes.begin(), classes.end());
+			{
+				bool success = false;
+				try
+				{
+					std::vector<unsigned> pointClassIndexes(N);
+					for (size_t index = 0; index < N; ++index)
+					{
+						int pointClass = static_cast<int>(sf->at(index));
+						pointClassIndexes[index] = static_cast<unsigned>(std::lower_bound(classValues.begin(), classValues.end(), pointClass) - classValues.begin());
+					}
+					success = classSubsets.build(pointClassIndexes, static_cast<unsigned>(classValues.size()));
+				}
+				catch (const std::bad_alloc&)
+				{
+				}
+
+				if (!success)
+				{
+					ccLog::Error(QT_TR_NOOP("Not enough memory"));
+					return false;
+				}
+			}
+
 			ccHObject* destObject = new ccHObject(cloud->getName() + " classes");
 			if (cloud->getParent())
 			{
 				cloud->getParent()->addChild(destObject);
 			}
-            
+
+			// the same reference cloud is used for all the classes
+			CCCoreLib::ReferenceCloud referenceCloud(cloud);
+
 			// create as many clouds as the number of classes
-			for (int pointClass : classes)
+			for (unsigned classIndex = 0; classIndex < classSubsets.subsetCount(); ++classIndex)
             {
+				int pointClass = classValues[classIndex];
                 ccLog::Print("[sfSplitCloud] build cloud corresponding to class #" + QString::number(pointClass));
                 
 				try
 				{
-					// create the reference cloud
-					CCCoreLib::ReferenceCloud referenceCloud(cloud);
-					
-					// populate the cloud with the points which have the selected class
-					for (unsigned index = 0; index < static_cast<unsigned>(cloud->size()); index++)
+					// populate the reference cloud with the points which have the selected class
+					if (!classSubsets.getSubset(classIndex, referenceCloud))
 					{
-						if (static_cast<int>(sf->at(index)) == pointClass)
-						{
-							referenceCloud.addPointIndex(index);
-						}
+						throw std::bad_alloc();
 					}
 					ccPointCloud* pc = cloud->partialClone(&referenceCloud);
 					if (pc)
@@ -2951,8 +2977,10 @@ namespace ccEntityAction
 				continue;
 			}
 
-			//compute the number of valid values
-			size_t sfValidCount = sf->countValidValues();
+			//compute the number of valid values (the values may have been modified since the last scan)
+			sf->computeMinAndMax();
+			const ccScalarField::Statistics& sfStats = sf->getStatistics();
+			size_t sfValidCount = sfStats.validCount;
 			if (sfValidCount == 0)
 			{
 				ccLog::Warning(QObject::tr("Scalar field '%1' of cloud %2 has no valid values").arg(sf->getName()).arg(pc->getName()));
@@ -3026,18 +3054,8 @@ namespace ccEntityAction
 
 				//compute RMS
 				{
-					unsigned n = pc->size();
-					double squareSum = 0;
-					double sum = 0;
-					for (unsigned i = 0; i < n; ++i)
-					{
-						ScalarType v = pc->getPointScalarValue(i);
-						if (CCCoreLib::ScalarField::ValidValue(v))
-						{
-							sum += static_cast<double>(v);
-							squareSum += static_cast<double>(v) * v;
-						}
-					}
+					double squareSum = sfStats.sumOfSquares();
+					double sum = sfStats.sum;
 
 					double rms = sqrt(squareSum / sfValidCount);
 					ccConsole::Print(QObject::tr("Scalar field statistics:"));
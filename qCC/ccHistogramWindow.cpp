@@ -295,18 +295,12 @@ bool ccHistogramWindow::computeBinArrayFromSF(size_t binCount)
 	double range = m_maxVal - m_minVal;
 	if (range > 0.0)
 	{
-		unsigned count = m_associatedSF->currentSize();
-		double step = range / binCount;
-		for (unsigned i = 0; i < count; ++i)
+		//we ignore values outside of [m_minVal,m_maxVal] (works for NaN values as well)
+		if (!m_associatedSF->computeHistogram(m_minVal, m_maxVal, binCount, m_histoValues))
 		{
-			double val = m_associatedSF->getValue(i);
-
-			//we ignore values outside of [m_minVal,m_maxVal] (works fro NaN values as well)
-			if (/*ccScalarField::ValidValue(val) &&*/val >= m_minVal && val <= m_maxVal)
-			{
-				size_t bin = static_cast<size_t>(floor((val - m_minVal) / step));
-				++m_histoValues[std::min(bin, binCount - 1)];
-			}
+			ccLog::Warning("[ccHistogramWindow::computeBinArrayFromSF] Not enough memory!");
+			m_histoValues.resize(0);
+			return false;
 		}
 	}
 	else
@@ -74,6 +74,7 @@
 
 //System
 #include <cassert>
+#include <cmath>
 
 class FilterMouseWheelNoFocusEvent : public QObject
 {
@@ -691,6 +692,16 @@ void ccPropertiesTreeDelegate::fillSFWithPointCloud(ccGenericPointCloud* _obj)
 			if (ccSF)
 			{
 				appendRow(ITEM( tr( "Shift" ) ), ITEM(QString::number(ccSF->getGlobalShift(), 'f', 2)));
+
+				//statistics (the values may have been modified since the last scan)
+				ccSF->computeMinAndMax();
+				const ccScalarField::Statistics& stats = ccSF->getStatistics();
+				appendRow(ITEM( tr( "Valid values" ) ), ITEM(QLocale(QLocale::English).toString(stats.validCount)));
+				if (stats.validCount != 0)
+				{
+					appendRow(ITEM( tr( "Mean" ) ), ITEM(QLocale(QLocale::English).toString(stats.mean())));
+					appendRow(ITEM( tr( "Std. dev." ) ), ITEM(QLocale(QLocale::English).toString(std::sqrt(stats.variance()))));
+				}
 			}
 
 			addSeparator("Color Scale");
@@ -9485,10 +9485,10 @@ void MainWindow::doActionCloudPrimitiveDist()
 		ccScalarField* sf = static_cast<ccScalarField*>(compEnt->getScalarField(sfIdx));
 		if (sf)
 		{
-			ScalarType mean;
-			ScalarType variance;
 			sf->computeMinAndMax();
-			sf->computeMeanAndVariance(mean, &variance);
+			const ccScalarField::Statistics& stats = sf->getStatistics();
+			ScalarType mean = static_cast<ScalarType>(stats.mean());
+			ScalarType variance = static_cast<ScalarType>(stats.variance());
 			ccLog::Print(tr("[Compute Primitive Distances] [Primitive: %1] [Cloud: %2] [%3] Mean distance = %4 / std deviation = %5")
 				.arg(refEntity->getName())
 				.arg(compEnt->getName())